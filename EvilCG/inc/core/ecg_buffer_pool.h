@@ -0,0 +1,109 @@
+#ifndef ECG_BUFFER_POOL_H
+#define ECG_BUFFER_POOL_H
+#include <core/ecg_cl_version.h>
+#include <core/ecg_cmd_chain.h>
+#include <help/ecg_geom.h>
+#include <ecg_api_define.h>
+#include <ecg_global.h>
+
+namespace ecg {
+	class ecg_buffer_pool;
+
+	/// <summary>
+	/// Device buffer that returns to its pool on destruction.
+	/// The capacity is rounded up to the size class, so the buffer can be larger than requested.
+	/// Buffers created from host memory aren't pooled and are released as usual.
+	/// The buffer may only be used by commands of the chain it was acquired for, or by commands ordered before them.
+	/// </summary>
+	class ECG_API ecg_pooled_buffer : public cl::Buffer {
+	public:
+		ecg_pooled_buffer() = default;
+		explicit ecg_pooled_buffer(const cl::Buffer& buffer);
+		ecg_pooled_buffer(std::weak_ptr<ecg_buffer_pool> pool, const cl::Buffer& buffer, ecg_cmd_chain& chain,
+			cl_mem_flags flags, size_t capacity, uint64_t generation);
+
+		ecg_pooled_buffer(const ecg_pooled_buffer& buffer) = delete;
+		ecg_pooled_buffer& operator=(const ecg_pooled_buffer& buffer) = delete;
+		ecg_pooled_buffer(ecg_pooled_buffer&& buffer) noexcept;
+		ecg_pooled_buffer& operator=(ecg_pooled_buffer&& buffer) noexcept;
+		~ecg_pooled_buffer();
+
+		size_t get_capacity() const;
+
+	private:
+		void recycle() noexcept;
+
+		std::weak_ptr<ecg_buffer_pool> m_pool;
+		std::shared_ptr<ecg_cmd_chain::state_t> m_chain;
+		cl::Context m_context;
+		cl_mem_flags m_flags = 0;
+		size_t m_capacity = 0;
+		uint64_t m_generation = 0;
+
+	};
+
+	/// <summary>
+	/// Pool of transient device buffers grouped by context, memory flags and power of two size class.
+	/// Free buffers are kept until the pool exceeds its limit, then the least recently returned ones are released.
+	/// The queues are out-of-order, so a returned buffer keeps the events of its chain at the time of return
+	/// and the chain of the next owner waits for them. Buffers are returned without waiting on the host.
+	/// Buffers outliving the pool are released as usual. Must be owned by std::shared_ptr.
+	/// Thread-Safe.
+	/// </summary>
+	class ECG_API ecg_buffer_pool : public std::enable_shared_from_this<ecg_buffer_pool> {
+	public:
+		virtual ~ecg_buffer_pool();
+
+		ecg_pooled_buffer acquire(ecg_cmd_chain& chain, cl_mem_flags flags, size_t size, cl_int* err = nullptr);
+		void release(const cl::Buffer& buffer, const cl::Context& context, std::vector<cl::Event> fence,
+			cl_mem_flags flags, size_t capacity, uint64_t generation) noexcept;
+
+		/// <summary>
+		/// Releases free buffers until the pool holds at most max_bytes, the oldest buffers are released first.
+		/// </summary>
+		void trim(size_t max_bytes = 0) noexcept;
+
+		/// <summary>
+		/// Releases all free buffers, buffers in use aren't returned to the pool anymore.
+		/// Called when the context of the buffers is released.
+		/// </summary>
+		void clear() noexcept;
+
+		void set_limit(size_t max_bytes);
+		size_t get_limit() const;
+
+		ecg_buffer_pool_stats_t get_stats() const;
+		void reset_stats();
+
+		static size_t get_size_class(size_t size);
+
+		static constexpr size_t min_size_class = 256;
+		static constexpr size_t default_limit = 256ull * 1024 * 1024;
+
+	private:
+		void trim_locked(size_t max_bytes) noexcept;
+
+		struct free_buffer_t {
+			cl::Buffer buffer;
+			cl::Context context;
+			std::vector<cl::Event> fence;
+			cl_mem_flags flags;
+			size_t capacity;
+		};
+
+		// Ordered by the time of return, the newest buffers are at the back
+		std::list<free_buffer_t> m_free_buffers;
+		mutable std::mutex m_pool_lock;
+
+		size_t m_limit = default_limit;
+		size_t m_cached_bytes = 0;
+		uint64_t m_generation = 0;
+
+		size_t m_hits = 0;
+		size_t m_misses = 0;
+		size_t m_evictions = 0;
+
+	};
+}
+
+#endif
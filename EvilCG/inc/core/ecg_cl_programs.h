@@ -519,76 +519,275 @@ namespace ecg {
 			}
 		);
 
+	/// <summary>
+	/// Every range of vertexes is swept by the same number of groups, each group reduces its part in local memory.
+	/// reduce_aabb then merges the partial boxes of every range in one group, so no work item touches a global atomic.
+	/// </summary>
+	constexpr size_t compute_aabb_group_size = 256;
+	constexpr size_t compute_aabb_groups_per_unit = 8;
+
 	const std::string compute_aabb_name = "compute_aabb";
+	const std::string reduce_aabb_name = "reduce_aabb";
 	const std::string compute_aabb_code =
-		enable_atomics_def +
-		atomic_min_f +
-		atomic_max_f +
+		typedef_uint32_t +
 		get_vertex +
+		"\n#define AABB_GROUP_SIZE " + std::to_string(compute_aabb_group_size) + "\n" +
 		SCRIPT(
+			void reduce_local_aabb(__local float* bb_min, __local float* bb_max, float3 vrt_min, float3 vrt_max) {
+				const uint32_t lid = get_local_id(0);
+				const uint32_t group_size = get_local_size(0);
+
+				bb_min[0 * AABB_GROUP_SIZE + lid] = vrt_min.x;
+				bb_min[1 * AABB_GROUP_SIZE + lid] = vrt_min.y;
+				bb_min[2 * AABB_GROUP_SIZE + lid] = vrt_min.z;
+				bb_max[0 * AABB_GROUP_SIZE + lid] = vrt_max.x;
+				bb_max[1 * AABB_GROUP_SIZE + lid] = vrt_max.y;
+				bb_max[2 * AABB_GROUP_SIZE + lid] = vrt_max.z;
+				barrier(CLK_LOCAL_MEM_FENCE);
+
+				for (uint32_t step = group_size / 2; step > 0; step >>= 1) {
+					if (lid < step) {
+						for (int axis = 0; axis < 3; ++axis) {
+							const uint32_t id = axis * AABB_GROUP_SIZE + lid;
+							bb_min[id] = fmin(bb_min[id], bb_min[id + step]);
+							bb_max[id] = fmax(bb_max[id], bb_max[id + step]);
+						}
+					}
+					barrier(CLK_LOCAL_MEM_FENCE);
+				}
+			}
+
 			__kernel void compute_aabb(
-				__global float* mesh_vertexes, int vertex_size,
-				__global float* aabb
+				__global float* vertexes,
+				__global uint32_t* range_offsets, uint32_t groups_per_range,
+				__global float* partials
 			) {
-				const int gid = get_global_id(0);
-				const int lid = get_local_id(0);
+				__local float bb_min[3 * AABB_GROUP_SIZE];
+				__local float bb_max[3 * AABB_GROUP_SIZE];
+
+				const uint32_t group_id = get_group_id(0);
+				const uint32_t range_id = group_id / groups_per_range;
+				const uint32_t stride = groups_per_range * get_local_size(0);
+				const uint32_t last = range_offsets[range_id + 1];
+
+				float3 vrt_min = (float3)(FLT_MAX, FLT_MAX, FLT_MAX);
+				float3 vrt_max = (float3)(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+				uint32_t first = range_offsets[range_id] + (group_id % groups_per_range) * get_local_size(0) + get_local_id(0);
+				for (uint32_t id = first; id < last; id += stride) {
+					float3 vrt = get_vertex(id, vertexes, 3);
+					vrt_min = fmin(vrt_min, vrt);
+					vrt_max = fmax(vrt_max, vrt);
+				}
+
+				reduce_local_aabb(bb_min, bb_max, vrt_min, vrt_max);
+
+				if (get_local_id(0) == 0) {
+					for (int axis = 0; axis < 3; ++axis) {
+						partials[group_id * 6 + axis] = bb_min[axis * AABB_GROUP_SIZE];
+						partials[group_id * 6 + axis + 3] = bb_max[axis * AABB_GROUP_SIZE];
+					}
+				}
+			}
+
+			__kernel void reduce_aabb(
+				__global float* partials, uint32_t groups_per_range,
+				__global float* aabbs
+			) {
+				__local float bb_min[3 * AABB_GROUP_SIZE];
+				__local float bb_max[3 * AABB_GROUP_SIZE];
+
+				const uint32_t range_id = get_group_id(0);
 
-				float3 vrt = get_vertex(gid, mesh_vertexes, vertex_size);
+				float3 part_min = (float3)(FLT_MAX, FLT_MAX, FLT_MAX);
+				float3 part_max = (float3)(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+				for (uint32_t id = get_local_id(0); id < groups_per_range; id += get_local_size(0)) {
+					const uint32_t part_id = range_id * groups_per_range + id;
+					part_min = fmin(part_min, get_vertex(part_id * 2, partials, 3));
+					part_max = fmax(part_max, get_vertex(part_id * 2 + 1, partials, 3));
+				}
 
-				atomic_min_f(&aabb[0], vrt.x);
-				atomic_min_f(&aabb[1], vrt.y);
-				atomic_min_f(&aabb[2], vrt.z);
+				reduce_local_aabb(bb_min, bb_max, part_min, part_max);
 
-				atomic_max_f(&aabb[3], vrt.x);
-				atomic_max_f(&aabb[4], vrt.y);
-				atomic_max_f(&aabb[5], vrt.z);
+				if (get_local_id(0) == 0) {
+					for (int axis = 0; axis < 3; ++axis) {
+						aabbs[range_id * 6 + axis] = bb_min[axis * AABB_GROUP_SIZE];
+						aabbs[range_id * 6 + axis + 3] = bb_max[axis * AABB_GROUP_SIZE];
+					}
+				}
 			}
 		);
 
+	/// <summary>
+	/// Directions of the k-DOP used to cull the interior of a point set before its convex hull is built.
+	/// The first 3 give the 6 extreme points of the box, all 13 give the 26 extreme points of the k-DOP.
+	/// </summary>
+	constexpr size_t kdop_6_directions_cnt = 3;
+	constexpr size_t kdop_26_directions_cnt = 13;
+	constexpr float kdop_directions[kdop_26_directions_cnt * 3] = {
+		1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f,
+		1.0f, 1.0f, 0.0f, 1.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, -1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, -1.0f,
+		1.0f, 1.0f, 1.0f, 1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f,
+	};
+	constexpr uint32_t kdop_no_vertex = 0xFFFFFFFF;
+
+	const std::string find_kdop_extremes_name = "find_kdop_extremes";
+	const std::string mark_hull_candidates_name = "mark_hull_candidates";
+	const std::string compact_hull_candidates_name = "compact_hull_candidates";
+	const std::string hull_prefilter_code =
+		typedef_uint32_t +
+		get_vertex +
+		"\n#define KDOP_GROUP_SIZE " + std::to_string(compute_aabb_group_size) + "\n" +
+		"\n#define KDOP_NO_VERTEX " + std::to_string(kdop_no_vertex) + "u\n" +
+		SCRIPT(
+			// The smaller id wins a tie, so the extremes don't depend on the number of groups
+			void reduce_local_extreme(__local float* values, __local uint32_t* ids, float value, uint32_t id, bool is_max) {
+				const uint32_t lid = get_local_id(0);
+				values[lid] = value;
+				ids[lid] = id;
+				barrier(CLK_LOCAL_MEM_FENCE);
+
+				for (uint32_t step = get_local_size(0) / 2; step > 0; step >>= 1) {
+					if (lid < step) {
+						const float other_value = values[lid + step];
+						const uint32_t other_id = ids[lid + step];
+						const bool is_better = is_max ? other_value > values[lid] : other_value < values[lid];
+						if (is_better || (other_value == values[lid] && other_id < ids[lid])) {
+							values[lid] = other_value;
+							ids[lid] = other_id;
+						}
+					}
+					barrier(CLK_LOCAL_MEM_FENCE);
+				}
+			}
+
+			// Every group writes the minimum and the maximum projection of its vertexes on every direction
+			__kernel void find_kdop_extremes(
+				__global float* vertexes, uint32_t vertexes_cnt,
+				__global float* directions, uint32_t directions_cnt,
+				__global float* partial_values, __global uint32_t* partial_ids
+			) {
+				__local float values[KDOP_GROUP_SIZE];
+				__local uint32_t ids[KDOP_GROUP_SIZE];
+
+				for (uint32_t direction_id = 0; direction_id < directions_cnt; ++direction_id) {
+					const float3 direction = get_vertex(direction_id, directions, 3);
+					float min_value = FLT_MAX;
+					float max_value = -FLT_MAX;
+					uint32_t min_id = KDOP_NO_VERTEX;
+					uint32_t max_id = KDOP_NO_VERTEX;
+
+					for (uint32_t id = get_global_id(0); id < vertexes_cnt; id += get_global_size(0)) {
+						const float value = dot(get_vertex(id, vertexes, 3), direction);
+						if (value < min_value) {
+							min_value = value;
+							min_id = id;
+						}
+						if (value > max_value) {
+							max_value = value;
+							max_id = id;
+						}
+					}
+
+					const uint32_t partial_id = (get_group_id(0) * directions_cnt + direction_id) * 2;
+					reduce_local_extreme(values, ids, min_value, min_id, false);
+					if (get_local_id(0) == 0) {
+						partial_values[partial_id + 0] = values[0];
+						partial_ids[partial_id + 0] = ids[0];
+					}
+					barrier(CLK_LOCAL_MEM_FENCE);
+
+					reduce_local_extreme(values, ids, max_value, max_id, true);
+					if (get_local_id(0) == 0) {
+						partial_values[partial_id + 1] = values[0];
+						partial_ids[partial_id + 1] = ids[0];
+					}
+					barrier(CLK_LOCAL_MEM_FENCE);
+				}
+			}
+
+			// Vertexes below all planes of the polytope of the extremes can't be on the hull
+			__kernel void mark_hull_candidates(
+				__global float* vertexes, uint32_t vertexes_cnt,
+				__global float* planes, uint32_t planes_cnt, float eps,
+				__global uint32_t* flags
+			) {
+				const uint32_t id = get_global_id(0);
+				if (id >= vertexes_cnt) return;
+
+				const float3 vrt = get_vertex(id, vertexes, 3);
+				uint32_t is_candidate = 0;
+				for (uint32_t plane_id = 0; plane_id < planes_cnt && !is_candidate; ++plane_id) {
+					const float3 normal = (float3)(planes[plane_id * 4 + 0], planes[plane_id * 4 + 1], planes[plane_id * 4 + 2]);
+					if (dot(normal, vrt) - planes[plane_id * 4 + 3] >= -eps) is_candidate = 1;
+				}
+
+				flags[id] = is_candidate;
+			}
+
+			__kernel void compact_hull_candidates(
+				__global uint32_t* offsets, uint32_t vertexes_cnt,
+				__global uint32_t* candidates
+			) {
+				const uint32_t id = get_global_id(0);
+				if (id >= vertexes_cnt) return;
+				if (offsets[id + 1] != offsets[id]) candidates[offsets[id]] = id;
+			}
+		);
+
+	/// <summary>
+	/// Largest work group of summ_vertexes, the local accumulator of the kernel is sized for it.
+	/// </summary>
+	constexpr size_t summ_vertexes_max_group_size = 256;
+	constexpr size_t summ_vertexes_groups_per_unit = 4;
+
 	const std::string summ_vertexes_name = "summ_vertexes";
 	const std::string summ_vertexes_code =
 		get_vertex +
+		"\n#define SUMM_VERTEXES_MAX_GROUP_SIZE " + std::to_string(summ_vertexes_max_group_size) + "\n" +
 		SCRIPT(
 			__kernel void summ_vertexes(
-				int vert_arr_len, int vert_size,
-				__global float* vertexes,
-				__global float* local_acc,
+				__global float* vertexes, uint32_t vertexes_cnt,
 				__global float* res)
 			{
-				const int group_size = get_local_size(0);
-				const int group_id = get_group_id(0);
-				const int gid = get_global_id(0);
-				const int lid = get_local_id(0);
-
-				if (gid >= vert_arr_len) return;
-
-				const int offset = group_id * group_size;
-				float3 v1 = gid * 2 < vert_arr_len ? get_vertex(gid * 2, vertexes, vert_size) : (float3)(0);
-				float3 v2 = gid * 2 + 1 < vert_arr_len ? get_vertex(gid * 2 + 1, vertexes, vert_size) : (float3)(0);
-				float3 summ = v1 + v2;
-
-				local_acc[(offset + lid) * vert_size + 0] = summ.x;
-				local_acc[(offset + lid) * vert_size + 1] = summ.y;
-				local_acc[(offset + lid) * vert_size + 2] = summ.z;
+				__local float acc[3 * SUMM_VERTEXES_MAX_GROUP_SIZE];
+
+				const uint32_t lid = get_local_id(0);
+				const uint32_t group_size = get_local_size(0);
+				const uint32_t stride = get_global_size(0);
+
+				// Kahan summation over the vertexes of the work item, the error doesn't grow with the mesh size
+				float3 summ = (float3)(0.0f, 0.0f, 0.0f);
+				float3 error = (float3)(0.0f, 0.0f, 0.0f);
+				for (uint32_t id = get_global_id(0); id < vertexes_cnt; id += stride) {
+					float3 value = get_vertex(id, vertexes, 3) - error;
+					float3 next = summ + value;
+					error = (next - summ) - value;
+					summ = next;
+				}
 
+				acc[0 * SUMM_VERTEXES_MAX_GROUP_SIZE + lid] = summ.x;
+				acc[1 * SUMM_VERTEXES_MAX_GROUP_SIZE + lid] = summ.y;
+				acc[2 * SUMM_VERTEXES_MAX_GROUP_SIZE + lid] = summ.z;
 				barrier(CLK_LOCAL_MEM_FENCE);
 
-				for (int iter = 2; iter <= group_size; iter <<= 1) {
-					if (lid % iter == 0) {
-						float3 temp_vert = get_vertex(offset + lid + (iter >> 1), local_acc, vert_size);
-						local_acc[(offset + lid) * vert_size + 0] += temp_vert.x;
-						local_acc[(offset + lid) * vert_size + 1] += temp_vert.y;
-						local_acc[(offset + lid) * vert_size + 2] += temp_vert.z;
+				// Pairwise tree with sequential addressing, active work items stay contiguous
+				for (uint32_t step = group_size / 2; step > 0; step >>= 1) {
+					if (lid < step) {
+						acc[0 * SUMM_VERTEXES_MAX_GROUP_SIZE + lid] += acc[0 * SUMM_VERTEXES_MAX_GROUP_SIZE + lid + step];
+						acc[1 * SUMM_VERTEXES_MAX_GROUP_SIZE + lid] += acc[1 * SUMM_VERTEXES_MAX_GROUP_SIZE + lid + step];
+						acc[2 * SUMM_VERTEXES_MAX_GROUP_SIZE + lid] += acc[2 * SUMM_VERTEXES_MAX_GROUP_SIZE + lid + step];
 					}
 					barrier(CLK_LOCAL_MEM_FENCE);
 				}
 
 				if (lid == 0) {
-					res[group_id * vert_size + 0] = local_acc[offset * vert_size + 0];
-					res[group_id * vert_size + 1] = local_acc[offset * vert_size + 1];
-					res[group_id * vert_size + 2] = local_acc[offset * vert_size + 2];
+					const uint32_t group_id = get_group_id(0);
+					res[group_id * 3 + 0] = acc[0 * SUMM_VERTEXES_MAX_GROUP_SIZE];
+					res[group_id * 3 + 1] = acc[1 * SUMM_VERTEXES_MAX_GROUP_SIZE];
+					res[group_id * 3 + 2] = acc[2 * SUMM_VERTEXES_MAX_GROUP_SIZE];
 				}
-				barrier(CLK_LOCAL_MEM_FENCE);
 			}
 		);
 
@@ -626,24 +825,23 @@ namespace ecg {
 		SCRIPT(
 			void update_local_mat(__local float* mat, float3 vrt, float4 center) { \n
 				atomic_add_fl(&mat[0 * 3 + 0], (vrt.x - center.x) * (vrt.x - center.x)); \n
-				atomic_add_fl(&mat[0 * 3 + 1], (vrt.x - center.x) * (vrt.x - center.y)); \n
-				atomic_add_fl(&mat[0 * 3 + 2], (vrt.x - center.x) * (vrt.x - center.z)); \n
+				atomic_add_fl(&mat[0 * 3 + 1], (vrt.x - center.x) * (vrt.y - center.y)); \n
+				atomic_add_fl(&mat[0 * 3 + 2], (vrt.x - center.x) * (vrt.z - center.z)); \n
 
 				atomic_add_fl(&mat[1 * 3 + 0], (vrt.y - center.y) * (vrt.x - center.x)); \n
-				atomic_add_fl(&mat[1 * 3 + 1], (vrt.y - center.y) * (vrt.x - center.y)); \n
-				atomic_add_fl(&mat[1 * 3 + 2], (vrt.y - center.y) * (vrt.x - center.z)); \n
+				atomic_add_fl(&mat[1 * 3 + 1], (vrt.y - center.y) * (vrt.y - center.y)); \n
+				atomic_add_fl(&mat[1 * 3 + 2], (vrt.y - center.y) * (vrt.z - center.z)); \n
 
 				atomic_add_fl(&mat[2 * 3 + 0], (vrt.z - center.z) * (vrt.x - center.x)); \n
-				atomic_add_fl(&mat[2 * 3 + 1], (vrt.z - center.z) * (vrt.x - center.y)); \n
-				atomic_add_fl(&mat[2 * 3 + 2], (vrt.z - center.z) * (vrt.x - center.z)); \n
+				atomic_add_fl(&mat[2 * 3 + 1], (vrt.z - center.z) * (vrt.y - center.y)); \n
+				atomic_add_fl(&mat[2 * 3 + 2], (vrt.z - center.z) * (vrt.z - center.z)); \n
 			}
 
 			__kernel void compute_cov(\n
-				__global float* vertexes, int vertex_size, float4 center, \n
+				__global float* vertexes, int vertex_size, int vertexes_cnt, float4 center, \n
 				__global float* cov_mat) { \n
 				const int gid = get_global_id(0); \n
 				const int lid = get_local_id(0); \n
-				float3 vrt = get_vertex(gid, vertexes, vertex_size); \n
 				__local float local_mat[9];
 
 				if (lid == 0) {
@@ -652,7 +850,8 @@ namespace ecg {
 				} \n
 				barrier(CLK_LOCAL_MEM_FENCE); \n
 
-				update_local_mat(local_mat, vrt, center); \n
+				if (gid < vertexes_cnt) \n
+					update_local_mat(local_mat, get_vertex(gid, vertexes, vertex_size), center); \n
 				barrier(CLK_LOCAL_MEM_FENCE); \n
 
 				if (lid == 0) {
@@ -678,7 +877,7 @@ namespace ecg {
 		mul_mat_vec +
 		SCRIPT(
 			__kernel void compute_obb(
-				__global float* vertexes, int vertex_size, 
+				__global float* vertexes, int vertex_size, int vertexes_cnt,
 				__global float* inv_mat, float4 center,
 				__global float* bounding_box) {
 				const int gid = get_global_id(0); \n
@@ -692,23 +891,24 @@ namespace ecg {
 				}
 				barrier(CLK_LOCAL_MEM_FENCE); \n
 
-				float3 vrt = get_vertex(gid, vertexes, vertex_size); \n
-				vrt = (float3)(
-					vrt.x - center.x,
-					vrt.y - center.y,
-					vrt.z - center.z
-				);
+				if (gid < vertexes_cnt) {
+					float3 vrt = get_vertex(gid, vertexes, vertex_size); \n
+					vrt = (float3)(
+						vrt.x - center.x,
+						vrt.y - center.y,
+						vrt.z - center.z
+					);
 
-				float3 new_pos = mul_mat3_vec3(inv_mat, vrt);
-				barrier(CLK_LOCAL_MEM_FENCE); \n
+					float3 new_pos = mul_mat3_vec3(inv_mat, vrt);
 
-				atomic_min_fl(&min[0], new_pos.x);
-				atomic_min_fl(&min[1], new_pos.y);
-				atomic_min_fl(&min[2], new_pos.z);
+					atomic_min_fl(&min[0], new_pos.x);
+					atomic_min_fl(&min[1], new_pos.y);
+					atomic_min_fl(&min[2], new_pos.z);
 
-				atomic_max_fl(&max[0], new_pos.x);
-				atomic_max_fl(&max[1], new_pos.y);
-				atomic_max_fl(&max[2], new_pos.z);
+					atomic_max_fl(&max[0], new_pos.x);
+					atomic_max_fl(&max[1], new_pos.y);
+					atomic_max_fl(&max[2], new_pos.z);
+				}
 
 				barrier(CLK_LOCAL_MEM_FENCE); \n
 				if (lid == 0) {
@@ -723,227 +923,697 @@ namespace ecg {
 			}
 		);
 
-	const std::string compute_surface_area_name = "compute_surface_area";
-	const std::string compute_surface_area_code =
-		enable_atomics_def +
-		atomic_add_f +
-		calculate_surf_area +
+	/// <summary>
+	/// Work items sweep vertexes and faces with the stride of the whole range, so a few groups cover any mesh.
+	/// Every group writes its partial statistics, they are merged on the host in double precision.
+	/// Sums and moments of vertexes are taken relative to the first vertex, so the covariance doesn't cancel out far from the origin.
+	/// </summary>
+	constexpr size_t mesh_stats_group_size = 128;
+	constexpr size_t mesh_stats_groups_per_unit = 8;
+	constexpr size_t mesh_stats_values = 17;
+
+	const std::string compute_mesh_stats_name = "compute_mesh_stats";
+	const std::string compute_mesh_stats_code =
+		typedef_uint32_t +
+		cl_structs::face_struct +
+		cl_structs::get_face_func +
+		cross_product +
+		get_vert_len +
+		get_vertex +
+		"\n#define MESH_STATS_GROUP_SIZE " + std::to_string(mesh_stats_group_size) + "\n" +
+		"\n#define MESH_STATS_VALUES " + std::to_string(mesh_stats_values) + "\n" +
+		"\n#define MESH_STATS_DEGENERATE_EPSILON 1e-6f\n" +
 		SCRIPT(
-			__kernel void compute_surface_area( \n
-				__global float* vertexes, int vertexes_size, \n
-				__global int* indexes, int indexes_size, \n
-				int vert_size, __global float* surface_area
-			) { \n
-				const int gid = get_global_id(0); \n 
-				const int lid = get_local_id(0);
-				__local float local_surf_area; \n
-				
-				if(lid == 0) local_surf_area = 0.0f;
+			__kernel void compute_mesh_stats(
+				__global float* vertexes, uint32_t vertexes_cnt,
+				__global uint32_t* indexes, uint32_t faces_cnt,
+				__global float* partials, __global uint32_t* degenerate_partials
+			) {
+				__local float values[MESH_STATS_VALUES * MESH_STATS_GROUP_SIZE];
+				__local uint32_t degenerate[MESH_STATS_GROUP_SIZE];
+
+				const uint32_t lid = get_local_id(0);
+				const uint32_t group_size = get_local_size(0);
+				const uint32_t stride = get_global_size(0);
+				const float3 pivot = get_vertex(0, vertexes, 3);
+
+				float3 sum = (float3)(0.0f, 0.0f, 0.0f);
+				float3 diag = (float3)(0.0f, 0.0f, 0.0f);
+				float3 off_diag = (float3)(0.0f, 0.0f, 0.0f);
+				float3 bb_min = (float3)(FLT_MAX, FLT_MAX, FLT_MAX);
+				float3 bb_max = (float3)(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+				float area = 0.0f;
+				float volume = 0.0f;
+				uint32_t degenerate_cnt = 0;
+
+				for (uint32_t id = get_global_id(0); id < vertexes_cnt; id += stride) {
+					float3 vrt = get_vertex(id, vertexes, 3);
+					float3 delta = vrt - pivot;
+
+					sum += delta;
+					diag += delta * delta;
+					off_diag += (float3)(delta.x * delta.y, delta.x * delta.z, delta.y * delta.z);
+					bb_min = fmin(bb_min, vrt);
+					bb_max = fmax(bb_max, vrt);
+				}
+
+				for (uint32_t id = get_global_id(0); id < faces_cnt; id += stride) {
+					struct face_t face = get_face(indexes, id);
+					float3 v0 = get_vertex(face.id0, vertexes, 3);
+					float3 v1 = get_vertex(face.id1, vertexes, 3);
+					float3 v2 = get_vertex(face.id2, vertexes, 3);
+
+					float3 ab = v1 - v0;
+					float3 ac = v2 - v0;
+					float3 bc = v2 - v1;
+					float face_area = get_len_fl3(cross_product(ab, ac)) / 2.0f;
+					float max_edge = fmax(dot(ab, ab), fmax(dot(ac, ac), dot(bc, bc)));
+
+					area += face_area;
+					volume += dot(v0, cross_product(v1, v2)) / 6.0f;
+					if (face_area <= MESH_STATS_DEGENERATE_EPSILON * max_edge) ++degenerate_cnt;
+				}
+
+				values[0 * MESH_STATS_GROUP_SIZE + lid] = sum.x;
+				values[1 * MESH_STATS_GROUP_SIZE + lid] = sum.y;
+				values[2 * MESH_STATS_GROUP_SIZE + lid] = sum.z;
+				values[3 * MESH_STATS_GROUP_SIZE + lid] = diag.x;
+				values[4 * MESH_STATS_GROUP_SIZE + lid] = diag.y;
+				values[5 * MESH_STATS_GROUP_SIZE + lid] = diag.z;
+				values[6 * MESH_STATS_GROUP_SIZE + lid] = off_diag.x;
+				values[7 * MESH_STATS_GROUP_SIZE + lid] = off_diag.y;
+				values[8 * MESH_STATS_GROUP_SIZE + lid] = off_diag.z;
+				values[9 * MESH_STATS_GROUP_SIZE + lid] = bb_min.x;
+				values[10 * MESH_STATS_GROUP_SIZE + lid] = bb_min.y;
+				values[11 * MESH_STATS_GROUP_SIZE + lid] = bb_min.z;
+				values[12 * MESH_STATS_GROUP_SIZE + lid] = bb_max.x;
+				values[13 * MESH_STATS_GROUP_SIZE + lid] = bb_max.y;
+				values[14 * MESH_STATS_GROUP_SIZE + lid] = bb_max.z;
+				values[15 * MESH_STATS_GROUP_SIZE + lid] = area;
+				values[16 * MESH_STATS_GROUP_SIZE + lid] = volume;
+				degenerate[lid] = degenerate_cnt;
 				barrier(CLK_LOCAL_MEM_FENCE);
 
-				int surf_id = gid * 3;
-				if (surf_id < indexes_size &&
-					surf_id + 1 < indexes_size &&
-					surf_id + 2 < indexes_size) {
-					const int ind_1 = indexes[surf_id];
-					const int ind_2 = indexes[surf_id + 1];
-					const int ind_3 = indexes[surf_id + 2];
+				// Values 9-11 are minimums, 12-14 maximums, all others are sums
+				for (uint32_t step = group_size / 2; step > 0; step >>= 1) {
+					if (lid < step) {
+						for (int value = 0; value < MESH_STATS_VALUES; ++value) {
+							float lhs = values[value * MESH_STATS_GROUP_SIZE + lid];
+							float rhs = values[value * MESH_STATS_GROUP_SIZE + lid + step];
 
-					float temp = calculate_surf_area(vertexes, ind_1, ind_2, ind_3, vert_size);
-					atomic_add_fl(&local_surf_area, temp);
+							if (value >= 9 && value < 12) lhs = fmin(lhs, rhs);
+							else if (value >= 12 && value < 15) lhs = fmax(lhs, rhs);
+							else lhs += rhs;
+
+							values[value * MESH_STATS_GROUP_SIZE + lid] = lhs;
+						}
+						degenerate[lid] += degenerate[lid + step];
+					}
+					barrier(CLK_LOCAL_MEM_FENCE);
 				}
 
-				barrier(CLK_LOCAL_MEM_FENCE);
-				if(lid == 0) atomic_add_f(surface_area, local_surf_area);
+				if (lid == 0) {
+					const uint32_t group_id = get_group_id(0);
+					for (int value = 0; value < MESH_STATS_VALUES; ++value)
+						partials[group_id * MESH_STATS_VALUES + value] = values[value * MESH_STATS_GROUP_SIZE];
+					degenerate_partials[group_id] = degenerate[0];
+				}
 			}
 		);
 
-	const std::string is_mesh_closed_name = "is_mesh_closed";
-	const std::string is_mesh_closed_code =
+	/// <summary>
+	/// Every group owns a contiguous chunk of faces and walks it tile by tile, so the order of additions depends only
+	/// on the number of chunks. Totals are merged by fixed trees and repeated runs on a device give the same bits.
+	/// compute_ranges_areas sums several face ranges in one dispatch, every range is swept by the same number of groups.
+	/// </summary>
+	constexpr size_t faces_areas_group_size = 256;
+	constexpr size_t faces_areas_groups_per_unit = 8;
+
+	const std::string compute_faces_areas_name = "compute_faces_areas";
+	const std::string compute_ranges_areas_name = "compute_ranges_areas";
+	const std::string reduce_surface_area_name = "reduce_surface_area";
+	const std::string add_chunk_offsets_name = "add_chunk_offsets";
+	const std::string compute_faces_areas_code =
 		typedef_uint32_t +
-		cl_structs::face_struct +
-		cl_structs::edge_struct +
-		cl_structs::get_face_func +
-		cl_structs::is_face_contains_edge_func +
+		calculate_surf_area +
+		"\n#define AREAS_GROUP_SIZE " + std::to_string(faces_areas_group_size) + "\n" +
 		SCRIPT(
-			__kernel void is_mesh_closed(
-				__global uint32_t* indexes, uint32_t indexes_cnt,
-				__global bool* result
+			float reduce_local_sum(__local float* values, float value) {
+				const uint32_t lid = get_local_id(0);
+
+				values[lid] = value;
+				barrier(CLK_LOCAL_MEM_FENCE);
+
+				for (uint32_t step = get_local_size(0) / 2; step > 0; step >>= 1) {
+					if (lid < step) values[lid] += values[lid + step];
+					barrier(CLK_LOCAL_MEM_FENCE);
+				}
+
+				float result = values[0];
+				barrier(CLK_LOCAL_MEM_FENCE);
+				return result;
+			}
+
+			__kernel void compute_faces_areas(
+				__global float* vertexes, __global uint32_t* indexes,
+				uint32_t first_face, uint32_t last_face, uint32_t chunk_size,
+				uint32_t write_areas, __global float* areas,
+				uint32_t with_cdf, __global float* cdf,
+				__global float* chunk_sums
 			) {
-				uint32_t gid = get_global_id(0);
-				if (gid >= indexes_cnt - 1) return;
+				__local float values[AREAS_GROUP_SIZE];
+
+				const uint32_t lid = get_local_id(0);
+				const uint32_t group_size = get_local_size(0);
+				const uint32_t chunk_first = first_face + get_group_id(0) * chunk_size;
+				const uint32_t chunk_last = min(chunk_first + chunk_size, last_face);
 
-				struct edge_t current_edge;
-				int edges_includes = 0;
+				float lane_sum = 0.0f;
+				float carry = 0.0f;
 
-				if (gid % 3 == 0 || gid % 3 == 1) {
-					current_edge.id0 = indexes[gid]; 
-					current_edge.id1 = indexes[gid + 1];
+				for (uint32_t tile = chunk_first; tile < chunk_last; tile += group_size) {
+					const uint32_t face_id = tile + lid;
+					float area = 0.0f;
+
+					if (face_id < chunk_last) {
+						area = calculate_surf_area(vertexes,
+							indexes[face_id * 3 + 0], indexes[face_id * 3 + 1], indexes[face_id * 3 + 2], 3);
+						if (write_areas) areas[face_id] = area;
+					}
+
+					lane_sum += area;
+					if (!with_cdf) continue;
+
+					// Inclusive scan of the tile, the carry holds the areas of previous tiles of the chunk
+					values[lid] = area;
+					barrier(CLK_LOCAL_MEM_FENCE);
+
+					for (uint32_t offset = 1; offset < group_size; offset <<= 1) {
+						float prev = lid >= offset ? values[lid - offset] : 0.0f;
+						barrier(CLK_LOCAL_MEM_FENCE);
+						values[lid] += prev;
+						barrier(CLK_LOCAL_MEM_FENCE);
+					}
+
+					if (face_id < chunk_last) cdf[face_id] = carry + values[lid];
+					carry += values[group_size - 1];
+					barrier(CLK_LOCAL_MEM_FENCE);
 				}
-				else if (gid % 3 == 2) {
-					current_edge.id0 = indexes[gid];
-					current_edge.id1 = indexes[gid - 2];
+
+				// The CDF continues from the last value of the previous chunk, so it never goes down between chunks
+				float chunk_sum = reduce_local_sum(values, lane_sum);
+				if (lid == 0) chunk_sums[get_group_id(0)] = with_cdf ? carry : chunk_sum;
+			}
+
+			__kernel void compute_ranges_areas(
+				__global float* vertexes, __global uint32_t* indexes,
+				__global uint32_t* range_offsets, uint32_t groups_per_range,
+				__global float* chunk_sums
+			) {
+				__local float values[AREAS_GROUP_SIZE];
+
+				const uint32_t group_id = get_group_id(0);
+				const uint32_t range_id = group_id / groups_per_range;
+				const uint32_t stride = groups_per_range * get_local_size(0);
+				const uint32_t last = range_offsets[range_id + 1];
+
+				float lane_sum = 0.0f;
+				uint32_t first = range_offsets[range_id] + (group_id % groups_per_range) * get_local_size(0) + get_local_id(0);
+				for (uint32_t face_id = first; face_id < last; face_id += stride) {
+					lane_sum += calculate_surf_area(vertexes,
+						indexes[face_id * 3 + 0], indexes[face_id * 3 + 1], indexes[face_id * 3 + 2], 3);
 				}
 
-				for (uint32_t face_id = 0; face_id < indexes_cnt / 3; ++face_id) {
-					if (*result == false) break;
-					struct face_t face = get_face(indexes, face_id);
+				float result = reduce_local_sum(values, lane_sum);
+				if (get_local_id(0) == 0) chunk_sums[group_id] = result;
+			}
+
+			// Every group reduces the chunks of one range
+			__kernel void reduce_surface_area(
+				__global float* chunk_sums, uint32_t chunks_cnt,
+				__global float* surface_area
+			) {
+				__local float values[AREAS_GROUP_SIZE];
+
+				const uint32_t range_id = get_group_id(0);
+
+				float lane_sum = 0.0f;
+				for (uint32_t id = get_local_id(0); id < chunks_cnt; id += get_local_size(0))
+					lane_sum += chunk_sums[range_id * chunks_cnt + id];
+
+				float result = reduce_local_sum(values, lane_sum);
+				if (get_local_id(0) == 0) surface_area[range_id] = result;
+			}
+
+			__kernel void add_chunk_offsets(
+				__global float* chunk_sums,
+				uint32_t first_face, uint32_t last_face, uint32_t chunk_size,
+				__global float* cdf
+			) {
+				__local float chunk_offset;
 
-					if (is_face_contains_edge(face, current_edge))
-						++edges_includes;
+				const uint32_t chunk_id = get_group_id(0);
+				if (get_local_id(0) == 0) {
+					float offset = 0.0f;
+					for (uint32_t id = 0; id < chunk_id; ++id) offset += chunk_sums[id];
+					chunk_offset = offset;
 				}
+				barrier(CLK_LOCAL_MEM_FENCE);
 
-				if (edges_includes != 2)
-					*result = false;
+				const uint32_t chunk_first = first_face + chunk_id * chunk_size;
+				const uint32_t chunk_last = min(chunk_first + chunk_size, last_face);
+				for (uint32_t face_id = chunk_first + get_local_id(0); face_id < chunk_last; face_id += get_local_size(0))
+					cdf[face_id] += chunk_offset;
 			}
 		);
 
-	const std::string is_mesh_vertexes_manifold_name = "is_mesh_vertexes_manifold";
-	const std::string is_mesh_vertexes_manifold_code =
+	/// <summary>
+	/// Half-edges are sorted by the undirected (min, max) key of their edge with a least significant digit radix sort,
+	/// so equal edges end up next to each other and edge counts are lengths of runs. Every pass ranks the keys of a tile
+	/// in its group and moves them by an exclusive scan of the digit counts of all groups, which keeps the sort stable.
+	/// Passes of digits above the largest key are skipped.
+	/// Long scans are split into blocks, the sums of the blocks are scanned and added back to their values.
+	/// </summary>
+	constexpr size_t edges_group_size = 256;
+	constexpr size_t edges_radix_bits = 4;
+	constexpr size_t scan_groups_per_unit = 8;
+
+	const std::string build_edge_keys_name = "build_edge_keys";
+	const std::string radix_rank_name = "radix_rank";
+	const std::string scan_exclusive_name = "scan_exclusive";
+	const std::string scan_blocks_name = "scan_blocks";
+	const std::string add_block_offsets_name = "add_block_offsets";
+	const std::string radix_scatter_name = "radix_scatter";
+	const std::string count_edge_runs_name = "count_edge_runs";
+	const std::string mark_edge_runs_name = "mark_edge_runs";
+	const std::string emit_edges_name = "emit_edges";
+	const std::string count_vertex_corners_name = "count_vertex_corners";
+	const std::string find_half_edges_positions_name = "find_half_edges_positions";
+	const std::string check_vertexes_fans_name = "check_vertexes_fans";
+	const std::string count_vertex_faces_name = "count_vertex_faces";
+	const std::string fill_vertex_faces_name = "fill_vertex_faces";
+	const std::string fill_vertex_vertexes_name = "fill_vertex_vertexes";
+	const std::string count_face_faces_name = "count_face_faces";
+	const std::string fill_face_faces_name = "fill_face_faces";
+	const std::string sort_adjacency_lists_name = "sort_adjacency_lists";
+	const std::string edge_topology_code =
 		typedef_uint32_t +
-		cl_structs::face_struct +
-		cl_structs::edge_struct +
-		cl_structs::get_face_func +
-		cl_structs::init_edge_func +
-		cl_structs::init_face_func +
-		cl_structs::is_face_null_func +
-		cl_structs::is_edges_equal_func +
-		cl_structs::is_face_contains_edge_func +
-		cl_structs::is_face_contains_vertex_func +
+		"\n#define EDGES_GROUP_SIZE " + std::to_string(edges_group_size) + "\n" +
+		"\n#define RADIX_DIGITS " + std::to_string(size_t(1) << edges_radix_bits) + "\n" +
 		SCRIPT(
-			uint32_t find_next_face( \n
-				__global uint32_t * indexes, uint32_t faces_cnt, \n
-				struct edge_t edge, uint32_t prev_face_id \n
-			) { \n
-				for (uint32_t face_id = 0; face_id < faces_cnt; ++face_id) { \n
-					if (face_id == prev_face_id) continue; \n
-					struct face_t face = get_face(indexes, face_id); \n
-					if (is_face_contains_edge(face, edge)) \n
-						return face_id; \n
-				} \n
-				return prev_face_id; \n
-			} \n\n
+			ulong get_edge_key(uint32_t id0, uint32_t id1, uint32_t vertexes_cnt) {
+				return id0 < id1 ?
+					(ulong)id0 * vertexes_cnt + id1 :
+					(ulong)id1 * vertexes_cnt + id0;
+			}
 
-			struct edge_t get_another_edge(struct face_t face, struct edge_t edge) { \n
-				struct edge_t new_edge; \n
-				init_edge(&new_edge); \n\n
+			uint32_t is_edge_run_head(__global ulong* keys, uint32_t position) {
+				return position == 0 || keys[position - 1] != keys[position];
+			}
 
-				if (face.id0 == edge.id0) { \n
-					if (face.id1 == edge.id1) { \n
-						new_edge.id0 = face.id0; \n
-						new_edge.id1 = face.id2; \n
-					} \n
-					if (face.id2 == edge.id1) { \n
-						new_edge.id0 = face.id0; \n
-						new_edge.id1 = face.id1; \n
-					} \n
-				} \n\n
+			uint32_t get_edge_run_first(__global ulong* keys, uint32_t position) {
+				uint32_t first = position;
+				while (first > 0 && keys[first - 1] == keys[position]) --first;
+				return first;
+			}
 
-				if (face.id1 == edge.id0) { \n
-					if (face.id0 == edge.id1) { \n
-						new_edge.id0 = face.id1; \n
-						new_edge.id1 = face.id2; \n
-					} \n
-					if (face.id2 == edge.id1) { \n
-						new_edge.id0 = face.id1; \n
-						new_edge.id1 = face.id0; \n
-					} \n
-				} \n\n
+			uint32_t get_edge_run_size(__global ulong* keys, uint32_t keys_cnt, uint32_t position) {
+				uint32_t run_size = 1;
+				while (position + run_size < keys_cnt && keys[position + run_size] == keys[position]) ++run_size;
+				return run_size;
+			}
 
-				if (face.id2 == edge.id0) { \n
-					if (face.id0 == edge.id1) { \n
-						new_edge.id0 = face.id2; \n
-						new_edge.id1 = face.id1; \n
-					} \n\n
-					if (face.id1 == edge.id1) { \n
-						new_edge.id0 = face.id2; \n
-						new_edge.id1 = face.id0; \n
-					} \n
-				} \n
+			// Inclusive scan of the group, every lane passes its value and gets the sum up to it
+			uint32_t scan_local_inclusive(__local uint32_t* values, uint32_t value) {
+				const uint32_t lid = get_local_id(0);
 
-				return new_edge; \n
-			} \n\n
+				values[lid] = value;
+				barrier(CLK_LOCAL_MEM_FENCE);
 
-			__kernel void is_mesh_vertexes_manifold( \n
-				__global uint32_t* indexes, uint32_t indexes_cnt, \n
-				uint32_t vertexes_cnt, __global bool* result \n
-			) { \n
-				uint32_t faces_cnt = indexes_cnt / 3; \n
-				uint32_t vertex_id = get_global_id(0); \n
-				if(vertex_id > vertexes_cnt) return; \n\n
-
-				uint32_t origin_face_id = 0; \n
-				uint32_t prev_face_id = 0; \n
-				uint32_t next_face_id = 0; \n\n
-
-				struct face_t origin_face; \n
-				struct face_t prev_face; \n
-				struct face_t next_face; \n\n
-
-				init_face(&origin_face); \n
-				init_face(&prev_face); \n
-				init_face(&next_face); \n\n
-
-				struct edge_t current_edge; \n
-				struct edge_t origin_edge; \n
-				init_edge(&current_edge); \n
-				init_edge(&origin_edge); \n\n
-
-				// 1. Find first face and count all faces with current vertex \n
-				uint32_t all_faces_with_vertex_cnt = 0; \n
-				for (uint32_t face_id = 0; face_id < faces_cnt; ++face_id) { \n
-					struct face_t face = get_face(indexes, face_id); \n
-					if (is_face_contains_vertex(face, vertex_id)) { \n
-						if (is_face_null(origin_face)) { \n
-							origin_face_id = face_id; \n
-							origin_face = face; \n
-						} \n
-						++all_faces_with_vertex_cnt; \n
-					} \n
-				} \n\n
+				for (uint32_t offset = 1; offset < get_local_size(0); offset <<= 1) {
+					uint32_t prev = lid >= offset ? values[lid - offset] : 0;
+					barrier(CLK_LOCAL_MEM_FENCE);
+					values[lid] += prev;
+					barrier(CLK_LOCAL_MEM_FENCE);
+				}
 
-				// 2. Get origin edge \n
-				origin_edge.id0 = vertex_id; \n
-				if (origin_face.id0 == vertex_id) origin_edge.id1 = origin_face.id1; \n
-				if (origin_face.id1 == vertex_id) origin_edge.id1 = origin_face.id2; \n
-				if (origin_face.id2 == vertex_id) origin_edge.id1 = origin_face.id0; \n\n
-
-				// 3. Search next edge \n
-				prev_face_id = origin_face_id; \n
-				next_face_id = find_next_face(indexes, faces_cnt, origin_edge, prev_face_id); \n
-				if (next_face_id == prev_face_id) { \n
-					*result = false; \n
-					return; \n
-				} \n\n
+				uint32_t result = values[lid];
+				barrier(CLK_LOCAL_MEM_FENCE);
+				return result;
+			}
 
-				next_face = get_face(indexes, next_face_id); \n
-				current_edge = get_another_edge(next_face, origin_edge); \n\n
-				uint32_t iter_counter = 1; \n
-				while (!is_edges_equal(origin_edge, current_edge) && iter_counter < all_faces_with_vertex_cnt) { \n
-					if (*result == false) return; \n
-					prev_face_id = next_face_id; \n
-
-					next_face_id = find_next_face(indexes, faces_cnt, current_edge, prev_face_id); \n
-					if (next_face_id == prev_face_id) { \n
-						*result = false; \n
-						return; \n
-					} \n
+			__kernel void build_edge_keys(
+				__global uint32_t* indexes, uint32_t half_edges_cnt, uint32_t vertexes_cnt,
+				__global ulong* keys, __global uint32_t* half_edges
+			) {
+				const uint32_t gid = get_global_id(0);
+				if (gid >= half_edges_cnt) return;
 
-					next_face = get_face(indexes, next_face_id); \n
-					current_edge = get_another_edge(next_face, current_edge); \n
-					++iter_counter; \n
-				} \n\n
+				// Half-edge face_id * 3 + corner goes from the vertex of the corner to the next one
+				const uint32_t next = gid % 3 == 2 ? gid - 2 : gid + 1;
+				keys[gid] = get_edge_key(indexes[gid], indexes[next], vertexes_cnt);
+				half_edges[gid] = gid;
+			}
+
+			__kernel void radix_rank(
+				__global ulong* keys, uint32_t keys_cnt, uint32_t shift,
+				__global uint32_t* ranks, __global uint32_t* digit_counts
+			) {
+				__local uint32_t values[EDGES_GROUP_SIZE];
+
+				const uint32_t gid = get_global_id(0);
+				const uint32_t lid = get_local_id(0);
+				const uint32_t digit = gid < keys_cnt ? (uint32_t)((keys[gid] >> shift) & (RADIX_DIGITS - 1)) : RADIX_DIGITS;
+				uint32_t rank = 0;
+
+				// Rank among the keys of the tile with the same digit, counts are stored digit-major for the scan
+				for (uint32_t current = 0; current < RADIX_DIGITS; ++current) {
+					uint32_t count = scan_local_inclusive(values, digit == current ? 1 : 0);
+					if (digit == current) rank = count - 1;
+					if (lid == get_local_size(0) - 1) digit_counts[current * get_num_groups(0) + get_group_id(0)] = count;
+				}
+
+				if (gid < keys_cnt) ranks[gid] = rank;
+			}
+
+			// Every lane scans a contiguous slice of [first, last), the last lane gets the total of the block
+			uint32_t scan_block_exclusive(__local uint32_t* sums, __global uint32_t* values, uint32_t first, uint32_t last) {
+				const uint32_t lid = get_local_id(0);
+				const uint32_t slice_size = (last - first + get_local_size(0) - 1) / get_local_size(0);
+				const uint32_t slice_first = min(first + lid * slice_size, last);
+				const uint32_t slice_last = min(slice_first + slice_size, last);
+
+				uint32_t lane_sum = 0;
+				for (uint32_t id = slice_first; id < slice_last; ++id) lane_sum += values[id];
+
+				uint32_t lane_end = scan_local_inclusive(sums, lane_sum);
+				uint32_t offset = lane_end - lane_sum;
+
+				for (uint32_t id = slice_first; id < slice_last; ++id) {
+					uint32_t value = values[id];
+					values[id] = offset;
+					offset += value;
+				}
+
+				return lane_end;
+			}
+
+			__kernel void scan_exclusive(__global uint32_t* values, uint32_t values_cnt) {
+				__local uint32_t sums[EDGES_GROUP_SIZE];
+
+				// One group, the total is stored after the values
+				uint32_t lane_end = scan_block_exclusive(sums, values, 0, values_cnt);
+				if (get_local_id(0) == get_local_size(0) - 1) values[values_cnt] = lane_end;
+			}
+
+			__kernel void scan_blocks(
+				__global uint32_t* values, uint32_t values_cnt, uint32_t block_size,
+				__global uint32_t* block_sums
+			) {
+				__local uint32_t sums[EDGES_GROUP_SIZE];
+
+				const uint32_t group_id = get_group_id(0);
+				const uint32_t first = min(group_id * block_size, values_cnt);
+				const uint32_t last = min(first + block_size, values_cnt);
+
+				uint32_t lane_end = scan_block_exclusive(sums, values, first, last);
+				if (get_local_id(0) == get_local_size(0) - 1) block_sums[group_id] = lane_end;
+			}
+
+			__kernel void add_block_offsets(
+				__global uint32_t* values, uint32_t values_cnt, uint32_t block_size,
+				__global uint32_t* block_offsets
+			) {
+				const uint32_t group_id = get_group_id(0);
+				const uint32_t first = min(group_id * block_size, values_cnt);
+				const uint32_t last = min(first + block_size, values_cnt);
+				const uint32_t offset = block_offsets[group_id];
+
+				for (uint32_t id = first + get_local_id(0); id < last; id += get_local_size(0))
+					values[id] += offset;
+
+				// The scan of the block sums ends with the total of all values
+				if (group_id == get_num_groups(0) - 1 && get_local_id(0) == 0)
+					values[values_cnt] = block_offsets[get_num_groups(0)];
+			}
+
+			__kernel void radix_scatter(
+				__global ulong* keys, __global uint32_t* half_edges, uint32_t keys_cnt, uint32_t shift,
+				__global uint32_t* ranks, __global uint32_t* digit_offsets,
+				__global ulong* sorted_keys, __global uint32_t* sorted_half_edges
+			) {
+				const uint32_t gid = get_global_id(0);
+				if (gid >= keys_cnt) return;
+
+				const ulong key = keys[gid];
+				const uint32_t digit = (uint32_t)((key >> shift) & (RADIX_DIGITS - 1));
+				const uint32_t position = digit_offsets[digit * get_num_groups(0) + get_group_id(0)] + ranks[gid];
+
+				sorted_keys[position] = key;
+				sorted_half_edges[position] = half_edges[gid];
+			}
+
+			__kernel void count_edge_runs(
+				__global ulong* keys, uint32_t keys_cnt, uint32_t vertexes_cnt,
+				__global uint32_t* counters, uint32_t with_valence, __global uint32_t* valence
+			) {
+				__local uint32_t group_counters[3];
+
+				const uint32_t gid = get_global_id(0);
+				const uint32_t lid = get_local_id(0);
+
+				for (uint32_t id = lid; id < 3; id += get_local_size(0)) group_counters[id] = 0;
+				barrier(CLK_LOCAL_MEM_FENCE);
+
+				// The first half-edge of every run counts its edge: all edges, boundary ones and ones of more than two faces
+				if (gid < keys_cnt && is_edge_run_head(keys, gid)) {
+					const uint32_t run_size = get_edge_run_size(keys, keys_cnt, gid);
+					atomic_inc(&group_counters[0]);
+					if (run_size == 1) atomic_inc(&group_counters[1]);
+					if (run_size > 2) atomic_inc(&group_counters[2]);
+
+					const uint32_t id0 = (uint32_t)(keys[gid] / vertexes_cnt);
+					const uint32_t id1 = (uint32_t)(keys[gid] % vertexes_cnt);
+					if (with_valence && id0 != id1) {
+						atomic_inc(&valence[id0]);
+						atomic_inc(&valence[id1]);
+					}
+				}
+				barrier(CLK_LOCAL_MEM_FENCE);
+
+				for (uint32_t id = lid; id < 3; id += get_local_size(0))
+					if (group_counters[id] != 0) atomic_add(&counters[id], group_counters[id]);
+			}
+
+			__kernel void mark_edge_runs(
+				__global ulong* keys, uint32_t keys_cnt,
+				uint32_t min_run_size, uint32_t max_run_size,
+				__global uint32_t* flags
+			) {
+				const uint32_t gid = get_global_id(0);
+				if (gid >= keys_cnt) return;
+
+				uint32_t flag = 0;
+				if (is_edge_run_head(keys, gid)) {
+					const uint32_t run_size = get_edge_run_size(keys, keys_cnt, gid);
+					flag = run_size >= min_run_size && run_size <= max_run_size;
+				}
+				flags[gid] = flag;
+			}
+
+			__kernel void emit_edges(
+				__global ulong* keys, uint32_t keys_cnt, uint32_t vertexes_cnt,
+				__global uint32_t* offsets, __global uint32_t* edges
+			) {
+				const uint32_t gid = get_global_id(0);
+				if (gid >= keys_cnt) return;
+
+				// Offsets are the exclusive scan of the flags, a marked run is the one where the offset grows
+				const uint32_t offset = offsets[gid];
+				if (offsets[gid + 1] == offset) return;
+
+				edges[offset * 2 + 0] = (uint32_t)(keys[gid] / vertexes_cnt);
+				edges[offset * 2 + 1] = (uint32_t)(keys[gid] % vertexes_cnt);
+			}
+
+			__kernel void count_vertex_corners(
+				__global uint32_t* indexes, uint32_t half_edges_cnt,
+				__global uint32_t* corners_cnt, __global uint32_t* first_half_edges
+			) {
+				const uint32_t gid = get_global_id(0);
+				if (gid >= half_edges_cnt) return;
+
+				const uint32_t vertex_id = indexes[gid];
+				atomic_inc(&corners_cnt[vertex_id]);
+				atomic_min(&first_half_edges[vertex_id], gid);
+			}
+
+			__kernel void find_half_edges_positions(
+				__global uint32_t* half_edges, uint32_t half_edges_cnt,
+				__global uint32_t* positions
+			) {
+				const uint32_t gid = get_global_id(0);
+				if (gid >= half_edges_cnt) return;
+				positions[half_edges[gid]] = gid;
+			}
+
+			// The other half-edge of the edge, half_edges_cnt when the edge doesn't have exactly two faces
+			uint32_t get_twin_half_edge(
+				__global ulong* keys, __global uint32_t* half_edges, uint32_t half_edges_cnt,
+				uint32_t position
+			) {
+				const uint32_t first = get_edge_run_first(keys, position);
+				if (get_edge_run_size(keys, half_edges_cnt, first) != 2) return half_edges_cnt;
+				return half_edges[first == position ? position + 1 : first];
+			}
+
+			__kernel void check_vertexes_fans(
+				__global uint32_t* indexes, __global ulong* keys, __global uint32_t* half_edges,
+				__global uint32_t* positions, uint32_t half_edges_cnt,
+				__global uint32_t* corners_cnt, __global uint32_t* first_half_edges,
+				uint32_t vertexes_cnt, __global bool* result
+			) {
+				const uint32_t vertex_id = get_global_id(0);
+				if (vertex_id >= vertexes_cnt) return;
 
-				if (iter_counter != all_faces_with_vertex_cnt) {\n
-					*result = false; \n
+				const uint32_t faces_cnt = corners_cnt[vertex_id];
+				if (faces_cnt == 0) {
+					*result = false;
 					return;
-				}\n\n
+				}
 
-				if(!is_edges_equal(origin_edge, current_edge)) { \n
-					*result = false; \n
-					return; \n
-				} \n
-			} \n
+				// The fan is walked from face to face over the edges of the vertex, a manifold vertex
+				// comes back to the first face after visiting every face around it exactly once
+				const uint32_t origin_face_id = first_half_edges[vertex_id] / 3;
+				uint32_t half_edge = first_half_edges[vertex_id];
+				uint32_t face_id = origin_face_id;
+				uint32_t visited_cnt = 0;
+
+				do {
+					const uint32_t twin = get_twin_half_edge(keys, half_edges, half_edges_cnt, positions[half_edge]);
+					if (twin == half_edges_cnt) {
+						*result = false;
+						return;
+					}
+
+					// Faces can be oriented either way, the walk leaves the face over its other edge at the vertex
+					face_id = twin / 3;
+					half_edge = indexes[twin] == vertex_id ?
+						face_id * 3 + (twin % 3 + 2) % 3 :
+						face_id * 3 + (twin % 3 + 1) % 3;
+					++visited_cnt;
+				} while (face_id != origin_face_id && visited_cnt < faces_cnt);
+
+				if (face_id != origin_face_id || visited_cnt != faces_cnt)
+					*result = false;
+			}
+
+			// Adjacency lists are filled by a counting sort: counts, their exclusive scan as offsets, a fill,
+			// then every list is sorted, so the lists don't depend on the order of the atomics
+			__kernel void count_vertex_faces(
+				__global uint32_t* indexes, uint32_t faces_cnt,
+				__global uint32_t* counts
+			) {
+				const uint32_t face_id = get_global_id(0);
+				if (face_id >= faces_cnt) return;
+
+				// A face with a repeated vertex is listed once for it
+				const uint32_t id0 = indexes[face_id * 3 + 0];
+				const uint32_t id1 = indexes[face_id * 3 + 1];
+				const uint32_t id2 = indexes[face_id * 3 + 2];
+				atomic_inc(&counts[id0]);
+				if (id1 != id0) atomic_inc(&counts[id1]);
+				if (id2 != id0 && id2 != id1) atomic_inc(&counts[id2]);
+			}
+
+			__kernel void fill_vertex_faces(
+				__global uint32_t* indexes, uint32_t faces_cnt,
+				__global uint32_t* offsets, __global uint32_t* cursors,
+				__global uint32_t* ids
+			) {
+				const uint32_t face_id = get_global_id(0);
+				if (face_id >= faces_cnt) return;
+
+				const uint32_t id0 = indexes[face_id * 3 + 0];
+				const uint32_t id1 = indexes[face_id * 3 + 1];
+				const uint32_t id2 = indexes[face_id * 3 + 2];
+				ids[offsets[id0] + atomic_inc(&cursors[id0])] = face_id;
+				if (id1 != id0) ids[offsets[id1] + atomic_inc(&cursors[id1])] = face_id;
+				if (id2 != id0 && id2 != id1) ids[offsets[id2] + atomic_inc(&cursors[id2])] = face_id;
+			}
+
+			__kernel void fill_vertex_vertexes(
+				__global ulong* keys, uint32_t keys_cnt, uint32_t vertexes_cnt,
+				__global uint32_t* offsets, __global uint32_t* cursors,
+				__global uint32_t* ids
+			) {
+				const uint32_t gid = get_global_id(0);
+				if (gid >= keys_cnt || !is_edge_run_head(keys, gid)) return;
+
+				// Counts are the valence of count_edge_runs, which skips degenerate edges as well
+				const uint32_t id0 = (uint32_t)(keys[gid] / vertexes_cnt);
+				const uint32_t id1 = (uint32_t)(keys[gid] % vertexes_cnt);
+				if (id0 == id1) return;
+
+				ids[offsets[id0] + atomic_inc(&cursors[id0])] = id1;
+				ids[offsets[id1] + atomic_inc(&cursors[id1])] = id0;
+			}
+
+			__kernel void count_face_faces(
+				__global ulong* keys, __global uint32_t* half_edges, __global uint32_t* positions,
+				uint32_t half_edges_cnt, uint32_t faces_cnt,
+				__global uint32_t* counts
+			) {
+				const uint32_t face_id = get_global_id(0);
+				if (face_id >= faces_cnt) return;
+
+				uint32_t count = 0;
+				for (uint32_t corner = 0; corner < 3; ++corner) {
+					const uint32_t first = get_edge_run_first(keys, positions[face_id * 3 + corner]);
+					const uint32_t last = first + get_edge_run_size(keys, half_edges_cnt, first);
+					for (uint32_t id = first; id < last; ++id)
+						if (half_edges[id] / 3 != face_id) ++count;
+				}
+				counts[face_id] = count;
+			}
+
+			__kernel void fill_face_faces(
+				__global ulong* keys, __global uint32_t* half_edges, __global uint32_t* positions,
+				uint32_t half_edges_cnt, uint32_t faces_cnt,
+				__global uint32_t* offsets, __global uint32_t* ids
+			) {
+				const uint32_t face_id = get_global_id(0);
+				if (face_id >= faces_cnt) return;
+
+				uint32_t offset = offsets[face_id];
+				for (uint32_t corner = 0; corner < 3; ++corner) {
+					const uint32_t first = get_edge_run_first(keys, positions[face_id * 3 + corner]);
+					const uint32_t last = first + get_edge_run_size(keys, half_edges_cnt, first);
+					for (uint32_t id = first; id < last; ++id)
+						if (half_edges[id] / 3 != face_id) ids[offset++] = half_edges[id] / 3;
+				}
+			}
+
+			__kernel void sort_adjacency_lists(
+				__global uint32_t* offsets, uint32_t items_cnt,
+				__global uint32_t* ids
+			) {
+				const uint32_t item_id = get_global_id(0);
+				if (item_id >= items_cnt) return;
+
+				// Lists are as short as the valence or the overlap of two faces, an insertion sort is enough
+				const uint32_t first = offsets[item_id];
+				const uint32_t last = offsets[item_id + 1];
+				for (uint32_t id = first + 1; id < last; ++id) {
+					const uint32_t value = ids[id];
+					uint32_t position = id;
+					while (position > first && ids[position - 1] > value) {
+						ids[position] = ids[position - 1];
+						--position;
+					}
+					ids[position] = value;
+				}
+			}
 		);
 
 	const std::string is_mesh_self_intersected_name = "is_mesh_self_intersected";
@@ -1005,6 +1675,356 @@ namespace ecg {
 			}
 		);
 
+	constexpr uint32_t bvh_invalid_node = 0xFFFFFFFF;
+	constexpr size_t bvh_morton_bits = 10;
+	constexpr uint32_t bvh_find_any = 0;
+	constexpr uint32_t bvh_count_pairs = 1;
+	constexpr uint32_t bvh_fill_pairs = 2;
+
+	const std::string compute_faces_morton_codes_name = "compute_faces_morton_codes";
+	const std::string build_bvh_nodes_name = "build_bvh_nodes";
+	const std::string compute_bvh_boxes_name = "compute_bvh_boxes";
+	const std::string find_bvh_intersections_name = "find_bvh_intersections";
+	const std::string find_bvh_candidates_name = "find_bvh_candidates";
+	const std::string bvh_code =
+		typedef_uint32_t +
+		cross_product +
+		get_vertex +
+		get_face_normal +
+		cl_structs::face_struct +
+		cl_structs::get_face_func +
+		is_vertex_of_triangle_func +
+		is_point_in_triangle_func +
+		"\n#define BVH_INVALID_NODE " + std::to_string(bvh_invalid_node) + "u\n" +
+		"\n#define BVH_MORTON_CELLS " + std::to_string(size_t(1) << bvh_morton_bits) + ".0f\n" +
+		"\n#define BVH_FIND_ANY " + std::to_string(bvh_find_any) + "\n" +
+		"\n#define BVH_COUNT_PAIRS " + std::to_string(bvh_count_pairs) + "\n" +
+		"\n#define BVH_FILL_PAIRS " + std::to_string(bvh_fill_pairs) + "\n" +
+		"\n#define BVH_BOX_PADDING 1e-5f\n" +
+		SCRIPT(
+			// Spreads the lower 10 bits of the value, so three coordinates interleave into a 30-bit code
+			uint32_t expand_morton_bits(uint32_t value) {
+				value = (value * 0x00010001u) & 0xFF0000FFu;
+				value = (value * 0x00000101u) & 0x0F00F00Fu;
+				value = (value * 0x00000011u) & 0xC30C30C3u;
+				value = (value * 0x00000005u) & 0x49249249u;
+				return value;
+			}
+
+			uint32_t get_morton_code(float3 point) {
+				const float3 cell = clamp(point * BVH_MORTON_CELLS, 0.0f, BVH_MORTON_CELLS - 1.0f);
+				return
+					(expand_morton_bits((uint32_t)cell.x) << 2) |
+					(expand_morton_bits((uint32_t)cell.y) << 1) |
+					expand_morton_bits((uint32_t)cell.z);
+			}
+
+			// Length of the common prefix of two sorted codes, equal codes are told apart by their positions
+			int get_common_prefix(__global ulong* codes, int leaves_cnt, int first, int second) {
+				if (second < 0 || second >= leaves_cnt) return -1;
+				const ulong first_code = codes[first];
+				const ulong second_code = codes[second];
+				if (first_code == second_code) return 64 + (int)clz((uint32_t)(first ^ second));
+				return (int)clz(first_code ^ second_code);
+			}
+
+			float3 get_bvh_box_min(volatile __global float* boxes, uint32_t node) {
+				return (float3)(boxes[node * 6 + 0], boxes[node * 6 + 1], boxes[node * 6 + 2]);
+			}
+
+			float3 get_bvh_box_max(volatile __global float* boxes, uint32_t node) {
+				return (float3)(boxes[node * 6 + 3], boxes[node * 6 + 4], boxes[node * 6 + 5]);
+			}
+
+			void set_bvh_box(volatile __global float* boxes, uint32_t node, float3 box_min, float3 box_max) {
+				boxes[node * 6 + 0] = box_min.x;
+				boxes[node * 6 + 1] = box_min.y;
+				boxes[node * 6 + 2] = box_min.z;
+				boxes[node * 6 + 3] = box_max.x;
+				boxes[node * 6 + 4] = box_max.y;
+				boxes[node * 6 + 5] = box_max.z;
+			}
+
+			// Crossing points are rounded, the margin keeps them inside the boxes of both faces
+			float3 get_face_box_padding(float3 box_min, float3 box_max) {
+				return fmax(fabs(box_min), fabs(box_max)) * BVH_BOX_PADDING;
+			}
+
+			bool is_bvh_box_overlapped(__global float* boxes, uint32_t node, float3 box_min, float3 box_max) {
+				const float3 node_min = get_bvh_box_min(boxes, node);
+				const float3 node_max = get_bvh_box_max(boxes, node);
+				return
+					node_min.x <= box_max.x && node_max.x >= box_min.x &&
+					node_min.y <= box_max.y && node_max.y >= box_min.y &&
+					node_min.z <= box_max.z && node_max.z >= box_min.z;
+			}
+
+			// Step of the stackless traversal, the previous node tells whether the node is entered from its parent
+			// or left after its left or right subtree. Subtrees are entered only when is_entered is set.
+			uint32_t get_next_bvh_node(
+				__global uint32_t* children, __global uint32_t* parents, uint32_t first_leaf_node,
+				uint32_t node, uint32_t previous, bool is_entered
+			) {
+				if (previous == parents[node]) return is_entered && node < first_leaf_node ? children[node * 2 + 0] : parents[node];
+				if (previous == children[node * 2 + 0]) return children[node * 2 + 1];
+				return parents[node];
+			}
+
+			// Segment p0-p1 of the face o0-o1-o2 against the face s0-s1-s2, touching at a vertex isn't a crossing
+			bool is_segment_crossing_face(float3 p0, float3 p1, float3 s0, float3 s1, float3 s2, float3 o0, float3 o1, float3 o2) {
+				const bool is_p0_shared = is_vertex_of_triangle(s0, s1, s2, p0);
+				const bool is_p1_shared = is_vertex_of_triangle(s0, s1, s2, p1);
+				if (is_p0_shared && is_p1_shared) return false;
+
+				const float3 direction = p1 - p0;
+				const float3 normal = get_face_normal(s0, s1, s2);
+				const float denom = dot(normal, direction);
+				const float d = -dot(normal, s0);
+
+				// A coplanar segment crosses the face when one of its ends lies inside it
+				if (denom == 0.0f) {
+					if (dot(normal, p0) + d != 0.0f || dot(normal, p1) + d != 0.0f) return false;
+					return
+						(!is_p0_shared && is_point_in_triangle(p0, s0, s1, s2)) ||
+						(!is_p1_shared && is_point_in_triangle(p1, s0, s1, s2));
+				}
+
+				// Otherwise the segment meets the plane once, at the shared vertex if it has one
+				if (is_p0_shared || is_p1_shared) return false;
+
+				const float t_param = -(d + dot(normal, p0)) / denom;
+				if (t_param < 0.0f || t_param > 1.0f) return false;
+
+				const float3 point = p0 + direction * t_param;
+				return
+					is_point_in_triangle(point, s0, s1, s2) &&
+					!is_vertex_of_triangle(s0, s1, s2, point) &&
+					!is_vertex_of_triangle(o0, o1, o2, point);
+			}
+
+			bool is_faces_crossed(float3 a0, float3 a1, float3 a2, float3 b0, float3 b1, float3 b2) {
+				return
+					is_segment_crossing_face(a0, a1, b0, b1, b2, a0, a1, a2) ||
+					is_segment_crossing_face(a1, a2, b0, b1, b2, a0, a1, a2) ||
+					is_segment_crossing_face(a2, a0, b0, b1, b2, a0, a1, a2) ||
+					is_segment_crossing_face(b0, b1, a0, a1, a2, b0, b1, b2) ||
+					is_segment_crossing_face(b1, b2, a0, a1, a2, b0, b1, b2) ||
+					is_segment_crossing_face(b2, b0, a0, a1, a2, b0, b1, b2);
+			}
+
+			__kernel void compute_faces_morton_codes(
+				__global float* vertexes, __global uint32_t* indexes, int vrt_size, uint32_t faces_cnt,
+				float min_x, float min_y, float min_z, float scale_x, float scale_y, float scale_z,
+				__global ulong* codes, __global uint32_t* faces
+			) {
+				const uint32_t face_id = get_global_id(0);
+				if (face_id >= faces_cnt) return;
+
+				const struct face_t face = get_face(indexes, face_id);
+				const float3 centroid = (
+					get_vertex(face.id0, vertexes, vrt_size) +
+					get_vertex(face.id1, vertexes, vrt_size) +
+					get_vertex(face.id2, vertexes, vrt_size)) / 3.0f;
+
+				// Centroids are mapped into the unit cube of the mesh box
+				const float3 point = (float3)((centroid.x - min_x) * scale_x, (centroid.y - min_y) * scale_y, (centroid.z - min_z) * scale_z);
+				codes[face_id] = get_morton_code(point);
+				faces[face_id] = face_id;
+			}
+
+			// Internal node of the radix tree over the sorted codes, every node is built independently
+			__kernel void build_bvh_nodes(
+				__global ulong* codes, uint32_t leaves_cnt,
+				__global uint32_t* children, __global uint32_t* parents, __global uint32_t* last_leaves
+			) {
+				const int cnt = leaves_cnt;
+				const int node = get_global_id(0);
+				if (node >= cnt - 1) return;
+
+				// The range of the node grows towards the neighbour with the longer common prefix
+				const int direction = get_common_prefix(codes, cnt, node, node + 1) >= get_common_prefix(codes, cnt, node, node - 1) ? 1 : -1;
+				const int min_prefix = get_common_prefix(codes, cnt, node, node - direction);
+
+				int max_length = 2;
+				while (get_common_prefix(codes, cnt, node, node + max_length * direction) > min_prefix) max_length <<= 1;
+
+				int length = 0;
+				for (int step = max_length >> 1; step > 0; step >>= 1)
+					if (get_common_prefix(codes, cnt, node, node + (length + step) * direction) > min_prefix) length += step;
+				const int other = node + length * direction;
+
+				// The split is the last leaf sharing more than the prefix of the whole range with the node
+				const int node_prefix = get_common_prefix(codes, cnt, node, other);
+				int split = 0;
+				int step = length;
+				do {
+					step = (step + 1) >> 1;
+					if (get_common_prefix(codes, cnt, node, node + (split + step) * direction) > node_prefix) split += step;
+				} while (step > 1);
+				const int split_leaf = node + split * direction + (direction < 0 ? -1 : 0);
+
+				const int first = node < other ? node : other;
+				const int last = node < other ? other : node;
+				const uint32_t left = first == split_leaf ? cnt - 1 + split_leaf : split_leaf;
+				const uint32_t right = last == split_leaf + 1 ? cnt + split_leaf : split_leaf + 1;
+
+				children[node * 2 + 0] = left;
+				children[node * 2 + 1] = right;
+				parents[left] = node;
+				parents[right] = node;
+				last_leaves[node] = last;
+			}
+
+			__kernel void compute_bvh_boxes(
+				__global float* vertexes, __global uint32_t* indexes, int vrt_size,
+				__global uint32_t* faces, uint32_t leaves_cnt,
+				__global uint32_t* children, __global uint32_t* parents,
+				__global uint32_t* visits, volatile __global float* boxes
+			) {
+				const uint32_t leaf = get_global_id(0);
+				if (leaf >= leaves_cnt) return;
+
+				const struct face_t face = get_face(indexes, faces[leaf]);
+				const float3 v0 = get_vertex(face.id0, vertexes, vrt_size);
+				const float3 v1 = get_vertex(face.id1, vertexes, vrt_size);
+				const float3 v2 = get_vertex(face.id2, vertexes, vrt_size);
+
+				float3 box_min = fmin(fmin(v0, v1), v2);
+				float3 box_max = fmax(fmax(v0, v1), v2);
+				const float3 padding = get_face_box_padding(box_min, box_max);
+				box_min -= padding;
+				box_max += padding;
+
+				uint32_t node = leaves_cnt - 1 + leaf;
+				set_bvh_box(boxes, node, box_min, box_max);
+
+				// The second child to reach a node merges both boxes, so every node is written once after its children
+				node = parents[node];
+				while (node != BVH_INVALID_NODE) {
+					mem_fence(CLK_GLOBAL_MEM_FENCE);
+					if (atomic_inc(&visits[node]) == 0) return;
+
+					const uint32_t left = children[node * 2 + 0];
+					const uint32_t right = children[node * 2 + 1];
+					box_min = fmin(get_bvh_box_min(boxes, left), get_bvh_box_min(boxes, right));
+					box_max = fmax(get_bvh_box_max(boxes, left), get_bvh_box_max(boxes, right));
+					set_bvh_box(boxes, node, box_min, box_max);
+					node = parents[node];
+				}
+			}
+
+			__kernel void find_bvh_intersections(
+				__global float* vertexes, __global uint32_t* indexes, int vrt_size,
+				__global uint32_t* faces, uint32_t leaves_cnt,
+				__global uint32_t* children, __global uint32_t* parents, __global uint32_t* last_leaves,
+				__global float* boxes, uint32_t mode,
+				__global uint32_t* counts, __global uint32_t* pairs, volatile __global uint32_t* is_found
+			) {
+				const uint32_t leaf = get_global_id(0);
+				if (leaf >= leaves_cnt) return;
+				if (mode == BVH_FIND_ANY && *is_found) return;
+
+				const uint32_t first_leaf_node = leaves_cnt - 1;
+				const uint32_t face_id = faces[leaf];
+				const struct face_t face = get_face(indexes, face_id);
+				const float3 v0 = get_vertex(face.id0, vertexes, vrt_size);
+				const float3 v1 = get_vertex(face.id1, vertexes, vrt_size);
+				const float3 v2 = get_vertex(face.id2, vertexes, vrt_size);
+				const float3 box_min = get_bvh_box_min(boxes, first_leaf_node + leaf);
+				const float3 box_max = get_bvh_box_max(boxes, first_leaf_node + leaf);
+
+				uint32_t pairs_cnt = 0;
+				const uint32_t offset = mode == BVH_FILL_PAIRS ? counts[leaf] : 0;
+
+				uint32_t previous = BVH_INVALID_NODE;
+				uint32_t node = 0;
+				while (node != BVH_INVALID_NODE) {
+					bool is_entered = false;
+					if (previous == parents[node]) {
+						// Every pair is found by its leaf with the smaller position, so ranges before this leaf are skipped
+						const bool is_leaf = node >= first_leaf_node;
+						const uint32_t last_leaf = is_leaf ? node - first_leaf_node : last_leaves[node];
+						is_entered = last_leaf > leaf && is_bvh_box_overlapped(boxes, node, box_min, box_max);
+
+						if (is_entered && is_leaf) {
+							const uint32_t other_id = faces[last_leaf];
+							const struct face_t other = get_face(indexes, other_id);
+							const float3 u0 = get_vertex(other.id0, vertexes, vrt_size);
+							const float3 u1 = get_vertex(other.id1, vertexes, vrt_size);
+							const float3 u2 = get_vertex(other.id2, vertexes, vrt_size);
+
+							if (is_faces_crossed(v0, v1, v2, u0, u1, u2)) {
+								if (mode == BVH_FIND_ANY) {
+									*is_found = 1;
+									return;
+								}
+
+								if (mode == BVH_FILL_PAIRS) {
+									pairs[(offset + pairs_cnt) * 2 + 0] = face_id < other_id ? face_id : other_id;
+									pairs[(offset + pairs_cnt) * 2 + 1] = face_id < other_id ? other_id : face_id;
+								}
+								++pairs_cnt;
+							}
+							if (mode == BVH_FIND_ANY && *is_found) return;
+						}
+					}
+
+					const uint32_t next = get_next_bvh_node(children, parents, first_leaf_node, node, previous, is_entered);
+					previous = node;
+					node = next;
+				}
+
+				if (mode == BVH_COUNT_PAIRS) counts[leaf] = pairs_cnt;
+			}
+
+			// Faces of the tree whose boxes overlap the faces of another mesh, written in the order of the leaves
+			__kernel void find_bvh_candidates(
+				__global float* vertexes, __global uint32_t* indexes, int vrt_size, uint32_t faces_cnt,
+				__global uint32_t* faces, uint32_t leaves_cnt,
+				__global uint32_t* children, __global uint32_t* parents,
+				__global float* boxes, uint32_t mode,
+				__global uint32_t* counts, __global uint32_t* candidates
+			) {
+				const uint32_t face_id = get_global_id(0);
+				if (face_id >= faces_cnt) return;
+
+				const uint32_t first_leaf_node = leaves_cnt - 1;
+				const struct face_t face = get_face(indexes, face_id);
+				const float3 v0 = get_vertex(face.id0, vertexes, vrt_size);
+				const float3 v1 = get_vertex(face.id1, vertexes, vrt_size);
+				const float3 v2 = get_vertex(face.id2, vertexes, vrt_size);
+
+				float3 box_min = fmin(fmin(v0, v1), v2);
+				float3 box_max = fmax(fmax(v0, v1), v2);
+				const float3 padding = get_face_box_padding(box_min, box_max);
+				box_min -= padding;
+				box_max += padding;
+
+				uint32_t candidates_cnt = 0;
+				const uint32_t offset = mode == BVH_FILL_PAIRS ? counts[face_id] : 0;
+
+				// Faces outside of the box of the other mesh stop at the root
+				uint32_t previous = BVH_INVALID_NODE;
+				uint32_t node = 0;
+				while (node != BVH_INVALID_NODE) {
+					bool is_entered = false;
+					if (previous == parents[node]) {
+						is_entered = is_bvh_box_overlapped(boxes, node, box_min, box_max);
+						if (is_entered && node >= first_leaf_node) {
+							if (mode == BVH_FILL_PAIRS) candidates[offset + candidates_cnt] = faces[node - first_leaf_node];
+							++candidates_cnt;
+						}
+					}
+
+					const uint32_t next = get_next_bvh_node(children, parents, first_leaf_node, node, previous, is_entered);
+					previous = node;
+					node = next;
+				}
+
+				if (mode == BVH_COUNT_PAIRS) counts[face_id] = candidates_cnt;
+			}
+		);
+
 	const std::string triangulate_mesh_name = "triangulate_mesh";
 	const std::string triangulate_mesh_code =
 		typedef_uint32_t +
@@ -1025,7 +2045,7 @@ namespace ecg {
 				for (uint32_t i = 0; i < base_num_verts - 2; ++i) {
 					uint32_t current_index = index_id + i + 1;
 
-					new_indexes[new_face_id * 3 + 0] = old_indexes[basic_index];
+					new_indexes[new_face_id * 3 + 0] = basic_index;
 					new_indexes[new_face_id * 3 + 1] = old_indexes[current_index];
 					new_indexes[new_face_id * 3 + 2] = old_indexes[current_index + 1];
 
@@ -1034,6 +2054,26 @@ namespace ecg {
 			}
 		);
 
+	const std::string get_face_volume =
+		SCRIPT(
+			float get_face_volume(float3 v0, float3 v1, float3 v2) {
+				float3 norm = get_face_normal(v0, v1, v2);
+
+				float3 center = (v0 + v1 + v2) / 3.0f;
+				float3 default_pt = (float3)( 0.0f, 0.0f, 0.0f );
+
+				float3 AB = v1 - v0;
+				float3 AC = v2 - v0;
+
+				float3 temp = cross_product(AB, AC);
+				float surf_area = get_len_fl3(temp) / 2.0f;
+
+				float3 OG = center - default_pt;
+				float sign = dot(OG, norm) > 0.0f ? 1.0f : -1.0f;
+				return (1.0f / 3.0f) * surf_area * sign;
+			}
+		);
+
 	const std::string compute_volume_name = "compute_volume";
 	const std::string compute_volume_code =
 		typedef_uint32_t +
@@ -1043,6 +2083,7 @@ namespace ecg {
 		get_face_normal +
 		get_vert_len +
 		get_vertex +
+		get_face_volume +
 		SCRIPT(
 			__kernel void compute_volume(
 				__global float* vertexes, uint32_t vertexes_size,
@@ -1056,20 +2097,7 @@ namespace ecg {
 				float3 v0 = get_vertex(face.id0, vertexes, 3);
 				float3 v1 = get_vertex(face.id1, vertexes, 3);
 				float3 v2 = get_vertex(face.id2, vertexes, 3);
-				float3 norm = get_face_normal(v0, v1, v2);
-
-				float3 center = (v0 + v1 + v2) / 3.0f;
-				float3 default_pt = (float3)( 0.0f, 0.0f, 0.0f );
-
-				float3 AB = v1 - v0;
-				float3 AC = v2 - v0;
-
-				float3 temp = cross_product(AB, AC);
-				float surf_area = get_len_fl3(temp) / 2.0f;
-
-				float3 OG = center - default_pt;
-				float sign = dot(OG, norm) > 0.0f ? 1.0f : -1.0f;
-				volumes[id] = (1.0f / 3.0f) * surf_area * sign;
+				volumes[id] = get_face_volume(v0, v1, v2);
 			}
 		);
 
@@ -1086,7 +2114,7 @@ namespace ecg {
 			__kernel void compute_faces_normals(
 				__global float* vertexes, uint32_t vertexes_size,
 				__global uint32_t * indexes, uint32_t indexes_size,
-				__global float3* normals, uint32_t faces_cnt
+				__global float* normals, uint32_t faces_cnt
 			) {
 				uint32_t id = get_global_id(0);
 				if (id >= faces_cnt) return;
@@ -1096,7 +2124,10 @@ namespace ecg {
 				float3 v1 = get_vertex(face.id1, vertexes, 3);
 				float3 v2 = get_vertex(face.id2, vertexes, 3);
 				float3 norm = normalize(get_face_normal(v0, v1, v2));
-				normals[id] = norm;
+
+				normals[id * 3 + 0] = norm.x;
+				normals[id * 3 + 1] = norm.y;
+				normals[id * 3 + 2] = norm.z;
 			}
 		);
 
@@ -1110,75 +2141,182 @@ namespace ecg {
 		get_vertex +
 		SCRIPT(
 			__kernel void compute_vertex_normals(
-				__global float3* vertexes, uint32_t vertexes_size,
-				__global uint32_t* indexes, uint32_t indexes_size,
-				int vrt_size, __global float3* result
+				__global float* vertexes, uint32_t vertexes_size,
+				__global uint32_t* indexes, __global uint32_t* faces_offsets, __global uint32_t* vertex_faces,
+				int vrt_size, __global float* result
 			) {
 				uint32_t vrt_id = get_global_id(0);
 				if (vrt_id >= vertexes_size) return;
 
-				uint32_t num_of_vertexes = 0;
-				result[vrt_id] = (float3)(0.0f, 0.0f, 0.0f);
-				float3 vertex = get_vertex(vrt_id, vertexes, vrt_size);
+				float3 normal = (float3)(0.0f, 0.0f, 0.0f);
+				const uint32_t first = faces_offsets[vrt_id];
+				const uint32_t last = faces_offsets[vrt_id + 1];
 
-				for (uint32_t face_id = 0; face_id < indexes_size / 3; ++face_id) {
-					struct face_t face = get_face(indexes, face_id);
+				// Faces of the vertex come from its adjacency list, so the cost is its valence instead of all faces
+				for (uint32_t id = first; id < last; ++id) {
+					struct face_t face = get_face(indexes, vertex_faces[id]);
 					float3 v0 = get_vertex(face.id0, vertexes, vrt_size);
 					float3 v1 = get_vertex(face.id1, vertexes, vrt_size);
 					float3 v2 = get_vertex(face.id2, vertexes, vrt_size);
-
-					if (face.id0 == vrt_id || face.id1 == vrt_id || face.id2 == vrt_id) {
-						result[vrt_id] += normalize(get_face_normal(v0, v1, v2));
-						++num_of_vertexes;
-					}
+					normal += normalize(get_face_normal(v0, v1, v2));
 				}
 
-				if (num_of_vertexes != 0) {
-					result[vrt_id] = result[vrt_id] / num_of_vertexes;
+				if (last != first) {
+					normal = normal / (float)(last - first);
 				}
-				else {
-					result[vrt_id] = (float3)(0.0f, 0.0f, 0.0f);
+
+				result[vrt_id * vrt_size + 0] = normal.x;
+				result[vrt_id * vrt_size + 1] = normal.y;
+				result[vrt_id * vrt_size + 2] = normal.z;
+			}
+		);
+
+	/// <summary>
+	/// Kernels of the batched API. Meshes are packed one after another, indexes are rebased to the packed vertexes
+	/// and offsets hold the first vertex (or face) of every mesh with the total count at the end.
+	/// </summary>
+	const std::string find_batch_mesh_func =
+		SCRIPT(
+			uint32_t find_batch_mesh(__global uint32_t* offsets, uint32_t meshes_cnt, uint32_t item_id) {
+				uint32_t first = 0;
+				uint32_t last = meshes_cnt;
+
+				while (last - first > 1) {
+					uint32_t middle = first + (last - first) / 2;
+					if (offsets[middle] <= item_id) first = middle;
+					else last = middle;
 				}
+
+				return first;
 			}
 		);
 
-	const std::string center_point_simplification_name = "center_point_simplification";
-	const std::string center_point_simplification_code =
+	const std::string batch_compute_volume_name = "batch_compute_volume";
+	const std::string batch_compute_volume_code =
+		enable_atomics_def +
 		typedef_uint32_t +
 		cl_structs::face_struct +
 		cl_structs::get_face_func +
-		cl_structs::faces_has_shared_edge_func +
+		atomic_add_f +
+		cross_product +
+		get_face_normal +
+		get_vert_len +
 		get_vertex +
+		get_face_volume +
+		find_batch_mesh_func +
 		SCRIPT(
-			__kernel void center_point_simplification(
-				__global float3* vertexes, uint32_t vertexes_size,
-				__global uint32_t* indexes, uint32_t indexes_size,
-				__global float3* result_vertexes, uint32_t result_vertexes_size,
-				__global uint32_t* result_indexes_size,
-				uint32_t vrt_size
+			__kernel void batch_compute_volume(
+				__global float* vertexes, __global uint32_t* indexes, uint32_t faces_cnt,
+				__global uint32_t* face_offsets, uint32_t meshes_cnt,
+				__global float* volumes
 			) {
 				uint32_t face_id = get_global_id(0);
-				uint32_t faces_cnt = indexes_size / 3;
-				
 				if (face_id >= faces_cnt) return;
-				if (face_id >= result_vertexes_size) return;
 
+				uint32_t mesh_id = find_batch_mesh(face_offsets, meshes_cnt, face_id);
 				struct face_t face = get_face(indexes, face_id);
-				float3 v0 = get_vertex(face.id0, vertexes, vrt_size);
-				float3 v1 = get_vertex(face.id1, vertexes, vrt_size);
-				float3 v2 = get_vertex(face.id2, vertexes, vrt_size);
+				float3 v0 = get_vertex(face.id0, vertexes, 3);
+				float3 v1 = get_vertex(face.id1, vertexes, 3);
+				float3 v2 = get_vertex(face.id2, vertexes, 3);
 
-				result_indexes_size[face_id] = 0;
-				result_vertexes[face_id] = (v0 + v1 + v2) / 3;
+				atomic_add_f(&volumes[mesh_id], get_face_volume(v0, v1, v2));
+			}
+		);
 
-				for (uint32_t id = 0; id < face_cnt; ++id) {
-					if (id == face_id) continue;
-					struct face_t temp_face = get_face(indexes, id);
+	const std::string compute_cell_keys_name = "compute_cell_keys";
+	const std::string find_cell_starts_name = "find_cell_starts";
+	const std::string average_cell_vertexes_name = "average_cell_vertexes";
+	const std::string mark_cluster_faces_name = "mark_cluster_faces";
+	const std::string compact_cluster_faces_name = "compact_cluster_faces";
 
-					if (faces_has_shared_edge(temp_face, face)) {
-						result_indexes_size[face_id] += 1;
-					}
-				}
+	/// <summary>
+	/// Vertex clustering on a grid: vertexes are sorted by the keys of their cells, every cell becomes the average
+	/// of its vertexes and faces with two corners in one cell are dropped.
+	/// </summary>
+	const std::string center_point_simplification_code =
+		typedef_uint32_t +
+		cl_structs::face_struct +
+		cl_structs::get_face_func +
+		get_vertex +
+		SCRIPT(
+			__kernel void compute_cell_keys(
+				__global float* vertexes, int vrt_size, uint32_t vertexes_cnt,
+				float min_x, float min_y, float min_z, float inv_cell_size,
+				uint32_t cells_x, uint32_t cells_y, uint32_t cells_z,
+				__global ulong* keys, __global uint32_t* ids
+			) {
+				const uint32_t vrt_id = get_global_id(0);
+				if (vrt_id >= vertexes_cnt) return;
+
+				// Vertexes on the max side of the box belong to the last cell
+				const float3 vrt = get_vertex(vrt_id, vertexes, vrt_size);
+				const ulong x = min((uint32_t)((vrt.x - min_x) * inv_cell_size), cells_x - 1);
+				const ulong y = min((uint32_t)((vrt.y - min_y) * inv_cell_size), cells_y - 1);
+				const ulong z = min((uint32_t)((vrt.z - min_z) * inv_cell_size), cells_z - 1);
+
+				keys[vrt_id] = (z * cells_y + y) * cells_x + x;
+				ids[vrt_id] = vrt_id;
+			}
+
+			// Offsets are the scanned flags of the first vertexes of the cells in the sorted order
+			__kernel void find_cell_starts(
+				__global ulong* keys, uint32_t vertexes_cnt,
+				__global uint32_t* offsets
+			) {
+				const uint32_t id = get_global_id(0);
+				if (id >= vertexes_cnt) return;
+				offsets[id] = id == 0 || keys[id] != keys[id - 1];
+			}
+
+			__kernel void average_cell_vertexes(
+				__global float* vertexes, int vrt_size, uint32_t vertexes_cnt,
+				__global uint32_t* sorted_ids, __global uint32_t* offsets,
+				__global uint32_t* vertex_cells, __global float* cell_vertexes
+			) {
+				const uint32_t id = get_global_id(0);
+				if (id >= vertexes_cnt) return;
+
+				const uint32_t cell_id = offsets[id + 1] - 1;
+				vertex_cells[sorted_ids[id]] = cell_id;
+				if (offsets[id + 1] == offsets[id]) return;
+
+				// The first vertex of a cell sums the run of its cell
+				float3 sum = (float3)(0.0f);
+				uint32_t last = id;
+				for (; last < vertexes_cnt && offsets[last + 1] - 1 == cell_id; ++last)
+					sum += get_vertex(sorted_ids[last], vertexes, vrt_size);
+
+				vstore3(sum / (float)(last - id), cell_id, cell_vertexes);
+			}
+
+			__kernel void mark_cluster_faces(
+				__global uint32_t* indexes, uint32_t faces_cnt,
+				__global uint32_t* vertex_cells, __global uint32_t* flags
+			) {
+				const uint32_t face_id = get_global_id(0);
+				if (face_id >= faces_cnt) return;
+
+				const struct face_t face = get_face(indexes, face_id);
+				const uint32_t c0 = vertex_cells[face.id0];
+				const uint32_t c1 = vertex_cells[face.id1];
+				const uint32_t c2 = vertex_cells[face.id2];
+				flags[face_id] = c0 != c1 && c1 != c2 && c0 != c2;
+			}
+
+			__kernel void compact_cluster_faces(
+				__global uint32_t* indexes, uint32_t faces_cnt,
+				__global uint32_t* vertex_cells, __global uint32_t* offsets,
+				__global uint32_t* result_indexes
+			) {
+				const uint32_t face_id = get_global_id(0);
+				if (face_id >= faces_cnt) return;
+				if (offsets[face_id + 1] == offsets[face_id]) return;
+
+				const struct face_t face = get_face(indexes, face_id);
+				const uint32_t result_id = offsets[face_id] * 3;
+				result_indexes[result_id + 0] = vertex_cells[face.id0];
+				result_indexes[result_id + 1] = vertex_cells[face.id1];
+				result_indexes[result_id + 2] = vertex_cells[face.id2];
 			}
 		);
 
@@ -1292,11 +2430,31 @@ namespace ecg {
 			);
 
 		const std::string intersect_two_meshes_name = "intersect_two_meshes";
+		const std::string intersect_candidate_faces_name = "intersect_candidate_faces";
 		const std::string intersect_two_meshes_code =
 			check_is_point_in_face_func +
 			intersect_face_and_line_func +
 			get_vertex +
 			SCRIPT(
+				// Edges of every face against the other face, points are counted per face of the first mesh
+				void intersect_faces( \n
+					float3 a_1, float3 b_1, float3 c_1, \n
+					float3 a_2, float3 b_2, float3 c_2, \n\n
+
+					__global volatile int* vrt_offsets, int vrt_offsets_size, \n
+					__global volatile float* intersect, long intersect_size, \n
+					__global volatile unsigned int* int_faces, long int_faces_size, \n
+					int f1_id, int f2_id, int* intersect_offset \n
+				) { \n
+					intersect_face_and_line(a_1, b_1, c_1, a_2, b_2, vrt_offsets, vrt_offsets_size, intersect, intersect_size, int_faces, int_faces_size, f1_id, f2_id, intersect_offset); \n
+					intersect_face_and_line(a_1, b_1, c_1, b_2, c_2, vrt_offsets, vrt_offsets_size, intersect, intersect_size, int_faces, int_faces_size, f1_id, f2_id, intersect_offset); \n
+					intersect_face_and_line(a_1, b_1, c_1, c_2, a_2, vrt_offsets, vrt_offsets_size, intersect, intersect_size, int_faces, int_faces_size, f1_id, f2_id, intersect_offset); \n\n
+
+					intersect_face_and_line(a_2, b_2, c_2, a_1, b_1, vrt_offsets, vrt_offsets_size, intersect, intersect_size, int_faces, int_faces_size, f1_id, f2_id, intersect_offset); \n
+					intersect_face_and_line(a_2, b_2, c_2, b_1, c_1, vrt_offsets, vrt_offsets_size, intersect, intersect_size, int_faces, int_faces_size, f1_id, f2_id, intersect_offset); \n
+					intersect_face_and_line(a_2, b_2, c_2, c_1, a_1, vrt_offsets, vrt_offsets_size, intersect, intersect_size, int_faces, int_faces_size, f1_id, f2_id, intersect_offset); \n
+				}; \n\n
+
 				__kernel void intersect_two_meshes(
 					__global float * m1_vertexes, int m1_vertexes_size, \n
 					__global float * m2_vertexes, int m2_vertexes_size, \n \n
@@ -1327,13 +2485,44 @@ namespace ecg {
 						float3 b_2 = get_vertex(m2_indexes[offset_2 + 1], m2_vertexes, 3); \n
 						float3 c_2 = get_vertex(m2_indexes[offset_2 + 2], m2_vertexes, 3); \n\n
 
-						intersect_face_and_line(a_1, b_1, c_1, a_2, b_2, vrt_offsets, vrt_offsets_size, intersect, intersect_size, int_faces, int_faces_size, m1_face_id, m2_face_id, &intersect_offset); \n
-						intersect_face_and_line(a_1, b_1, c_1, b_2, c_2, vrt_offsets, vrt_offsets_size, intersect, intersect_size, int_faces, int_faces_size, m1_face_id, m2_face_id, &intersect_offset); \n
-						intersect_face_and_line(a_1, b_1, c_1, c_2, a_2, vrt_offsets, vrt_offsets_size, intersect, intersect_size, int_faces, int_faces_size, m1_face_id, m2_face_id, &intersect_offset); \n
+						intersect_faces(a_1, b_1, c_1, a_2, b_2, c_2, vrt_offsets, vrt_offsets_size, intersect, intersect_size, int_faces, int_faces_size, m1_face_id, m2_face_id, &intersect_offset); \n
+					}\n
+				}; \n\n
 
-						intersect_face_and_line(a_2, b_2, c_2, a_1, b_1, vrt_offsets, vrt_offsets_size, intersect, intersect_size, int_faces, int_faces_size, m1_face_id, m2_face_id, &intersect_offset); \n
-						intersect_face_and_line(a_2, b_2, c_2, b_1, c_1, vrt_offsets, vrt_offsets_size, intersect, intersect_size, int_faces, int_faces_size, m1_face_id, m2_face_id, &intersect_offset); \n
-						intersect_face_and_line(a_2, b_2, c_2, c_1, a_1, vrt_offsets, vrt_offsets_size, intersect, intersect_size, int_faces, int_faces_size, m1_face_id, m2_face_id, &intersect_offset); \n
+				// Same as intersect_two_meshes, but only the faces of m2 listed for the face of m1 are tested
+				__kernel void intersect_candidate_faces(
+					__global float * m1_vertexes, int m1_vertexes_size, \n
+					__global float * m2_vertexes, int m2_vertexes_size, \n \n
+
+					__global int* m1_indexes, int m1_indexes_size, \n
+					__global int* m2_indexes, int m2_indexes_size, \n\n
+
+					__global unsigned int* candidate_offsets, __global unsigned int* candidates, \n
+					__global int* vrt_offsets, int vrt_offsets_size, \n
+					__global float* intersect, long intersect_size, \n
+					__global unsigned int* int_faces, long int_faces_size \n
+				) { \n
+					int m1_face_id = get_global_id(0); \n
+					if (m1_face_id >= m1_indexes_size / 3) return; \n\n
+
+					size_t offset_1 = m1_face_id * 3; \n
+					float3 a_1 = get_vertex(m1_indexes[offset_1 + 0], m1_vertexes, 3); \n
+					float3 b_1 = get_vertex(m1_indexes[offset_1 + 1], m1_vertexes, 3); \n
+					float3 c_1 = get_vertex(m1_indexes[offset_1 + 2], m1_vertexes, 3); \n\n
+
+					int intersect_offset = 0; \n
+					if (m1_face_id != 0) { \n
+						intersect_offset = vrt_offsets[m1_face_id - 1]; \n
+					} \n\n
+
+					for (unsigned int id = candidate_offsets[m1_face_id]; id < candidate_offsets[m1_face_id + 1]; ++id) { \n
+						int m2_face_id = candidates[id]; \n
+						size_t offset_2 = m2_face_id * 3; \n
+						float3 a_2 = get_vertex(m2_indexes[offset_2 + 0], m2_vertexes, 3); \n
+						float3 b_2 = get_vertex(m2_indexes[offset_2 + 1], m2_vertexes, 3); \n
+						float3 c_2 = get_vertex(m2_indexes[offset_2 + 2], m2_vertexes, 3); \n\n
+
+						intersect_faces(a_1, b_1, c_1, a_2, b_2, c_2, vrt_offsets, vrt_offsets_size, intersect, intersect_size, int_faces, int_faces_size, m1_face_id, m2_face_id, &intersect_offset); \n
 					}\n
 				}; \n
 			);
@@ -1371,6 +2560,30 @@ namespace ecg {
 					} \n
 				} \n
 			);
+
+	/// <summary>
+	/// Programs used by the API with the names they are cached under.
+	/// Sources must match the call sites, because the program cache is keyed by name.
+	/// </summary>
+	const std::vector<std::pair<std::string, std::vector<std::string>>> api_programs = {
+		{ summ_vertexes_name, { summ_vertexes_code } },
+		{ compute_aabb_name, { compute_aabb_code } },
+		{ find_kdop_extremes_name, { hull_prefilter_code } },
+		{ compute_faces_areas_name, { compute_faces_areas_code } },
+		{ compute_mesh_stats_name, { compute_mesh_stats_code } },
+		{ compute_cov_mat_name, { enable_atomics_def, get_vertex, compute_cov_mat_code, compute_obb_code } },
+		{ compute_obb_name, { enable_atomics_def, get_vertex, compute_cov_mat_code, compute_obb_code } },
+		{ build_edge_keys_name, { edge_topology_code } },
+		{ is_mesh_self_intersected_name, { is_mesh_self_intersected_code } },
+		{ compute_faces_morton_codes_name, { bvh_code } },
+		{ compute_cell_keys_name, { center_point_simplification_code } },
+		{ triangulate_mesh_name, { triangulate_mesh_code } },
+		{ compute_volume_name, { compute_volume_code } },
+		{ compute_faces_normals_name, { compute_faces_normals_code } },
+		{ compute_vertex_normals_name, { compute_vertex_normals_code } },
+		{ intersect_two_meshes_name, { intersect_two_meshes_code } },
+		{ batch_compute_volume_name, { batch_compute_volume_code } },
+	};
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,86 @@
+#ifndef ECG_CMD_CHAIN_H
+#define ECG_CMD_CHAIN_H
+#include <core/ecg_cl_version.h>
+#include <core/ecg_profiler.h>
+#include <ecg_api_define.h>
+#include <ecg_global.h>
+
+namespace ecg {
+	/// <summary>
+	/// Commands of one call on an out-of-order queue.
+	/// Every command waits for the events of the previous one, so the commands of a chain run in order,
+	/// while commands of other chains on the same queue can run in between. The host waits only in wait().
+	/// Not thread-safe, except get_events, which is used by buffers returning to the pool.
+	/// </summary>
+	class ECG_API ecg_cmd_chain {
+	public:
+		/// <summary>
+		/// Events the next command of the chain waits for, shared with the buffers acquired for the chain.
+		/// </summary>
+		struct state_t {
+			std::vector<cl::Event> events;
+			mutable std::mutex lock;
+		};
+
+		explicit ecg_cmd_chain(const cl::CommandQueue& queue);
+		ecg_cmd_chain(const ecg_cmd_chain& chain) = delete;
+		ecg_cmd_chain& operator=(const ecg_cmd_chain& chain) = delete;
+
+		cl::CommandQueue& get_queue();
+		cl::Context& get_context();
+		std::shared_ptr<state_t> get_state() const;
+
+		/// <summary>
+		/// Wait list of the next command, nullptr when it doesn't wait for anything.
+		/// </summary>
+		const std::vector<cl::Event>* get_wait_list() const;
+
+		/// <summary>
+		/// The next command also waits for the events, used for commands outside of the chain.
+		/// </summary>
+		void add_dependencies(const std::vector<cl::Event>& events);
+
+		/// <summary>
+		/// The command of the event was enqueued with get_wait_list, the next commands wait only for it.
+		/// </summary>
+		void push(const cl::Event& event);
+
+		std::vector<cl::Event> get_events() const;
+
+		/// <summary>
+		/// Event that completes after all commands of the chain, a completed user event for an empty chain.
+		/// </summary>
+		cl_int get_last_event(cl::Event* event);
+
+		/// <summary>
+		/// Waits for all commands of the chain, results read by the chain are available after it.
+		/// </summary>
+		cl_int wait();
+
+		cl_int write_buffer(const cl::Buffer& buffer, size_t offset, size_t size, const void* ptr);
+		cl_int read_buffer(const cl::Buffer& buffer, size_t offset, size_t size, void* ptr);
+		cl_int copy_buffer(const cl::Buffer& src, const cl::Buffer& dst, size_t src_offset, size_t dst_offset, size_t size);
+
+		/// <summary>
+		/// Maps the buffer for the host, the pointer is valid after the commands of the chain complete.
+		/// </summary>
+		void* map_buffer(const cl::Buffer& buffer, cl_map_flags flags, size_t offset, size_t size, cl_int* err = nullptr);
+		cl_int unmap_buffer(const cl::Buffer& buffer, void* ptr);
+
+		template <typename Type>
+		cl_int fill_buffer(const cl::Buffer& buffer, const Type& pattern, size_t offset, size_t size) {
+			cl::Event event;
+			cl_int result = m_queue.enqueueFillBuffer(buffer, pattern, offset, size, get_wait_list(), &event);
+			if (result == CL_SUCCESS) push(event);
+			return result;
+		}
+
+	private:
+		std::shared_ptr<state_t> m_state;
+		cl::CommandQueue m_queue;
+		cl::Context m_context;
+
+	};
+}
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef ECG_CPU_H
+#define ECG_CPU_H
+#include <core/ecg_task_pool.h>
+#include <help/ecg_status.h>
+#include <help/ecg_geom.h>
+#include <ecg_global.h>
+#include <ecg_api.h>
+
+#include <exception>
+
+namespace ecg::cpu {
+	/// <summary>
+	/// Minimal number of items computed by one host thread.
+	/// Linear passes are cheaper than the hand-off to a worker for fewer items.
+	/// </summary>
+	constexpr size_t default_grain = 4096;
+
+	/// <summary>
+	/// Calls func(begin, end) for consecutive chunks of [0, items_cnt) on the compute pool.
+	/// The calling thread computes the first chunk, the first exception is rethrown after all chunks are done.
+	/// </summary>
+	template <typename Func>
+	void parallel_for(size_t items_cnt, size_t grain, Func&& func) {
+		auto& pool = ecg_task_pool::get_compute_instance();
+		size_t max_chunks = pool.get_threads_count() + 1;
+		size_t chunks_cnt = std::min(max_chunks, (items_cnt + grain - 1) / std::max<size_t>(grain, 1));
+
+		if (chunks_cnt <= 1) {
+			if (items_cnt != 0) func(size_t(0), items_cnt);
+			return;
+		}
+
+		size_t chunk_size = (items_cnt + chunks_cnt - 1) / chunks_cnt;
+		std::vector<std::future<void>> chunks;
+
+		for (size_t begin = chunk_size; begin < items_cnt; begin += chunk_size) {
+			size_t end = std::min(begin + chunk_size, items_cnt);
+			chunks.push_back(pool.submit([&func, begin, end] { func(begin, end); }));
+		}
+
+		// Workers reference func, so they are waited for even if the first chunk fails
+		std::exception_ptr error;
+		try {
+			func(size_t(0), chunk_size);
+		}
+		catch (...) {
+			error = std::current_exception();
+		}
+
+		for (auto& chunk : chunks) {
+			try {
+				chunk.get();
+			}
+			catch (...) {
+				if (!error) error = std::current_exception();
+			}
+		}
+
+		if (error) std::rethrow_exception(error);
+	}
+
+	/// <summary>
+	/// Reduces [0, items_cnt) with func(begin, end) -> T per chunk and reduce(T, T) over the chunks in order.
+	/// </summary>
+	template <typename T, typename Func, typename Reduce>
+	T parallel_reduce(size_t items_cnt, size_t grain, T init, Func&& func, Reduce&& reduce) {
+		size_t chunk_size = std::max<size_t>(grain, 1);
+		size_t chunks_cnt = (items_cnt + chunk_size - 1) / chunk_size;
+		std::vector<T> partial(chunks_cnt, init);
+
+		parallel_for(chunks_cnt, 1, [&](size_t begin, size_t end) {
+			for (size_t chunk_id = begin; chunk_id < end; ++chunk_id) {
+				size_t first = chunk_id * chunk_size;
+				partial[chunk_id] = func(first, std::min(first + chunk_size, items_cnt));
+			}
+		});
+
+		T result = init;
+		for (const T& value : partial)
+			result = reduce(result, value);
+		return result;
+	}
+
+	/// <summary>
+	/// Adjacency list in CSR form, the neighbours of item i are ids[offsets[i], offsets[i + 1]) in ascending order.
+	/// </summary>
+	struct adjacency_list_t {
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> ids;
+	};
+
+	/// <summary>
+	/// Faces of every vertex, a face with a repeated vertex is listed once.
+	/// </summary>
+	adjacency_list_t get_vertex_faces(const ecg_mesh_t* mesh);
+
+	/// <summary>
+	/// Faces sharing an edge with every face, a face is listed once per shared edge.
+	/// </summary>
+	adjacency_list_t get_face_faces(const ecg_mesh_t* mesh);
+
+	/// <summary>
+	/// Vertexes sharing an edge with every vertex, degenerate edges are skipped.
+	/// </summary>
+	adjacency_list_t get_vertex_vertexes(const ecg_mesh_t* mesh);
+
+	/// <summary>
+	/// Host implementations of the public API, used by the CPU backend.
+	/// The mesh must already pass default_mesh_check, errors are reported through op_res.
+	/// Functions that can't fail keep op_res too, it also keeps the calls apart from the public overloads.
+	/// </summary>
+	void check_indexes(const ecg_mesh_t* mesh, ecg_status_handler& op_res);
+
+	vec3_base sum_vertexes(const ecg_mesh_t* mesh, ecg_status_handler& op_res);
+	vec3_base get_center(const ecg_mesh_t* mesh, ecg_status_handler& op_res);
+	float compute_surface_area(const ecg_mesh_t* mesh, ecg_status_handler& op_res);
+	ecg_array_t compute_faces_areas(const ecg_mesh_t* mesh, ecg_array_t* areas_cdf, ecg_status_handler& op_res);
+	mat3_base compute_covariance_matrix(const ecg_mesh_t* mesh, ecg_status_handler& op_res);
+	ecg_edge_stats_t compute_edge_stats(const ecg_mesh_t* mesh, ecg_status_handler& op_res);
+	/// <summary>
+	/// Edges with [min_faces_cnt, max_faces_cnt] faces as pairs of vertex ids, ordered by the ids.
+	/// </summary>
+	ecg_array_t find_edges(const ecg_mesh_t* mesh, uint32_t min_faces_cnt, uint32_t max_faces_cnt, ecg_status_handler& op_res);
+	ecg_array_t compute_vertexes_valence(const ecg_mesh_t* mesh, ecg_status_handler& op_res);
+	ecg_adjacency_t build_adjacency(const ecg_mesh_t* mesh, ecg_status_handler& op_res);
+	bool is_mesh_closed(const ecg_mesh_t* mesh, ecg_status_handler& op_res);
+	bool is_mesh_manifold(const ecg_mesh_t* mesh, ecg_status_handler& op_res);
+	bool is_mesh_self_intersected(const ecg_mesh_t* mesh, self_intersection_method method, ecg_status_handler& op_res);
+	ecg_array_t find_self_intersections(const ecg_mesh_t* mesh, ecg_status_handler& op_res);
+	ecg_array_t triangulate_mesh(const ecg_mesh_t* mesh, int base_num_vert, ecg_status_handler& op_res);
+	float compute_volume(const ecg_mesh_t* mesh, ecg_status_handler& op_res);
+	/// <summary>
+	/// Volume of the mesh without the manifold check of compute_volume.
+	/// </summary>
+	float sum_faces_volumes(const ecg_mesh_t* mesh, ecg_status_handler& op_res);
+	ecg_array_t compute_faces_normals(const ecg_mesh_t* mesh, ecg_status_handler& op_res);
+	ecg_array_t compute_vertex_normals(const ecg_mesh_t* mesh, ecg_status_handler& op_res);
+	intersection_set_t get_intersection_points(const ecg_mesh_t* m1, const ecg_mesh_t* m2, ecg_status_handler& op_res);
+
+	bounding_box compute_aabb(const ecg_mesh_t* mesh, ecg_status_handler& op_res);
+	full_bounding_box compute_obb(const ecg_mesh_t* mesh, ecg_status_handler& op_res);
+	ecg_mesh_stats_t compute_mesh_stats(const ecg_mesh_t* mesh, ecg_status_handler& op_res);
+}
+
+#endif
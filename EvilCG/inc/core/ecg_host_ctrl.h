@@ -1,6 +1,7 @@
 #ifndef ECG_HOST_CTRL_H
 #define ECG_HOST_CTRL_H
 #include <core/ecg_cl_version.h>
+#include <core/ecg_buffer_pool.h>
 #include <help/ecg_logger.h>
 #include <ecg_api_define.h>
 #include <ecg_global.h>
@@ -20,6 +21,8 @@ namespace ecg {
 	/// <summary>
 	/// Global OpenCL Host Controller.
 	/// Thread-Safe - Singleton.
+	/// In thread-safe mode every thread gets its own command queue in the shared context,
+	/// so threads only wait for their own commands. Init and release must not run concurrently with other calls.
 	/// </summary>
 	class ECG_API ecg_cl {
 	public:
@@ -35,8 +38,37 @@ namespace ecg {
 		cl::Device& get_device();
 		cl::Context& get_context();
 		cl::CommandQueue& get_cmd_queue();
+		size_t get_thread_queues_count();
 		cl_int get_max_work_group_size() const;
 
+		/// <summary>
+		/// Pool of transient device buffers, it is cleared when the controller is released.
+		/// </summary>
+		ecg_buffer_pool& get_buffer_pool();
+
+		void set_thread_safe_mode(bool enabled);
+		bool is_thread_safe_mode() const;
+
+		/// <summary>
+		/// True for CPU devices and devices that share physical memory with the host.
+		/// </summary>
+		bool is_host_unified_memory() const;
+
+		/// <summary>
+		/// Zero-copy is active when it is enabled and the device has unified memory,
+		/// then transient buffers are created over host arrays instead of copying them.
+		/// </summary>
+		void set_zero_copy_mode(bool enabled);
+		bool is_zero_copy_mode() const;
+
+		/// <summary>
+		/// Alignment of host arrays that back buffers without a copy, at least a page and the base address alignment of the device.
+		/// </summary>
+		size_t get_zero_copy_alignment() const;
+
+		static constexpr size_t zero_copy_page_size = 4096;
+		static constexpr size_t zero_copy_size_multiple = 64;
+
 	protected:
 		ecg_cl(int device_id = default_id);
 		
@@ -49,6 +81,14 @@ namespace ecg {
 		cl::Device find_best_device();
 		
 	private:
+		std::unordered_map<std::thread::id, std::shared_ptr<cl::CommandQueue>> m_thread_queues;
+		std::mutex m_thread_queues_lock;
+		std::atomic<bool> m_is_thread_safe = false;
+		std::atomic<bool> m_is_zero_copy = true;
+		std::atomic<bool> m_is_unified_memory = false;
+		std::atomic<size_t> m_zero_copy_alignment = zero_copy_page_size;
+
+		std::shared_ptr<ecg_buffer_pool> m_buffer_pool = std::make_shared<ecg_buffer_pool>();
 		cl::CommandQueue m_cmd_queue;
 		std::atomic<bool> m_is_initialized;
 		cl::Device m_main_device;
@@ -2,26 +2,189 @@
 #define ECG_INTERNAL_H
 #include <core/ecg_cl_version.h>
 #include <core/ecg_host_ctrl.h>
+#include <help/ecg_status.h>
+#include <help/ecg_geom.h>
 #include <ecg_global.h>
+#include <ecg_api.h>
 
 namespace ecg {
+	struct ecg_cl_adjacency_t;
+
 	struct ecg_cl_mesh_t {
-		cl::Buffer vertexes_buffer;
+		cl::Context context;
+
+		ecg_pooled_buffer vertexes_buffer;
 		size_t vertexes_buffer_size;
 		size_t vertexes_size;
 
-		cl::Buffer indexes_buffer;
+		ecg_pooled_buffer indexes_buffer;
 		size_t indexes_buffer_size;
 		size_t indexes_size;
 
 		bool is_valid = false;
 
+		// Built on first use and dropped when the geometry changes, see internal_get_adjacency
+		mutable std::shared_ptr<ecg_cl_adjacency_t> adjacency;
+		std::shared_ptr<std::mutex> adjacency_lock = std::make_shared<std::mutex>();
+
 		ecg_cl_mesh_t() :
-			vertexes_size(0), indexes_size(0), 
+			vertexes_size(0), indexes_size(0),
 			vertexes_buffer_size(0), indexes_buffer_size(0),
 			is_valid(false)
 		{ }
 	};
+
+	/// <summary>
+	/// Half-edges of a mesh sorted by the undirected key min * vertexes_cnt + max of their edge.
+	/// Half-edge face_id * 3 + corner goes from the vertex of the corner to the next one, equal edges are adjacent,
+	/// so the length of a run is the number of faces of the edge.
+	/// </summary>
+	struct ecg_cl_edges_t {
+		ecg_pooled_buffer keys_buffer;
+		ecg_pooled_buffer half_edges_buffer;
+		cl_uint half_edges_cnt = 0;
+		cl_uint vertexes_cnt = 0;
+	};
+
+	/// <summary>
+	/// Adjacency list in CSR form, the neighbours of item i are ids[offsets[i], offsets[i + 1]) in ascending order.
+	/// </summary>
+	struct ecg_cl_adjacency_list_t {
+		ecg_pooled_buffer offsets_buffer;
+		ecg_pooled_buffer ids_buffer;
+		cl_uint items_cnt = 0;
+		cl_uint ids_cnt = 0;
+	};
+
+	struct ecg_cl_adjacency_t {
+		ecg_cl_adjacency_list_t vertex_faces;
+		ecg_cl_adjacency_list_t face_faces;
+		ecg_cl_adjacency_list_t vertex_vertexes;
+	};
+
+	/// <summary>
+	/// Linear BVH over the faces of a mesh. Internal nodes are [0, leaves_cnt - 1), leaf i is the node leaves_cnt - 1 + i
+	/// and holds the face faces[i]. Boxes keep the min and max corners of every node as 6 floats.
+	/// </summary>
+	struct ecg_cl_bvh_t {
+		ecg_pooled_buffer faces_buffer;
+		ecg_pooled_buffer children_buffer;
+		ecg_pooled_buffer parents_buffer;
+		ecg_pooled_buffer last_leaves_buffer;
+		ecg_pooled_buffer boxes_buffer;
+		cl_uint leaves_cnt = 0;
+	};
+
+	/// <summary>
+	/// Device-side implementations of the public API.
+	/// They work on already uploaded geometry and report errors through op_res.
+	/// Commands are enqueued on the chain, functions returning host values wait for it, device buffers are returned without waiting.
+	/// </summary>
+	vec3_base internal_sum_vertexes(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res);
+	vec3_base internal_get_center(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res);
+	float internal_compute_surface_area(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res);
+
+	/// <summary>
+	/// Surface area of the faces [first_face, last_face) of the buffers, used for parts of a mesh on other devices.
+	/// </summary>
+	float internal_compute_surface_area(ecg_cmd_chain& chain, cl::Device& dev,
+		const cl::Buffer& vertexes_buffer, const cl::Buffer& indexes_buffer, cl_uint first_face, cl_uint last_face, ecg_status_handler& op_res);
+
+	/// <summary>
+	/// Surface areas of the face ranges [range_offsets[i], range_offsets[i + 1]) in one dispatch, used for meshes of a batch.
+	/// </summary>
+	std::vector<float> internal_compute_surface_areas(ecg_cmd_chain& chain, cl::Device& dev,
+		const cl::Buffer& vertexes_buffer, const cl::Buffer& indexes_buffer, const std::vector<cl_uint>& range_offsets, ecg_status_handler& op_res);
+	ecg_array_t internal_compute_faces_areas(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_array_t* areas_cdf, ecg_status_handler& op_res);
+
+	/// <summary>
+	/// Enqueue-only versions for calls that return to the host later, see ecg_async.h.
+	/// Results are in the host memory after the commands of the chain complete, host inputs must stay valid until then.
+	/// </summary>
+	void internal_enqueue_sum_vertexes(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, vec3_base* result, ecg_status_handler& op_res);
+	void internal_enqueue_surface_area(ecg_cmd_chain& chain, cl::Device& dev,
+		const cl::Buffer& vertexes_buffer, const cl::Buffer& indexes_buffer, cl_uint first_face, cl_uint last_face, float* result, ecg_status_handler& op_res);
+	void internal_enqueue_surface_areas(ecg_cmd_chain& chain, cl::Device& dev,
+		const cl::Buffer& vertexes_buffer, const cl::Buffer& indexes_buffer, const std::vector<cl_uint>& range_offsets, float* result, ecg_status_handler& op_res);
+	ecg_array_t internal_enqueue_faces_normals(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res);
+
+	mat3_base internal_compute_covariance_matrix(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res);
+	ecg_mesh_stats_t internal_compute_mesh_stats(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, bool with_faces, ecg_status_handler& op_res);
+
+	/// <summary>
+	/// Exclusive scan of the values in place, the total is written after them, so the buffer holds values_cnt + 1 items.
+	/// </summary>
+	void internal_scan_exclusive(ecg_cmd_chain& chain, const cl::Buffer& values_buffer, cl_uint values_cnt, ecg_status_handler& op_res);
+
+	/// <summary>
+	/// Stable radix sort of 64-bit keys with 32-bit values, only the lower key_bits bits of the keys are compared.
+	/// The sorted items are returned in the same buffers.
+	/// </summary>
+	void internal_sort_keys(ecg_cmd_chain& chain, ecg_pooled_buffer& keys_buffer, ecg_pooled_buffer& values_buffer, cl_uint items_cnt, size_t key_bits, ecg_status_handler& op_res);
+
+	/// <summary>
+	/// Sorts the ids of every list in place, the lists are given by lists_cnt + 1 offsets.
+	/// </summary>
+	void internal_sort_lists(ecg_cmd_chain& chain, const cl::Buffer& offsets_buffer, cl_uint lists_cnt, const cl::Buffer& ids_buffer, ecg_status_handler& op_res);
+	ecg_cl_edges_t internal_sort_edges(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res);
+
+	/// <summary>
+	/// Counts the edges of sorted half-edges. With valence_buffer the number of edges of every vertex is added to it.
+	/// </summary>
+	ecg_edge_stats_t internal_count_edges(ecg_cmd_chain& chain, const ecg_cl_edges_t& edges, const cl::Buffer* valence_buffer, ecg_status_handler& op_res);
+
+	/// <summary>
+	/// Edges with [min_faces_cnt, max_faces_cnt] faces as pairs of vertex ids, ordered by their keys.
+	/// </summary>
+	ecg_array_t internal_find_edges(ecg_cmd_chain& chain, const ecg_cl_edges_t& edges, cl_uint min_faces_cnt, cl_uint max_faces_cnt, ecg_status_handler& op_res);
+
+	/// <summary>
+	/// Adjacency of the mesh, built with the sorted edges and cached in the mesh, so uploaded meshes build it once.
+	/// </summary>
+	std::shared_ptr<ecg_cl_adjacency_t> internal_get_adjacency(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res);
+	bool internal_is_mesh_vertexes_manifold(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, const ecg_cl_edges_t& edges, ecg_status_handler& op_res);
+	bool internal_is_mesh_closed(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res);
+	bool internal_is_mesh_manifold(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res);
+	bool internal_is_mesh_self_intersected(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, self_intersection_method method, ecg_status_handler& op_res);
+
+	/// <summary>
+	/// Builds the BVH of a mesh with at least one face: faces are sorted by the Morton codes of their centroids,
+	/// every internal node is built independently and the boxes are merged from the leaves up.
+	/// </summary>
+	ecg_cl_bvh_t internal_build_bvh(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res);
+
+	/// <summary>
+	/// Pairs of crossing faces found with the BVH, returns their number. Without pairs the search stops
+	/// at the first crossing and returns 1, otherwise the pairs are sorted by face ids.
+	/// </summary>
+	cl_uint internal_find_self_intersections(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_array_t* pairs, ecg_status_handler& op_res);
+
+	/// <summary>
+	/// Faces of the tree whose boxes overlap every face of the mesh, returns their total number.
+	/// The lists are sorted by face ids and given by faces_cnt + 1 offsets.
+	/// </summary>
+	cl_uint internal_find_bvh_candidates(
+		ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, const ecg_cl_bvh_t& bvh,
+		ecg_pooled_buffer& offsets_buffer, ecg_pooled_buffer& candidates_buffer, ecg_status_handler& op_res
+	);
+	float internal_compute_volume(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res);
+	ecg_array_t internal_compute_faces_normals(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res);
+	ecg_array_t internal_compute_vertex_normals(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res);
+
+	ecg_array_t add_interior_intersection_points(const ecg_mesh_t* m1, const ecg_mesh_t* m2, const intersection_set_t* int_set, ecg_status* status);
+
+	namespace hulls {
+		/// <summary>
+		/// Boxes of the vertex ranges [range_offsets[i], range_offsets[i + 1]) of the buffer, all ranges are computed in the same dispatch.
+		/// Any context can be used, so parts of a mesh on several devices or meshes of a batch go through it as well.
+		/// </summary>
+		std::vector<bounding_box> internal_compute_aabbs(ecg_cmd_chain& chain, cl::Device& dev,
+			const cl::Buffer& vertexes_buffer, const std::vector<cl_uint>& range_offsets, ecg_status_handler& op_res);
+		void internal_enqueue_aabbs(ecg_cmd_chain& chain, cl::Device& dev,
+			const cl::Buffer& vertexes_buffer, const std::vector<cl_uint>& range_offsets, bounding_box* result, ecg_status_handler& op_res);
+		bounding_box internal_compute_aabb(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res);
+		full_bounding_box internal_compute_obb(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res);
+	}
 }
 
 #endif
\ No newline at end of file
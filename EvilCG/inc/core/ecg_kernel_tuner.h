@@ -0,0 +1,112 @@
+#ifndef ECG_KERNEL_TUNER_H
+#define ECG_KERNEL_TUNER_H
+#include <core/ecg_cl_version.h>
+#include <ecg_api_define.h>
+#include <ecg_global.h>
+
+namespace ecg {
+	/// <summary>
+	/// Local size chosen for one launch. Zero leaves the choice to the OpenCL implementation.
+	/// Sampled launches are timed, their event has to be passed to ecg_kernel_tuner::add_sample.
+	/// </summary>
+	struct ecg_tuned_launch_t {
+		std::string key;
+		size_t local_size = 0;
+		bool is_sample = false;
+	};
+
+	/// <summary>
+	/// Chooses local work sizes per kernel, device and size class of the work range.
+	/// The first launches of every key try the candidate sizes in turn and are timed with queue profiling,
+	/// once every candidate has enough samples the fastest one is used for all following launches.
+	/// Results can be stored in a profile file, so later runs start with tuned sizes.
+	/// Thread-Safe - Singleton.
+	/// </summary>
+	class ECG_API ecg_kernel_tuner {
+	public:
+		static ecg_kernel_tuner& get_instance();
+
+		/// <summary>
+		/// Returns the local size for a launch over items_cnt work items, the global range must be rounded up to it.
+		/// Power of two sizes are required by kernels with tree reductions over the work group,
+		/// kernels with local arrays of a fixed size limit the local size with max_local_size, zero doesn't limit it.
+		/// </summary>
+		ecg_tuned_launch_t get_launch(const cl::Device& device, const cl::Kernel& kernel, const std::string& kernel_name,
+			size_t items_cnt, bool pow2_only = false, size_t max_local_size = 0);
+
+		/// <summary>
+		/// Adds the time of a sampled launch, the event is read once it completes.
+		/// </summary>
+		void add_sample(const ecg_tuned_launch_t& launch, const cl::Event& event, size_t global_size);
+
+		/// <summary>
+		/// Returns the tuned local size, zero while the key is still being tuned.
+		/// </summary>
+		size_t get_tuned_local_size(const cl::Device& device, const std::string& kernel_name, size_t items_cnt);
+
+		void set_enabled(bool enabled);
+		bool is_enabled() const;
+
+		/// <summary>
+		/// Loads tuned sizes from the file and stores new results there, an empty path keeps them in memory only.
+		/// </summary>
+		void set_profile(const std::string& path);
+		std::string get_profile() const;
+
+		/// <summary>
+		/// Forgets all tuned sizes and samples, the profile file is kept.
+		/// </summary>
+		void reset();
+
+		/// <summary>
+		/// Kernels of the library that skip work items past their item count.
+		/// Only their global range may be rounded up, other kernels are launched as requested.
+		/// </summary>
+		static bool is_range_checked(const std::string& kernel_name);
+		static size_t get_size_class(size_t items_cnt);
+
+		static constexpr size_t samples_per_candidate = 3;
+
+	protected:
+		ecg_kernel_tuner() = default;
+		virtual ~ecg_kernel_tuner() = default;
+
+	private:
+		struct pending_sample_t {
+			size_t candidate_id;
+			size_t global_size;
+			cl::Event event;
+		};
+
+		struct entry_t {
+			std::vector<size_t> candidates;
+			std::vector<double> best_times;
+			std::vector<size_t> samples_cnt;
+			std::vector<pending_sample_t> pending;
+			size_t next_candidate = 0;
+			size_t local_size = 0;
+			bool is_tuned = false;
+		};
+
+		std::string get_key(const cl::Device& device, const std::string& kernel_name, size_t items_cnt);
+		static std::vector<size_t> get_candidates(const cl::Device& device, const cl::Kernel& kernel,
+			size_t items_cnt, bool pow2_only, size_t max_local_size);
+
+		void collect_samples(entry_t& entry);
+		bool try_finish(entry_t& entry);
+
+		void load_profile(const std::string& path);
+		std::string serialize_profile() const;
+		static void save_profile(const std::string& path, const std::string& data);
+
+		std::unordered_map<std::string, entry_t> m_entries;
+		std::unordered_map<cl_device_id, std::string> m_device_keys;
+		mutable std::mutex m_entries_lock;
+
+		std::string m_profile;
+		std::atomic<bool> m_is_enabled = true;
+
+	};
+}
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef ECG_MULTI_CL_H
+#define ECG_MULTI_CL_H
+#include <core/ecg_cl_version.h>
+#include <core/ecg_host_ctrl.h>
+#include <core/ecg_task_pool.h>
+#include <core/ecg_profiler.h>
+#include <help/ecg_status.h>
+#include <ecg_api_define.h>
+#include <ecg_global.h>
+
+namespace ecg {
+	/// <summary>
+	/// Device with its own context and queue.
+	/// Throughput is measured in work items per microsecond, 0 until the first measured run.
+	/// </summary>
+	struct ecg_device_ctx_t {
+		int id;
+		cl::Device device;
+		cl::Context context;
+		cl::CommandQueue queue;
+		double score;
+		double throughput;
+	};
+
+	/// <summary>
+	/// Part of a work range that is computed on one device.
+	/// </summary>
+	struct ecg_work_part_t {
+		size_t id;
+		std::shared_ptr<ecg_device_ctx_t> device;
+		size_t offset;
+		size_t size;
+	};
+
+	/// <summary>
+	/// Controller of all OpenCL devices for work splitting.
+	/// Embarrassingly parallel ranges are split between the devices proportionally to their measured throughput,
+	/// devices without measurements are weighted by compute units and clock frequency.
+	/// Thread-Safe - Singleton.
+	/// </summary>
+	class ECG_API ecg_multi_cl {
+	public:
+		virtual ~ecg_multi_cl();
+
+		static ecg_multi_cl& get_instance();
+
+		/// <summary>
+		/// Creates contexts and queues for the devices with the given ids from ecg_cl::get_available_devices,
+		/// all available devices are used when the list is empty.
+		/// </summary>
+		cl_int init(const std::vector<int>& device_ids = {});
+		void release() noexcept;
+		bool is_init() const;
+
+		std::vector<std::shared_ptr<ecg_device_ctx_t>> get_devices() const;
+
+		/// <summary>
+		/// Splits items_cnt items into consecutive parts, one per device.
+		/// Part sizes are multiples of the granularity except the last one, devices without work are skipped.
+		/// </summary>
+		std::vector<ecg_work_part_t> split(size_t items_cnt) const;
+
+		/// <summary>
+		/// Minimal number of items computed on one device.
+		/// Small ranges aren't split, the launch overhead of a device is higher than its work.
+		/// </summary>
+		void set_granularity(size_t granularity);
+		size_t get_granularity() const;
+
+		/// <summary>
+		/// Computes all parts in parallel on the compute pool, one task per device, and updates the throughput of the devices.
+		/// The parts only wait for their own devices, so they don't block other tasks of the pool.
+		/// Func is called as func(const ecg_work_part_t&, ecg_status_handler&), the first failed status is returned.
+		/// </summary>
+		template <typename Func>
+		ecg_status run(const std::vector<ecg_work_part_t>& parts, Func&& func) {
+			std::vector<ecg_status> results(parts.size(), ecg_status_code::SUCCESS);
+			std::vector<std::future<void>> tasks;
+			auto& pool = ecg_task_pool::get_compute_instance();
+			auto call = ecg_profiler::get_current_call();
+
+			for (size_t part_id = 0; part_id < parts.size(); ++part_id) {
+				tasks.push_back(pool.submit([this, &parts, &results, &func, call, part_id] {
+					ecg_profile_attach profile_attach(call);
+					const auto& part = parts[part_id];
+					auto start = std::chrono::steady_clock::now();
+					ecg_status_handler part_res;
+
+					try {
+						func(part, part_res);
+					}
+					catch (...) {
+						results[part_id] = part_res == ecg_status_code::SUCCESS ?
+							ecg_status_code::UNKNOWN_EXCEPTION : part_res.get_status();
+						return;
+					}
+
+					auto time = std::chrono::steady_clock::now() - start;
+					update_throughput(*part.device, part.size, std::chrono::duration<double, std::micro>(time).count());
+				}));
+			}
+
+			for (auto& task : tasks) task.wait();
+
+			for (ecg_status result : results)
+				if (result != ecg_status_code::SUCCESS) return result;
+			return ecg_status_code::SUCCESS;
+		}
+
+		static constexpr size_t default_granularity = 256;
+
+	protected:
+		ecg_multi_cl() = default;
+
+		void update_throughput(ecg_device_ctx_t& device, size_t items_cnt, double time_us);
+
+	private:
+		std::vector<std::shared_ptr<ecg_device_ctx_t>> m_devices;
+		size_t m_granularity = default_granularity;
+		mutable std::mutex m_devices_lock;
+
+	};
+}
+
+#endif
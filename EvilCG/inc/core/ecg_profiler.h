@@ -0,0 +1,156 @@
+#ifndef ECG_PROFILER_H
+#define ECG_PROFILER_H
+#include <core/ecg_cl_version.h>
+#include <help/ecg_geom.h>
+#include <ecg_api_define.h>
+#include <ecg_global.h>
+
+#include <deque>
+
+namespace ecg {
+	/// <summary>
+	/// Records API calls with their kernels, copies between host and device and host-side phases.
+	/// Device times come from the events of the profiling queues and are moved to the host clock
+	/// by the time the command was enqueued. Disabled by default, then every hook only checks a flag.
+	/// Thread-Safe - Singleton.
+	/// </summary>
+	class ECG_API ecg_profiler {
+	public:
+		struct device_event_t {
+			std::string name;
+			std::string category;
+			size_t bytes = 0;
+			uint64_t host_ns = 0;
+			cl::Event event;
+
+			bool has_times = false;
+			cl_ulong queued_ns = 0;
+			cl_ulong submit_ns = 0;
+			cl_ulong start_ns = 0;
+			cl_ulong end_ns = 0;
+		};
+
+		struct phase_t {
+			std::string name;
+			uint64_t thread_id = 0;
+			uint64_t start_ns = 0;
+			uint64_t end_ns = 0;
+		};
+
+		/// <summary>
+		/// One API call. Workers of the call append to it from their threads.
+		/// </summary>
+		struct call_t {
+			std::string name;
+			uint64_t thread_id = 0;
+			uint64_t start_ns = 0;
+			uint64_t end_ns = 0;
+			size_t host_to_device_bytes = 0;
+			size_t device_to_host_bytes = 0;
+			std::vector<device_event_t> device_events;
+			std::vector<phase_t> phases;
+			std::mutex lock;
+		};
+
+		static ecg_profiler& get_instance();
+
+		void set_enabled(bool enabled);
+		bool is_enabled() const;
+
+		/// <summary>
+		/// Forgets recorded calls and counters.
+		/// </summary>
+		void clear();
+
+		/// <summary>
+		/// Starts a call on the calling thread. Returns nullptr when profiling is disabled or a call is already running,
+		/// then nested calls are recorded as phases of the outer one.
+		/// </summary>
+		std::shared_ptr<call_t> begin_call(const std::string& name);
+		void end_call(const std::shared_ptr<call_t>& call);
+
+		static std::shared_ptr<call_t> get_current_call();
+		static void set_current_call(std::shared_ptr<call_t> call);
+		static bool is_recording();
+		static uint64_t get_thread_id();
+		static uint64_t now_ns();
+
+		static void add_phase(const std::string& name, uint64_t start_ns, uint64_t end_ns);
+		static void add_kernel(const std::string& name, const cl::Event& event, uint64_t host_ns);
+		static void add_transfer(bool to_device, size_t bytes, const cl::Event* event, uint64_t host_ns);
+
+		/// <summary>
+		/// Same as the methods of the queue, the copy is counted for the current call.
+		/// </summary>
+		static cl_int write_buffer(const cl::CommandQueue& queue, const cl::Buffer& buffer, cl_bool blocking,
+			size_t offset, size_t size, const void* ptr, const std::vector<cl::Event>* events = nullptr, cl::Event* event = nullptr);
+		static cl_int read_buffer(const cl::CommandQueue& queue, const cl::Buffer& buffer, cl_bool blocking,
+			size_t offset, size_t size, void* ptr, const std::vector<cl::Event>* events = nullptr, cl::Event* event = nullptr);
+
+		/// <summary>
+		/// Totals of calls with the name, all calls for an empty name.
+		/// </summary>
+		ecg_profiling_stats_t get_stats(const std::string& name = "") const;
+		void log_stats() const;
+
+		/// <summary>
+		/// Writes the recorded calls in the Chrome trace event format, readable by chrome://tracing and Perfetto.
+		/// </summary>
+		bool save_trace(const std::string& path) const;
+
+		/// <summary>
+		/// Number of calls kept for the trace, older calls are dropped but stay in the counters.
+		/// </summary>
+		static constexpr size_t max_calls = 1 << 16;
+
+	protected:
+		ecg_profiler() = default;
+		virtual ~ecg_profiler() = default;
+
+	private:
+		static void resolve_times(device_event_t& device_event);
+
+		std::deque<std::shared_ptr<call_t>> m_calls;
+		std::map<std::string, ecg_profiling_stats_t> m_totals;
+		mutable std::mutex m_calls_lock;
+		std::atomic<bool> m_is_enabled = false;
+
+	};
+
+	/// <summary>
+	/// Records the scope as an API call, or as a host phase when a call is already running on the thread.
+	/// </summary>
+	class ECG_API ecg_profile_scope {
+	public:
+		explicit ecg_profile_scope(const char* name);
+		~ecg_profile_scope();
+
+		ecg_profile_scope(const ecg_profile_scope& scope) = delete;
+		ecg_profile_scope& operator=(const ecg_profile_scope& scope) = delete;
+
+	private:
+		std::shared_ptr<ecg_profiler::call_t> m_call;
+		const char* m_name;
+		uint64_t m_start_ns = 0;
+		bool m_is_phase = false;
+
+	};
+
+	/// <summary>
+	/// Makes a call of another thread current on the calling thread, used by the workers of one API call.
+	/// </summary>
+	class ECG_API ecg_profile_attach {
+	public:
+		explicit ecg_profile_attach(std::shared_ptr<ecg_profiler::call_t> call);
+		~ecg_profile_attach();
+
+		ecg_profile_attach(const ecg_profile_attach& attach) = delete;
+		ecg_profile_attach& operator=(const ecg_profile_attach& attach) = delete;
+
+	private:
+		std::shared_ptr<ecg_profiler::call_t> m_previous;
+
+	};
+}
+
+#endif
@@ -1,6 +1,9 @@
 #ifndef ECG_PROGRAM_H
 #define ECG_PROGRAM_H
+#include <core/ecg_kernel_tuner.h>
 #include <core/ecg_cl_version.h>
+#include <core/ecg_cmd_chain.h>
+#include <core/ecg_profiler.h>
 #include <ecg_api_define.h>
 #include <ecg_global.h>
 
@@ -16,7 +19,80 @@ namespace ecg {
 		std::is_same_v<T, cl_float4> || std::is_same_v<T, cl_float8> ||
 		std::is_same_v<T, cl_half> || std::is_same_v<T, cl_mem> ||
 		std::is_same_v<T, cl_sampler> || std::is_same_v<T, cl_event> ||
-		std::is_same_v<T, cl::Buffer> || std::is_same_v<T, std::nullptr_t>;
+		std::is_base_of_v<cl::Buffer, T> || std::is_same_v<T, std::nullptr_t>;
+
+	/// <summary>
+	/// Kernel object with cached argument slots.
+	/// Values are passed to OpenCL only when they differ from the last call. Buffers are always passed,
+	/// a handle of a released buffer can be reused by a new one.
+	/// Not thread-safe, ecg_program_wrapper leases one instance to one caller at a time.
+	/// </summary>
+	class ECG_API ecg_bound_kernel {
+	public:
+		virtual ~ecg_bound_kernel() = default;
+		ecg_bound_kernel(const ecg_bound_kernel& kernel) = delete;
+		ecg_bound_kernel(const cl::Program& program, const std::string& kernel_name, cl_int* err = nullptr);
+
+		template <typename Type>
+		cl_int set_arg(cl_uint index, const Type& arg) {
+			using ArgType = std::decay_t<Type>;
+			static_assert(is_opencl_type<ArgType>,
+				"Unsupported argument type: must be an OpenCL type or nullptr");
+
+			if (index >= m_args.size()) m_args.resize(index + 1);
+			auto& slot = m_args[index];
+
+			// Pooled buffers are passed as plain buffers, the kernel only needs the handle
+			if constexpr (std::is_base_of_v<cl::Buffer, ArgType> || std::is_same_v<ArgType, std::nullptr_t>) {
+				slot.is_set = false;
+				if constexpr (std::is_same_v<ArgType, std::nullptr_t>) return m_kernel.setArg(index, arg);
+				else return m_kernel.setArg(index, static_cast<const cl::Buffer&>(arg));
+			}
+			else {
+				std::vector<uint8_t> value(sizeof(ArgType));
+				std::memcpy(value.data(), &arg, sizeof(ArgType));
+				if (slot.is_set && slot.value == value) return CL_SUCCESS;
+
+				cl_int result = m_kernel.setArg(index, arg);
+				slot.is_set = (result == CL_SUCCESS);
+				slot.value = std::move(value);
+				return result;
+			}
+		}
+
+		template <typename... Args>
+		cl_int set_args(const Args&... args) {
+			cl_int result = CL_SUCCESS;
+			cl_uint arg_index = 0;
+
+			auto set_arg_with_check = [&](auto& arg) {
+				cl_int arg_result = set_arg(arg_index++, arg);
+				if (result == CL_SUCCESS) result = arg_result;
+			};
+
+			(set_arg_with_check(args), ...);
+			return result;
+		}
+
+		/// <summary>
+		/// Enqueues the kernel after the commands of the chain, the next commands of the chain wait for it.
+		/// </summary>
+		cl_int enqueue(ecg_cmd_chain& chain, const cl::NDRange& global_range, const cl::NDRange& local_range,
+			const cl::NDRange& offset_range = cl::NullRange, cl::Event* event = nullptr);
+
+		cl::Kernel& get_kernel();
+
+	private:
+		struct arg_slot_t {
+			bool is_set = false;
+			std::vector<uint8_t> value;
+		};
+
+		std::vector<arg_slot_t> m_args;
+		cl::Kernel m_kernel;
+		std::string m_name;
+
+	};
 
 	/// <summary>
 	/// Program wrapper for easy work with OpenCL program.
@@ -32,38 +108,86 @@ namespace ecg {
 			cl::Program::Sources& sources, std::string name
 		);
 
+		/// <summary>
+		/// Sets the directory for compiled program binaries, an empty path disables the disk cache.
+		/// Binaries are keyed by device, driver version, build options and sources.
+		/// </summary>
+		static void set_cache_dir(const std::string& path);
+		static std::string get_cache_dir();
+
 		const bool is_program_was_built() const;
+		const bool is_program_loaded_from_cache() const;
 		cl::Program get_program() const;
 
+		/// <summary>
+		/// Leases a free kernel, it returns to the program when the pointer is released.
+		/// Kernels are created on demand, so there are as many of them as callers using the kernel at once.
+		/// </summary>
+		std::shared_ptr<ecg_bound_kernel> get_kernel(const std::string& kernel_name);
+
+		/// <summary>
+		/// Sets changed arguments and enqueues the kernel after the commands of the chain without waiting for it.
+		/// Later commands of the chain see its results, the host has to wait with chain.wait().
+		/// Range-checked kernels launched with cl::NullRange get the local size of ecg_kernel_tuner.
+		/// </summary>
 		template <typename... Args>
-		cl_int execute(cl::CommandQueue& queue, const std::string& kernel_name,
+		cl_int execute(ecg_cmd_chain& chain, const std::string& kernel_name,
 			cl::NDRange& global_range, cl::NDRange& local_range,
 			const Args&... args
+		) {
+			return execute_range(chain, kernel_name, cl::NullRange, global_range, local_range, args...);
+		}
+
+		/// <summary>
+		/// Same as execute, but global ids start at offset_range.
+		/// Used to compute a part of the work range, for example on one of several devices.
+		/// </summary>
+		template <typename... Args>
+		cl_int execute_range(ecg_cmd_chain& chain, const std::string& kernel_name,
+			const cl::NDRange& offset_range, cl::NDRange& global_range, cl::NDRange& local_range,
+			const Args&... args
 		) {
 			if (!m_is_built) return CL_BUILD_PROGRAM_FAILURE;
 
-			cl_int result = CL_SUCCESS;
-			cl::Kernel kernel(m_program, kernel_name.c_str(), &result);
+			auto kernel = get_kernel(kernel_name);
+			if (kernel == nullptr) return CL_INVALID_KERNEL_NAME;
 
-			int arg_index = 0;
-			auto set_arg_with_check = [&](auto& arg) {
-				using ArgType = std::decay_t<decltype(arg)>;
-				static_assert(is_opencl_type<ArgType>,
-					"Unsupported argument type: must be an OpenCL type or nullptr");
-				return kernel.setArg(arg_index++, arg);
-			};
+			cl_int result = kernel->set_args(args...);
+			if (result != CL_SUCCESS) return result;
 
-			(set_arg_with_check(args), ...);
+			// Ranges split between devices start at an offset, rounding them up would overlap the next part
+			if (local_range.dimensions() == 0 && offset_range.dimensions() == 0 && global_range.dimensions() == 1 &&
+				ecg_kernel_tuner::is_range_checked(kernel_name)) {
+				return enqueue_tuned(chain, *kernel, kernel_name, global_range.get()[0]);
+			}
 
-			result = queue.enqueueNDRangeKernel(kernel, cl::NullRange, global_range, local_range);
-			queue.finish();
-			return result;
+			return kernel->enqueue(chain, global_range, local_range, offset_range);
 		}
 
 	private:
+		cl_int enqueue_tuned(ecg_cmd_chain& chain, ecg_bound_kernel& kernel, const std::string& kernel_name, size_t items_cnt);
+
+		static std::string get_cache_key(cl::Device& device, const std::string& options, cl::Program::Sources& sources);
+		bool load_binary(cl::Context& context, const std::filesystem::path& path);
+		void save_binary(const std::filesystem::path& path);
+
+		static std::string m_cache_dir;
+		static std::mutex m_cache_dir_lock;
+
+		/// <summary>
+		/// Kernels that aren't leased, shared with the leases so they can return after the program is gone.
+		/// </summary>
+		struct free_kernels_t {
+			std::unordered_map<std::string, std::vector<std::unique_ptr<ecg_bound_kernel>>> kernels;
+			std::mutex lock;
+		};
+
+		std::shared_ptr<free_kernels_t> m_free_kernels = std::make_shared<free_kernels_t>();
+
 		cl::Program m_program;
 		cl::Device m_device;
 		bool m_is_built;
+		bool m_is_from_cache;
 
 	};
 }
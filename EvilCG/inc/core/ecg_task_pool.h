@@ -0,0 +1,64 @@
+#ifndef ECG_TASK_POOL_H
+#define ECG_TASK_POOL_H
+#include <ecg_global.h>
+
+#include <functional>
+#include <future>
+
+namespace ecg {
+	/// <summary>
+	/// Fixed pool of host threads for background API calls.
+	/// The set of threads is bounded, so per-thread command queues of ecg_cl don't grow with the number of calls.
+	/// Thread-Safe - Singleton.
+	/// </summary>
+	class ecg_task_pool {
+	public:
+		static ecg_task_pool& get_instance() {
+			static ecg_task_pool instance;
+			return instance;
+		}
+
+		/// <summary>
+		/// Pool for data-parallel host work of the CPU backend.
+		/// It is separate from the pool of background calls, so a background call can wait for its chunks.
+		/// </summary>
+		static ecg_task_pool& get_compute_instance() {
+			static ecg_task_pool instance;
+			return instance;
+		}
+
+		template <typename Func>
+		auto submit(Func&& func) -> std::future<std::invoke_result_t<Func>> {
+			using result_t = std::invoke_result_t<Func>;
+			auto task = std::make_shared<std::packaged_task<result_t()>>(std::forward<Func>(func));
+			auto result = task->get_future();
+
+			{
+				std::scoped_lock lock(m_tasks_lock);
+				m_tasks.emplace_back([task] { (*task)(); });
+			}
+
+			m_tasks_cv.notify_one();
+			return result;
+		}
+
+		size_t get_threads_count() const;
+
+	protected:
+		virtual ~ecg_task_pool();
+		ecg_task_pool();
+
+		void worker_loop();
+
+	private:
+		std::list<std::function<void()>> m_tasks;
+		std::condition_variable m_tasks_cv;
+		std::mutex m_tasks_lock;
+
+		std::vector<std::thread> m_workers;
+		bool m_is_stopped;
+
+	};
+}
+
+#endif
@@ -30,7 +30,7 @@ namespace ecg {
 	/// </summary>
 	enum self_intersection_method {
 		SI_BRUTEFORCE,
-		/*BHV_ALGORITHM,*/
+		SI_BVH,
 		SI_METHODS_COUNT
 	};
 
@@ -43,6 +43,16 @@ namespace ecg {
 		SM_METHODS_COUNT,
 	};
 
+	/// <summary>
+	/// Culling of the vertexes inside the polytope of the extreme points before a convex hull is built.
+	/// </summary>
+	enum hull_prefilter_method {
+		HP_NONE,
+		HP_KDOP_6,
+		HP_KDOP_26,
+		HP_METHODS_COUNT
+	};
+
 	/// <summary>
 	/// Type of file.
 	/// </summary>
@@ -52,6 +62,15 @@ namespace ecg {
 		ECG_UNKNOWN_TYPE,
 	};
 
+	/// <summary>
+	/// Implementation used by the API functions.
+	/// </summary>
+	enum ecg_backend {
+		ECG_BACKEND_AUTO,
+		ECG_BACKEND_OPENCL,
+		ECG_BACKEND_CPU,
+	};
+
 #if defined(ECG_USE_SPDLOG) && __cplusplus
 	/// <summary>
 	/// Init logger for more information
@@ -66,11 +85,169 @@ namespace ecg {
 	/// <returns></returns>
 	ECG_API void cleanup(uint64_t handler);
 
+	/// <summary>
+	/// Releases all arrays of the adjacency.
+	/// </summary>
+	ECG_API void cleanup(const ecg_adjacency_t& adjacency);
+
 	/// <summary>
 	/// Cleanup all memory that was allocated in library.
 	/// </summary>
 	/// <returns></returns>
 	ECG_API void cleanup_all();
+
+	/// <summary>
+	/// Sets the directory where compiled OpenCL programs are stored between runs.
+	/// Programs found there are loaded instead of compiled, an empty path or nullptr disables the cache.
+	/// </summary>
+	/// <param name="path">Directory for program binaries, it is created on first write.</param>
+	/// <returns></returns>
+	ECG_API void set_program_cache_dir(const char* path);
+
+	/// <summary>
+	/// Builds all programs used by the library, so the first calls of the API don't pay the compile cost.
+	/// With a program cache directory the built binaries are also written to disk.
+	/// </summary>
+	/// <param name="status">Optional pointer to an ecg_status variable that will hold the status of the function execution.</param>
+	/// <returns></returns>
+	ECG_API void prewarm_all_programs(ecg_status* status = nullptr);
+
+	/// <summary>
+	/// Enables automatic choice of the local work size for kernels launched without one. Enabled by default.
+	/// The first launches of a kernel time every candidate size for the size class of the work range,
+	/// then the fastest size is used. Needs a command queue with profiling, which the controller creates.
+	/// </summary>
+	/// <param name="enabled">True to tune local work sizes, false to leave them to the OpenCL implementation.</param>
+	/// <returns></returns>
+	ECG_API void set_autotuning(bool enabled);
+	ECG_API bool is_autotuning();
+
+	/// <summary>
+	/// Sets the file with tuned local work sizes. Sizes found there are used without timing and new results are added to it.
+	/// Entries are keyed by device and driver version, so one file can be shared by several machines.
+	/// </summary>
+	/// <param name="path">Path of the profile file, an empty path or nullptr keeps the results in memory only.</param>
+	/// <returns></returns>
+	ECG_API void set_tuning_profile(const char* path);
+
+	/// <summary>
+	/// Enables recording of API calls with their kernels, copies between host and device and host phases. Disabled by default.
+	/// Kernel and copy times are read from the events of the command queues, so recorded calls wait for their commands.
+	/// </summary>
+	/// <param name="enabled">True to record calls, false to stop recording. Recorded data is kept.</param>
+	/// <returns></returns>
+	ECG_API void set_profiling(bool enabled);
+	ECG_API bool is_profiling();
+
+	/// <summary>
+	/// Forgets all recorded calls and counters.
+	/// </summary>
+	/// <returns></returns>
+	ECG_API void clear_profiling();
+
+	/// <summary>
+	/// Returns the totals of recorded calls.
+	/// </summary>
+	/// <param name="call_name">Name of the API call, for example "compute_aabb". nullptr returns the totals of all calls.</param>
+	/// <returns>Number of calls, kernels and copies with their times and copied bytes.</returns>
+	ECG_API ecg_profiling_stats_t get_profiling_stats(const char* call_name = nullptr);
+
+	/// <summary>
+	/// Writes the totals of recorded calls to the logger, one line per call name.
+	/// </summary>
+	/// <returns></returns>
+	ECG_API void log_profiling_stats();
+
+	/// <summary>
+	/// Writes recorded calls in the Chrome trace event format, the file can be opened in chrome://tracing or Perfetto.
+	/// Host calls and phases are shown per thread, kernels and copies on a separate device track.
+	/// </summary>
+	/// <param name="filename">Path of the JSON file.</param>
+	/// <param name="status">Optional pointer to an ecg_status variable that will hold the status of the function execution.</param>
+	/// <returns></returns>
+	ECG_API void save_profiling_trace(const char* filename, ecg_status* status = nullptr);
+
+	/// <summary>
+	/// Enables calling the API from several threads at once.
+	/// Every calling thread gets its own command queue in the shared context, so threads don't wait for the work of each other.
+	/// Programs and memory handles are shared between threads. The controller must not be initialized or released
+	/// while other threads use the API.
+	/// </summary>
+	/// <param name="enabled">True to use a command queue per thread, false to use one queue for all threads.</param>
+	/// <returns></returns>
+	ECG_API void set_thread_safe_mode(bool enabled);
+	ECG_API bool is_thread_safe_mode();
+
+	/// <summary>
+	/// Enables zero-copy on CPU devices and devices with memory shared with the host.
+	/// Device buffers are then created over the arrays of the mesh and results are mapped instead of copied,
+	/// so the arrays must not be changed by other threads during a call. Enabled by default.
+	/// </summary>
+	/// <param name="enabled">True to use host arrays directly when the device allows it.</param>
+	/// <returns></returns>
+	ECG_API void set_zero_copy_mode(bool enabled);
+
+	/// <summary>
+	/// Returns true when zero-copy is enabled and supported by the current device.
+	/// </summary>
+	/// <returns></returns>
+	ECG_API bool is_zero_copy_mode();
+
+	/// <summary>
+	/// Selects the implementation of the API functions. The CPU backend computes on all host threads without OpenCL,
+	/// AUTO uses it while the OpenCL controller isn't initialized. Functions for uploaded meshes and the multi namespace
+	/// always use OpenCL. Defaults to AUTO.
+	/// </summary>
+	/// <param name="backend">Backend for the following calls.</param>
+	/// <returns></returns>
+	ECG_API void set_backend(ecg_backend backend);
+	ECG_API ecg_backend get_backend();
+
+	/// <summary>
+	/// Returns the backend used by the next call, AUTO is resolved to OpenCL or CPU.
+	/// </summary>
+	/// <returns></returns>
+	ECG_API ecg_backend get_active_backend();
+
+	/// <summary>
+	/// Sets the maximum size of free device buffers kept for reuse by the API functions.
+	/// Free buffers above the limit are released, the least recently used first. Zero disables pooling.
+	/// </summary>
+	/// <param name="max_bytes">Maximum size of the free buffers in bytes.</param>
+	/// <returns></returns>
+	ECG_API void set_buffer_pool_limit(size_t max_bytes);
+
+	/// <summary>
+	/// Releases free pooled device buffers until at most max_bytes of them are left.
+	/// </summary>
+	/// <param name="max_bytes">Size of the free buffers in bytes that may stay in the pool.</param>
+	/// <returns></returns>
+	ECG_API void trim_buffer_pool(size_t max_bytes = 0);
+
+	/// <summary>
+	/// Returns hit/miss counters and the current size of the pool of device buffers.
+	/// </summary>
+	/// <returns>Statistics of the buffer pool.</returns>
+	ECG_API ecg_buffer_pool_stats_t get_buffer_pool_stats();
+
+	/// <summary>
+	/// Uploads the mesh geometry to the device once, so it can be reused by the overloads that take ecg_uploaded_mesh_t.
+	/// The geometry stays on the device until cleanup is called with the handler of the result.
+	/// </summary>
+	/// <param name="mesh">Pointer to the triangulated mesh that will be copied to the device.</param>
+	/// <param name="status">Optional pointer to an ecg_status variable that will hold the status of the function execution.</param>
+	/// <returns>Handle of the uploaded mesh. On failure the handler is 0.</returns>
+	ECG_API ecg_uploaded_mesh_t upload_mesh(const ecg_mesh_t* mesh, ecg_status* status = nullptr);
+
+	/// <summary>
+	/// Replaces the geometry of an uploaded mesh. Device buffers are rewritten in place when the sizes 
+	/// are unchanged and reallocated otherwise, the handler stays the same.
+	/// </summary>
+	/// <param name="uploaded_mesh">Handle returned by upload_mesh. Its sizes are updated on success.</param>
+	/// <param name="mesh">Pointer to the triangulated mesh with the new geometry.</param>
+	/// <param name="status">Optional pointer to an ecg_status variable that will hold the status of the function execution.</param>
+	/// <returns></returns>
+	ECG_API void update_uploaded_mesh(ecg_uploaded_mesh_t* uploaded_mesh, const ecg_mesh_t* mesh, ecg_status* status = nullptr);
 	
 	/// <summary>
 	/// Computes the sum of all vertex positions in the specified mesh.
@@ -83,6 +260,7 @@ namespace ecg {
 	/// The status will indicate success or describe any errors encountered during computation.</param>
 	/// <returns>A vec3_base vector that contains the summed vertex positions of the mesh.</returns>
 	ECG_API vec3_base sum_vertexes(const ecg_mesh_t* mesh, ecg_status* status = nullptr);
+	ECG_API vec3_base sum_vertexes(const ecg_uploaded_mesh_t& mesh, ecg_status* status = nullptr);
 
 	/// <summary>
 	/// Calculates the geometric center (centroid) of a 3D mesh. 
@@ -95,6 +273,7 @@ namespace ecg {
 	/// <returns>A vec3_base vector representing the calculated center point of the mesh.
 	/// If the mesh has no vertices, returns a vec3_base initialized to zero or another appropriate default.</returns>
 	ECG_API vec3_base get_center(const ecg_mesh_t* mesh, ecg_status* status = nullptr);
+	ECG_API vec3_base get_center(const ecg_uploaded_mesh_t& mesh, ecg_status* status = nullptr);
 	
 	/// <summary>
 	/// Computes the total surface area of a 3D mesh. The surface area is calculated by iterating over each triangle in the mesh
@@ -107,6 +286,19 @@ namespace ecg {
 	/// The computed surface area as a `float` value. If the mesh is invalid or an error occurs, the function returns `-FLT_MAX`.
 	/// </returns>
 	ECG_API float compute_surface_area(const ecg_mesh_t* mesh, ecg_status* status = nullptr);
+	ECG_API float compute_surface_area(const ecg_uploaded_mesh_t& mesh, ecg_status* status = nullptr);
+	
+	/// <summary>
+	/// Computes the area of every face, the total is summed by fixed trees, so compute_surface_area gives the same bits on repeated runs.
+	/// With areas_cdf the inclusive prefix sum of the areas is returned as well. Its last value is the surface area,
+	/// so faces can be sampled proportionally to their area by a binary search of a uniform value in [0, last value).
+	/// </summary>
+	/// <param name="mesh">Pointer to the mesh data structure containing vertex and index arrays that define the mesh geometry.</param>
+	/// <param name="areas_cdf">Optional pointer to an array that receives the prefix sum of the areas, released with cleanup.</param>
+	/// <param name="status">Optional pointer to an ecg_status variable that will hold the status of the function execution.</param>
+	/// <returns>Array of floats, one area per face. Released with cleanup.</returns>
+	ECG_API ecg_array_t compute_faces_areas(const ecg_mesh_t* mesh, ecg_array_t* areas_cdf = nullptr, ecg_status* status = nullptr);
+	ECG_API ecg_array_t compute_faces_areas(const ecg_uploaded_mesh_t& mesh, ecg_array_t* areas_cdf = nullptr, ecg_status* status = nullptr);
 	
 	/// <summary>
 	/// A function for comparing two meshes with transformations
@@ -140,6 +332,17 @@ namespace ecg {
 	/// covariance between different axes.
 	/// </returns>
 	ECG_API mat3_base compute_covariance_matrix(const ecg_mesh_t* mesh, ecg_status* status = nullptr);
+	ECG_API mat3_base compute_covariance_matrix(const ecg_uploaded_mesh_t& mesh, ecg_status* status = nullptr);
+
+	/// <summary>
+	/// Computes the vertex sum, center, AABB, covariance matrix, surface area, signed volume and face counts of the mesh
+	/// in a single sweep over its vertexes and faces. It is cheaper than calling the separate functions one after another.
+	/// </summary>
+	/// <param name="mesh">Pointer to the mesh.</param>
+	/// <param name="status">Optional pointer to an ecg_status variable that will hold the status of the function execution.</param>
+	/// <returns>Statistics of the mesh, see ecg_mesh_stats_t.</returns>
+	ECG_API ecg_mesh_stats_t compute_mesh_stats(const ecg_mesh_t* mesh, ecg_status* status = nullptr);
+	ECG_API ecg_mesh_stats_t compute_mesh_stats(const ecg_uploaded_mesh_t& mesh, ecg_status* status = nullptr);
 	
 	/// <summary>
 	/// 
@@ -155,6 +358,7 @@ namespace ecg {
 	/// </param>
 	/// <returns></returns>
 	ECG_API bool is_mesh_closed(const ecg_mesh_t* mesh, ecg_status* status = nullptr);
+	ECG_API bool is_mesh_closed(const ecg_uploaded_mesh_t& mesh, ecg_status* status = nullptr);
 	
 	/// <summary>
 	/// Checks that each edge of the mesh belongs to only two polygons, and that all vertexes are manifold.
@@ -163,14 +367,75 @@ namespace ecg {
 	/// <param name="status"></param>
 	/// <returns></returns>
 	ECG_API bool is_mesh_manifold(const ecg_mesh_t* mesh, ecg_status* status = nullptr);
+	ECG_API bool is_mesh_manifold(const ecg_uploaded_mesh_t& mesh, ecg_status* status = nullptr);
+
+	/// <summary>
+	/// Counts the undirected edges of the mesh, its boundary edges and edges shared by more than two faces.
+	/// Edges are found by sorting the edge keys of all faces, so the cost grows as E log E.
+	/// </summary>
+	/// <param name="mesh">Pointer to the mesh.</param>
+	/// <param name="status">Optional pointer to an ecg_status variable that will hold the status of the function execution.</param>
+	/// <returns>Edge counts of the mesh, see ecg_edge_stats_t.</returns>
+	ECG_API ecg_edge_stats_t compute_edge_stats(const ecg_mesh_t* mesh, ecg_status* status = nullptr);
+	ECG_API ecg_edge_stats_t compute_edge_stats(const ecg_uploaded_mesh_t& mesh, ecg_status* status = nullptr);
+
+	/// <summary>
+	/// Finds edges that belong to only one face.
+	/// </summary>
+	/// <param name="mesh">Pointer to the mesh.</param>
+	/// <param name="status">Optional pointer to an ecg_status variable that will hold the status of the function execution.</param>
+	/// <returns>Array of uint32_t, two vertex ids per edge with the smaller id first, ordered by the ids. Released with cleanup.</returns>
+	ECG_API ecg_array_t find_boundary_edges(const ecg_mesh_t* mesh, ecg_status* status = nullptr);
+	ECG_API ecg_array_t find_boundary_edges(const ecg_uploaded_mesh_t& mesh, ecg_status* status = nullptr);
+
+	/// <summary>
+	/// Finds edges shared by more than two faces, same layout as find_boundary_edges.
+	/// </summary>
+	/// <param name="mesh">Pointer to the mesh.</param>
+	/// <param name="status">Optional pointer to an ecg_status variable that will hold the status of the function execution.</param>
+	/// <returns>Array of uint32_t, two vertex ids per edge. Released with cleanup.</returns>
+	ECG_API ecg_array_t find_non_manifold_edges(const ecg_mesh_t* mesh, ecg_status* status = nullptr);
+	ECG_API ecg_array_t find_non_manifold_edges(const ecg_uploaded_mesh_t& mesh, ecg_status* status = nullptr);
+
+	/// <summary>
+	/// Computes the number of edges of every vertex, which is the number of its distinct neighbours.
+	/// </summary>
+	/// <param name="mesh">Pointer to the mesh.</param>
+	/// <param name="status">Optional pointer to an ecg_status variable that will hold the status of the function execution.</param>
+	/// <returns>Array of uint32_t, one value per vertex. Released with cleanup.</returns>
+	ECG_API ecg_array_t compute_vertexes_valence(const ecg_mesh_t* mesh, ecg_status* status = nullptr);
+	ECG_API ecg_array_t compute_vertexes_valence(const ecg_uploaded_mesh_t& mesh, ecg_status* status = nullptr);
+
+	/// <summary>
+	/// Builds the vertex to face, face to face and vertex to vertex adjacency of the mesh in linear time.
+	/// The adjacency of an uploaded mesh is kept on the device until the mesh is updated or released,
+	/// so functions that walk the neighbours of vertexes or faces don't build it again.
+	/// </summary>
+	/// <param name="mesh">Pointer to the mesh.</param>
+	/// <param name="status">Optional pointer to an ecg_status variable that will hold the status of the function execution.</param>
+	/// <returns>Adjacency lists of the mesh, see ecg_adjacency_t. Released with cleanup.</returns>
+	ECG_API ecg_adjacency_t build_adjacency(const ecg_mesh_t* mesh, ecg_status* status = nullptr);
+	ECG_API ecg_adjacency_t build_adjacency(const ecg_uploaded_mesh_t& mesh, ecg_status* status = nullptr);
 	
 	/// <summary>
 	/// Checks that the mesh contains a self-intersection.
+	/// SI_BRUTEFORCE tests every pair of faces. SI_BVH builds a linear BVH over the face boxes and tests only faces
+	/// with overlapping boxes, edges are checked as segments and faces touching at a vertex or an edge don't intersect.
 	/// </summary>
 	/// <param name="mesh"></param>
 	/// <param name="status"></param>
 	/// <returns></returns>
 	ECG_API bool is_mesh_self_intersected(const ecg_mesh_t* mesh, self_intersection_method method, ecg_status* status = nullptr);
+	ECG_API bool is_mesh_self_intersected(const ecg_uploaded_mesh_t& mesh, self_intersection_method method, ecg_status* status = nullptr);
+
+	/// <summary>
+	/// Finds all pairs of crossing faces of the mesh with the BVH, see SI_BVH.
+	/// </summary>
+	/// <param name="mesh">Pointer to the triangulated mesh.</param>
+	/// <param name="status">Optional pointer to an ecg_status variable that will hold the status of the function execution.</param>
+	/// <returns>Pairs of face ids with the smaller id first, sorted in ascending order. Empty without intersections.</returns>
+	ECG_API ecg_array_t find_self_intersections(const ecg_mesh_t* mesh, ecg_status* status = nullptr);
+	ECG_API ecg_array_t find_self_intersections(const ecg_uploaded_mesh_t& mesh, ecg_status* status = nullptr);
 	
 	/// <summary>
 	/// Convert non-triangulated mesh into triangulated.
@@ -188,6 +453,7 @@ namespace ecg {
 	/// <param name="status"></param>
 	/// <returns></returns>
 	ECG_API float compute_volume(const ecg_mesh_t* mesh, ecg_status* status = nullptr);
+	ECG_API float compute_volume(const ecg_uploaded_mesh_t& mesh, ecg_status* status = nullptr);
 	
 	/// <summary>
 	/// Calculates all the normals of the faces.
@@ -196,6 +462,7 @@ namespace ecg {
 	/// <param name="status"></param>
 	/// <returns></returns>
 	ECG_API ecg_array_t compute_faces_normals(const ecg_mesh_t* mesh, ecg_status* status = nullptr);
+	ECG_API ecg_array_t compute_faces_normals(const ecg_uploaded_mesh_t& mesh, ecg_status* status = nullptr);
 
 	/// <summary>
 	/// Calculates all the normals of the vectors.
@@ -204,14 +471,32 @@ namespace ecg {
 	/// <param name="status"></param>
 	/// <returns></returns>
 	ECG_API ecg_array_t compute_vertex_normals(const ecg_mesh_t* mesh, ecg_status* status = nullptr);
+	ECG_API ecg_array_t compute_vertex_normals(const ecg_uploaded_mesh_t& mesh, ecg_status* status = nullptr);
 	
 	/// <summary>
 	/// A method of creating a LOD (level-of-detail) from a mesh using various algorithms.
+	/// SM_QEM collapses edges by their quadric error on the host threads, open borders and edges with more
+	/// than two faces are kept in place and collapses that flip faces or break the manifold are skipped.
+	/// SM_CENTER_POINT merges the vertexes of every cell of a grid into their average and drops the faces
+	/// with two corners in one cell. It is a fast preview, the target number of faces is only approximated.
 	/// </summary>
 	/// <param name="mesh"></param>
+	/// <param name="params">Target number of faces and maximal error of a collapse.</param>
 	/// <param name="status"></param>
-	/// <returns></returns>
-	//ECG_API ecg_internal_mesh simplify_mesh(const ecg_mesh_t* mesh, simplify_method method, ecg_status* status = nullptr);
+	/// <returns>New mesh without the collapsed vertexes.</returns>
+	ECG_API ecg_internal_mesh_t simplify_mesh(const ecg_mesh_t* mesh, simplify_method method, const ecg_simplify_params_t& params, ecg_status* status = nullptr);
+
+	/// <summary>
+	/// Builds levels of detail with SM_QEM in one pass. Every level keeps the given part of the faces of the mesh
+	/// and continues the collapses of the previous level with the same quadrics, so the levels are nested.
+	/// All arrays of the result are released with cleanup.
+	/// </summary>
+	/// <param name="mesh"></param>
+	/// <param name="ratios">Parts of the faces kept by the levels, in (0, 1] and non-increasing.</param>
+	/// <param name="ratios_count">Number of levels.</param>
+	/// <param name="status"></param>
+	/// <returns>Levels packed into one allocation with their offsets.</returns>
+	ECG_API ecg_lod_chain_t generate_lod_chain(const ecg_mesh_t* mesh, const float* ratios, size_t ratios_count, ecg_status* status = nullptr);
 
 	/// <summary>
 	/// Save ecg mesh to file.
@@ -236,6 +521,7 @@ namespace ecg {
 	/// <param name="status"></param>
 	/// <returns></returns>
 	ECG_API ecg_internal_mesh_t compute_intersection(const ecg_mesh_t* m1, const ecg_mesh_t* m2, ecg_status* status = nullptr);
+	ECG_API ecg_internal_mesh_t compute_intersection(const ecg_uploaded_mesh_t& m1, const ecg_uploaded_mesh_t& m2, ecg_status* status = nullptr);
 
 	#ifdef __cplusplus
 	namespace hulls {
@@ -250,6 +536,7 @@ namespace ecg {
 		/// The status will indicate success or describe any errors encountered during computation.</param>
 		/// <returns>A bounding_box structure containing the minimum and maximum points of the AABB.</returns>
 		ECG_API bounding_box compute_aabb(const ecg_mesh_t* mesh, ecg_status* status = nullptr);
+		ECG_API bounding_box compute_aabb(const ecg_uploaded_mesh_t& mesh, ecg_status* status = nullptr);
 
 		/// <summary>
 		/// Converts a bounding_box structure to a full_bounding_box structure, adding additional information 
@@ -271,14 +558,114 @@ namespace ecg {
 		/// The status will indicate success or describe any errors encountered during computation.</param>
 		/// <returns>A full_bounding_box structure representing the OBB for the specified mesh.</returns>
 		ECG_API full_bounding_box compute_obb(const ecg_mesh_t* mesh, ecg_status* status = nullptr);
+		ECG_API full_bounding_box compute_obb(const ecg_uploaded_mesh_t& mesh, ecg_status* status = nullptr);
 
 		/// <summary>
-		/// Function for creating a convex hull from a set of 3D vertexes.
+		/// Function for creating a convex hull from a set of 3D vertexes with Quickhull.
+		/// Vertexes lying on one plane have no volume and are rejected with INVALID_ARG.
+		/// Large sets are culled with HP_KDOP_26 first, smaller ones are built without culling.
 		/// </summary>
-		/// <param name="vertexes"></param>
+		/// <param name="vertexes">Vertexes of the set, at least four.</param>
 		/// <param name="status"></param>
-		/// <returns></returns>
+		/// <returns>A copy of the vertexes and the faces of the hull wound outwards.</returns>
 		ECG_API ecg_internal_mesh_t create_convex_hull(const ecg_array_t vrt_arr, ecg_status* status = nullptr);
+
+		/// <summary>
+		/// Same as create_convex_hull with an explicit pre-pass. The extreme points of the 6 or 26 directions of the k-DOP
+		/// are found on the active backend, and the vertexes inside their hull are dropped before Quickhull sees them.
+		/// </summary>
+		/// <param name="prefilter">Culling pre-pass, HP_NONE builds the hull from all vertexes.</param>
+		/// <param name="culled_cnt">Optional pointer to the number of vertexes dropped by the pre-pass.</param>
+		ECG_API ecg_internal_mesh_t create_convex_hull(const ecg_array_t vrt_arr, hull_prefilter_method prefilter, size_t* culled_cnt, ecg_status* status = nullptr);
+	#ifdef __cplusplus
+	}
+	#endif
+
+	#ifdef __cplusplus
+	namespace multi {
+	#endif
+		/// <summary>
+		/// Creates a context and a queue for every device that is used for work splitting.
+		/// The functions of this namespace split their work between these devices proportionally to the measured throughput.
+		/// </summary>
+		/// <param name="device_ids">Ids of devices from ecg_cl::get_available_devices, all devices are used if it is nullptr.</param>
+		/// <param name="ids_count">Number of ids in device_ids.</param>
+		/// <param name="status">Optional pointer to an ecg_status variable that will hold the status of the function execution.</param>
+		/// <returns></returns>
+		ECG_API void init(const int* device_ids = nullptr, size_t ids_count = 0, ecg_status* status = nullptr);
+
+		/// <summary>
+		/// Releases the contexts of all devices used for work splitting.
+		/// </summary>
+		/// <returns></returns>
+		ECG_API void release();
+
+		/// <summary>
+		/// Number of devices used for work splitting, 0 before init.
+		/// </summary>
+		/// <returns></returns>
+		ECG_API size_t get_devices_count();
+
+		/// <summary>
+		/// Multi-device versions of the API. Faces (or vertexes for AABB) are split into consecutive ranges,
+		/// each device computes its range with its own copy of the mesh and partial results are merged on the host.
+		/// Results and statuses are the same as for the single device functions, RUNTIME_ERROR is returned before init.
+		/// </summary>
+		ECG_API float compute_surface_area(const ecg_mesh_t* mesh, ecg_status* status = nullptr);
+		ECG_API ecg_array_t compute_faces_normals(const ecg_mesh_t* mesh, ecg_status* status = nullptr);
+		ECG_API bool is_mesh_self_intersected(const ecg_mesh_t* mesh, self_intersection_method method, ecg_status* status = nullptr);
+		ECG_API ecg_internal_mesh_t compute_intersection(const ecg_mesh_t* m1, const ecg_mesh_t* m2, ecg_status* status = nullptr);
+
+		#ifdef __cplusplus
+		namespace hulls {
+		#endif
+			ECG_API bounding_box compute_aabb(const ecg_mesh_t* mesh, ecg_status* status = nullptr);
+		#ifdef __cplusplus
+		}
+		#endif
+	#ifdef __cplusplus
+	}
+	#endif
+
+	#ifdef __cplusplus
+	namespace batch {
+	#endif
+		/// <summary>
+		/// Batched versions of the API for many small meshes. All meshes are packed into one vertex and one index buffer
+		/// with tables of their offsets, so every operation is a single kernel launch and a single readback for the whole batch.
+		/// Every mesh must pass the checks of the single mesh functions, otherwise the batch fails with the status of the first invalid mesh.
+		/// Results are released with cleanup.
+		/// </summary>
+		/// <param name="meshes">Array of meshes.</param>
+		/// <param name="meshes_count">Number of meshes in the array.</param>
+		/// <param name="status">Optional pointer to an ecg_status variable that will hold the status of the function execution.</param>
+		/// <returns>Array of floats, one area per mesh.</returns>
+		ECG_API ecg_array_t compute_surface_area(const ecg_mesh_t* meshes, size_t meshes_count, ecg_status* status = nullptr);
+
+		/// <summary>
+		/// Same as compute_surface_area of the namespace. Unlike the single mesh function, meshes aren't checked for manifoldness,
+		/// use is_mesh_manifold beforehand when the input isn't known to be manifold.
+		/// </summary>
+		/// <returns>Array of floats, one volume per mesh.</returns>
+		ECG_API ecg_array_t compute_volume(const ecg_mesh_t* meshes, size_t meshes_count, ecg_status* status = nullptr);
+
+		/// <summary>
+		/// Same as compute_surface_area of the namespace.
+		/// </summary>
+		/// <returns>Array of vec3_base with the normals of all faces, faces of a mesh follow the faces of the previous meshes.</returns>
+		ECG_API ecg_array_t compute_faces_normals(const ecg_mesh_t* meshes, size_t meshes_count, ecg_status* status = nullptr);
+
+		#ifdef __cplusplus
+		namespace hulls {
+		#endif
+			/// <summary>
+			/// Same as compute_surface_area of the namespace.
+			/// </summary>
+			/// <returns>Array of bounding_box, one per mesh.</returns>
+			ECG_API ecg_array_t compute_aabb(const ecg_mesh_t* meshes, size_t meshes_count, ecg_status* status = nullptr);
+		#ifdef __cplusplus
+		}
+		#endif
 	#ifdef __cplusplus
 	}
 	#endif
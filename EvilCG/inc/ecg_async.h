@@ -0,0 +1,126 @@
+#ifndef ECG_ASYNC_H
+#define ECG_ASYNC_H
+#include <help/ecg_status.h>
+#include <ecg_api_define.h>
+#include <help/ecg_geom.h>
+#include <ecg_global.h>
+#include <ecg_api.h>
+
+#include <future>
+
+namespace ecg::async {
+	/// <summary>
+	/// Result of an API call that runs in the background.
+	/// The event completes together with the device work of the call, so it can be used in OpenCL wait lists
+	/// and in the wait lists of other calls. It ends with a negative status if the call failed.
+	/// </summary>
+	template <typename Type>
+	class ecg_future {
+	public:
+		using result_t = std::pair<Type, ecg_status>;
+
+		ecg_future() = default;
+		ecg_future(std::shared_future<result_t> result, cl::Event event) :
+			m_result(std::move(result)), m_event(std::move(event))
+		{}
+
+		bool is_valid() const {
+			return m_result.valid();
+		}
+
+		bool is_ready() const {
+			if (!is_valid()) return false;
+
+			// Results of enqueued calls are read on the first get, they are ready once the commands complete
+			auto state = m_result.wait_for(std::chrono::seconds(0));
+			if (state != std::future_status::deferred) return state == std::future_status::ready;
+			return m_event() == nullptr || m_event.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>() <= CL_COMPLETE;
+		}
+
+		void wait() const {
+			if (is_valid()) m_result.wait();
+		}
+
+		/// <summary>
+		/// Waits for the call and returns its result, the status of the call is written to status.
+		/// </summary>
+		Type get(ecg_status* status = nullptr) const {
+			if (!is_valid()) {
+				if (status != nullptr) *status = ecg_status_code::RUNTIME_ERROR;
+				return Type{};
+			}
+
+			const result_t& result = m_result.get();
+			if (status != nullptr) *status = result.second;
+			return result.first;
+		}
+
+		cl::Event get_event() const {
+			return m_event;
+		}
+
+	private:
+		std::shared_future<result_t> m_result;
+		cl::Event m_event;
+
+	};
+
+	using ecg_wait_list_t = std::vector<cl::Event>;
+
+	/// <summary>
+	/// Asynchronous versions of the API, the commands of a call start after the events of its wait list.
+	/// Calls that only read their results back at the end (upload_mesh, sum_vertexes, get_center, compute_surface_area,
+	/// compute_faces_normals and hulls::compute_aabb) are enqueued on the out-of-order queue by the caller,
+	/// their event completes with the last command of the call and the results are read on the first get.
+	/// Other calls decide on the host between their commands, they run on a pool of host threads
+	/// and their event is a user event completed with the call.
+	/// A failed event in the wait list fails the call and its event.
+	/// Meshes passed by pointer have to stay valid until the future is ready.
+	/// </summary>
+	ECG_API ecg_future<ecg_uploaded_mesh_t> upload_mesh(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list = {});
+
+	ECG_API ecg_future<vec3_base> sum_vertexes(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list = {});
+	ECG_API ecg_future<vec3_base> sum_vertexes(const ecg_uploaded_mesh_t& mesh, const ecg_wait_list_t& wait_list = {});
+
+	ECG_API ecg_future<vec3_base> get_center(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list = {});
+	ECG_API ecg_future<vec3_base> get_center(const ecg_uploaded_mesh_t& mesh, const ecg_wait_list_t& wait_list = {});
+
+	ECG_API ecg_future<float> compute_surface_area(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list = {});
+	ECG_API ecg_future<float> compute_surface_area(const ecg_uploaded_mesh_t& mesh, const ecg_wait_list_t& wait_list = {});
+
+	ECG_API ecg_future<mat3_base> compute_covariance_matrix(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list = {});
+	ECG_API ecg_future<mat3_base> compute_covariance_matrix(const ecg_uploaded_mesh_t& mesh, const ecg_wait_list_t& wait_list = {});
+
+	ECG_API ecg_future<bool> is_mesh_closed(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list = {});
+	ECG_API ecg_future<bool> is_mesh_closed(const ecg_uploaded_mesh_t& mesh, const ecg_wait_list_t& wait_list = {});
+
+	ECG_API ecg_future<bool> is_mesh_manifold(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list = {});
+	ECG_API ecg_future<bool> is_mesh_manifold(const ecg_uploaded_mesh_t& mesh, const ecg_wait_list_t& wait_list = {});
+
+	ECG_API ecg_future<bool> is_mesh_self_intersected(const ecg_mesh_t* mesh, self_intersection_method method, const ecg_wait_list_t& wait_list = {});
+	ECG_API ecg_future<bool> is_mesh_self_intersected(const ecg_uploaded_mesh_t& mesh, self_intersection_method method, const ecg_wait_list_t& wait_list = {});
+
+	ECG_API ecg_future<ecg_array_t> triangulate_mesh(const ecg_mesh_t* mesh, int base_num_vert, const ecg_wait_list_t& wait_list = {});
+
+	ECG_API ecg_future<float> compute_volume(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list = {});
+	ECG_API ecg_future<float> compute_volume(const ecg_uploaded_mesh_t& mesh, const ecg_wait_list_t& wait_list = {});
+
+	ECG_API ecg_future<ecg_array_t> compute_faces_normals(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list = {});
+	ECG_API ecg_future<ecg_array_t> compute_faces_normals(const ecg_uploaded_mesh_t& mesh, const ecg_wait_list_t& wait_list = {});
+
+	ECG_API ecg_future<ecg_array_t> compute_vertex_normals(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list = {});
+	ECG_API ecg_future<ecg_array_t> compute_vertex_normals(const ecg_uploaded_mesh_t& mesh, const ecg_wait_list_t& wait_list = {});
+
+	ECG_API ecg_future<ecg_internal_mesh_t> compute_intersection(const ecg_mesh_t* m1, const ecg_mesh_t* m2, const ecg_wait_list_t& wait_list = {});
+	ECG_API ecg_future<ecg_internal_mesh_t> compute_intersection(const ecg_uploaded_mesh_t& m1, const ecg_uploaded_mesh_t& m2, const ecg_wait_list_t& wait_list = {});
+
+	namespace hulls {
+		ECG_API ecg_future<bounding_box> compute_aabb(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list = {});
+		ECG_API ecg_future<bounding_box> compute_aabb(const ecg_uploaded_mesh_t& mesh, const ecg_wait_list_t& wait_list = {});
+
+		ECG_API ecg_future<full_bounding_box> compute_obb(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list = {});
+		ECG_API ecg_future<full_bounding_box> compute_obb(const ecg_uploaded_mesh_t& mesh, const ecg_wait_list_t& wait_list = {});
+	}
+}
+
+#endif
@@ -11,6 +11,7 @@
 
 #include <type_traits>
 #include <concepts>
+#include <typeindex>
 #include <typeinfo>
 
 #include <unordered_map>
@@ -25,6 +26,7 @@
 #include <sstream>
 #include <iomanip>
 #include <utility>
+#include <random>
 #include <ranges>
 #include <vector>
 #include <format>
@@ -33,5 +35,6 @@
 #include <map>
 #include <set>
 #include <any>
+#include <bit>
 
 #endif
\ No newline at end of file
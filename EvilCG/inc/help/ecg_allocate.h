@@ -2,6 +2,7 @@
 #define ECG_ALLOCATE_H
 #include <core/ecg_host_ctrl.h>
 #include <core/ecg_internal.h>
+#include <core/ecg_profiler.h>
 #include <help/ecg_status.h>
 #include <help/ecg_geom.h>
 #include <help/ecg_mem.h>
@@ -38,7 +39,36 @@ namespace ecg {
 		std::memcpy(arr.arr_ptr, container.data(), sizeof(Type) * container.size());
 	}
 
-	ecg_cl_mesh_t allocate_cl_mesh(const ecg_mesh_t* mesh);
+	/// <summary>
+	/// Checks that the host array of size bytes can back a buffer without a copy.
+	/// Drivers copy arrays that aren't aligned to a page or whose size isn't a multiple of a cache line anyway.
+	/// </summary>
+	template <typename Type>
+	bool is_zero_copy_array(const Type* ptr, size_t size) {
+		auto& ctrl = ecg_cl::get_instance();
+		return ctrl.is_zero_copy_mode() && ptr != nullptr && size != 0 &&
+			reinterpret_cast<uintptr_t>(ptr) % ctrl.get_zero_copy_alignment() == 0 &&
+			size % ecg_cl::zero_copy_size_multiple == 0;
+	}
+
+	/// <summary>
+	/// Transient meshes on devices with unified memory use the arrays of the mesh directly,
+	/// so the arrays must not change until the buffers are released. Persistent meshes always own a copy.
+	/// The copy is enqueued on the chain, the arrays must stay valid until its commands complete.
+	/// </summary>
+	ecg_cl_mesh_t allocate_cl_mesh(ecg_cmd_chain& chain, const ecg_mesh_t* mesh, ecg_status_handler& op_res, bool is_transient = true);
+	ecg_cl_mesh_t allocate_cl_mesh(const ecg_mesh_t* mesh, cl::Context& context, ecg_status_handler& op_res);
+	void update_cl_mesh(ecg_cmd_chain& chain, ecg_cl_mesh_t& cl_mesh, const ecg_mesh_t* mesh, ecg_status_handler& op_res);
+	/// <summary>
+	/// Buffer for size bytes of results that are read to host_ptr.
+	/// With zero-copy the buffer is created over host_ptr, so read_result_buffer only synchronizes it.
+	/// The results are in host_ptr after the commands of the chain complete.
+	/// </summary>
+	ecg_pooled_buffer allocate_result_buffer(ecg_cmd_chain& chain, void* host_ptr, size_t size, ecg_status_handler& op_res);
+	void read_result_buffer(ecg_cmd_chain& chain, const cl::Buffer& buffer, void* host_ptr, size_t size, ecg_status_handler& op_res);
+
+	void read_cl_mesh(ecg_cmd_chain& chain, const ecg_cl_mesh_t& cl_mesh, std::vector<vec3_base>& vertexes, std::vector<uint32_t>& indexes, ecg_status_handler& op_res);
+	std::shared_ptr<ecg_cl_mesh_t> get_cl_mesh(const ecg_uploaded_mesh_t& mesh, ecg_status_handler& op_res);
 }
 
 #endif
\ No newline at end of file
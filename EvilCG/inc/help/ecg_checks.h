@@ -7,6 +7,7 @@
 
 namespace ecg {
 	void default_mesh_check(const ecg_mesh_t* mesh, ecg_status_handler& op_res, ecg_status* status);
+	std::shared_ptr<ecg_cl_mesh_t> uploaded_mesh_check(const ecg_uploaded_mesh_t& mesh, ecg_status_handler& op_res, ecg_status* status);
 	void on_unknown_exception(ecg_status_handler& op_res, ecg_status* status);
 }
 
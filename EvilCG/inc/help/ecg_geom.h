@@ -148,6 +148,19 @@ namespace ecg {
 #endif
 	};
 
+	/// <summary>
+	/// Handle to a mesh whose geometry was uploaded to the device with upload_mesh.
+	/// The geometry stays on the device until cleanup is called with the handler.
+	/// </summary>
+	ECG_API struct ecg_uploaded_mesh_t : public ecg_handle_t {
+		uint32_t vertexes_size;
+		uint32_t indexes_size;
+
+#ifdef __cplusplus
+		ecg_uploaded_mesh_t() : vertexes_size(0), indexes_size(0) {}
+#endif
+	};
+
 	ECG_API struct face_t {
 		uint32_t ind_1;
 		uint32_t ind_2;
@@ -164,6 +177,109 @@ namespace ecg {
 		ecg_array_t indexes;
 	};
 
+	/// <summary>
+	/// Limits of a mesh simplification, it stops at the first one reached.
+	/// A target of zero faces doesn't limit the number of faces. The error is the sum of squared distances
+	/// of a new vertex to the planes of the original faces around it, in the units of the mesh.
+	/// Grid resolution is the number of cells along the largest side of the box for the clustering methods,
+	/// zero derives it from the target number of faces.
+	/// </summary>
+	ECG_API struct ecg_simplify_params_t {
+		size_t target_faces_cnt;
+		float max_error;
+		uint32_t grid_resolution;
+
+#ifdef __cplusplus
+		ecg_simplify_params_t() : target_faces_cnt(0), max_error(std::numeric_limits<float>::max()), grid_resolution(0) {}
+#endif
+	};
+
+	/// <summary>
+	/// Levels of detail packed into one mesh. Level i has the vertexes [vertex_offsets[i], vertex_offsets[i + 1])
+	/// and the indexes [index_offsets[i], index_offsets[i + 1]), its indexes start from its first vertex.
+	/// Both offset arrays hold uint32_t and have one value more than there are levels.
+	/// </summary>
+	ECG_API struct ecg_lod_chain_t {
+		ecg_internal_mesh_t mesh;
+		ecg_array_t vertex_offsets;
+		ecg_array_t index_offsets;
+	};
+
+	/// <summary>
+	/// Statistics of the pool of transient device buffers.
+	/// Hits are requests served by a free buffer, misses are requests that created a new one.
+	/// </summary>
+	ECG_API struct ecg_buffer_pool_stats_t {
+		size_t hits;
+		size_t misses;
+		size_t evictions;
+		size_t cached_buffers;
+		size_t cached_bytes;
+		size_t limit_bytes;
+	};
+
+	/// <summary>
+	/// Counters of profiled API calls. Times are in nanoseconds,
+	/// device times are the sums of the durations of kernels and copies.
+	/// </summary>
+	ECG_API struct ecg_profiling_stats_t {
+		size_t calls;
+		size_t kernels;
+		size_t transfers;
+		size_t host_to_device_bytes;
+		size_t device_to_host_bytes;
+		uint64_t host_time_ns;
+		uint64_t kernel_time_ns;
+		uint64_t transfer_time_ns;
+	};
+
+	/// <summary>
+	/// Statistics of a mesh computed in one sweep over its vertexes and faces.
+	/// The covariance matrix isn't divided by the number of vertexes, same as compute_covariance_matrix.
+	/// The volume is the signed volume enclosed by the faces, it is positive for outward facing counter-clockwise faces.
+	/// Faces with an area below 1e-6 of the square of their longest edge are counted as degenerate.
+	/// </summary>
+	ECG_API struct ecg_mesh_stats_t {
+		vec3_base vertexes_sum;
+		vec3_base center;
+		bounding_box aabb;
+		mat3_base covariance;
+		float surface_area;
+		float volume;
+		size_t vertexes_cnt;
+		size_t faces_cnt;
+		size_t degenerate_faces_cnt;
+	};
+
+	/// <summary>
+	/// Undirected edges of a mesh. A boundary edge belongs to one face, a non-manifold edge to more than two faces,
+	/// a closed mesh has neither of them.
+	/// </summary>
+	ECG_API struct ecg_edge_stats_t {
+		size_t edges_cnt;
+		size_t boundary_edges_cnt;
+		size_t non_manifold_edges_cnt;
+	};
+
+	/// <summary>
+	/// Adjacency list in CSR form, the neighbours of item i are ids[offsets[i], offsets[i + 1]) in ascending order.
+	/// Both arrays hold uint32_t, offsets has one value more than there are items.
+	/// </summary>
+	ECG_API struct ecg_adjacency_list_t {
+		ecg_array_t offsets;
+		ecg_array_t ids;
+	};
+
+	/// <summary>
+	/// Adjacency of a mesh. Faces of a vertex use it, neighbour faces share an edge with the face
+	/// and are listed once per shared edge, neighbour vertexes share an edge with the vertex.
+	/// </summary>
+	ECG_API struct ecg_adjacency_t {
+		ecg_adjacency_list_t vertex_faces;
+		ecg_adjacency_list_t face_faces;
+		ecg_adjacency_list_t vertex_vertexes;
+	};
+
 	extern "C" vec3_base ECG_API add_vec(const vec3_base& lhs, const vec3_base& rhs);
 	extern "C" vec3_base ECG_API sub_vec(const vec3_base& lhs, const vec3_base& rhs);
 	extern "C" vec3_base ECG_API mul_vec(const vec3_base& lhs, const float rhs);
@@ -30,6 +30,17 @@ namespace ecg {
 		void delete_memory(uint64_t handle);
 		void delete_all_memory();
 
+		template <typename Type>
+		std::shared_ptr<Type> get_memory(uint64_t handle) {
+			std::scoped_lock lock(m_memory_lock);
+
+			auto it = m_memory_map.find(handle);
+			if (it == m_memory_map.end() || it->second.type != typeid(Type))
+				return nullptr;
+
+			return std::static_pointer_cast<Type>(it->second.ptr);
+		}
+
 		template <typename Type>
 		handle_t<Type> allocate() {
 			try {
@@ -37,7 +48,7 @@ namespace ecg {
 
 				auto id = get_next_id();
 				auto ptr = std::make_shared<Type>();
-				m_memory_map[id] = std::static_pointer_cast<void>(ptr);
+				m_memory_map.insert_or_assign(id, memory_item_t{ std::static_pointer_cast<void>(ptr), typeid(Type) });
 
 				return handle_t<Type>(ptr, id);
 			}
@@ -60,7 +71,7 @@ namespace ecg {
 				auto id = get_next_id();
 				auto raw_ptr = new Type[size];
 				auto vec_ptr = std::shared_ptr<Type>(raw_ptr, std::default_delete<Type[]>());
-				m_memory_map[id] = std::static_pointer_cast<void>(vec_ptr);
+				m_memory_map.insert_or_assign(id, memory_item_t{ std::static_pointer_cast<void>(vec_ptr), typeid(Type[]) });
 				
 				handle_t<Type> res;
 				res.ptr = vec_ptr;
@@ -99,7 +110,12 @@ namespace ecg {
 		}
 
 	private:
-		std::unordered_map<uint64_t, std::shared_ptr<void>> m_memory_map;
+		struct memory_item_t {
+			std::shared_ptr<void> ptr;
+			std::type_index type;
+		};
+
+		std::unordered_map<uint64_t, memory_item_t> m_memory_map;
 		std::mutex m_memory_lock;
 		static uint64_t ms_id;
 	};
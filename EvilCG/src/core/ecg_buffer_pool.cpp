@@ -0,0 +1,191 @@
+#include <core/ecg_buffer_pool.h>
+
+namespace ecg {
+	ecg_pooled_buffer::ecg_pooled_buffer(const cl::Buffer& buffer) :
+		cl::Buffer(buffer)
+	{ }
+
+	ecg_pooled_buffer::ecg_pooled_buffer(std::weak_ptr<ecg_buffer_pool> pool, const cl::Buffer& buffer, ecg_cmd_chain& chain,
+		cl_mem_flags flags, size_t capacity, uint64_t generation
+	) :
+		cl::Buffer(buffer), m_pool(std::move(pool)), m_chain(chain.get_state()), m_context(chain.get_context()),
+		m_flags(flags), m_capacity(capacity), m_generation(generation)
+	{ }
+
+	ecg_pooled_buffer::ecg_pooled_buffer(ecg_pooled_buffer&& buffer) noexcept :
+		cl::Buffer(std::move(buffer)), m_pool(std::move(buffer.m_pool)), m_chain(std::move(buffer.m_chain)),
+		m_context(std::move(buffer.m_context)), m_flags(buffer.m_flags),
+		m_capacity(buffer.m_capacity), m_generation(buffer.m_generation)
+	{ }
+
+	ecg_pooled_buffer& ecg_pooled_buffer::operator=(ecg_pooled_buffer&& buffer) noexcept {
+		if (this == &buffer) return *this;
+
+		recycle();
+		cl::Buffer::operator=(std::move(buffer));
+		m_pool = std::move(buffer.m_pool);
+		m_chain = std::move(buffer.m_chain);
+		m_context = std::move(buffer.m_context);
+		m_flags = buffer.m_flags;
+		m_capacity = buffer.m_capacity;
+		m_generation = buffer.m_generation;
+		return *this;
+	}
+
+	ecg_pooled_buffer::~ecg_pooled_buffer() {
+		recycle();
+	}
+
+	size_t ecg_pooled_buffer::get_capacity() const {
+		return m_capacity;
+	}
+
+	void ecg_pooled_buffer::recycle() noexcept {
+		auto pool = m_pool.lock();
+		if (pool != nullptr && m_chain != nullptr && (*this)() != nullptr) {
+			// The last command of the chain comes after every command that used the buffer
+			try {
+				std::vector<cl::Event> fence;
+				{
+					std::scoped_lock lock(m_chain->lock);
+					fence = m_chain->events;
+				}
+
+				pool->release(*this, m_context, std::move(fence), m_flags, m_capacity, m_generation);
+			}
+			catch (...) {
+				// The buffer is released by its last reference
+			}
+		}
+
+		m_pool.reset();
+		m_chain.reset();
+		m_context = cl::Context();
+		cl::Buffer::operator=(cl::Buffer());
+	}
+
+	ecg_buffer_pool::~ecg_buffer_pool() {
+		clear();
+	}
+
+	size_t ecg_buffer_pool::get_size_class(size_t size) {
+		return std::bit_ceil(std::max(size, min_size_class));
+	}
+
+	ecg_pooled_buffer ecg_buffer_pool::acquire(ecg_cmd_chain& chain, cl_mem_flags flags, size_t size, cl_int* err) {
+		// Host memory belongs to the caller, such buffers can't be reused
+		if (flags & (CL_MEM_USE_HOST_PTR | CL_MEM_COPY_HOST_PTR)) {
+			if (err != nullptr) *err = CL_INVALID_VALUE;
+			return ecg_pooled_buffer();
+		}
+
+		if (size == 0) {
+			if (err != nullptr) *err = CL_INVALID_BUFFER_SIZE;
+			return ecg_pooled_buffer();
+		}
+
+		size_t capacity = get_size_class(size);
+		uint64_t generation = 0;
+		cl::Buffer free_buffer;
+		std::vector<cl::Event> fence;
+
+		{
+			std::scoped_lock lock(m_pool_lock);
+			generation = m_generation;
+
+			// The most recently returned buffer is the most likely to be resident
+			for (auto it = m_free_buffers.rbegin(); it != m_free_buffers.rend(); ++it) {
+				if (it->context() != chain.get_context()() || it->flags != flags || it->capacity != capacity) continue;
+
+				free_buffer = std::move(it->buffer);
+				fence = std::move(it->fence);
+				m_cached_bytes -= it->capacity;
+				m_free_buffers.erase(std::next(it).base());
+				++m_hits;
+				break;
+			}
+
+			if (free_buffer() == nullptr) ++m_misses;
+		}
+
+		// Commands of the previous owner may still run, the new owner starts after them
+		if (free_buffer() != nullptr) {
+			chain.add_dependencies(fence);
+			if (err != nullptr) *err = CL_SUCCESS;
+			return ecg_pooled_buffer(weak_from_this(), free_buffer, chain, flags, capacity, generation);
+		}
+
+		cl_int err_create_buffer = CL_SUCCESS;
+		cl::Context& context = chain.get_context();
+		cl::Buffer buffer(context, flags, capacity, nullptr, &err_create_buffer);
+
+		// Free buffers hold device memory that the new buffer may need
+		if (err_create_buffer == CL_MEM_OBJECT_ALLOCATION_FAILURE || err_create_buffer == CL_OUT_OF_RESOURCES) {
+			trim();
+			buffer = cl::Buffer(context, flags, capacity, nullptr, &err_create_buffer);
+		}
+
+		if (err != nullptr) *err = err_create_buffer;
+		if (err_create_buffer != CL_SUCCESS) return ecg_pooled_buffer();
+		return ecg_pooled_buffer(weak_from_this(), buffer, chain, flags, capacity, generation);
+	}
+
+	void ecg_buffer_pool::release(const cl::Buffer& buffer, const cl::Context& context, std::vector<cl::Event> fence,
+		cl_mem_flags flags, size_t capacity, uint64_t generation
+	) noexcept {
+		try {
+			std::scoped_lock lock(m_pool_lock);
+			if (generation != m_generation || capacity > m_limit) return;
+
+			m_free_buffers.push_back(free_buffer_t{ buffer, context, std::move(fence), flags, capacity });
+			m_cached_bytes += capacity;
+			trim_locked(m_limit);
+		}
+		catch (...) {
+			// The buffer is released by its last reference
+		}
+	}
+
+	void ecg_buffer_pool::trim(size_t max_bytes) noexcept {
+		std::scoped_lock lock(m_pool_lock);
+		trim_locked(max_bytes);
+	}
+
+	void ecg_buffer_pool::trim_locked(size_t max_bytes) noexcept {
+		while (m_cached_bytes > max_bytes && !m_free_buffers.empty()) {
+			m_cached_bytes -= m_free_buffers.front().capacity;
+			m_free_buffers.pop_front();
+			++m_evictions;
+		}
+	}
+
+	void ecg_buffer_pool::clear() noexcept {
+		std::scoped_lock lock(m_pool_lock);
+		m_free_buffers.clear();
+		m_cached_bytes = 0;
+		++m_generation;
+	}
+
+	void ecg_buffer_pool::set_limit(size_t max_bytes) {
+		std::scoped_lock lock(m_pool_lock);
+		m_limit = max_bytes;
+		trim_locked(m_limit);
+	}
+
+	size_t ecg_buffer_pool::get_limit() const {
+		std::scoped_lock lock(m_pool_lock);
+		return m_limit;
+	}
+
+	ecg_buffer_pool_stats_t ecg_buffer_pool::get_stats() const {
+		std::scoped_lock lock(m_pool_lock);
+		return ecg_buffer_pool_stats_t{ m_hits, m_misses, m_evictions, m_free_buffers.size(), m_cached_bytes, m_limit };
+	}
+
+	void ecg_buffer_pool::reset_stats() {
+		std::scoped_lock lock(m_pool_lock);
+		m_hits = 0;
+		m_misses = 0;
+		m_evictions = 0;
+	}
+}
@@ -0,0 +1,118 @@
+#include <core/ecg_cmd_chain.h>
+
+namespace ecg {
+	ecg_cmd_chain::ecg_cmd_chain(const cl::CommandQueue& queue) :
+		m_state(std::make_shared<state_t>()), m_queue(queue)
+	{
+		m_context = m_queue.getInfo<CL_QUEUE_CONTEXT>();
+	}
+
+	cl::CommandQueue& ecg_cmd_chain::get_queue() {
+		return m_queue;
+	}
+
+	cl::Context& ecg_cmd_chain::get_context() {
+		return m_context;
+	}
+
+	std::shared_ptr<ecg_cmd_chain::state_t> ecg_cmd_chain::get_state() const {
+		return m_state;
+	}
+
+	const std::vector<cl::Event>* ecg_cmd_chain::get_wait_list() const {
+		// Only the owner of the chain changes the events, it reads them without the lock
+		return m_state->events.empty() ? nullptr : &m_state->events;
+	}
+
+	void ecg_cmd_chain::add_dependencies(const std::vector<cl::Event>& events) {
+		// Completed events don't order anything, failed ones are kept to fail the chain
+		std::vector<cl::Event> pending;
+		for (const auto& event : events)
+			if (event() != nullptr && event.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>() != CL_COMPLETE) pending.push_back(event);
+
+		std::scoped_lock lock(m_state->lock);
+		m_state->events.insert(m_state->events.end(), pending.begin(), pending.end());
+	}
+
+	void ecg_cmd_chain::push(const cl::Event& event) {
+		std::scoped_lock lock(m_state->lock);
+		m_state->events.assign(1, event);
+	}
+
+	std::vector<cl::Event> ecg_cmd_chain::get_events() const {
+		std::scoped_lock lock(m_state->lock);
+		return m_state->events;
+	}
+
+	cl_int ecg_cmd_chain::get_last_event(cl::Event* event) {
+		if (m_state->events.size() == 1) {
+			*event = m_state->events.front();
+			return CL_SUCCESS;
+		}
+
+		if (m_state->events.empty()) {
+			cl_int err = CL_SUCCESS;
+			cl::UserEvent done(m_context, &err);
+			if (err != CL_SUCCESS) return err;
+
+			err = done.setStatus(CL_COMPLETE);
+			*event = done;
+			return err;
+		}
+
+		// A marker with an empty wait list would wait for the commands of other chains as well
+		cl_int result = m_queue.enqueueMarkerWithWaitList(get_wait_list(), event);
+		if (result == CL_SUCCESS) push(*event);
+		return result;
+	}
+
+	cl_int ecg_cmd_chain::wait() {
+		std::vector<cl::Event> events = get_events();
+		if (events.empty()) return CL_SUCCESS;
+
+		cl_int result = cl::WaitForEvents(events);
+		if (result != CL_SUCCESS) return result;
+
+		// Completed events don't order anything anymore
+		std::scoped_lock lock(m_state->lock);
+		m_state->events.clear();
+		return CL_SUCCESS;
+	}
+
+	cl_int ecg_cmd_chain::write_buffer(const cl::Buffer& buffer, size_t offset, size_t size, const void* ptr) {
+		cl::Event event;
+		cl_int result = ecg_profiler::write_buffer(m_queue, buffer, CL_FALSE, offset, size, ptr, get_wait_list(), &event);
+		if (result == CL_SUCCESS) push(event);
+		return result;
+	}
+
+	cl_int ecg_cmd_chain::read_buffer(const cl::Buffer& buffer, size_t offset, size_t size, void* ptr) {
+		cl::Event event;
+		cl_int result = ecg_profiler::read_buffer(m_queue, buffer, CL_FALSE, offset, size, ptr, get_wait_list(), &event);
+		if (result == CL_SUCCESS) push(event);
+		return result;
+	}
+
+	cl_int ecg_cmd_chain::copy_buffer(const cl::Buffer& src, const cl::Buffer& dst, size_t src_offset, size_t dst_offset, size_t size) {
+		cl::Event event;
+		cl_int result = m_queue.enqueueCopyBuffer(src, dst, src_offset, dst_offset, size, get_wait_list(), &event);
+		if (result == CL_SUCCESS) push(event);
+		return result;
+	}
+
+	void* ecg_cmd_chain::map_buffer(const cl::Buffer& buffer, cl_map_flags flags, size_t offset, size_t size, cl_int* err) {
+		cl::Event event;
+		cl_int err_map = CL_SUCCESS;
+		void* ptr = m_queue.enqueueMapBuffer(buffer, CL_FALSE, flags, offset, size, get_wait_list(), &event, &err_map);
+		if (err_map == CL_SUCCESS) push(event);
+		if (err != nullptr) *err = err_map;
+		return ptr;
+	}
+
+	cl_int ecg_cmd_chain::unmap_buffer(const cl::Buffer& buffer, void* ptr) {
+		cl::Event event;
+		cl_int result = m_queue.enqueueUnmapMemObject(buffer, ptr, get_wait_list(), &event);
+		if (result == CL_SUCCESS) push(event);
+		return result;
+	}
+}
@@ -13,16 +13,23 @@ namespace ecg {
 		if (m_is_initialized) {
 			try {
 				m_cmd_queue.finish();
+
+				std::scoped_lock lock(m_thread_queues_lock);
+				for (auto& [id, queue] : m_thread_queues) queue->finish();
+				m_thread_queues.clear();
 			}
 			catch (const std::exception& ex) {
 				if (log) spdlog::error(ex.what());
 			}
 
+			m_buffer_pool->clear();
 			m_cmd_queue = cl::CommandQueue();
 			m_main_device = cl::Device();
 			m_context = cl::Context();
 			
 			if(log) spdlog::info("Controller was released");
+			m_is_unified_memory = false;
+			m_zero_copy_alignment = zero_copy_page_size;
 			m_is_initialized = false;
 		}
 	}
@@ -41,8 +48,76 @@ namespace ecg {
 		return m_main_device;
 	}
 
+	/// <summary>
+	/// Drops the queue of a thread when the thread exits, otherwise short-lived threads would leave their queues behind.
+	/// </summary>
+	struct ecg_thread_queue_guard_t {
+		std::function<void()> on_exit;
+
+		~ecg_thread_queue_guard_t() {
+			if (on_exit) on_exit();
+		}
+	};
+
 	cl::CommandQueue& ecg_cl::get_cmd_queue() {
-		return m_cmd_queue;
+		if (!m_is_thread_safe || !m_is_initialized) return m_cmd_queue;
+
+		thread_local ecg_thread_queue_guard_t thread_guard;
+		if (!thread_guard.on_exit) {
+			thread_guard.on_exit = [this, id = std::this_thread::get_id()] {
+				// Commands already enqueued complete after the release, chains hold their own references to the queue
+				std::scoped_lock lock(m_thread_queues_lock);
+				m_thread_queues.erase(id);
+			};
+		}
+
+		std::scoped_lock lock(m_thread_queues_lock);
+		auto& queue = m_thread_queues[std::this_thread::get_id()];
+		if (queue != nullptr) return *queue;
+
+		// Same properties as the main queue, functions rely on them
+		cl_int err = CL_SUCCESS;
+		auto properties = m_cmd_queue.getInfo<CL_QUEUE_PROPERTIES>();
+		queue = std::make_shared<cl::CommandQueue>(m_context, m_main_device, properties, &err);
+		if (err != CL_SUCCESS) {
+			m_thread_queues.erase(std::this_thread::get_id());
+			return m_cmd_queue;
+		}
+
+		return *queue;
+	}
+
+	size_t ecg_cl::get_thread_queues_count() {
+		std::scoped_lock lock(m_thread_queues_lock);
+		return m_thread_queues.size();
+	}
+
+	void ecg_cl::set_thread_safe_mode(bool enabled) {
+		m_is_thread_safe = enabled;
+	}
+
+	bool ecg_cl::is_thread_safe_mode() const {
+		return m_is_thread_safe;
+	}
+
+	ecg_buffer_pool& ecg_cl::get_buffer_pool() {
+		return *m_buffer_pool;
+	}
+
+	bool ecg_cl::is_host_unified_memory() const {
+		return m_is_unified_memory;
+	}
+
+	void ecg_cl::set_zero_copy_mode(bool enabled) {
+		m_is_zero_copy = enabled;
+	}
+
+	bool ecg_cl::is_zero_copy_mode() const {
+		return m_is_zero_copy && m_is_unified_memory;
+	}
+
+	size_t ecg_cl::get_zero_copy_alignment() const {
+		return m_zero_copy_alignment;
 	}
 
 	cl_int ecg_cl::get_max_work_group_size() const {
@@ -153,6 +228,16 @@ namespace ecg {
 			m_context = cl::Context(m_main_device);
 			m_cmd_queue = cl::CommandQueue(m_context,
 				CL_QUEUE_PROFILING_ENABLE | CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE);
+
+			// Deprecated since OpenCL 2.0, but still the only portable way to detect integrated devices
+			cl_bool is_unified = CL_FALSE;
+			m_main_device.getInfo(CL_DEVICE_HOST_UNIFIED_MEMORY, &is_unified);
+			cl_device_type type = m_main_device.getInfo<CL_DEVICE_TYPE>();
+			m_is_unified_memory = is_unified == CL_TRUE || (type & CL_DEVICE_TYPE_CPU) != 0;
+
+			// The alignment is reported in bits
+			cl_uint base_addr_align = m_main_device.getInfo<CL_DEVICE_MEM_BASE_ADDR_ALIGN>();
+			m_zero_copy_alignment = std::max<size_t>(zero_copy_page_size, base_addr_align / 8);
 			m_is_initialized = true;
 		}
 
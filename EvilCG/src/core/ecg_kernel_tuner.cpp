@@ -0,0 +1,284 @@
+#include <core/ecg_kernel_tuner.h>
+#include <core/ecg_cl_programs.h>
+
+namespace ecg {
+	ecg_kernel_tuner& ecg_kernel_tuner::get_instance() {
+		static ecg_kernel_tuner instance;
+		return instance;
+	}
+
+	bool ecg_kernel_tuner::is_range_checked(const std::string& kernel_name) {
+		static const std::unordered_set<std::string> kernels = {
+			compute_cov_mat_name, compute_obb_name, mark_hull_candidates_name, compact_hull_candidates_name,
+			build_edge_keys_name, count_edge_runs_name, mark_edge_runs_name, emit_edges_name,
+			count_vertex_corners_name, find_half_edges_positions_name, check_vertexes_fans_name,
+			count_vertex_faces_name, fill_vertex_faces_name, fill_vertex_vertexes_name,
+			count_face_faces_name, fill_face_faces_name, sort_adjacency_lists_name, is_mesh_self_intersected_name,
+			compute_faces_morton_codes_name, build_bvh_nodes_name, compute_bvh_boxes_name, find_bvh_intersections_name, find_bvh_candidates_name,
+			triangulate_mesh_name, compute_volume_name, compute_faces_normals_name, compute_vertex_normals_name,
+			compute_cell_keys_name, find_cell_starts_name, average_cell_vertexes_name, mark_cluster_faces_name, compact_cluster_faces_name,
+			intersect_two_meshes_name, intersect_candidate_faces_name, check_is_point_in_mesh_name,
+			batch_compute_volume_name
+		};
+
+		return kernels.contains(kernel_name);
+	}
+
+	size_t ecg_kernel_tuner::get_size_class(size_t items_cnt) {
+		return std::bit_ceil(std::max<size_t>(items_cnt, 1));
+	}
+
+	std::string ecg_kernel_tuner::get_key(const cl::Device& device, const std::string& kernel_name, size_t items_cnt) {
+		auto it = m_device_keys.find(device());
+		if (it == m_device_keys.end()) {
+			// FNV-1a of the device and its driver, the same device is tuned again after a driver update
+			uint64_t hash = 14695981039346656037ull;
+			for (unsigned char ch : device.getInfo<CL_DEVICE_NAME>() + "|" + device.getInfo<CL_DRIVER_VERSION>()) {
+				hash ^= ch;
+				hash *= 1099511628211ull;
+			}
+
+			std::stringstream device_key;
+			device_key << std::hex << std::setw(16) << std::setfill('0') << hash;
+			it = m_device_keys.emplace(device(), device_key.str()).first;
+		}
+
+		std::stringstream key;
+		key << it->second << "/" << kernel_name << "/" << get_size_class(items_cnt);
+		return key.str();
+	}
+
+	std::vector<size_t> ecg_kernel_tuner::get_candidates(const cl::Device& device, const cl::Kernel& kernel,
+		size_t items_cnt, bool pow2_only, size_t max_local_size
+	) {
+		size_t max_size = kernel.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(device);
+		auto item_sizes = device.getInfo<CL_DEVICE_MAX_WORK_ITEM_SIZES>();
+		if (!item_sizes.empty()) max_size = std::min(max_size, item_sizes[0]);
+		if (max_local_size != 0) max_size = std::min(max_size, max_local_size);
+
+		size_t multiple = std::max<size_t>(kernel.getWorkGroupInfo<CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE>(device), 1);
+		if (pow2_only) {
+			multiple = std::bit_ceil(multiple);
+			max_size = std::bit_floor(max_size);
+		}
+
+		// Groups larger than the work range only add idle work items
+		size_t limit = std::min(max_size, std::max(multiple, get_size_class(items_cnt)));
+
+		std::vector<size_t> candidates;
+		for (size_t size = multiple; size <= limit; size *= 2)
+			candidates.push_back(size);
+
+		if (candidates.empty() && max_size > 0) candidates.push_back(max_size);
+		return candidates;
+	}
+
+	ecg_tuned_launch_t ecg_kernel_tuner::get_launch(const cl::Device& device, const cl::Kernel& kernel, const std::string& kernel_name,
+		size_t items_cnt, bool pow2_only, size_t max_local_size
+	) {
+		if (!m_is_enabled || items_cnt == 0) return ecg_tuned_launch_t();
+
+		std::string profile_data;
+		std::string profile_path;
+		ecg_tuned_launch_t launch;
+
+		{
+			std::scoped_lock lock(m_entries_lock);
+			launch.key = get_key(device, kernel_name, items_cnt);
+
+			auto it = m_entries.find(launch.key);
+			if (it == m_entries.end()) {
+				entry_t entry;
+				entry.candidates = get_candidates(device, kernel, items_cnt, pow2_only, max_local_size);
+				entry.best_times.assign(entry.candidates.size(), std::numeric_limits<double>::max());
+				entry.samples_cnt.assign(entry.candidates.size(), 0);
+
+				// Nothing to choose from, the only size is used without timing
+				if (entry.candidates.size() <= 1) {
+					entry.local_size = entry.candidates.empty() ? 0 : entry.candidates.front();
+					entry.is_tuned = true;
+				}
+
+				it = m_entries.emplace(launch.key, std::move(entry)).first;
+			}
+
+			auto& entry = it->second;
+			if (!entry.is_tuned) {
+				collect_samples(entry);
+				if (try_finish(entry) && !m_profile.empty()) {
+					profile_data = serialize_profile();
+					profile_path = m_profile;
+				}
+			}
+
+			if (entry.is_tuned) {
+				launch.local_size = entry.local_size;
+			}
+			else {
+				launch.local_size = entry.candidates[entry.next_candidate++ % entry.candidates.size()];
+				launch.is_sample = true;
+			}
+		}
+
+		if (!profile_path.empty()) save_profile(profile_path, profile_data);
+		return launch;
+	}
+
+	void ecg_kernel_tuner::add_sample(const ecg_tuned_launch_t& launch, const cl::Event& event, size_t global_size) {
+		if (!launch.is_sample || event() == nullptr) return;
+
+		std::scoped_lock lock(m_entries_lock);
+		auto it = m_entries.find(launch.key);
+		if (it == m_entries.end() || it->second.is_tuned) return;
+
+		auto& entry = it->second;
+		auto candidate = std::find(entry.candidates.begin(), entry.candidates.end(), launch.local_size);
+		if (candidate == entry.candidates.end()) return;
+
+		entry.pending.push_back(pending_sample_t{ static_cast<size_t>(candidate - entry.candidates.begin()), global_size, event });
+	}
+
+	void ecg_kernel_tuner::collect_samples(entry_t& entry) {
+		std::vector<pending_sample_t> still_pending;
+
+		for (auto& sample : entry.pending) {
+			cl_int err = CL_SUCCESS;
+			cl_int status = sample.event.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>(&err);
+			if (err != CL_SUCCESS || status < 0) continue;
+			if (status != CL_COMPLETE) {
+				still_pending.push_back(std::move(sample));
+				continue;
+			}
+
+			cl_int err_start = CL_SUCCESS, err_end = CL_SUCCESS;
+			cl_ulong start = sample.event.getProfilingInfo<CL_PROFILING_COMMAND_START>(&err_start);
+			cl_ulong end = sample.event.getProfilingInfo<CL_PROFILING_COMMAND_END>(&err_end);
+
+			// The queue was created without profiling, the implementation keeps choosing the size
+			if (err_start != CL_SUCCESS || err_end != CL_SUCCESS) {
+				entry.local_size = 0;
+				entry.is_tuned = true;
+				entry.pending.clear();
+				return;
+			}
+
+			if (end < start) continue;
+
+			// Ranges of one size class differ up to twice, so the time is compared per work item
+			double time = static_cast<double>(end - start) / static_cast<double>(std::max<size_t>(sample.global_size, 1));
+			entry.best_times[sample.candidate_id] = std::min(entry.best_times[sample.candidate_id], time);
+			++entry.samples_cnt[sample.candidate_id];
+		}
+
+		entry.pending = std::move(still_pending);
+	}
+
+	bool ecg_kernel_tuner::try_finish(entry_t& entry) {
+		if (entry.is_tuned) return false;
+
+		for (size_t samples : entry.samples_cnt)
+			if (samples < samples_per_candidate) return false;
+
+		// The fastest sample of every candidate is kept, so a cold first launch doesn't decide
+		auto best = std::min_element(entry.best_times.begin(), entry.best_times.end());
+		entry.local_size = entry.candidates[best - entry.best_times.begin()];
+		entry.is_tuned = true;
+
+		entry.candidates.clear();
+		entry.best_times.clear();
+		entry.samples_cnt.clear();
+		entry.pending.clear();
+		return true;
+	}
+
+	size_t ecg_kernel_tuner::get_tuned_local_size(const cl::Device& device, const std::string& kernel_name, size_t items_cnt) {
+		std::scoped_lock lock(m_entries_lock);
+		auto it = m_entries.find(get_key(device, kernel_name, items_cnt));
+		if (it == m_entries.end() || !it->second.is_tuned) return 0;
+		return it->second.local_size;
+	}
+
+	void ecg_kernel_tuner::set_enabled(bool enabled) {
+		m_is_enabled = enabled;
+	}
+
+	bool ecg_kernel_tuner::is_enabled() const {
+		return m_is_enabled;
+	}
+
+	void ecg_kernel_tuner::set_profile(const std::string& path) {
+		std::scoped_lock lock(m_entries_lock);
+		m_profile = path;
+		if (!m_profile.empty()) load_profile(m_profile);
+	}
+
+	std::string ecg_kernel_tuner::get_profile() const {
+		std::scoped_lock lock(m_entries_lock);
+		return m_profile;
+	}
+
+	void ecg_kernel_tuner::reset() {
+		std::scoped_lock lock(m_entries_lock);
+		m_entries.clear();
+	}
+
+	void ecg_kernel_tuner::load_profile(const std::string& path) {
+		std::ifstream file(path);
+		if (!file.is_open()) return;
+
+		// One "<device>/<kernel>/<size class> <local size>" entry per line
+		std::string line;
+		while (std::getline(file, line)) {
+			std::stringstream stream(line);
+			std::string key;
+			size_t local_size = 0;
+			if (!(stream >> key >> local_size) || local_size == 0) continue;
+
+			entry_t entry;
+			entry.local_size = local_size;
+			entry.is_tuned = true;
+			m_entries[key] = std::move(entry);
+		}
+	}
+
+	std::string ecg_kernel_tuner::serialize_profile() const {
+		std::map<std::string, size_t> sorted;
+		for (const auto& [key, entry] : m_entries)
+			if (entry.is_tuned && entry.local_size != 0) sorted[key] = entry.local_size;
+
+		std::stringstream data;
+		for (const auto& [key, local_size] : sorted)
+			data << key << " " << local_size << "\n";
+		return data.str();
+	}
+
+	void ecg_kernel_tuner::save_profile(const std::string& path, const std::string& data) {
+		try {
+			std::filesystem::path profile_path(path);
+			std::error_code ec;
+			if (profile_path.has_parent_path()) std::filesystem::create_directories(profile_path.parent_path(), ec);
+
+			// Same as program binaries, readers never see a partially written profile
+			std::stringstream tmp_name;
+			tmp_name << profile_path.filename().string() << "." << std::this_thread::get_id() << ".tmp";
+			auto tmp_path = profile_path.parent_path() / tmp_name.str();
+
+			{
+				std::ofstream file(tmp_path, std::ios::trunc);
+				if (!file.is_open()) return;
+				file << data;
+				if (!file.good()) {
+					file.close();
+					std::filesystem::remove(tmp_path, ec);
+					return;
+				}
+			}
+
+			std::filesystem::rename(tmp_path, profile_path, ec);
+			if (ec) std::filesystem::remove(tmp_path, ec);
+		}
+		catch (...) {
+			// The profile is an optimization only
+		}
+	}
+}
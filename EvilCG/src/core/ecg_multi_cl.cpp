@@ -0,0 +1,123 @@
+#include <core/ecg_multi_cl.h>
+
+namespace ecg {
+	// Weight of the last measurement in the throughput of a device
+	const double throughput_smoothing = 0.5;
+
+	ecg_multi_cl::~ecg_multi_cl() {
+		// The controller can be already destroyed on exit, so the buffer pool isn't touched here
+		std::scoped_lock lock(m_devices_lock);
+		m_devices.clear();
+	}
+
+	ecg_multi_cl& ecg_multi_cl::get_instance() {
+		static ecg_multi_cl m_instance;
+		return m_instance;
+	}
+
+	cl_int ecg_multi_cl::init(const std::vector<int>& device_ids) {
+		std::vector<std::shared_ptr<ecg_device_ctx_t>> devices;
+		cl_int op_res = CL_SUCCESS;
+
+		for (auto& item : ecg_cl::get_available_devices()) {
+			if (!device_ids.empty() && std::find(device_ids.begin(), device_ids.end(), item.id) == device_ids.end())
+				continue;
+
+			cl_bool is_available = item.device.getInfo<CL_DEVICE_AVAILABLE>();
+			cl_bool is_compiler_available = item.device.getInfo<CL_DEVICE_COMPILER_AVAILABLE>();
+			if (!is_available || !is_compiler_available) continue;
+
+			auto device = std::make_shared<ecg_device_ctx_t>();
+			device->id = item.id;
+			device->device = item.device;
+			device->context = cl::Context(item.device, nullptr, nullptr, nullptr, &op_res);
+			if (op_res != CL_SUCCESS) return op_res;
+
+			device->queue = cl::CommandQueue(device->context, device->device, CL_QUEUE_PROFILING_ENABLE, &op_res);
+			if (op_res != CL_SUCCESS) return op_res;
+
+			cl_uint compute_units = item.device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+			cl_uint max_frequency = item.device.getInfo<CL_DEVICE_MAX_CLOCK_FREQUENCY>();
+			device->score = std::max(1.0, static_cast<double>(compute_units) * max_frequency);
+			device->throughput = 0.0;
+			devices.push_back(device);
+		}
+
+		if (devices.empty()) return CL_DEVICE_NOT_FOUND;
+
+		std::scoped_lock lock(m_devices_lock);
+		m_devices = std::move(devices);
+		return op_res;
+	}
+
+	void ecg_multi_cl::release() noexcept {
+		std::scoped_lock lock(m_devices_lock);
+		if (m_devices.empty()) return;
+
+		// Pooled buffers keep the contexts of the devices alive
+		ecg_cl::get_instance().get_buffer_pool().clear();
+		m_devices.clear();
+	}
+
+	bool ecg_multi_cl::is_init() const {
+		std::scoped_lock lock(m_devices_lock);
+		return !m_devices.empty();
+	}
+
+	std::vector<std::shared_ptr<ecg_device_ctx_t>> ecg_multi_cl::get_devices() const {
+		std::scoped_lock lock(m_devices_lock);
+		return m_devices;
+	}
+
+	void ecg_multi_cl::set_granularity(size_t granularity) {
+		std::scoped_lock lock(m_devices_lock);
+		m_granularity = std::max<size_t>(granularity, 1);
+	}
+
+	size_t ecg_multi_cl::get_granularity() const {
+		std::scoped_lock lock(m_devices_lock);
+		return m_granularity;
+	}
+
+	std::vector<ecg_work_part_t> ecg_multi_cl::split(size_t items_cnt) const {
+		std::scoped_lock lock(m_devices_lock);
+		std::vector<ecg_work_part_t> parts;
+		if (m_devices.empty() || items_cnt == 0) return parts;
+		size_t granularity = m_granularity;
+
+		// Measured and estimated weights can't be mixed, estimates are used until every device was measured
+		bool is_measured = std::all_of(m_devices.begin(), m_devices.end(),
+			[](const auto& device) { return device->throughput > 0.0; });
+
+		std::vector<double> weights;
+		for (const auto& device : m_devices)
+			weights.push_back(is_measured ? device->throughput : device->score);
+		double total_weight = std::accumulate(weights.begin(), weights.end(), 0.0);
+
+		size_t offset = 0;
+		for (size_t device_id = 0; device_id < m_devices.size() && offset < items_cnt; ++device_id) {
+			size_t size = items_cnt - offset;
+
+			if (device_id + 1 < m_devices.size()) {
+				double share = weights[device_id] / total_weight * static_cast<double>(items_cnt);
+				size_t granules = static_cast<size_t>(std::llround(share / static_cast<double>(granularity)));
+
+				// Every device gets some work, otherwise its throughput is never measured
+				size = std::min(std::max<size_t>(granules, 1) * granularity, items_cnt - offset);
+			}
+
+			parts.push_back(ecg_work_part_t{ parts.size(), m_devices[device_id], offset, size });
+			offset += size;
+		}
+
+		return parts;
+	}
+
+	void ecg_multi_cl::update_throughput(ecg_device_ctx_t& device, size_t items_cnt, double time_us) {
+		std::scoped_lock lock(m_devices_lock);
+		double throughput = static_cast<double>(items_cnt) / std::max(time_us, 1.0);
+
+		if (device.throughput <= 0.0) device.throughput = throughput;
+		else device.throughput = throughput_smoothing * throughput + (1.0 - throughput_smoothing) * device.throughput;
+	}
+}
@@ -0,0 +1,331 @@
+#include <core/ecg_profiler.h>
+#include <help/ecg_logger.h>
+
+namespace ecg {
+	thread_local std::shared_ptr<ecg_profiler::call_t> t_current_call;
+
+	ecg_profiler& ecg_profiler::get_instance() {
+		static ecg_profiler instance;
+		return instance;
+	}
+
+	void ecg_profiler::set_enabled(bool enabled) {
+		m_is_enabled = enabled;
+	}
+
+	bool ecg_profiler::is_enabled() const {
+		return m_is_enabled;
+	}
+
+	void ecg_profiler::clear() {
+		std::scoped_lock lock(m_calls_lock);
+		m_calls.clear();
+		m_totals.clear();
+	}
+
+	uint64_t ecg_profiler::now_ns() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	uint64_t ecg_profiler::get_thread_id() {
+		// Small sequential ids keep the rows of the trace readable
+		static std::atomic<uint64_t> next_id = 0;
+		thread_local uint64_t thread_id = ++next_id;
+		return thread_id;
+	}
+
+	std::shared_ptr<ecg_profiler::call_t> ecg_profiler::get_current_call() {
+		return t_current_call;
+	}
+
+	void ecg_profiler::set_current_call(std::shared_ptr<call_t> call) {
+		t_current_call = std::move(call);
+	}
+
+	bool ecg_profiler::is_recording() {
+		return t_current_call != nullptr;
+	}
+
+	std::shared_ptr<ecg_profiler::call_t> ecg_profiler::begin_call(const std::string& name) {
+		if (!m_is_enabled || t_current_call != nullptr) return nullptr;
+
+		auto call = std::make_shared<call_t>();
+		call->name = name;
+		call->thread_id = get_thread_id();
+		call->start_ns = now_ns();
+		t_current_call = call;
+		return call;
+	}
+
+	void ecg_profiler::end_call(const std::shared_ptr<call_t>& call) {
+		if (call == nullptr) return;
+		if (t_current_call == call) t_current_call = nullptr;
+
+		ecg_profiling_stats_t stats = {};
+		{
+			std::scoped_lock lock(call->lock);
+			call->end_ns = now_ns();
+
+			stats.calls = 1;
+			stats.host_time_ns = call->end_ns - call->start_ns;
+			stats.host_to_device_bytes = call->host_to_device_bytes;
+			stats.device_to_host_bytes = call->device_to_host_bytes;
+
+			// The events are released here, the trace keeps only their times
+			for (auto& device_event : call->device_events) {
+				resolve_times(device_event);
+				uint64_t time = device_event.has_times ? device_event.end_ns - device_event.start_ns : 0;
+
+				if (device_event.category == "kernel") {
+					++stats.kernels;
+					stats.kernel_time_ns += time;
+				}
+				else {
+					++stats.transfers;
+					stats.transfer_time_ns += time;
+				}
+			}
+		}
+
+		std::scoped_lock lock(m_calls_lock);
+		auto& totals = m_totals[call->name];
+		totals.calls += stats.calls;
+		totals.kernels += stats.kernels;
+		totals.transfers += stats.transfers;
+		totals.host_to_device_bytes += stats.host_to_device_bytes;
+		totals.device_to_host_bytes += stats.device_to_host_bytes;
+		totals.host_time_ns += stats.host_time_ns;
+		totals.kernel_time_ns += stats.kernel_time_ns;
+		totals.transfer_time_ns += stats.transfer_time_ns;
+
+		m_calls.push_back(call);
+		if (m_calls.size() > max_calls) m_calls.pop_front();
+	}
+
+	void ecg_profiler::resolve_times(device_event_t& device_event) {
+		if (device_event.event() == nullptr) return;
+
+		cl_int err = device_event.event.wait();
+		cl_int err_queued = CL_SUCCESS, err_submit = CL_SUCCESS, err_start = CL_SUCCESS, err_end = CL_SUCCESS;
+		device_event.queued_ns = device_event.event.getProfilingInfo<CL_PROFILING_COMMAND_QUEUED>(&err_queued);
+		device_event.submit_ns = device_event.event.getProfilingInfo<CL_PROFILING_COMMAND_SUBMIT>(&err_submit);
+		device_event.start_ns = device_event.event.getProfilingInfo<CL_PROFILING_COMMAND_START>(&err_start);
+		device_event.end_ns = device_event.event.getProfilingInfo<CL_PROFILING_COMMAND_END>(&err_end);
+
+		// Queues without profiling have no timestamps, such commands are only counted
+		device_event.has_times = err == CL_SUCCESS && err_queued == CL_SUCCESS && err_submit == CL_SUCCESS &&
+			err_start == CL_SUCCESS && err_end == CL_SUCCESS &&
+			device_event.queued_ns <= device_event.start_ns && device_event.start_ns <= device_event.end_ns;
+		device_event.event = cl::Event();
+	}
+
+	void ecg_profiler::add_phase(const std::string& name, uint64_t start_ns, uint64_t end_ns) {
+		auto call = t_current_call;
+		if (call == nullptr) return;
+
+		std::scoped_lock lock(call->lock);
+		call->phases.push_back(phase_t{ name, get_thread_id(), start_ns, end_ns });
+	}
+
+	void ecg_profiler::add_kernel(const std::string& name, const cl::Event& event, uint64_t host_ns) {
+		auto call = t_current_call;
+		if (call == nullptr) return;
+
+		device_event_t device_event;
+		device_event.name = name;
+		device_event.category = "kernel";
+		device_event.host_ns = host_ns;
+		device_event.event = event;
+
+		std::scoped_lock lock(call->lock);
+		call->device_events.push_back(std::move(device_event));
+	}
+
+	void ecg_profiler::add_transfer(bool to_device, size_t bytes, const cl::Event* event, uint64_t host_ns) {
+		auto call = t_current_call;
+		if (call == nullptr) return;
+
+		std::scoped_lock lock(call->lock);
+		if (to_device) call->host_to_device_bytes += bytes;
+		else call->device_to_host_bytes += bytes;
+
+		// Buffers created from host memory are copied without an event
+		if (event == nullptr) return;
+
+		device_event_t device_event;
+		device_event.name = to_device ? "write_buffer" : "read_buffer";
+		device_event.category = to_device ? "write" : "read";
+		device_event.bytes = bytes;
+		device_event.host_ns = host_ns;
+		device_event.event = *event;
+		call->device_events.push_back(std::move(device_event));
+	}
+
+	cl_int ecg_profiler::write_buffer(const cl::CommandQueue& queue, const cl::Buffer& buffer, cl_bool blocking,
+		size_t offset, size_t size, const void* ptr, const std::vector<cl::Event>* events, cl::Event* event
+	) {
+		if (!is_recording()) return queue.enqueueWriteBuffer(buffer, blocking, offset, size, ptr, events, event);
+
+		uint64_t host_ns = now_ns();
+		cl::Event write_event;
+		cl_int result = queue.enqueueWriteBuffer(buffer, blocking, offset, size, ptr, events, &write_event);
+		if (result == CL_SUCCESS) add_transfer(true, size, &write_event, host_ns);
+		if (event != nullptr) *event = write_event;
+		return result;
+	}
+
+	cl_int ecg_profiler::read_buffer(const cl::CommandQueue& queue, const cl::Buffer& buffer, cl_bool blocking,
+		size_t offset, size_t size, void* ptr, const std::vector<cl::Event>* events, cl::Event* event
+	) {
+		if (!is_recording()) return queue.enqueueReadBuffer(buffer, blocking, offset, size, ptr, events, event);
+
+		uint64_t host_ns = now_ns();
+		cl::Event read_event;
+		cl_int result = queue.enqueueReadBuffer(buffer, blocking, offset, size, ptr, events, &read_event);
+		if (result == CL_SUCCESS) add_transfer(false, size, &read_event, host_ns);
+		if (event != nullptr) *event = read_event;
+		return result;
+	}
+
+	ecg_profiling_stats_t ecg_profiler::get_stats(const std::string& name) const {
+		std::scoped_lock lock(m_calls_lock);
+		ecg_profiling_stats_t result = {};
+
+		for (const auto& [call_name, totals] : m_totals) {
+			if (!name.empty() && call_name != name) continue;
+
+			result.calls += totals.calls;
+			result.kernels += totals.kernels;
+			result.transfers += totals.transfers;
+			result.host_to_device_bytes += totals.host_to_device_bytes;
+			result.device_to_host_bytes += totals.device_to_host_bytes;
+			result.host_time_ns += totals.host_time_ns;
+			result.kernel_time_ns += totals.kernel_time_ns;
+			result.transfer_time_ns += totals.transfer_time_ns;
+		}
+
+		return result;
+	}
+
+	void ecg_profiler::log_stats() const {
+		std::map<std::string, ecg_profiling_stats_t> totals;
+		{
+			std::scoped_lock lock(m_calls_lock);
+			totals = m_totals;
+		}
+
+		auto to_ms = [](uint64_t time_ns) { return static_cast<double>(time_ns) / 1e6; };
+
+		std::scoped_lock lock(g_ecg_logger_mutex);
+		auto logger = g_ecg_logger != nullptr ? g_ecg_logger : spdlog::default_logger();
+		if (logger == nullptr) return;
+
+		for (const auto& [name, stats] : totals) {
+			logger->info("[profile] {}: calls = {}, host = {:.3f} ms, kernels = {} ({:.3f} ms), copies = {} ({:.3f} ms), "
+				"host->device = {} B, device->host = {} B",
+				name, stats.calls, to_ms(stats.host_time_ns),
+				stats.kernels, to_ms(stats.kernel_time_ns),
+				stats.transfers, to_ms(stats.transfer_time_ns),
+				stats.host_to_device_bytes, stats.device_to_host_bytes);
+		}
+	}
+
+	bool ecg_profiler::save_trace(const std::string& path) const {
+		std::vector<std::shared_ptr<call_t>> calls;
+		{
+			std::scoped_lock lock(m_calls_lock);
+			calls.assign(m_calls.begin(), m_calls.end());
+		}
+
+		std::ofstream file(path, std::ios::trunc);
+		if (!file.is_open()) return false;
+
+		uint64_t epoch_ns = UINT64_MAX;
+		for (const auto& call : calls) epoch_ns = std::min(epoch_ns, call->start_ns);
+
+		auto to_us = [epoch_ns](uint64_t time_ns) { return static_cast<double>(time_ns - epoch_ns) / 1e3; };
+		auto escape = [](const std::string& str) {
+			std::string result;
+			for (char ch : str) {
+				if (ch == '"' || ch == '\\') result.push_back('\\');
+				if (static_cast<unsigned char>(ch) >= 0x20) result.push_back(ch);
+			}
+			return result;
+		};
+
+		constexpr int host_pid = 1;
+		constexpr int device_pid = 2;
+
+		file << std::fixed << std::setprecision(3);
+		file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << host_pid << ",\"args\":{\"name\":\"host\"}},\n";
+		file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << device_pid << ",\"args\":{\"name\":\"device\"}}";
+
+		for (const auto& call : calls) {
+			std::scoped_lock lock(call->lock);
+			std::string call_name = escape(call->name);
+
+			file << ",\n{\"name\":\"" << call_name << "\",\"cat\":\"call\",\"ph\":\"X\",\"pid\":" << host_pid
+				<< ",\"tid\":" << call->thread_id << ",\"ts\":" << to_us(call->start_ns)
+				<< ",\"dur\":" << static_cast<double>(call->end_ns - call->start_ns) / 1e3
+				<< ",\"args\":{\"host_to_device_bytes\":" << call->host_to_device_bytes
+				<< ",\"device_to_host_bytes\":" << call->device_to_host_bytes << "}}";
+
+			for (const auto& phase : call->phases) {
+				file << ",\n{\"name\":\"" << escape(phase.name) << "\",\"cat\":\"phase\",\"ph\":\"X\",\"pid\":" << host_pid
+					<< ",\"tid\":" << phase.thread_id << ",\"ts\":" << to_us(phase.start_ns)
+					<< ",\"dur\":" << static_cast<double>(phase.end_ns - phase.start_ns) / 1e3
+					<< ",\"args\":{\"call\":\"" << call_name << "\"}}";
+			}
+
+			// Device clocks have their own epoch, commands are placed relative to the time they were enqueued
+			for (const auto& device_event : call->device_events) {
+				if (!device_event.has_times) continue;
+
+				uint64_t start_ns = device_event.host_ns + (device_event.start_ns - device_event.queued_ns);
+				file << ",\n{\"name\":\"" << escape(device_event.name) << "\",\"cat\":\"" << device_event.category
+					<< "\",\"ph\":\"X\",\"pid\":" << device_pid << ",\"tid\":" << call->thread_id
+					<< ",\"ts\":" << to_us(start_ns)
+					<< ",\"dur\":" << static_cast<double>(device_event.end_ns - device_event.start_ns) / 1e3
+					<< ",\"args\":{\"call\":\"" << call_name << "\",\"bytes\":" << device_event.bytes
+					<< ",\"queued_ns\":" << device_event.queued_ns << ",\"submit_ns\":" << device_event.submit_ns
+					<< ",\"start_ns\":" << device_event.start_ns << ",\"end_ns\":" << device_event.end_ns << "}}";
+			}
+		}
+
+		file << "\n]}\n";
+		return file.good();
+	}
+
+	ecg_profile_scope::ecg_profile_scope(const char* name) : m_name(name) {
+		auto& profiler = ecg_profiler::get_instance();
+		if (!profiler.is_enabled() && !ecg_profiler::is_recording()) return;
+
+		m_call = profiler.begin_call(name);
+		if (m_call == nullptr && ecg_profiler::is_recording()) {
+			m_is_phase = true;
+			m_start_ns = ecg_profiler::now_ns();
+		}
+	}
+
+	ecg_profile_scope::~ecg_profile_scope() {
+		try {
+			if (m_call != nullptr) ecg_profiler::get_instance().end_call(m_call);
+			else if (m_is_phase) ecg_profiler::add_phase(m_name, m_start_ns, ecg_profiler::now_ns());
+		}
+		catch (...) {
+			// Profiling never fails the call
+		}
+	}
+
+	ecg_profile_attach::ecg_profile_attach(std::shared_ptr<ecg_profiler::call_t> call) :
+		m_previous(ecg_profiler::get_current_call())
+	{
+		ecg_profiler::set_current_call(std::move(call));
+	}
+
+	ecg_profile_attach::~ecg_profile_attach() {
+		ecg_profiler::set_current_call(std::move(m_previous));
+	}
+}
@@ -6,23 +6,44 @@ namespace ecg {
 		cl::Program::Sources& sources, std::string name
 	) {
 		static std::unordered_map<std::string, std::shared_ptr<ecg_program_wrapper>> cache;
-		auto it = cache.find(name);
+		static std::mutex cache_lock;
+
+		// Programs of the same name are built for every context they are used in
+		std::stringstream key;
+		key << name << "@" << context();
+
+		std::scoped_lock lock(cache_lock);
+		auto it = cache.find(key.str());
 		if (it != cache.end()) return it->second;
 
 		auto prog = std::make_shared<ecg_program_wrapper>(context, device, sources);
-		cache[name] = prog;
+		cache[key.str()] = prog;
 		return prog;
 	}
 
+	const std::string g_build_options = "";
+
+	std::string ecg_program_wrapper::m_cache_dir;
+	std::mutex ecg_program_wrapper::m_cache_dir_lock;
+
 	ecg_program_wrapper::ecg_program_wrapper(
 		cl::Context& context, cl::Device& device, cl::Program::Sources& sources
-	) : m_device(device), m_is_built(false) {
+	) : m_device(device), m_is_built(false), m_is_from_cache(false) {
 		try {
+			std::filesystem::path binary_path;
+			std::string cache_dir = get_cache_dir();
+			if (!cache_dir.empty()) {
+				binary_path = std::filesystem::path(cache_dir) / (get_cache_key(m_device, g_build_options, sources) + ".bin");
+				m_is_from_cache = load_binary(context, binary_path);
+				m_is_built = m_is_from_cache;
+				if (m_is_built) return;
+			}
+
 			cl_int err = CL_SUCCESS;
 			m_program = cl::Program(context, sources, &err);
 			if (err != CL_SUCCESS) return;
 
-			err = m_program.build(m_device);
+			err = m_program.build(m_device, g_build_options.c_str());
 			m_is_built = (err == CL_SUCCESS);
 
 			if (!m_is_built) {
@@ -31,6 +52,9 @@ namespace ecg {
 					<< m_device.getInfo<CL_DEVICE_NAME>() << "\n"
 					<< log << std::endl;
 			}
+			else if (!binary_path.empty()) {
+				save_binary(binary_path);
+			}
 		}
 		catch (const std::exception& e) {
 			std::cerr << "[Exception] OpenCL build failed: " << e.what() << std::endl;
@@ -42,11 +66,172 @@ namespace ecg {
 		}
 	}
 
+	void ecg_program_wrapper::set_cache_dir(const std::string& path) {
+		std::scoped_lock lock(m_cache_dir_lock);
+		m_cache_dir = path;
+	}
+
+	std::string ecg_program_wrapper::get_cache_dir() {
+		std::scoped_lock lock(m_cache_dir_lock);
+		return m_cache_dir;
+	}
+
+	std::string ecg_program_wrapper::get_cache_key(cl::Device& device, const std::string& options, cl::Program::Sources& sources) {
+		// FNV-1a over everything that changes the compiled binary
+		uint64_t hash = 14695981039346656037ull;
+		auto add = [&hash](const std::string& str) {
+			for (unsigned char ch : str) {
+				hash ^= ch;
+				hash *= 1099511628211ull;
+			}
+
+			hash ^= 0xff;
+			hash *= 1099511628211ull;
+		};
+
+		add(device.getInfo<CL_DEVICE_NAME>());
+		add(device.getInfo<CL_DRIVER_VERSION>());
+		add(options);
+		for (const auto& src : sources) add(std::string(src.begin(), src.end()));
+
+		std::stringstream key;
+		key << std::hex << std::setw(16) << std::setfill('0') << hash;
+		return key.str();
+	}
+
+	bool ecg_program_wrapper::load_binary(cl::Context& context, const std::filesystem::path& path) {
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open()) return false;
+
+		std::vector<unsigned char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		if (binary.empty()) return false;
+
+		try {
+			cl_int err = CL_SUCCESS;
+			std::vector<cl_int> binary_status;
+			cl::Program program(context, { m_device }, cl::Program::Binaries{ binary }, &binary_status, &err);
+			if (err != CL_SUCCESS) return false;
+
+			err = program.build(m_device, g_build_options.c_str());
+			if (err != CL_SUCCESS) return false;
+
+			m_program = program;
+			return true;
+		}
+		catch (...) {
+			// Stale or foreign binary, the caller rebuilds from sources
+			return false;
+		}
+	}
+
+	void ecg_program_wrapper::save_binary(const std::filesystem::path& path) {
+		try {
+			auto binaries = m_program.getInfo<CL_PROGRAM_BINARIES>();
+			if (binaries.empty() || binaries[0].empty()) return;
+
+			std::error_code ec;
+			std::filesystem::create_directories(path.parent_path(), ec);
+
+			// Write to a unique temporary file first, so concurrent processes never see a partial binary
+			std::stringstream tmp_name;
+			tmp_name << path.filename().string() << "." << std::this_thread::get_id() << ".tmp";
+			auto tmp_path = path.parent_path() / tmp_name.str();
+
+			{
+				std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+				if (!file.is_open()) return;
+				file.write(reinterpret_cast<const char*>(binaries[0].data()), binaries[0].size());
+				if (!file.good()) {
+					file.close();
+					std::filesystem::remove(tmp_path, ec);
+					return;
+				}
+			}
+
+			std::filesystem::rename(tmp_path, path, ec);
+			if (ec) std::filesystem::remove(tmp_path, ec);
+		}
+		catch (...) {
+			// The disk cache is an optimization only
+		}
+	}
+
 	const bool ecg_program_wrapper::is_program_was_built() const {
 		return m_is_built;
 	}
 
+	const bool ecg_program_wrapper::is_program_loaded_from_cache() const {
+		return m_is_from_cache;
+	}
+
 	cl::Program ecg_program_wrapper::get_program() const {
 		return m_program;
 	}
+
+	std::shared_ptr<ecg_bound_kernel> ecg_program_wrapper::get_kernel(const std::string& kernel_name) {
+		std::unique_ptr<ecg_bound_kernel> kernel;
+
+		{
+			std::scoped_lock lock(m_free_kernels->lock);
+			auto& kernels = m_free_kernels->kernels[kernel_name];
+			if (!kernels.empty()) {
+				kernel = std::move(kernels.back());
+				kernels.pop_back();
+			}
+		}
+
+		if (kernel == nullptr) {
+			cl_int err = CL_SUCCESS;
+			kernel = std::make_unique<ecg_bound_kernel>(m_program, kernel_name, &err);
+			if (err != CL_SUCCESS) return nullptr;
+		}
+
+		// Arguments are copied when the kernel is enqueued, so the kernel is free again right after it
+		std::weak_ptr<free_kernels_t> free_kernels = m_free_kernels;
+		return std::shared_ptr<ecg_bound_kernel>(kernel.release(), [free_kernels, kernel_name](ecg_bound_kernel* leased) {
+			std::unique_ptr<ecg_bound_kernel> owned(leased);
+			auto kernels = free_kernels.lock();
+			if (kernels == nullptr) return;
+
+			std::scoped_lock lock(kernels->lock);
+			kernels->kernels[kernel_name].push_back(std::move(owned));
+		});
+	}
+
+	cl_int ecg_program_wrapper::enqueue_tuned(ecg_cmd_chain& chain, ecg_bound_kernel& kernel, const std::string& kernel_name, size_t items_cnt) {
+		auto& tuner = ecg_kernel_tuner::get_instance();
+		auto launch = tuner.get_launch(m_device, kernel.get_kernel(), kernel_name, items_cnt);
+		if (launch.local_size == 0) return kernel.enqueue(chain, cl::NDRange(items_cnt), cl::NullRange);
+
+		cl::Event event;
+		size_t global_size = (items_cnt + launch.local_size - 1) / launch.local_size * launch.local_size;
+		cl_int result = kernel.enqueue(chain, cl::NDRange(global_size), cl::NDRange(launch.local_size), cl::NullRange, &event);
+		if (result == CL_SUCCESS) tuner.add_sample(launch, event, global_size);
+		return result;
+	}
+
+	ecg_bound_kernel::ecg_bound_kernel(const cl::Program& program, const std::string& kernel_name, cl_int* err) :
+		m_name(kernel_name)
+	{
+		m_kernel = cl::Kernel(program, kernel_name.c_str(), err);
+	}
+
+	cl_int ecg_bound_kernel::enqueue(ecg_cmd_chain& chain, const cl::NDRange& global_range, const cl::NDRange& local_range,
+		const cl::NDRange& offset_range, cl::Event* event
+	) {
+		uint64_t host_ns = ecg_profiler::is_recording() ? ecg_profiler::now_ns() : 0;
+		cl::Event kernel_event;
+		cl_int result = chain.get_queue().enqueueNDRangeKernel(m_kernel, offset_range, global_range, local_range,
+			chain.get_wait_list(), &kernel_event);
+		if (result != CL_SUCCESS) return result;
+
+		chain.push(kernel_event);
+		if (host_ns != 0) ecg_profiler::add_kernel(m_name, kernel_event, host_ns);
+		if (event != nullptr) *event = kernel_event;
+		return CL_SUCCESS;
+	}
+
+	cl::Kernel& ecg_bound_kernel::get_kernel() {
+		return m_kernel;
+	}
 }
\ No newline at end of file
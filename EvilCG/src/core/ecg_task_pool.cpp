@@ -0,0 +1,41 @@
+#include <core/ecg_task_pool.h>
+
+namespace ecg {
+	ecg_task_pool::ecg_task_pool() : m_is_stopped(false) {
+		size_t threads_count = std::max<size_t>(2, std::thread::hardware_concurrency());
+		for (size_t id = 0; id < threads_count; ++id)
+			m_workers.emplace_back([this] { worker_loop(); });
+	}
+
+	ecg_task_pool::~ecg_task_pool() {
+		{
+			std::scoped_lock lock(m_tasks_lock);
+			m_is_stopped = true;
+		}
+
+		m_tasks_cv.notify_all();
+		for (auto& worker : m_workers)
+			if (worker.joinable()) worker.join();
+	}
+
+	size_t ecg_task_pool::get_threads_count() const {
+		return m_workers.size();
+	}
+
+	void ecg_task_pool::worker_loop() {
+		while (true) {
+			std::function<void()> task;
+
+			{
+				std::unique_lock lock(m_tasks_lock);
+				m_tasks_cv.wait(lock, [this] { return m_is_stopped || !m_tasks.empty(); });
+				if (m_is_stopped && m_tasks.empty()) return;
+
+				task = std::move(m_tasks.front());
+				m_tasks.pop_front();
+			}
+
+			task();
+		}
+	}
+}
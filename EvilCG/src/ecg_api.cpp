@@ -1,6 +1,7 @@
 #include <ecg_api.h>
 
 #include <core/ecg_cl_programs.h>
+#include <core/ecg_cpu.h>
 #include <core/ecg_host_ctrl.h>
 #include <core/ecg_internal.h>
 #include <core/ecg_program.h>
@@ -13,6 +14,9 @@
 #include <help/ecg_geom.h>
 
 namespace ecg {
+	// AUTO is resolved on every call, so releasing the controller switches to the host
+	std::atomic<ecg_backend> g_ecg_backend = ECG_BACKEND_AUTO;
+
 	void set_logger(std::shared_ptr<spdlog::logger> ptr) {
 		std::scoped_lock lock(g_ecg_logger_mutex);
 		g_ecg_logger = ptr;
@@ -23,19 +27,274 @@ namespace ecg {
 		mem.delete_memory(handler);
 	}
 	
+	void cleanup(const ecg_adjacency_t& adjacency) {
+		auto& mem = ecg_mem::get_instance();
+		for (const auto* list : { &adjacency.vertex_faces, &adjacency.face_faces, &adjacency.vertex_vertexes }) {
+			if (list->offsets.handler != 0) mem.delete_memory(list->offsets.handler);
+			if (list->ids.handler != 0) mem.delete_memory(list->ids.handler);
+		}
+	}
+
 	void cleanup_all() {
 		auto& mem = ecg_mem::get_instance();
 		mem.delete_all_memory();
 	}
 
+	void set_program_cache_dir(const char* path) {
+		ecg_program_wrapper::set_cache_dir(path != nullptr ? path : "");
+	}
+
+	void set_autotuning(bool enabled) {
+		ecg_kernel_tuner::get_instance().set_enabled(enabled);
+	}
+
+	bool is_autotuning() {
+		return ecg_kernel_tuner::get_instance().is_enabled();
+	}
+
+	void set_tuning_profile(const char* path) {
+		ecg_kernel_tuner::get_instance().set_profile(path != nullptr ? path : "");
+	}
+
+	void set_profiling(bool enabled) {
+		ecg_profiler::get_instance().set_enabled(enabled);
+	}
+
+	bool is_profiling() {
+		return ecg_profiler::get_instance().is_enabled();
+	}
+
+	void clear_profiling() {
+		ecg_profiler::get_instance().clear();
+	}
+
+	ecg_profiling_stats_t get_profiling_stats(const char* call_name) {
+		return ecg_profiler::get_instance().get_stats(call_name != nullptr ? call_name : "");
+	}
+
+	void log_profiling_stats() {
+		ecg_profiler::get_instance().log_stats();
+	}
+
+	void save_profiling_trace(const char* filename, ecg_status* status) {
+		ecg_status_handler op_res;
+
+		try {
+			if (filename == nullptr || filename[0] == '\0') op_res = ecg_status_code::INVALID_ARG;
+			if (!ecg_profiler::get_instance().save_trace(filename)) op_res = ecg_status_code::RUNTIME_ERROR;
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+		}
+	}
+
+	void set_thread_safe_mode(bool enabled) {
+		ecg_cl::get_instance().set_thread_safe_mode(enabled);
+	}
+
+	bool is_thread_safe_mode() {
+		return ecg_cl::get_instance().is_thread_safe_mode();
+	}
+
+	void set_zero_copy_mode(bool enabled) {
+		ecg_cl::get_instance().set_zero_copy_mode(enabled);
+	}
+
+	bool is_zero_copy_mode() {
+		return ecg_cl::get_instance().is_zero_copy_mode();
+	}
+
+	void set_backend(ecg_backend backend) {
+		g_ecg_backend = backend;
+	}
+
+	ecg_backend get_backend() {
+		return g_ecg_backend;
+	}
+
+	ecg_backend get_active_backend() {
+		ecg_backend backend = g_ecg_backend;
+		if (backend != ECG_BACKEND_AUTO) return backend;
+		return ecg_cl::get_instance().is_init() ? ECG_BACKEND_OPENCL : ECG_BACKEND_CPU;
+	}
+
+	void set_buffer_pool_limit(size_t max_bytes) {
+		ecg_cl::get_instance().get_buffer_pool().set_limit(max_bytes);
+	}
+
+	void trim_buffer_pool(size_t max_bytes) {
+		ecg_cl::get_instance().get_buffer_pool().trim(max_bytes);
+	}
+
+	ecg_buffer_pool_stats_t get_buffer_pool_stats() {
+		return ecg_cl::get_instance().get_buffer_pool().get_stats();
+	}
+
+	void prewarm_all_programs(ecg_status* status) {
+		ecg_profile_scope profile_scope("prewarm_all_programs");
+		auto& ctrl = ecg_cl::get_instance();
+		auto& context = ctrl.get_context();
+		auto& dev = ctrl.get_device();
+		ecg_status_handler op_res;
+
+		try {
+			if (status != nullptr) *status = ecg_status_code::SUCCESS;
+
+			// Build everything first, a single broken program shouldn't stop the others
+			bool all_built = true;
+			for (const auto& [name, program_sources] : api_programs) {
+				cl::Program::Sources sources(program_sources.begin(), program_sources.end());
+				auto program = ecg_program_wrapper::get_program(context, dev, sources, name);
+				all_built &= program->is_program_was_built();
+			}
+
+			if (!all_built) op_res = ecg_status_code::OPENCL_ERROR;
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+		}
+	}
+
+	ecg_uploaded_mesh_t upload_mesh(const ecg_mesh_t* mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("upload_mesh");
+		auto& mem_inst = ecg_mem::get_instance();
+		ecg_uploaded_mesh_t result;
+		ecg_status_handler op_res;
+
+		try {
+			default_mesh_check(mesh, op_res, status);
+
+			auto handle_data = mem_inst.allocate<ecg_cl_mesh_t>();
+			if (handle_data.ptr == nullptr) op_res = ecg_status_code::RUNTIME_ERROR;
+
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			*handle_data.ptr = allocate_cl_mesh(chain, mesh, op_res, false);
+			result.handler = handle_data.handle;
+			op_res = chain.wait();
+			result.vertexes_size = mesh->vertexes_size;
+			result.indexes_size = mesh->indexes_size;
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+			if (result.handler != 0) mem_inst.delete_memory(result.handler);
+			result = ecg_uploaded_mesh_t();
+		}
+
+		return result;
+	}
+
+	void update_uploaded_mesh(ecg_uploaded_mesh_t* uploaded_mesh, const ecg_mesh_t* mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("update_uploaded_mesh");
+		ecg_status_handler op_res;
+
+		try {
+			if (uploaded_mesh == nullptr) op_res = ecg_status_code::INVALID_ARG;
+			default_mesh_check(mesh, op_res, status);
+
+			auto cl_mesh = get_cl_mesh(*uploaded_mesh, op_res);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			update_cl_mesh(chain, *cl_mesh, mesh, op_res);
+			op_res = chain.wait();
+
+			uploaded_mesh->vertexes_size = mesh->vertexes_size;
+			uploaded_mesh->indexes_size = mesh->indexes_size;
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+		}
+	}
+
+	vec3_base internal_get_center(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res) {
+		vec3_base acc = internal_sum_vertexes(chain, mesh, op_res);
+		return acc / static_cast<float>(mesh.vertexes_size);
+	}
+
+	vec3_base internal_sum_vertexes(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res) {
+		vec3_base result;
+		internal_enqueue_sum_vertexes(chain, mesh, &result, op_res);
+		op_res = chain.wait();
+		return result;
+	}
+
+	void internal_enqueue_sum_vertexes(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, vec3_base* result, ecg_status_handler& op_res) {
+		auto& ctrl = ecg_cl::get_instance();
+		auto& context = ctrl.get_context();
+		auto& dev = ctrl.get_device();
+
+		cl::Program::Sources sources = { summ_vertexes_code };
+		auto program = ecg_program_wrapper::get_program(context, dev, sources, summ_vertexes_name);
+		auto kernel = program->get_kernel(summ_vertexes_name);
+
+		// The tree reduction needs a power of two group, the local accumulator of the kernel limits its size
+		auto& tuner = ecg_kernel_tuner::get_instance();
+		ecg_tuned_launch_t launch;
+		size_t group_size = summ_vertexes_max_group_size;
+		if (kernel != nullptr) {
+			launch = tuner.get_launch(dev, kernel->get_kernel(), summ_vertexes_name, mesh.vertexes_size, true, summ_vertexes_max_group_size);
+			group_size = launch.local_size != 0 ? std::min(launch.local_size, summ_vertexes_max_group_size) :
+				std::min(group_size, std::bit_floor(kernel->get_kernel().getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(dev)));
+		}
+
+		// Work items sweep the mesh with the stride of the range, so the partial sums fit one group for the final pass
+		const size_t max_groups_cnt = std::min(
+			std::max<size_t>(dev.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>(), 1) * summ_vertexes_groups_per_unit, group_size);
+		const size_t groups_cnt = std::clamp<size_t>((mesh.vertexes_size + group_size - 1) / group_size, 1, max_groups_cnt);
+
+		cl_int err_create_buffer = CL_SUCCESS;
+		ecg_pooled_buffer partials_buffer = ctrl.get_buffer_pool().acquire(chain, CL_MEM_READ_WRITE, groups_cnt * sizeof(vec3_base), &err_create_buffer); op_res = err_create_buffer;
+		ecg_pooled_buffer res_buffer = ctrl.get_buffer_pool().acquire(chain, CL_MEM_READ_WRITE, sizeof(vec3_base), &err_create_buffer); op_res = err_create_buffer;
+
+		cl::NDRange global = groups_cnt * group_size;
+		cl::NDRange final_global = group_size;
+		cl::NDRange local = group_size;
+
+		op_res = program->execute(
+			chain, summ_vertexes_name, global, local,
+			mesh.vertexes_buffer, static_cast<cl_uint>(mesh.vertexes_size), partials_buffer
+		);
+
+		// The first pass reads the whole mesh, its time decides the group size
+		if (launch.is_sample) {
+			cl::Event event;
+			op_res = chain.get_last_event(&event);
+			tuner.add_sample(launch, event, groups_cnt * group_size);
+		}
+
+		// The final pass reduces the partial sums in one group, nothing returns to the host in between
+		op_res = program->execute(
+			chain, summ_vertexes_name, final_global, local,
+			partials_buffer, static_cast<cl_uint>(groups_cnt), res_buffer
+		);
+
+		op_res = chain.read_buffer(res_buffer, 0, sizeof(vec3_base), result);
+	}
+
 	vec3_base get_center(const ecg_mesh_t* mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("get_center");
 		ecg_status_handler op_res;
 
 		try {
 			default_mesh_check(mesh, op_res, status);
-			vec3_base acc = sum_vertexes(mesh, status); 
-			if (status != nullptr) op_res = *status;
-			return acc / mesh->vertexes_size;
+			if (get_active_backend() == ECG_BACKEND_CPU) return cpu::get_center(mesh, op_res);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+			return internal_get_center(chain, cl_mesh, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+		}
+
+		return vec3_base();
+	}
+
+	vec3_base get_center(const ecg_uploaded_mesh_t& mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("get_center");
+		ecg_status_handler op_res;
+
+		try {
+			auto cl_mesh = uploaded_mesh_check(mesh, op_res, status);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			return internal_get_center(chain, *cl_mesh, op_res);
 		}
 		catch (...) {
 			on_unknown_exception(op_res, status);
@@ -45,65 +304,33 @@ namespace ecg {
 	}
 
 	vec3_base sum_vertexes(const ecg_mesh_t* mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("sum_vertexes");
 		ecg_status_handler op_res;
 		vec3_base result;
 
 		try {
 			default_mesh_check(mesh, op_res, status);
+			if (get_active_backend() == ECG_BACKEND_CPU) return cpu::sum_vertexes(mesh, op_res);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+			result = internal_sum_vertexes(chain, cl_mesh, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+		}
 
-			auto& ctrl = ecg_cl::get_instance();
-			auto& queue = ctrl.get_cmd_queue();
-			auto& context = ctrl.get_context();
-			auto& dev = ctrl.get_device();
+		return result;
+	}
 
-			const size_t max_work_group_size = ctrl.get_max_work_group_size();
-			cl::Program::Sources sources = { summ_vertexes_code };
-			auto program = ecg_program_wrapper::get_program(context, dev, sources, summ_vertexes_name);
-
-			auto internal_summ = [&](const vec3_base* data, cl_int data_size) {
-				const float temp_groups = static_cast<float>(data_size) / max_work_group_size;
-				const size_t work_groups = std::ceil(temp_groups);
-
-				constexpr cl_int vert_sz = sizeof(vec3_base) / sizeof(float);
-				constexpr size_t item_sz = sizeof(data[0]);
-
-				const size_t accumulator_buffer_size = work_groups * max_work_group_size * item_sz;
-				const size_t vertexes_buffer_size = data_size * item_sz;
-				const size_t result_buffer_size = work_groups * item_sz;
-				std::vector<vec3_base> result;
-				result.resize(work_groups);
-
-				cl_int err_create_buffer = CL_SUCCESS;
-				cl::Buffer acc_buffer  = cl::Buffer(context, CL_MEM_READ_WRITE, accumulator_buffer_size, nullptr, &err_create_buffer); op_res = err_create_buffer;
-				cl::Buffer vert_buffer = cl::Buffer(context, CL_MEM_READ_ONLY,  vertexes_buffer_size,    nullptr, &err_create_buffer); op_res = err_create_buffer;
-				cl::Buffer res_buffer  = cl::Buffer(context, CL_MEM_WRITE_ONLY, result_buffer_size,      nullptr, &err_create_buffer); op_res = err_create_buffer;
-
-				cl::NDRange local = max_work_group_size;
-				cl::NDRange global = work_groups * max_work_group_size;
-
-				op_res = queue.enqueueFillBuffer(res_buffer, (cl_int(0)), 0, result_buffer_size);
-				op_res = queue.enqueueFillBuffer(acc_buffer, (cl_int(0)), 0, accumulator_buffer_size);
-				op_res = queue.enqueueWriteBuffer(vert_buffer, CL_FALSE, 0, vertexes_buffer_size, data);
-				op_res = queue.finish();
-
-				op_res = program->execute(
-					queue, summ_vertexes_name, global, local, 
-					data_size, vert_sz,
-					vert_buffer, acc_buffer,
-					res_buffer
-				);
-
-				op_res = queue.enqueueReadBuffer(res_buffer, CL_FALSE, 0, result_buffer_size, result.data());
-				queue.finish();
-				return result;
-			};
-			
-			std::vector<vec3_base> acc_vector;
-			acc_vector = internal_summ(mesh->vertexes, mesh->vertexes_size);
-			while (acc_vector.size() > 1) {
-				acc_vector = std::move(internal_summ(acc_vector.data(), acc_vector.size()));
-			}
-			result = acc_vector[0];
+	vec3_base sum_vertexes(const ecg_uploaded_mesh_t& mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("sum_vertexes");
+		ecg_status_handler op_res;
+		vec3_base result;
+
+		try {
+			auto cl_mesh = uploaded_mesh_check(mesh, op_res, status);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			result = internal_sum_vertexes(chain, *cl_mesh, op_res);
 		}
 		catch (...) {
 			on_unknown_exception(op_res, status);
@@ -112,55 +339,276 @@ namespace ecg {
 		return result;
 	}
 
+	/// <summary>
+	/// Launch of the faces areas kernels, every group sums one chunk of faces.
+	/// </summary>
+	struct faces_areas_launch_t {
+		std::shared_ptr<ecg_program_wrapper> program;
+		size_t group_size = 0;
+		size_t chunks_cnt = 0;
+		size_t chunk_size = 0;
+	};
+
+	faces_areas_launch_t get_faces_areas_launch(cl::Context& context, cl::Device& dev, size_t faces_cnt) {
+		cl::Program::Sources sources = { compute_faces_areas_code };
+		auto program = ecg_program_wrapper::get_program(context, dev, sources, compute_faces_areas_name);
+		auto kernel = program->get_kernel(compute_faces_areas_name);
+
+		// Local arrays of the kernels are sized for the default group, smaller groups have to be powers of two
+		faces_areas_launch_t launch;
+		launch.program = program;
+		launch.group_size = faces_areas_group_size;
+		if (kernel != nullptr)
+			launch.group_size = std::min(launch.group_size, std::bit_floor(kernel->get_kernel().getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(dev)));
+
+		// The split into chunks depends only on the device and the number of faces, so the sums are reproducible
+		const size_t max_chunks_cnt = std::max<size_t>(dev.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>(), 1) * faces_areas_groups_per_unit;
+		launch.chunks_cnt = std::clamp<size_t>((faces_cnt + launch.group_size - 1) / launch.group_size, 1, max_chunks_cnt);
+		launch.chunk_size = std::max<size_t>((faces_cnt + launch.chunks_cnt - 1) / launch.chunks_cnt, 1);
+		launch.chunks_cnt = std::max<size_t>((faces_cnt + launch.chunk_size - 1) / launch.chunk_size, 1);
+		return launch;
+	}
+
+	float internal_compute_surface_area(ecg_cmd_chain& chain, cl::Device& dev,
+		const cl::Buffer& vertexes_buffer, const cl::Buffer& indexes_buffer, cl_uint first_face, cl_uint last_face, ecg_status_handler& op_res
+	) {
+		float result = -FLT_MAX;
+		internal_enqueue_surface_area(chain, dev, vertexes_buffer, indexes_buffer, first_face, last_face, &result, op_res);
+		op_res = chain.wait();
+		return result;
+	}
+
+	void internal_enqueue_surface_area(ecg_cmd_chain& chain, cl::Device& dev,
+		const cl::Buffer& vertexes_buffer, const cl::Buffer& indexes_buffer, cl_uint first_face, cl_uint last_face, float* result, ecg_status_handler& op_res
+	) {
+		auto& buffer_pool = ecg_cl::get_instance().get_buffer_pool();
+		auto launch = get_faces_areas_launch(chain.get_context(), dev, last_face - first_face);
+
+		cl_int err_create_buffer = CL_SUCCESS;
+		ecg_pooled_buffer chunk_sums_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(float) * launch.chunks_cnt, &err_create_buffer); op_res = err_create_buffer;
+		ecg_pooled_buffer surf_area_buffer = buffer_pool.acquire(chain, CL_MEM_WRITE_ONLY, sizeof(float), &err_create_buffer); op_res = err_create_buffer;
+
+		cl::NDRange global = launch.chunks_cnt * launch.group_size;
+		cl::NDRange reduce_global = launch.group_size;
+		cl::NDRange local = launch.group_size;
+		cl_uint chunk_size = static_cast<cl_uint>(launch.chunk_size);
+		cl_uint chunks_cnt = static_cast<cl_uint>(launch.chunks_cnt);
+
+		// Areas and the CDF aren't needed for the total, the sums buffer stands in for them
+		op_res = launch.program->execute(
+			chain, compute_faces_areas_name, global, local,
+			vertexes_buffer, indexes_buffer,
+			first_face, last_face, chunk_size,
+			cl_uint(0), chunk_sums_buffer,
+			cl_uint(0), chunk_sums_buffer,
+			chunk_sums_buffer
+		);
+
+		op_res = launch.program->execute(
+			chain, reduce_surface_area_name, reduce_global, local,
+			chunk_sums_buffer, chunks_cnt,
+			surf_area_buffer
+		);
+
+		op_res = chain.read_buffer(surf_area_buffer, 0, sizeof(float), result);
+	}
+
+	std::vector<float> internal_compute_surface_areas(ecg_cmd_chain& chain, cl::Device& dev,
+		const cl::Buffer& vertexes_buffer, const cl::Buffer& indexes_buffer, const std::vector<cl_uint>& range_offsets, ecg_status_handler& op_res
+	) {
+		std::vector<float> result(range_offsets.size() - 1, -FLT_MAX);
+		internal_enqueue_surface_areas(chain, dev, vertexes_buffer, indexes_buffer, range_offsets, result.data(), op_res);
+		op_res = chain.wait();
+		return result;
+	}
+
+	void internal_enqueue_surface_areas(ecg_cmd_chain& chain, cl::Device& dev,
+		const cl::Buffer& vertexes_buffer, const cl::Buffer& indexes_buffer, const std::vector<cl_uint>& range_offsets, float* result, ecg_status_handler& op_res
+	) {
+		auto& buffer_pool = ecg_cl::get_instance().get_buffer_pool();
+		const size_t ranges_cnt = range_offsets.size() - 1;
+
+		size_t max_range_size = 0;
+		for (size_t range_id = 0; range_id < ranges_cnt; ++range_id)
+			max_range_size = std::max<size_t>(max_range_size, range_offsets[range_id + 1] - range_offsets[range_id]);
+
+		// All ranges get the same number of groups, together they fill the device
+		auto launch = get_faces_areas_launch(chain.get_context(), dev, max_range_size);
+		const size_t max_chunks_cnt = std::max<size_t>(dev.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>(), 1) * faces_areas_groups_per_unit;
+		const size_t groups_per_range = std::clamp<size_t>(launch.chunks_cnt, 1, std::max<size_t>(max_chunks_cnt / ranges_cnt, 1));
+
+		cl_int err_create_buffer = CL_SUCCESS;
+		size_t offsets_buffer_size = sizeof(cl_uint) * range_offsets.size();
+		ecg_pooled_buffer offsets_buffer = buffer_pool.acquire(chain, CL_MEM_READ_ONLY, offsets_buffer_size, &err_create_buffer); op_res = err_create_buffer;
+		ecg_pooled_buffer chunk_sums_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(float) * ranges_cnt * groups_per_range, &err_create_buffer); op_res = err_create_buffer;
+		ecg_pooled_buffer areas_buffer = buffer_pool.acquire(chain, CL_MEM_WRITE_ONLY, sizeof(float) * ranges_cnt, &err_create_buffer); op_res = err_create_buffer;
+
+		cl::NDRange global = ranges_cnt * groups_per_range * launch.group_size;
+		cl::NDRange reduce_global = ranges_cnt * launch.group_size;
+		cl::NDRange local = launch.group_size;
+		cl_uint groups_cnt = static_cast<cl_uint>(groups_per_range);
+
+		op_res = chain.write_buffer(offsets_buffer, 0, offsets_buffer_size, range_offsets.data());
+
+		op_res = launch.program->execute(
+			chain, compute_ranges_areas_name, global, local,
+			vertexes_buffer, indexes_buffer,
+			offsets_buffer, groups_cnt,
+			chunk_sums_buffer
+		);
+
+		op_res = launch.program->execute(
+			chain, reduce_surface_area_name, reduce_global, local,
+			chunk_sums_buffer, groups_cnt,
+			areas_buffer
+		);
+
+		op_res = chain.read_buffer(areas_buffer, 0, sizeof(float) * ranges_cnt, result);
+	}
+
+	float internal_compute_surface_area(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res) {
+		auto& ctrl = ecg_cl::get_instance();
+		return internal_compute_surface_area(chain, ctrl.get_device(),
+			mesh.vertexes_buffer, mesh.indexes_buffer, 0, static_cast<cl_uint>(mesh.indexes_size / 3), op_res);
+	}
+
 	float compute_surface_area(const ecg_mesh_t* mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("compute_surface_area");
 		ecg_status_handler op_res;
 		float result = -FLT_MAX;
 
 		try {
 			default_mesh_check(mesh, op_res, status);
+			if (get_active_backend() == ECG_BACKEND_CPU) return cpu::compute_surface_area(mesh, op_res);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+			result = internal_compute_surface_area(chain, cl_mesh, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+		}
 
-			auto& ctrl = ecg_cl::get_instance();
-			auto& queue = ctrl.get_cmd_queue();
-			auto& context = ctrl.get_context();
-			auto& dev = ctrl.get_device();
+		return result;
+	}
 
-			cl::Program::Sources sources = { compute_surface_area_code };
-			auto program = ecg_program_wrapper::get_program(context, dev, sources, compute_surface_area_name);
+	float compute_surface_area(const ecg_uploaded_mesh_t& mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("compute_surface_area");
+		ecg_status_handler op_res;
+		float result = -FLT_MAX;
 
-			const cl_int vert_buffer_sz = sizeof(mesh->vertexes[0]) * mesh->vertexes_size;
-			const cl_int ind_buffer_sz = sizeof(mesh->indexes[0]) * mesh->indexes_size;
-			const cl_int vert_size = sizeof(mesh->vertexes[0]) / sizeof(float);
+		try {
+			auto cl_mesh = uploaded_mesh_check(mesh, op_res, status);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			result = internal_compute_surface_area(chain, *cl_mesh, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+		}
+
+		return result;
+	}
 
-			const cl_int vert_arr_size = mesh->vertexes_size;
-			const cl_int ind_arr_size = mesh->indexes_size;
+	ecg_array_t internal_compute_faces_areas(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_array_t* areas_cdf, ecg_status_handler& op_res) {
+		auto& ctrl = ecg_cl::get_instance();
+		auto& context = ctrl.get_context();
+		auto& dev = ctrl.get_device();
 
-			cl::Buffer vert_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, vert_buffer_sz);
-			cl::Buffer ind_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, ind_buffer_sz);
-			cl::Buffer surf_area_buff = cl::Buffer(context, CL_MEM_READ_WRITE, sizeof(float));
+		cl_uint faces_cnt = mesh.indexes_size / 3;
+		auto launch = get_faces_areas_launch(context, dev, faces_cnt);
+		size_t areas_buffer_size = sizeof(float) * faces_cnt;
 
-			cl::NDRange local = cl::NullRange;
-			cl::NDRange global = mesh->indexes_size / 3;
+		ecg_array_t result_areas = allocate_array<float>(faces_cnt);
+		ecg_pooled_buffer areas_buffer = allocate_result_buffer(chain, result_areas.arr_ptr, areas_buffer_size, op_res);
 
-			op_res = queue.enqueueWriteBuffer(vert_buffer, CL_FALSE, 0, vert_buffer_sz, mesh->vertexes);
-			op_res = queue.enqueueWriteBuffer(ind_buffer, CL_FALSE, 0, ind_buffer_sz, mesh->indexes);
-			op_res = queue.enqueueFillBuffer(surf_area_buff, 0, 0, sizeof(float));
-			op_res = queue.finish();
+		ecg_pooled_buffer cdf_buffer;
+		if (areas_cdf != nullptr) {
+			*areas_cdf = allocate_array<float>(faces_cnt);
+			cdf_buffer = allocate_result_buffer(chain, areas_cdf->arr_ptr, areas_buffer_size, op_res);
+		}
 
-			op_res = program->execute(
-				queue, compute_surface_area_name, global, local,
-				vert_buffer, vert_arr_size,
-				ind_buffer, ind_arr_size,
-				vert_size, surf_area_buff
+		cl_int err_create_buffer = CL_SUCCESS;
+		ecg_pooled_buffer chunk_sums_buffer = ctrl.get_buffer_pool().acquire(chain, CL_MEM_READ_WRITE, sizeof(float) * launch.chunks_cnt, &err_create_buffer); op_res = err_create_buffer;
+
+		cl::NDRange global = launch.chunks_cnt * launch.group_size;
+		cl::NDRange local = launch.group_size;
+		cl_uint chunk_size = static_cast<cl_uint>(launch.chunk_size);
+		cl_uint with_cdf = areas_cdf != nullptr ? 1 : 0;
+
+		op_res = launch.program->execute(
+			chain, compute_faces_areas_name, global, local,
+			mesh.vertexes_buffer, mesh.indexes_buffer,
+			cl_uint(0), faces_cnt, chunk_size,
+			cl_uint(1), areas_buffer,
+			with_cdf, with_cdf ? cdf_buffer : areas_buffer,
+			chunk_sums_buffer
+		);
+
+		if (areas_cdf != nullptr) {
+			op_res = launch.program->execute(
+				chain, add_chunk_offsets_name, global, local,
+				chunk_sums_buffer,
+				cl_uint(0), faces_cnt, chunk_size,
+				cdf_buffer
 			);
 
-			op_res = queue.enqueueReadBuffer(surf_area_buff, CL_FALSE, 0, sizeof(float), &result);
-			op_res = queue.finish();
+			read_result_buffer(chain, cdf_buffer, areas_cdf->arr_ptr, areas_buffer_size, op_res);
+		}
+
+		read_result_buffer(chain, areas_buffer, result_areas.arr_ptr, areas_buffer_size, op_res);
+		op_res = chain.wait();
+		return result_areas;
+	}
+
+	ecg_array_t compute_faces_areas(const ecg_mesh_t* mesh, ecg_array_t* areas_cdf, ecg_status* status) {
+		ecg_profile_scope profile_scope("compute_faces_areas");
+		auto& mem_inst = ecg_mem::get_instance();
+		ecg_array_t result_areas;
+		ecg_status_handler op_res;
+
+		try {
+			if (areas_cdf != nullptr) *areas_cdf = ecg_array_t{};
+			default_mesh_check(mesh, op_res, status);
+			if (get_active_backend() == ECG_BACKEND_CPU) return cpu::compute_faces_areas(mesh, areas_cdf, op_res);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+			result_areas = internal_compute_faces_areas(chain, cl_mesh, areas_cdf, op_res);
 		}
 		catch (...) {
 			on_unknown_exception(op_res, status);
+			if (result_areas.handler != 0) mem_inst.delete_memory(result_areas.handler);
+			result_areas = ecg_array_t{};
+			if (areas_cdf != nullptr) {
+				if (areas_cdf->handler != 0) mem_inst.delete_memory(areas_cdf->handler);
+				*areas_cdf = ecg_array_t{};
+			}
 		}
 
-		return result;
+		return result_areas;
+	}
+
+	ecg_array_t compute_faces_areas(const ecg_uploaded_mesh_t& mesh, ecg_array_t* areas_cdf, ecg_status* status) {
+		ecg_profile_scope profile_scope("compute_faces_areas");
+		auto& mem_inst = ecg_mem::get_instance();
+		ecg_array_t result_areas;
+		ecg_status_handler op_res;
+
+		try {
+			if (areas_cdf != nullptr) *areas_cdf = ecg_array_t{};
+			auto cl_mesh = uploaded_mesh_check(mesh, op_res, status);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			result_areas = internal_compute_faces_areas(chain, *cl_mesh, areas_cdf, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+			if (result_areas.handler != 0) mem_inst.delete_memory(result_areas.handler);
+			result_areas = ecg_array_t{};
+			if (areas_cdf != nullptr) {
+				if (areas_cdf->handler != 0) mem_inst.delete_memory(areas_cdf->handler);
+				*areas_cdf = ecg_array_t{};
+			}
+		}
+
+		return result_areas;
 	}
 
 	cmp_res compare_meshes(const ecg_mesh_t* m1, const ecg_mesh_t* m2, mat3_base* delta_transform, ecg_status* status) {
@@ -186,50 +634,39 @@ namespace ecg {
 		return result;
 	}
 
+	mat3_base internal_compute_covariance_matrix(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res) {
+		// The center and the moments come from one sweep over the vertexes
+		return internal_compute_mesh_stats(chain, mesh, false, op_res).covariance;
+	}
+
 	mat3_base compute_covariance_matrix(const ecg_mesh_t* mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("compute_covariance_matrix");
 		mat3_base cov_mat = null_mat3;
 		ecg_status_handler op_res;
 
 		try {
 			default_mesh_check(mesh, op_res, status);
+			if (get_active_backend() == ECG_BACKEND_CPU) return cpu::compute_covariance_matrix(mesh, op_res);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+			cov_mat = internal_compute_covariance_matrix(chain, cl_mesh, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+		}
 
-			auto& ctrl = ecg_cl::get_instance();
-			auto& queue = ctrl.get_cmd_queue();
-			auto& context = ctrl.get_context();
-			auto& dev = ctrl.get_device();
+		return cov_mat;
+	}
 
-			bounding_box bb = default_bb;
-			vec3_base center = get_center(mesh, status);
-			cl_float4 center_cl = { center.x, center.y, center.z, 0.0f };
-			const cl_int vertex_size = sizeof(vec3_base) / sizeof(float);
-
-			cl_int vertex_buffer_size = mesh->vertexes_size * sizeof(mesh->vertexes[0]);
-			cl::Buffer cov_mat_buffer = cl::Buffer(context, CL_MEM_READ_WRITE, sizeof(cov_mat));
-			cl::Buffer vertex_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, vertex_buffer_size);
-
-			cl::Program::Sources obb_sources = {
-				enable_atomics_def,
-				get_vertex,
-				compute_cov_mat_code,
-				compute_obb_code
-			};
-
-			auto compute_obb = ecg_program_wrapper::get_program(context, dev, obb_sources, compute_cov_mat_name);
-			cl::NDRange global = mesh->vertexes_size;
-			cl::NDRange local = cl::NullRange;
-
-			op_res = queue.enqueueWriteBuffer(vertex_buffer, CL_FALSE, 0, vertex_buffer_size, mesh->vertexes);
-			op_res = queue.enqueueWriteBuffer(cov_mat_buffer, CL_FALSE, 0, sizeof(mat3_base), &cov_mat);
-			op_res = queue.finish();
-
-			op_res = compute_obb->execute(
-				queue, compute_cov_mat_name, global, local,
-				vertex_buffer, vertex_size, center_cl,
-				cov_mat_buffer
-			);
+	mat3_base compute_covariance_matrix(const ecg_uploaded_mesh_t& mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("compute_covariance_matrix");
+		mat3_base cov_mat = null_mat3;
+		ecg_status_handler op_res;
 
-			op_res = queue.enqueueReadBuffer(cov_mat_buffer, CL_FALSE, 0, sizeof(mat3_base), &cov_mat);
-			op_res = queue.finish();
+		try {
+			auto cl_mesh = uploaded_mesh_check(mesh, op_res, status);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			cov_mat = internal_compute_covariance_matrix(chain, *cl_mesh, op_res);
 		}
 		catch (...) {
 			on_unknown_exception(op_res, status);
@@ -238,43 +675,154 @@ namespace ecg {
 		return cov_mat;
 	}
 
-	bool is_mesh_closed(const ecg_mesh_t* mesh, ecg_status* status) {
+	ecg_mesh_stats_t internal_compute_mesh_stats(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, bool with_faces, ecg_status_handler& op_res) {
+		auto& ctrl = ecg_cl::get_instance();
+		auto& context = ctrl.get_context();
+		auto& dev = ctrl.get_device();
+		ecg_mesh_stats_t result{};
+
+		cl::Program::Sources sources = { compute_mesh_stats_code };
+		auto program = ecg_program_wrapper::get_program(context, dev, sources, compute_mesh_stats_name);
+		auto kernel = program->get_kernel(compute_mesh_stats_name);
+
+		// Local arrays of the kernel are sized for the default group, smaller groups have to be powers of two
+		size_t group_size = mesh_stats_group_size;
+		if (kernel != nullptr)
+			group_size = std::min(group_size, std::bit_floor(kernel->get_kernel().getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(dev)));
+
+		cl_uint vertexes_cnt = static_cast<cl_uint>(mesh.vertexes_size);
+		cl_uint faces_cnt = with_faces ? static_cast<cl_uint>(mesh.indexes_size / 3) : 0;
+
+		// Enough groups to fill the device, every work item sweeps the rest of the mesh with the stride of the range
+		const size_t items_cnt = std::max<size_t>(vertexes_cnt, faces_cnt);
+		const size_t max_groups_cnt = std::max<size_t>(dev.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>(), 1) * mesh_stats_groups_per_unit;
+		const size_t groups_cnt = std::clamp<size_t>((items_cnt + group_size - 1) / group_size, 1, max_groups_cnt);
+
+		const size_t partials_buffer_size = groups_cnt * mesh_stats_values * sizeof(float);
+		const size_t degenerate_buffer_size = groups_cnt * sizeof(cl_uint);
+
+		cl_int err_create_buffer = CL_SUCCESS;
+		ecg_pooled_buffer partials_buffer = ctrl.get_buffer_pool().acquire(chain, CL_MEM_WRITE_ONLY, partials_buffer_size, &err_create_buffer); op_res = err_create_buffer;
+		ecg_pooled_buffer degenerate_buffer = ctrl.get_buffer_pool().acquire(chain, CL_MEM_WRITE_ONLY, degenerate_buffer_size, &err_create_buffer); op_res = err_create_buffer;
+
+		cl::NDRange global = groups_cnt * group_size;
+		cl::NDRange local = group_size;
+
+		op_res = program->execute(
+			chain, compute_mesh_stats_name, global, local,
+			mesh.vertexes_buffer, vertexes_cnt,
+			mesh.indexes_buffer, faces_cnt,
+			partials_buffer, degenerate_buffer
+		);
+
+		// The kernel takes moments around the first vertex, it is read with the partials
+		std::vector<float> partials(groups_cnt * mesh_stats_values);
+		std::vector<cl_uint> degenerate(groups_cnt);
+		vec3_base pivot;
+
+		op_res = chain.read_buffer(partials_buffer, 0, partials_buffer_size, partials.data());
+		op_res = chain.read_buffer(degenerate_buffer, 0, degenerate_buffer_size, degenerate.data());
+		op_res = chain.read_buffer(mesh.vertexes_buffer, 0, sizeof(vec3_base), &pivot);
+		op_res = chain.wait();
+
+		std::array<double, mesh_stats_values> values{};
+		for (size_t id = 9; id < 12; ++id) values[id] = DBL_MAX;
+		for (size_t id = 12; id < 15; ++id) values[id] = -DBL_MAX;
+
+		for (size_t group_id = 0; group_id < groups_cnt; ++group_id) {
+			const float* group = &partials[group_id * mesh_stats_values];
+			for (size_t id = 0; id < mesh_stats_values; ++id) {
+				if (id >= 9 && id < 12) values[id] = std::min<double>(values[id], group[id]);
+				else if (id >= 12 && id < 15) values[id] = std::max<double>(values[id], group[id]);
+				else values[id] += group[id];
+			}
+			result.degenerate_faces_cnt += degenerate[group_id];
+		}
+
+		// Moments around the mean follow from the moments around the pivot
+		const double n = static_cast<double>(vertexes_cnt);
+		const double mean[3] = { values[0] / n, values[1] / n, values[2] / n };
+		const double pivot_xyz[3] = { pivot.x, pivot.y, pivot.z };
+
+		result.vertexes_sum = vec3_base(
+			static_cast<float>(values[0] + n * pivot_xyz[0]),
+			static_cast<float>(values[1] + n * pivot_xyz[1]),
+			static_cast<float>(values[2] + n * pivot_xyz[2]));
+		result.center = vec3_base(
+			static_cast<float>(pivot_xyz[0] + mean[0]),
+			static_cast<float>(pivot_xyz[1] + mean[1]),
+			static_cast<float>(pivot_xyz[2] + mean[2]));
+
+		result.covariance.m00 = static_cast<float>(values[3] - n * mean[0] * mean[0]);
+		result.covariance.m11 = static_cast<float>(values[4] - n * mean[1] * mean[1]);
+		result.covariance.m22 = static_cast<float>(values[5] - n * mean[2] * mean[2]);
+		result.covariance.m01 = result.covariance.m10 = static_cast<float>(values[6] - n * mean[0] * mean[1]);
+		result.covariance.m02 = result.covariance.m20 = static_cast<float>(values[7] - n * mean[0] * mean[2]);
+		result.covariance.m12 = result.covariance.m21 = static_cast<float>(values[8] - n * mean[1] * mean[2]);
+
+		result.aabb.min = vec3_base(static_cast<float>(values[9]), static_cast<float>(values[10]), static_cast<float>(values[11]));
+		result.aabb.max = vec3_base(static_cast<float>(values[12]), static_cast<float>(values[13]), static_cast<float>(values[14]));
+		result.surface_area = static_cast<float>(values[15]);
+		result.volume = static_cast<float>(values[16]);
+		result.vertexes_cnt = vertexes_cnt;
+		result.faces_cnt = faces_cnt;
+		return result;
+	}
+
+	ecg_mesh_stats_t compute_mesh_stats(const ecg_mesh_t* mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("compute_mesh_stats");
+		ecg_mesh_stats_t result{};
 		ecg_status_handler op_res;
-		bool result = true;
 
 		try {
 			default_mesh_check(mesh, op_res, status);
+			if (get_active_backend() == ECG_BACKEND_CPU) return cpu::compute_mesh_stats(mesh, op_res);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+			result = internal_compute_mesh_stats(chain, cl_mesh, true, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+		}
 
-			auto& ctrl = ecg_cl::get_instance();
-			auto& queue = ctrl.get_cmd_queue();
-			auto& context = ctrl.get_context();
-			auto& dev = ctrl.get_device();
+		return result;
+	}
 
-			cl_uint vertexes_size = mesh->vertexes_size;
-			cl_uint indexes_size = mesh->indexes_size;
+	ecg_mesh_stats_t compute_mesh_stats(const ecg_uploaded_mesh_t& mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("compute_mesh_stats");
+		ecg_mesh_stats_t result{};
+		ecg_status_handler op_res;
 
-			cl_int ind_buffer_size = mesh->indexes_size * sizeof(mesh->indexes[0]);
-			cl::Buffer result_buffer = cl::Buffer(context, CL_MEM_READ_WRITE, sizeof(bool));
-			cl::Buffer ind_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, ind_buffer_size);
+		try {
+			auto cl_mesh = uploaded_mesh_check(mesh, op_res, status);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			result = internal_compute_mesh_stats(chain, *cl_mesh, true, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+		}
 
-			cl::Program::Sources sources = { is_mesh_closed_code };
-			auto is_mesh_close_program = ecg_program_wrapper::get_program(context, dev, sources, is_mesh_closed_name);
-			
-			op_res = queue.enqueueWriteBuffer(result_buffer, CL_FALSE, 0, sizeof(bool), &result);
-			op_res = queue.enqueueWriteBuffer(ind_buffer, CL_FALSE, 0, ind_buffer_size, mesh->indexes);
-			op_res = queue.finish();
+		return result;
+	}
 
-			cl::NDRange global = cl::NDRange(mesh->indexes_size);
-			cl::NDRange local = cl::NullRange;
+	bool internal_is_mesh_closed(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res) {
+		// Every undirected edge of a closed mesh is shared by exactly two faces
+		ecg_cl_edges_t edges = internal_sort_edges(chain, mesh, op_res);
+		ecg_edge_stats_t stats = internal_count_edges(chain, edges, nullptr, op_res);
+		return stats.boundary_edges_cnt == 0 && stats.non_manifold_edges_cnt == 0;
+	}
 
-			op_res = is_mesh_close_program->execute(
-				queue, is_mesh_closed_name, global, local,
-				ind_buffer, indexes_size,
-				result_buffer
-			);
+	bool is_mesh_closed(const ecg_mesh_t* mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("is_mesh_closed");
+		ecg_status_handler op_res;
+		bool result = true;
 
-			op_res = queue.enqueueReadBuffer(result_buffer, CL_FALSE, 0, sizeof(bool), &result);
-			op_res = queue.finish();
+		try {
+			default_mesh_check(mesh, op_res, status);
+			if (get_active_backend() == ECG_BACKEND_CPU) return cpu::is_mesh_closed(mesh, op_res);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+			result = internal_is_mesh_closed(chain, cl_mesh, op_res);
 		}
 		catch (...) {
 			on_unknown_exception(op_res, status);
@@ -283,78 +831,71 @@ namespace ecg {
 		return result;
 	}
 
-	bool is_mesh_manifold(const ecg_mesh_t* mesh, ecg_status* status) {
+	bool is_mesh_closed(const ecg_uploaded_mesh_t& mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("is_mesh_closed");
 		ecg_status_handler op_res;
-		bool result = false;
+		bool result = true;
 
 		try {
-			default_mesh_check(mesh, op_res, status);
-			
-			bool is_mesh_self_intersected = false;
-			bool all_vertexes_manifold = true;
-			bool is_mesh_closed = true;
-
-			auto& ctrl = ecg_cl::get_instance();
-			auto& queue = ctrl.get_cmd_queue();
-			auto& context = ctrl.get_context();
-			auto& dev = ctrl.get_device();
-
-			cl::Program::Sources is_mesh_closed_src = { is_mesh_closed_code };
-			cl::Program::Sources is_mesh_vertex_manifold_src = { is_mesh_vertexes_manifold_code };
-			cl::Program::Sources is_mesh_self_intersected_src = { is_mesh_self_intersected_code };
+			auto cl_mesh = uploaded_mesh_check(mesh, op_res, status);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			result = internal_is_mesh_closed(chain, *cl_mesh, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+		}
 
-			auto is_mesh_closed_prog = ecg_program_wrapper::get_program(context, dev, is_mesh_closed_src, is_mesh_closed_name);
-			auto is_mesh_self_intersected_prog = ecg_program_wrapper::get_program(context, dev, is_mesh_self_intersected_src, is_mesh_self_intersected_name);
-			auto is_mesh_vertexes_manifold_prog = ecg_program_wrapper::get_program(context, dev, is_mesh_vertex_manifold_src, is_mesh_vertexes_manifold_name);
+		return result;
+	}
 
-			cl_int vrt_size = sizeof(mesh->vertexes[0]) / sizeof(float);
+	bool internal_is_mesh_manifold(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res) {
+		// Sorted edges answer both topology checks, the geometric check runs only for meshes that pass them
+		ecg_cl_edges_t edges = internal_sort_edges(chain, mesh, op_res);
+		ecg_edge_stats_t stats = internal_count_edges(chain, edges, nullptr, op_res);
+		if (stats.boundary_edges_cnt != 0 || stats.non_manifold_edges_cnt != 0) return false;
+		if (!internal_is_mesh_vertexes_manifold(chain, mesh, edges, op_res)) return false;
 
-			cl_uint indexes_size = mesh->indexes_size;
-			cl_uint ind_buffer_size = mesh->indexes_size * sizeof(mesh->indexes[0]);
-			cl::Buffer ind_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, ind_buffer_size);
+		auto& ctrl = ecg_cl::get_instance();
+		auto& context = ctrl.get_context();
+		auto& dev = ctrl.get_device();
 
-			cl_uint vertexes_size = mesh->vertexes_size;
-			cl_uint vert_buffer_size = mesh->vertexes_size * sizeof(mesh->vertexes[0]);
-			cl::Buffer vert_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, vert_buffer_size);
+		cl::Program::Sources is_mesh_self_intersected_src = { is_mesh_self_intersected_code };
+		auto is_mesh_self_intersected_prog = ecg_program_wrapper::get_program(context, dev, is_mesh_self_intersected_src, is_mesh_self_intersected_name);
 
-			cl::Buffer is_closed_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, sizeof(bool));
-			cl::Buffer is_self_intersected_buffer = cl::Buffer(context, CL_MEM_READ_WRITE, sizeof(bool));
-			cl::Buffer all_vertexes_manifold_buffer = cl::Buffer(context, CL_MEM_READ_WRITE, sizeof(bool));
+		cl_int vrt_size = sizeof(vec3_base) / sizeof(float);
+		cl_uint indexes_size = mesh.indexes_size;
+		cl_uint vertexes_size = mesh.vertexes_size;
+		bool is_mesh_self_intersected = false;
 
-			op_res = queue.enqueueWriteBuffer(all_vertexes_manifold_buffer, CL_FALSE, 0, sizeof(bool), &all_vertexes_manifold);
-			op_res = queue.enqueueWriteBuffer(is_closed_buffer, CL_FALSE, 0, sizeof(bool), &is_mesh_closed);
-			op_res = queue.enqueueWriteBuffer(vert_buffer, CL_FALSE, 0, vert_buffer_size, mesh->vertexes);
-			op_res = queue.enqueueWriteBuffer(ind_buffer, CL_FALSE, 0, ind_buffer_size, mesh->indexes);
-			op_res = queue.finish();
+		ecg_pooled_buffer is_self_intersected_buffer = ctrl.get_buffer_pool().acquire(chain, CL_MEM_READ_WRITE, sizeof(bool));
+		op_res = chain.write_buffer(is_self_intersected_buffer, 0, sizeof(bool), &is_mesh_self_intersected);
 
-			cl::NDRange global = cl::NDRange(mesh->vertexes_size);
-			cl::NDRange local = cl::NullRange;
+		cl::NDRange global = mesh.indexes_size / 3;
+		cl::NDRange local = cl::NullRange;
 
-			op_res = is_mesh_closed_prog->execute(
-				queue, is_mesh_closed_name, global, local,
-				ind_buffer, indexes_size,
-				is_closed_buffer
-			);
+		op_res = is_mesh_self_intersected_prog->execute(
+			chain, is_mesh_self_intersected_name, global, local,
+			mesh.vertexes_buffer, vertexes_size, mesh.indexes_buffer, indexes_size,
+			vrt_size, is_self_intersected_buffer
+		);
 
-			op_res = is_mesh_vertexes_manifold_prog->execute(
-				queue, is_mesh_vertexes_manifold_name, global, local,
-				ind_buffer, indexes_size, vertexes_size,
-				all_vertexes_manifold_buffer
-			);
+		op_res = chain.read_buffer(is_self_intersected_buffer, 0, sizeof(bool), &is_mesh_self_intersected);
+		op_res = chain.wait();
 
-			global = mesh->indexes_size / 3;
-			op_res = is_mesh_self_intersected_prog->execute(
-				queue, is_mesh_self_intersected_name, global, local,
-				vert_buffer, vertexes_size, ind_buffer, indexes_size,
-				vrt_size, is_self_intersected_buffer
-			);
+		return !is_mesh_self_intersected;
+	}
 
-			op_res = queue.enqueueReadBuffer(is_self_intersected_buffer, CL_FALSE, 0, sizeof(bool), &is_mesh_self_intersected);
-			op_res = queue.enqueueReadBuffer(all_vertexes_manifold_buffer, CL_FALSE, 0, sizeof(bool), &all_vertexes_manifold);
-			op_res = queue.enqueueReadBuffer(is_closed_buffer, CL_FALSE, 0, sizeof(bool), &is_mesh_closed);
-			op_res = queue.finish();
+	bool is_mesh_manifold(const ecg_mesh_t* mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("is_mesh_manifold");
+		ecg_status_handler op_res;
+		bool result = false;
 
-			result = is_mesh_closed && all_vertexes_manifold && !is_mesh_self_intersected;
+		try {
+			default_mesh_check(mesh, op_res, status);
+			if (get_active_backend() == ECG_BACKEND_CPU) return cpu::is_mesh_manifold(mesh, op_res);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+			result = internal_is_mesh_manifold(chain, cl_mesh, op_res);
 		}
 		catch (...) {
 			on_unknown_exception(op_res, status);
@@ -363,53 +904,89 @@ namespace ecg {
 		return result;
 	}
 
-	bool is_mesh_self_intersected(const ecg_mesh_t* mesh, self_intersection_method method, ecg_status* status) {
+	bool is_mesh_manifold(const ecg_uploaded_mesh_t& mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("is_mesh_manifold");
 		ecg_status_handler op_res;
 		bool result = false;
-		
+
 		try {
-			default_mesh_check(mesh, op_res, status);
-		
-			auto& ctrl = ecg_cl::get_instance();
-			auto& queue = ctrl.get_cmd_queue();
-			auto& context = ctrl.get_context();
-			auto& dev = ctrl.get_device();
+			auto cl_mesh = uploaded_mesh_check(mesh, op_res, status);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			result = internal_is_mesh_manifold(chain, *cl_mesh, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+		}
 
-			cl_int vrt_size = sizeof(mesh->vertexes[0]) / sizeof(float);
-			cl::Program::Sources source = { is_mesh_self_intersected_code };
-			auto is_self_intersected_prog = ecg_program_wrapper::get_program(context, dev, source, is_mesh_self_intersected_name);
+		return result;
+	}
 
-			cl_uint indexes_size = mesh->indexes_size;
-			cl_uint indexes_buffer_size = sizeof(mesh->indexes[0]) * mesh->indexes_size;
-			cl::Buffer indexes_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, indexes_buffer_size);
+	bool internal_is_mesh_self_intersected(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, self_intersection_method method, ecg_status_handler& op_res) {
+		auto& ctrl = ecg_cl::get_instance();
+		auto& context = ctrl.get_context();
+		auto& dev = ctrl.get_device();
+		bool result = false;
 
-			cl_uint vertexes_size = mesh->vertexes_size;
-			cl_uint vertexes_buffer_size = sizeof(mesh->vertexes[0]) * mesh->vertexes_size;
-			cl::Buffer vertexes_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, vertexes_buffer_size);
+		if (method >= self_intersection_method::SI_METHODS_COUNT)
+			op_res = ecg_status_code::INCORRECT_METHOD;
+		if (method == self_intersection_method::SI_BVH)
+			return internal_find_self_intersections(chain, mesh, nullptr, op_res) != 0;
 
-			cl::Buffer is_self_intersected_buffer = cl::Buffer(context, CL_MEM_READ_WRITE, sizeof(bool));
+		cl_int vrt_size = sizeof(vec3_base) / sizeof(float);
+		cl::Program::Sources source = { is_mesh_self_intersected_code };
+		auto is_self_intersected_prog = ecg_program_wrapper::get_program(context, dev, source, is_mesh_self_intersected_name);
 
-			if (method == self_intersection_method::SI_BRUTEFORCE) {
-				cl::NDRange global = mesh->indexes_size / 3;
-				cl::NDRange local = cl::NullRange;
+		cl_uint indexes_size = mesh.indexes_size;
+		cl_uint vertexes_size = mesh.vertexes_size;
+		ecg_pooled_buffer is_self_intersected_buffer = ctrl.get_buffer_pool().acquire(chain, CL_MEM_READ_WRITE, sizeof(bool));
 
-				op_res = queue.enqueueWriteBuffer(indexes_buffer, CL_FALSE, 0, indexes_buffer_size, mesh->indexes);
-				op_res = queue.enqueueWriteBuffer(vertexes_buffer, CL_FALSE, 0, vertexes_buffer_size, mesh->vertexes);
-				op_res = queue.enqueueWriteBuffer(is_self_intersected_buffer, CL_FALSE, 0, sizeof(bool), &result);
-				op_res = queue.finish();
+		cl::NDRange global = mesh.indexes_size / 3;
+		cl::NDRange local = cl::NullRange;
 
-				op_res = is_self_intersected_prog->execute(
-					queue, is_mesh_self_intersected_name, global, local,
-					vertexes_buffer, vertexes_size, indexes_buffer, indexes_size,
-					vrt_size, is_self_intersected_buffer
-				);
+		op_res = chain.write_buffer(is_self_intersected_buffer, 0, sizeof(bool), &result);
 
-				op_res = queue.enqueueReadBuffer(is_self_intersected_buffer, CL_FALSE, 0, sizeof(bool), &result);
-				op_res = queue.finish();
-			}
-			else {
+		op_res = is_self_intersected_prog->execute(
+			chain, is_mesh_self_intersected_name, global, local,
+			mesh.vertexes_buffer, vertexes_size, mesh.indexes_buffer, indexes_size,
+			vrt_size, is_self_intersected_buffer
+		);
+
+		op_res = chain.read_buffer(is_self_intersected_buffer, 0, sizeof(bool), &result);
+		op_res = chain.wait();
+		return result;
+	}
+
+	bool is_mesh_self_intersected(const ecg_mesh_t* mesh, self_intersection_method method, ecg_status* status) {
+		ecg_profile_scope profile_scope("is_mesh_self_intersected");
+		ecg_status_handler op_res;
+		bool result = false;
+		
+		try {
+			default_mesh_check(mesh, op_res, status);
+			if (method >= self_intersection_method::SI_METHODS_COUNT)
 				op_res = ecg_status_code::INCORRECT_METHOD;
-			}
+
+			if (get_active_backend() == ECG_BACKEND_CPU) return cpu::is_mesh_self_intersected(mesh, method, op_res);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+			result = internal_is_mesh_self_intersected(chain, cl_mesh, method, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+		}
+
+		return result;
+	}
+
+	bool is_mesh_self_intersected(const ecg_uploaded_mesh_t& mesh, self_intersection_method method, ecg_status* status) {
+		ecg_profile_scope profile_scope("is_mesh_self_intersected");
+		ecg_status_handler op_res;
+		bool result = false;
+
+		try {
+			auto cl_mesh = uploaded_mesh_check(mesh, op_res, status);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			result = internal_is_mesh_self_intersected(chain, *cl_mesh, method, op_res);
 		}
 		catch (...) {
 			on_unknown_exception(op_res, status);
@@ -419,6 +996,7 @@ namespace ecg {
 	}
 
 	ecg_array_t triangulate_mesh(const ecg_mesh_t* mesh, int base_num_vert, ecg_status* status) {
+		ecg_profile_scope profile_scope("triangulate_mesh");
 		ecg_status_handler op_res;
 		ecg_array_t result_indexes;
 
@@ -427,11 +1005,13 @@ namespace ecg {
 			if (mesh == nullptr || base_num_vert <= 0) op_res = ecg_status_code::INVALID_ARG;
 			if (mesh->indexes == nullptr || mesh->indexes_size <= 0) op_res = ecg_status_code::EMPTY_INDEX_ARR;
 			if (mesh->indexes_size % base_num_vert != 0) op_res = ecg_status_code::INCORRECT_VERTEX_COUNT_IN_FACE;
+			if (base_num_vert < 3) op_res = ecg_status_code::INCORRECT_VERTEX_COUNT_IN_FACE;
+			if (get_active_backend() == ECG_BACKEND_CPU) return cpu::triangulate_mesh(mesh, base_num_vert, op_res);
 
 			auto& ctrl = ecg_cl::get_instance();
-			auto& queue = ctrl.get_cmd_queue();
 			auto& context = ctrl.get_context();
 			auto& dev = ctrl.get_device();
+			ecg_cmd_chain chain(ctrl.get_cmd_queue());
 
 			const size_t triangle_size = 3;
 			const cl_uint default_index_value = 0;
@@ -446,8 +1026,8 @@ namespace ecg {
 			size_t new_indexes_buffer_size = new_indexes_size * sizeof(uint32_t);
 			size_t old_indexes_buffer_size = mesh->indexes_size * sizeof(uint32_t);
 			
-			cl::Buffer new_indexes_buffer = cl::Buffer(context, CL_MEM_READ_WRITE, new_indexes_buffer_size, nullptr, &err_create_buffer); op_res = err_create_buffer;
-			cl::Buffer old_indexes_buffer = cl::Buffer(context, CL_MEM_READ_ONLY,  old_indexes_buffer_size, nullptr, &err_create_buffer); op_res = err_create_buffer;
+			ecg_pooled_buffer new_indexes_buffer = ctrl.get_buffer_pool().acquire(chain, CL_MEM_READ_WRITE, new_indexes_buffer_size, &err_create_buffer); op_res = err_create_buffer;
+			ecg_pooled_buffer old_indexes_buffer = ctrl.get_buffer_pool().acquire(chain, CL_MEM_READ_ONLY,  old_indexes_buffer_size, &err_create_buffer); op_res = err_create_buffer;
 
 			cl::Program::Sources sources = { triangulate_mesh_code };
 			auto program = ecg_program_wrapper::get_program(context, dev, sources, triangulate_mesh_name);
@@ -455,20 +1035,19 @@ namespace ecg {
 			cl::NDRange global = old_faces_cnt;
 			cl::NDRange local  = cl::NullRange;
 
-			op_res = queue.enqueueFillBuffer(new_indexes_buffer, default_index_value, 0, new_indexes_buffer_size);
-			op_res = queue.enqueueWriteBuffer(old_indexes_buffer, CL_FALSE, 0, old_indexes_buffer_size, mesh->indexes);
-			op_res = queue.finish();
+			op_res = chain.fill_buffer(new_indexes_buffer, default_index_value, 0, new_indexes_buffer_size);
+			op_res = chain.write_buffer(old_indexes_buffer, 0, old_indexes_buffer_size, mesh->indexes);
 
 			op_res = program->execute(
-				queue, triangulate_mesh_name, global, local,
+				chain, triangulate_mesh_name, global, local,
 				old_indexes_buffer, old_indexes_size,
 				new_indexes_buffer, new_indexes_size,
 				old_faces_cnt, curr_vertexes_in_face
 			);
 
 			result_indexes = allocate_array<uint32_t>(new_indexes_size);
-			op_res = queue.enqueueReadBuffer(new_indexes_buffer, CL_FALSE, 0, new_indexes_buffer_size, result_indexes.arr_ptr);
-			op_res = queue.finish();
+			op_res = chain.read_buffer(new_indexes_buffer, 0, new_indexes_buffer_size, result_indexes.arr_ptr);
+			op_res = chain.wait();
 		}
 		catch (...) {
 			on_unknown_exception(op_res, status);
@@ -477,59 +1056,59 @@ namespace ecg {
 		return result_indexes;
 	}
 
-	float compute_volume(const ecg_mesh_t* mesh, ecg_status* status) {
-		ecg_status_handler op_res;
-		float result_volume = -1.0f;
+	float internal_compute_volume(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res) {
+		bool is_manifold = internal_is_mesh_manifold(chain, mesh, op_res);
+		if (!is_manifold) op_res = ecg_status_code::NON_MANIFOLD_MESH;
 
-		try {
-			default_mesh_check(mesh, op_res, status);
-			bool is_manifold = is_mesh_manifold(mesh, status);
-			if (!is_manifold) op_res = ecg_status_code::NON_MANIFOLD_MESH;
+		auto& ctrl = ecg_cl::get_instance();
+		auto& context = ctrl.get_context();
+		auto& dev = ctrl.get_device();
 
-			auto& ctrl = ecg_cl::get_instance();
-			auto& queue = ctrl.get_cmd_queue();
-			auto& context = ctrl.get_context();
-			auto& dev = ctrl.get_device();
+		cl::Program::Sources sources = { compute_volume_code };
+		auto program = ecg_program_wrapper::get_program(context, dev, sources, compute_volume_name);
 
-			cl::Program::Sources sources = { compute_volume_code };
-			auto program = ecg_program_wrapper::get_program(context, dev, sources, compute_volume_name);
+		cl_uint indexes_size = mesh.indexes_size;
+		cl_uint faces_cnt = mesh.indexes_size / 3;
+		cl_uint vertexes_size = mesh.vertexes_size;
+		size_t volume_buffer_size = sizeof(cl_float) * faces_cnt;
 
-			cl_uint indexes_size = mesh->indexes_size;
-			cl_uint faces_cnt = mesh->indexes_size / 3;
-			cl_uint vertexes_size = mesh->vertexes_size;
-			size_t vertexes_buffer_size = sizeof(vec3_base) * vertexes_size;
-			size_t indexes_buffer_size  = sizeof(uint32_t) * indexes_size;
-			size_t volume_buffer_size   = sizeof(cl_float) * faces_cnt;
+		cl_float pattern = 0.0f;
+		cl_int err_create_buffer = CL_SUCCESS;
+		ecg_pooled_buffer volume_buffer = ctrl.get_buffer_pool().acquire(chain, CL_MEM_READ_WRITE, volume_buffer_size, &err_create_buffer); op_res = err_create_buffer;
 
-			cl_float pattern = 0.0f;
-			cl_int err_create_buffer = CL_SUCCESS;
-			cl::Buffer vertexes_buffer = cl::Buffer(context, CL_MEM_READ_ONLY,  vertexes_buffer_size, nullptr, &err_create_buffer); op_res = err_create_buffer;
-			cl::Buffer indexes_buffer  = cl::Buffer(context, CL_MEM_READ_ONLY,  indexes_buffer_size , nullptr, &err_create_buffer); op_res = err_create_buffer;
-			cl::Buffer volume_buffer   = cl::Buffer(context, CL_MEM_READ_WRITE, volume_buffer_size  , nullptr, &err_create_buffer); op_res = err_create_buffer;
+		cl::NDRange global = faces_cnt;
+		cl::NDRange local = cl::NullRange;
 
-			cl::NDRange global = faces_cnt;
-			cl::NDRange local = cl::NullRange;
+		op_res = chain.fill_buffer(volume_buffer, pattern, 0, volume_buffer_size);
 
-			op_res = queue.enqueueWriteBuffer(vertexes_buffer, CL_FALSE, 0, vertexes_buffer_size, mesh->vertexes);
-			op_res = queue.enqueueWriteBuffer(indexes_buffer,  CL_FALSE, 0, indexes_buffer_size,  mesh->indexes);
-			op_res = queue.enqueueFillBuffer(volume_buffer, pattern, 0, volume_buffer_size);
-			op_res = queue.finish();
+		op_res = program->execute(
+			chain, compute_volume_name, global, local,
+			mesh.vertexes_buffer, vertexes_size,
+			mesh.indexes_buffer, indexes_size,
+			volume_buffer, faces_cnt 
+		);
 
-			op_res = program->execute(
-				queue, compute_volume_name, global, local,
-				vertexes_buffer, vertexes_size,
-				indexes_buffer, indexes_size,
-				volume_buffer, faces_cnt 
-			);
+		// TODO: summ on GPU using volume_buffer
+		std::vector<float> volumes; 
+		volumes.resize(faces_cnt);
+		
+		op_res = chain.read_buffer(volume_buffer, 0, volume_buffer_size, volumes.data());
+		op_res = chain.wait();
 
-			// TODO: summ on GPU using volume_buffer
-			std::vector<float> volumes; 
-			volumes.resize(faces_cnt);
-			
-			op_res = queue.enqueueReadBuffer(volume_buffer, CL_FALSE, 0, volume_buffer_size, volumes.data());
-			queue.finish();
+		return std::accumulate(volumes.begin(), volumes.end(), 0.0f);
+	}
+
+	float compute_volume(const ecg_mesh_t* mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("compute_volume");
+		ecg_status_handler op_res;
+		float result_volume = -1.0f;
 
-			result_volume = std::accumulate(volumes.begin(), volumes.end(), 0.0f);
+		try {
+			default_mesh_check(mesh, op_res, status);
+			if (get_active_backend() == ECG_BACKEND_CPU) return cpu::compute_volume(mesh, op_res);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+			result_volume = internal_compute_volume(chain, cl_mesh, op_res);
 		}
 		catch (...) {
 			on_unknown_exception(op_res, status);
@@ -538,51 +1117,74 @@ namespace ecg {
 		return result_volume;
 	}
 
-	ecg_array_t compute_faces_normals(const ecg_mesh_t* mesh, ecg_status* status) {
-		ecg_array_t result_normals;
+	float compute_volume(const ecg_uploaded_mesh_t& mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("compute_volume");
 		ecg_status_handler op_res;
+		float result_volume = -1.0f;
 
 		try {
-			default_mesh_check(mesh, op_res, status);
-			auto& ctrl = ecg_cl::get_instance();
-			auto& queue = ctrl.get_cmd_queue();
-			auto& context = ctrl.get_context();
-			auto& dev = ctrl.get_device();
+			auto cl_mesh = uploaded_mesh_check(mesh, op_res, status);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			result_volume = internal_compute_volume(chain, *cl_mesh, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+		}
 
-			cl::Program::Sources sources = { compute_faces_normals_code };
-			auto program = ecg_program_wrapper::get_program(context, dev, sources, compute_faces_normals_name);
+		return result_volume;
+	}
 
-			cl_uint indexes_size = mesh->indexes_size;
-			cl_uint faces_cnt = mesh->indexes_size / 3;
-			cl_uint vertexes_size = mesh->vertexes_size;
-			size_t vertexes_buffer_size = sizeof(vec3_base) * vertexes_size;
-			size_t indexes_buffer_size = sizeof(uint32_t) * indexes_size;
-			size_t normals_buffer_size = sizeof(vec3_base) * faces_cnt;
+	ecg_array_t internal_compute_faces_normals(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res) {
+		ecg_array_t result_normals = internal_enqueue_faces_normals(chain, mesh, op_res);
+		op_res = chain.wait();
+		return result_normals;
+	}
 
-			cl_float pattern = 0.0f;
-			cl_int err_create_buffer = CL_SUCCESS;
-			cl::Buffer vertexes_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, vertexes_buffer_size, nullptr, &err_create_buffer); op_res = err_create_buffer;
-			cl::Buffer indexes_buffer  = cl::Buffer(context, CL_MEM_READ_ONLY, indexes_buffer_size,  nullptr, &err_create_buffer); op_res = err_create_buffer;
-			cl::Buffer normals_buffer  = cl::Buffer(context, CL_MEM_READ_WRITE, normals_buffer_size, nullptr, &err_create_buffer); op_res = err_create_buffer;
+	ecg_array_t internal_enqueue_faces_normals(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res) {
+		auto& ctrl = ecg_cl::get_instance();
+		auto& context = ctrl.get_context();
+		auto& dev = ctrl.get_device();
+		ecg_array_t result_normals;
 
-			cl::NDRange global = faces_cnt;
-			cl::NDRange local = cl::NullRange;
+		cl::Program::Sources sources = { compute_faces_normals_code };
+		auto program = ecg_program_wrapper::get_program(context, dev, sources, compute_faces_normals_name);
 
-			op_res = queue.enqueueWriteBuffer(vertexes_buffer, CL_FALSE, 0, vertexes_buffer_size, mesh->vertexes);
-			op_res = queue.enqueueWriteBuffer(indexes_buffer, CL_FALSE, 0, indexes_buffer_size, mesh->indexes);
-			op_res = queue.enqueueFillBuffer(normals_buffer, pattern, 0, normals_buffer_size);
-			op_res = queue.finish();
+		cl_uint indexes_size = mesh.indexes_size;
+		cl_uint faces_cnt = mesh.indexes_size / 3;
+		cl_uint vertexes_size = mesh.vertexes_size;
+		size_t normals_buffer_size = sizeof(vec3_base) * faces_cnt;
 
-			op_res = program->execute(
-				queue, compute_faces_normals_name, global, local,
-				vertexes_buffer, vertexes_size,
-				indexes_buffer, indexes_size,
-				normals_buffer, faces_cnt
-			);
+		cl_float pattern = 0.0f;
+		result_normals = allocate_array<vec3_base>(faces_cnt);
+		ecg_pooled_buffer normals_buffer = allocate_result_buffer(chain, result_normals.arr_ptr, normals_buffer_size, op_res);
+
+		cl::NDRange global = faces_cnt;
+		cl::NDRange local = cl::NullRange;
 
-			result_normals = allocate_array<vec3_base>(faces_cnt);
-			op_res = queue.enqueueReadBuffer(normals_buffer, CL_FALSE, 0, normals_buffer_size, result_normals.arr_ptr);
-			op_res = queue.finish();
+		op_res = chain.fill_buffer(normals_buffer, pattern, 0, normals_buffer_size);
+
+		op_res = program->execute(
+			chain, compute_faces_normals_name, global, local,
+			mesh.vertexes_buffer, vertexes_size,
+			mesh.indexes_buffer, indexes_size,
+			normals_buffer, faces_cnt
+		);
+
+		read_result_buffer(chain, normals_buffer, result_normals.arr_ptr, normals_buffer_size, op_res);
+		return result_normals;
+	}
+
+	ecg_array_t compute_faces_normals(const ecg_mesh_t* mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("compute_faces_normals");
+		ecg_array_t result_normals;
+		ecg_status_handler op_res;
+
+		try {
+			default_mesh_check(mesh, op_res, status);
+			if (get_active_backend() == ECG_BACKEND_CPU) return cpu::compute_faces_normals(mesh, op_res);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+			result_normals = internal_compute_faces_normals(chain, cl_mesh, op_res);
 		}
 		catch (...) {
 			on_unknown_exception(op_res, status);
@@ -591,50 +1193,86 @@ namespace ecg {
 		return result_normals;
 	}
 
-	ecg_array_t compute_vertex_normals(const ecg_mesh_t* mesh, ecg_status* status) {
+	ecg_array_t compute_faces_normals(const ecg_uploaded_mesh_t& mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("compute_faces_normals");
+		ecg_array_t result_normals;
 		ecg_status_handler op_res;
-		ecg_array_t result;
 
 		try {
-			default_mesh_check(mesh, op_res, status);
-			auto& ctrl = ecg_cl::get_instance();
-			auto& queue = ctrl.get_cmd_queue();
-			auto& context = ctrl.get_context();
-			auto& dev = ctrl.get_device();
+			auto cl_mesh = uploaded_mesh_check(mesh, op_res, status);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			result_normals = internal_compute_faces_normals(chain, *cl_mesh, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+		}
 
-			cl::Program::Sources sources = { compute_vertex_normals_code };
-			auto program = ecg_program_wrapper::get_program(context, dev, sources, compute_vertex_normals_name);
+		return result_normals;
+	}
 
-			cl_uint indexes_size = mesh->indexes_size;
-			cl_uint vertexes_size = mesh->vertexes_size;
-			size_t indexes_buffer_size = sizeof(uint32_t) * indexes_size;
-			size_t vertexes_buffer_size = sizeof(vec3_base) * vertexes_size;
+	ecg_array_t internal_compute_vertex_normals(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res) {
+		auto& ctrl = ecg_cl::get_instance();
+		auto& context = ctrl.get_context();
+		auto& dev = ctrl.get_device();
+		ecg_array_t result;
 
-			cl_float pattern = 0.0f;
-			cl_int err_create_buffer = CL_SUCCESS;
-			cl_int vrt_size = sizeof(vec3_base) / sizeof(float);
-			cl::Buffer vertexes_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, vertexes_buffer_size, nullptr, &err_create_buffer); op_res = err_create_buffer;
-			cl::Buffer normals_buffer = cl::Buffer(context, CL_MEM_READ_WRITE, vertexes_buffer_size, nullptr, &err_create_buffer); op_res = err_create_buffer;
-			cl::Buffer indexes_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, indexes_buffer_size, nullptr, &err_create_buffer); op_res = err_create_buffer;
+		cl::Program::Sources sources = { compute_vertex_normals_code };
+		auto program = ecg_program_wrapper::get_program(context, dev, sources, compute_vertex_normals_name);
+		auto adjacency = internal_get_adjacency(chain, mesh, op_res);
 
-			cl::NDRange global = mesh->vertexes_size;
-			cl::NDRange local = cl::NullRange;
+		cl_uint vertexes_size = mesh.vertexes_size;
+		size_t normals_buffer_size = sizeof(vec3_base) * vertexes_size;
 
-			op_res = queue.enqueueWriteBuffer(vertexes_buffer, CL_FALSE, 0, vertexes_buffer_size, mesh->vertexes);
-			op_res = queue.enqueueWriteBuffer(indexes_buffer, CL_FALSE, 0, indexes_buffer_size, mesh->indexes);
-			op_res = queue.enqueueFillBuffer(normals_buffer, pattern, 0, vertexes_buffer_size);
-			op_res = queue.finish();
+		cl_float pattern = 0.0f;
+		cl_int vrt_size = sizeof(vec3_base) / sizeof(float);
+		result = allocate_array<vec3_base>(mesh.vertexes_size);
+		ecg_pooled_buffer normals_buffer = allocate_result_buffer(chain, result.arr_ptr, normals_buffer_size, op_res);
 
-			op_res = program->execute(
-				queue, compute_vertex_normals_name, global, local,
-				vertexes_buffer, vertexes_size,
-				indexes_buffer, indexes_size,
-				vrt_size, normals_buffer
-			);
+		cl::NDRange global = mesh.vertexes_size;
+		cl::NDRange local = cl::NullRange;
+
+		op_res = chain.fill_buffer(normals_buffer, pattern, 0, normals_buffer_size);
+
+		op_res = program->execute(
+			chain, compute_vertex_normals_name, global, local,
+			mesh.vertexes_buffer, vertexes_size,
+			mesh.indexes_buffer, adjacency->vertex_faces.offsets_buffer, adjacency->vertex_faces.ids_buffer,
+			vrt_size, normals_buffer
+		);
+
+		read_result_buffer(chain, normals_buffer, result.arr_ptr, normals_buffer_size, op_res);
+		op_res = chain.wait();
+		return result;
+	}
+
+	ecg_array_t compute_vertex_normals(const ecg_mesh_t* mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("compute_vertex_normals");
+		ecg_status_handler op_res;
+		ecg_array_t result;
+
+		try {
+			default_mesh_check(mesh, op_res, status);
+			if (get_active_backend() == ECG_BACKEND_CPU) return cpu::compute_vertex_normals(mesh, op_res);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+			result = internal_compute_vertex_normals(chain, cl_mesh, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+		}
+
+		return result;
+	}
+
+	ecg_array_t compute_vertex_normals(const ecg_uploaded_mesh_t& mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("compute_vertex_normals");
+		ecg_status_handler op_res;
+		ecg_array_t result;
 
-			result = allocate_array<vec3_base>(mesh->vertexes_size);
-			op_res = queue.enqueueReadBuffer(normals_buffer, CL_FALSE, 0, vertexes_buffer_size, result.arr_ptr);
-			op_res = queue.finish();
+		try {
+			auto cl_mesh = uploaded_mesh_check(mesh, op_res, status);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			result = internal_compute_vertex_normals(chain, *cl_mesh, op_res);
 		}
 		catch (...) {
 			on_unknown_exception(op_res, status);
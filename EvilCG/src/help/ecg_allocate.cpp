@@ -1,40 +1,122 @@
 #include <help/ecg_allocate.h>
 
 namespace ecg {
-	ecg_cl_mesh_t allocate_cl_mesh(const ecg_mesh_t* mesh) {
+	ecg_cl_mesh_t allocate_cl_mesh(ecg_cmd_chain& chain, const ecg_mesh_t* mesh, ecg_status_handler& op_res, bool is_transient) {
 		auto& ctrl = ecg_cl::get_instance();
-		auto queue = ctrl.get_cmd_queue();
-		auto context = ctrl.get_context();
-		auto device = ctrl.get_device();
+		auto& pool = ctrl.get_buffer_pool();
+		ecg_cl_mesh_t cl_mesh;
+
+		cl_mesh.context = ctrl.get_context();
+		cl_mesh.indexes_size = mesh->indexes_size;
+		cl_mesh.vertexes_size = mesh->vertexes_size;
+		cl_mesh.indexes_buffer_size = sizeof(uint32_t) * cl_mesh.indexes_size;
+		cl_mesh.vertexes_buffer_size = sizeof(vec3_base) * cl_mesh.vertexes_size;
+
+		cl_int err_create_buffer = CL_SUCCESS;
+		if (is_transient && is_zero_copy_array(mesh->vertexes, cl_mesh.vertexes_buffer_size) && is_zero_copy_array(mesh->indexes, cl_mesh.indexes_buffer_size)) {
+			cl_mem_flags flags = CL_MEM_READ_ONLY | CL_MEM_USE_HOST_PTR;
+			cl_mesh.vertexes_buffer = ecg_pooled_buffer(cl::Buffer(cl_mesh.context, flags, cl_mesh.vertexes_buffer_size, mesh->vertexes, &err_create_buffer)); op_res = err_create_buffer;
+			cl_mesh.indexes_buffer  = ecg_pooled_buffer(cl::Buffer(cl_mesh.context, flags, cl_mesh.indexes_buffer_size,  mesh->indexes,  &err_create_buffer)); op_res = err_create_buffer;
+			cl_mesh.is_valid = true;
+			return cl_mesh;
+		}
+
+		if (is_transient) {
+			cl_mesh.vertexes_buffer = pool.acquire(chain, CL_MEM_READ_ONLY, cl_mesh.vertexes_buffer_size, &err_create_buffer); op_res = err_create_buffer;
+			cl_mesh.indexes_buffer  = pool.acquire(chain, CL_MEM_READ_ONLY, cl_mesh.indexes_buffer_size,  &err_create_buffer); op_res = err_create_buffer;
+		}
+		else {
+			// Persistent meshes are used by the chains of later calls, so they get their own buffers of the exact size
+			cl_mesh.vertexes_buffer = ecg_pooled_buffer(cl::Buffer(cl_mesh.context, CL_MEM_READ_ONLY, cl_mesh.vertexes_buffer_size, nullptr, &err_create_buffer)); op_res = err_create_buffer;
+			cl_mesh.indexes_buffer  = ecg_pooled_buffer(cl::Buffer(cl_mesh.context, CL_MEM_READ_ONLY, cl_mesh.indexes_buffer_size,  nullptr, &err_create_buffer)); op_res = err_create_buffer;
+		}
 
-		ecg_status_handler op_res;
+		update_cl_mesh(chain, cl_mesh, mesh, op_res);
+		return cl_mesh;
+	}
+
+	ecg_cl_mesh_t allocate_cl_mesh(const ecg_mesh_t* mesh, cl::Context& context, ecg_status_handler& op_res) {
 		ecg_cl_mesh_t cl_mesh;
 
-		try {
-			queue.finish();
-			{
-				cl_mesh.is_valid = false;
+		cl_mesh.context = context;
+		cl_mesh.indexes_size = mesh->indexes_size;
+		cl_mesh.vertexes_size = mesh->vertexes_size;
+		cl_mesh.indexes_buffer_size = sizeof(uint32_t) * cl_mesh.indexes_size;
+		cl_mesh.vertexes_buffer_size = sizeof(vec3_base) * cl_mesh.vertexes_size;
+
+		// The data is copied on creation, no queue of the context is needed, so these buffers aren't pooled
+		cl_int err_create_buffer = CL_SUCCESS;
+		cl_mem_flags flags = CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR;
+		cl_mesh.vertexes_buffer = ecg_pooled_buffer(cl::Buffer(context, flags, cl_mesh.vertexes_buffer_size, mesh->vertexes, &err_create_buffer)); op_res = err_create_buffer;
+		cl_mesh.indexes_buffer  = ecg_pooled_buffer(cl::Buffer(context, flags, cl_mesh.indexes_buffer_size,  mesh->indexes,  &err_create_buffer)); op_res = err_create_buffer;
+		ecg_profiler::add_transfer(true, cl_mesh.vertexes_buffer_size + cl_mesh.indexes_buffer_size, nullptr, ecg_profiler::now_ns());
 
-				cl_mesh.indexes_size = mesh->indexes_size;
-				cl_mesh.vertexes_size = mesh->vertexes_size;
-				cl_mesh.indexes_buffer_size = sizeof(uint32_t) * cl_mesh.indexes_size;
-				cl_mesh.vertexes_buffer_size = sizeof(vec3_base) * cl_mesh.vertexes_size;
+		cl_mesh.is_valid = true;
+		return cl_mesh;
+	}
 
-				int err_create_buffer = CL_SUCCESS;
-				cl_mesh.vertexes_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, cl_mesh.vertexes_buffer_size, nullptr, &err_create_buffer);  op_res = err_create_buffer;
-				cl_mesh.indexes_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, cl_mesh.indexes_buffer_size, nullptr, &err_create_buffer);  op_res = err_create_buffer;
+	void update_cl_mesh(ecg_cmd_chain& chain, ecg_cl_mesh_t& cl_mesh, const ecg_mesh_t* mesh, ecg_status_handler& op_res) {
+		// Adjacency may be built by another thread right now, the new mesh keeps the same lock
+		auto adjacency_lock = cl_mesh.adjacency_lock;
+		std::scoped_lock lock(*adjacency_lock);
 
-				queue.enqueueFillBuffer(cl_mesh.vertexes_buffer, CL_FALSE, 0, cl_mesh.vertexes_buffer_size);
-				queue.enqueueFillBuffer(cl_mesh.indexes_buffer, CL_FALSE, 0, cl_mesh.indexes_buffer_size);
-			}
-			queue.finish();
+		// Geometry with another layout needs new buffers
+		if (cl_mesh.vertexes_size != mesh->vertexes_size || cl_mesh.indexes_size != mesh->indexes_size) {
+			cl_mesh = allocate_cl_mesh(chain, mesh, op_res, false);
+			cl_mesh.adjacency_lock = adjacency_lock;
+			return;
+		}
 
-			cl_mesh.is_valid = true;
+		cl_mesh.is_valid = false;
+		cl_mesh.adjacency.reset();
+		op_res = chain.write_buffer(cl_mesh.vertexes_buffer, 0, cl_mesh.vertexes_buffer_size, mesh->vertexes);
+		op_res = chain.write_buffer(cl_mesh.indexes_buffer, 0, cl_mesh.indexes_buffer_size, mesh->indexes);
+		cl_mesh.is_valid = true;
+	}
+
+	ecg_pooled_buffer allocate_result_buffer(ecg_cmd_chain& chain, void* host_ptr, size_t size, ecg_status_handler& op_res) {
+		auto& ctrl = ecg_cl::get_instance();
+		cl_int err_create_buffer = CL_SUCCESS;
+
+		if (is_zero_copy_array(host_ptr, size)) {
+			cl::Buffer buffer(ctrl.get_context(), CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, size, host_ptr, &err_create_buffer); op_res = err_create_buffer;
+			return ecg_pooled_buffer(buffer);
 		}
-		catch (...) {
-			cl_mesh = ecg_cl_mesh_t();
+
+		ecg_pooled_buffer buffer = ctrl.get_buffer_pool().acquire(chain, CL_MEM_READ_WRITE, size, &err_create_buffer); op_res = err_create_buffer;
+		return buffer;
+	}
+
+	void read_result_buffer(ecg_cmd_chain& chain, const cl::Buffer& buffer, void* host_ptr, size_t size, ecg_status_handler& op_res) {
+		if (buffer.getInfo<CL_MEM_HOST_PTR>() != host_ptr) {
+			op_res = chain.read_buffer(buffer, 0, size, host_ptr);
+			return;
 		}
 
+		// Mapping a buffer over host memory makes the results visible in it without a copy
+		cl_int err_map = CL_SUCCESS;
+		void* mapped = chain.map_buffer(buffer, CL_MAP_READ, 0, size, &err_map); op_res = err_map;
+		op_res = chain.unmap_buffer(buffer, mapped);
+	}
+
+	void read_cl_mesh(ecg_cmd_chain& chain, const ecg_cl_mesh_t& cl_mesh, std::vector<vec3_base>& vertexes, std::vector<uint32_t>& indexes, ecg_status_handler& op_res) {
+		vertexes.resize(cl_mesh.vertexes_size);
+		indexes.resize(cl_mesh.indexes_size);
+
+		op_res = chain.read_buffer(cl_mesh.vertexes_buffer, 0, cl_mesh.vertexes_buffer_size, vertexes.data());
+		op_res = chain.read_buffer(cl_mesh.indexes_buffer, 0, cl_mesh.indexes_buffer_size, indexes.data());
+	}
+
+	std::shared_ptr<ecg_cl_mesh_t> get_cl_mesh(const ecg_uploaded_mesh_t& mesh, ecg_status_handler& op_res) {
+		auto& mem_inst = ecg_mem::get_instance();
+		auto& ctrl = ecg_cl::get_instance();
+
+		auto cl_mesh = mem_inst.get_memory<ecg_cl_mesh_t>(mesh.handler);
+		if (cl_mesh == nullptr || !cl_mesh->is_valid) op_res = ecg_status_code::INVALID_ARG;
+
+		// Buffers from a released controller can't be used with the current context
+		if (cl_mesh->context() != ctrl.get_context()()) op_res = ecg_status_code::INVALID_ARG;
+
 		return cl_mesh;
 	}
 }
\ No newline at end of file
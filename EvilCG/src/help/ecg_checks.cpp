@@ -1,3 +1,4 @@
+#include <help/ecg_allocate.h>
 #include <help/ecg_checks.h>
 
 namespace ecg {
@@ -9,15 +10,19 @@ namespace ecg {
 		if (mesh->indexes_size % 3 != 0) op_res = ecg_status_code::NOT_TRIANGULATED_MESH;
 	}
 
+	std::shared_ptr<ecg_cl_mesh_t> uploaded_mesh_check(const ecg_uploaded_mesh_t& mesh, ecg_status_handler& op_res, ecg_status* status) {
+		if (status != nullptr) *status = ecg_status_code::SUCCESS;
+		if (mesh.handler == 0) op_res = ecg_status_code::INVALID_ARG;
+		return get_cl_mesh(mesh, op_res);
+	}
+
 	void on_unknown_exception(ecg_status_handler& op_res, ecg_status* status) {
 		if (op_res == ecg_status_code::SUCCESS)
 			op_res = ecg_status_code::UNKNOWN_EXCEPTION;
 		if (status != nullptr)
 			*status = op_res.get_status();
 		
-		if (g_ecg_logger) {
-			std::scoped_lock lock{ g_ecg_logger_mutex };
-			g_ecg_logger->error("Unknown error: {}", op_res.get_status());
-		}
+		std::scoped_lock lock{ g_ecg_logger_mutex };
+		if (g_ecg_logger) g_ecg_logger->error("Unknown error: {}", op_res.get_status());
 	}
 }
\ No newline at end of file
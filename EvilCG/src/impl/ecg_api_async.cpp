@@ -0,0 +1,396 @@
+#include <ecg_async.h>
+
+#include <core/ecg_task_pool.h>
+#include <core/ecg_host_ctrl.h>
+#include <core/ecg_internal.h>
+
+#include <help/ecg_allocate.h>
+#include <help/ecg_checks.h>
+#include <help/ecg_overloads.h>
+
+#include <optional>
+#include <atomic>
+
+namespace ecg::async {
+	/// <summary>
+	/// Host part of an enqueued call, it runs after the commands of the call complete.
+	/// </summary>
+	template <typename Type>
+	using ecg_pending_t = std::function<Type()>;
+
+	template <typename Type, typename Func>
+	ecg_future<Type> run_async(const ecg_wait_list_t& wait_list, Func&& func) {
+		// The controller has to outlive the pool, its singleton is created first
+		auto& ctrl = ecg_cl::get_instance();
+		auto& pool = ecg_task_pool::get_instance();
+
+		cl_int err = CL_SUCCESS;
+		cl::UserEvent event;
+		if (ctrl.is_init()) event = cl::UserEvent(ctrl.get_context(), &err);
+		if (err != CL_SUCCESS) event = cl::UserEvent();
+
+		auto result = pool.submit([func = std::forward<Func>(func), wait_list, event]() mutable {
+			ecg_status status = ecg_status_code::SUCCESS;
+			Type value{};
+
+			// The call decides on the host between its commands, so the host waits for the events
+			cl_int err_wait = wait_list.empty() ? CL_SUCCESS : cl::WaitForEvents(wait_list);
+			if (err_wait == CL_SUCCESS) value = func(&status);
+			else status = err_wait;
+
+			// Any negative status fails the commands that wait for the event
+			if (event() != nullptr) event.setStatus(status == ecg_status_code::SUCCESS ? CL_COMPLETE : -1);
+			return std::make_pair(value, status);
+		});
+
+		return ecg_future<Type>(result.share(), event);
+	}
+
+	/// <summary>
+	/// Event that completes after the events of the wait list, whatever their status.
+	/// Commands waiting for a failed event fail as well and would fail every later owner of their pooled buffers,
+	/// so the commands of the call always run and the failure is reported through its future.
+	/// </summary>
+	cl::Event gate_dependencies(const ecg_wait_list_t& wait_list, std::shared_ptr<std::atomic<bool>> failed, ecg_status_handler& op_res) {
+		struct gate_t {
+			std::atomic<size_t> pending_cnt;
+			std::shared_ptr<std::atomic<bool>> failed;
+			cl::UserEvent event;
+		};
+
+		cl_int err_create_event = CL_SUCCESS;
+		cl::UserEvent event(ecg_cl::get_instance().get_context(), &err_create_event); op_res = err_create_event;
+
+		// The gate holds one count itself, so it doesn't complete while callbacks are still registered
+		auto gate = new gate_t{ wait_list.size() + 1, failed, event };
+		auto on_complete = [](cl_event, cl_int status, void* data) {
+			auto gate = static_cast<gate_t*>(data);
+			if (status < 0) gate->failed->store(true);
+			if (gate->pending_cnt.fetch_sub(1) != 1) return;
+
+			gate->event.setStatus(CL_COMPLETE);
+			delete gate;
+		};
+
+		for (cl::Event wait_event : wait_list) {
+			cl_int err_callback = CL_INVALID_EVENT;
+			if (wait_event() != nullptr) err_callback = wait_event.setCallback(CL_COMPLETE, on_complete, gate);
+			if (err_callback != CL_SUCCESS) on_complete(nullptr, wait_event() == nullptr ? CL_COMPLETE : err_callback, gate);
+		}
+
+		on_complete(nullptr, CL_COMPLETE, gate);
+		return event;
+	}
+
+	/// <summary>
+	/// Enqueues the commands of the call on the queue of the caller, the host part runs on the first get.
+	/// The host backend has no commands to enqueue, there the call runs on the pool.
+	/// </summary>
+	template <typename Type, typename Func, typename EnqueueFunc>
+	ecg_future<Type> run_enqueued(const ecg_wait_list_t& wait_list, Func&& func, EnqueueFunc&& enqueue) {
+		if (get_active_backend() == ECG_BACKEND_CPU) return run_async<Type>(wait_list, std::forward<Func>(func));
+
+		struct holder_t {
+			std::shared_ptr<ecg_pending_t<Type>> pending;
+			std::shared_ptr<std::atomic<bool>> failed;
+			cl::UserEvent done;
+		};
+
+		auto& ctrl = ecg_cl::get_instance();
+		ecg_status_handler op_res;
+		ecg_status status = ecg_status_code::SUCCESS;
+		std::shared_ptr<ecg_pending_t<Type>> pending;
+		auto failed = std::make_shared<std::atomic<bool>>(false);
+		std::optional<ecg_cmd_chain> chain;
+		cl::Event event;
+
+		try {
+			chain.emplace(ctrl.get_cmd_queue());
+			if (!wait_list.empty()) chain->add_dependencies({ gate_dependencies(wait_list, failed, op_res) });
+			pending = std::make_shared<ecg_pending_t<Type>>(enqueue(*chain, op_res));
+
+			cl::Event last_event;
+			op_res = chain->get_last_event(&last_event);
+
+			// Later calls wait for the event of the future, it fails with the dependencies of the call
+			cl_int err_create_event = CL_SUCCESS;
+			cl::UserEvent done(ctrl.get_context(), &err_create_event); op_res = err_create_event;
+			event = done;
+
+			// Commands write to the memory held by the host part, it lives until they complete even without the future
+			auto holder = new holder_t{ pending, failed, done };
+			cl_int err_callback = last_event.setCallback(CL_COMPLETE, [](cl_event, cl_int status, void* data) {
+				auto holder = static_cast<holder_t*>(data);
+				holder->done.setStatus(status < 0 || holder->failed->load() ? -1 : CL_COMPLETE);
+				delete holder;
+			}, holder);
+
+			if (err_callback != CL_SUCCESS) {
+				delete holder;
+				op_res = chain->wait();
+				done.setStatus(failed->load() ? -1 : CL_COMPLETE);
+			}
+		}
+		catch (...) {
+			on_unknown_exception(op_res, &status);
+
+			// Commands already enqueued may still use the memory of the host part
+			if (chain.has_value()) chain->wait();
+			pending.reset();
+			cl_int err = CL_SUCCESS;
+			cl::UserEvent failed_event;
+			if (ctrl.is_init()) failed_event = cl::UserEvent(ctrl.get_context(), &err);
+			if (err == CL_SUCCESS && failed_event() != nullptr) failed_event.setStatus(-1);
+			event = failed_event;
+		}
+
+		auto result = std::async(std::launch::deferred, [pending, event, status]() {
+			ecg_status_handler op_res;
+			ecg_status result_status = status;
+			Type value{};
+			if (pending == nullptr) return std::make_pair(value, result_status);
+
+			try {
+				op_res = event.wait();
+				value = (*pending)();
+			}
+			catch (...) {
+				on_unknown_exception(op_res, &result_status);
+			}
+
+			return std::make_pair(value, result_status);
+		});
+
+		return ecg_future<Type>(result.share(), event);
+	}
+
+	ecg_pending_t<ecg_uploaded_mesh_t> enqueue_upload_mesh(ecg_cmd_chain& chain, const ecg_mesh_t* mesh, ecg_status_handler& op_res) {
+		default_mesh_check(mesh, op_res, nullptr);
+		auto cl_mesh = std::make_shared<ecg_cl_mesh_t>(allocate_cl_mesh(chain, mesh, op_res, false));
+
+		// The handle is created once the data is on the device, a failed upload doesn't leave one behind
+		return [cl_mesh, vertexes_size = mesh->vertexes_size, indexes_size = mesh->indexes_size]() {
+			auto& mem_inst = ecg_mem::get_instance();
+			auto handle_data = mem_inst.allocate<ecg_cl_mesh_t>();
+			if (handle_data.ptr == nullptr) throw ecg_status_ex(ecg_status_code::RUNTIME_ERROR);
+
+			*handle_data.ptr = std::move(*cl_mesh);
+			ecg_uploaded_mesh_t result;
+			result.handler = handle_data.handle;
+			result.vertexes_size = vertexes_size;
+			result.indexes_size = indexes_size;
+			return result;
+		};
+	}
+
+	ecg_pending_t<vec3_base> enqueue_sum_vertexes(ecg_cmd_chain& chain, const ecg_cl_mesh_t& cl_mesh, float divider, ecg_status_handler& op_res) {
+		auto result = std::make_shared<vec3_base>();
+		internal_enqueue_sum_vertexes(chain, cl_mesh, result.get(), op_res);
+		return [result, divider]() { return *result / divider; };
+	}
+
+	ecg_pending_t<float> enqueue_surface_area(ecg_cmd_chain& chain, const ecg_cl_mesh_t& cl_mesh, ecg_status_handler& op_res) {
+		auto result = std::make_shared<float>(-FLT_MAX);
+		internal_enqueue_surface_area(chain, ecg_cl::get_instance().get_device(), cl_mesh.vertexes_buffer, cl_mesh.indexes_buffer,
+			0, static_cast<cl_uint>(cl_mesh.indexes_size / 3), result.get(), op_res);
+		return [result]() { return *result; };
+	}
+
+	ecg_pending_t<ecg_array_t> enqueue_faces_normals(ecg_cmd_chain& chain, const ecg_cl_mesh_t& cl_mesh, ecg_status_handler& op_res) {
+		// Normals of a failed or dropped call are released with the host part
+		auto result = std::shared_ptr<ecg_array_t>(new ecg_array_t(), [](ecg_array_t* normals) {
+			if (normals->handler != 0) ecg_mem::get_instance().delete_memory(normals->handler);
+			delete normals;
+		});
+
+		*result = internal_enqueue_faces_normals(chain, cl_mesh, op_res);
+		return [result]() {
+			ecg_array_t normals = *result;
+			result->handler = 0;
+			return normals;
+		};
+	}
+
+	ecg_pending_t<bounding_box> enqueue_aabb(ecg_cmd_chain& chain, const ecg_cl_mesh_t& cl_mesh, ecg_status_handler& op_res) {
+		struct aabb_staging_t {
+			std::vector<cl_uint> range_offsets;
+			bounding_box result = default_bb;
+		};
+
+		auto staging = std::make_shared<aabb_staging_t>();
+		staging->range_offsets = { 0, static_cast<cl_uint>(cl_mesh.vertexes_size) };
+		ecg::hulls::internal_enqueue_aabbs(chain, ecg_cl::get_instance().get_device(), cl_mesh.vertexes_buffer, staging->range_offsets, &staging->result, op_res);
+		return [staging]() { return staging->result; };
+	}
+
+	ecg_future<ecg_uploaded_mesh_t> upload_mesh(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list) {
+		return run_enqueued<ecg_uploaded_mesh_t>(wait_list,
+			[mesh](ecg_status* status) { return ecg::upload_mesh(mesh, status); },
+			[mesh](ecg_cmd_chain& chain, ecg_status_handler& op_res) { return enqueue_upload_mesh(chain, mesh, op_res); });
+	}
+
+	ecg_future<vec3_base> sum_vertexes(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list) {
+		return run_enqueued<vec3_base>(wait_list,
+			[mesh](ecg_status* status) { return ecg::sum_vertexes(mesh, status); },
+			[mesh](ecg_cmd_chain& chain, ecg_status_handler& op_res) {
+				default_mesh_check(mesh, op_res, nullptr);
+				auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+				return enqueue_sum_vertexes(chain, cl_mesh, 1.0f, op_res);
+			});
+	}
+
+	ecg_future<vec3_base> sum_vertexes(const ecg_uploaded_mesh_t& mesh, const ecg_wait_list_t& wait_list) {
+		return run_enqueued<vec3_base>(wait_list,
+			[mesh](ecg_status* status) { return ecg::sum_vertexes(mesh, status); },
+			[mesh](ecg_cmd_chain& chain, ecg_status_handler& op_res) {
+				auto cl_mesh = uploaded_mesh_check(mesh, op_res, nullptr);
+				return enqueue_sum_vertexes(chain, *cl_mesh, 1.0f, op_res);
+			});
+	}
+
+	ecg_future<vec3_base> get_center(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list) {
+		return run_enqueued<vec3_base>(wait_list,
+			[mesh](ecg_status* status) { return ecg::get_center(mesh, status); },
+			[mesh](ecg_cmd_chain& chain, ecg_status_handler& op_res) {
+				default_mesh_check(mesh, op_res, nullptr);
+				auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+				return enqueue_sum_vertexes(chain, cl_mesh, static_cast<float>(cl_mesh.vertexes_size), op_res);
+			});
+	}
+
+	ecg_future<vec3_base> get_center(const ecg_uploaded_mesh_t& mesh, const ecg_wait_list_t& wait_list) {
+		return run_enqueued<vec3_base>(wait_list,
+			[mesh](ecg_status* status) { return ecg::get_center(mesh, status); },
+			[mesh](ecg_cmd_chain& chain, ecg_status_handler& op_res) {
+				auto cl_mesh = uploaded_mesh_check(mesh, op_res, nullptr);
+				return enqueue_sum_vertexes(chain, *cl_mesh, static_cast<float>(cl_mesh->vertexes_size), op_res);
+			});
+	}
+
+	ecg_future<float> compute_surface_area(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list) {
+		return run_enqueued<float>(wait_list,
+			[mesh](ecg_status* status) { return ecg::compute_surface_area(mesh, status); },
+			[mesh](ecg_cmd_chain& chain, ecg_status_handler& op_res) {
+				default_mesh_check(mesh, op_res, nullptr);
+				auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+				return enqueue_surface_area(chain, cl_mesh, op_res);
+			});
+	}
+
+	ecg_future<float> compute_surface_area(const ecg_uploaded_mesh_t& mesh, const ecg_wait_list_t& wait_list) {
+		return run_enqueued<float>(wait_list,
+			[mesh](ecg_status* status) { return ecg::compute_surface_area(mesh, status); },
+			[mesh](ecg_cmd_chain& chain, ecg_status_handler& op_res) {
+				auto cl_mesh = uploaded_mesh_check(mesh, op_res, nullptr);
+				return enqueue_surface_area(chain, *cl_mesh, op_res);
+			});
+	}
+
+	ecg_future<mat3_base> compute_covariance_matrix(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list) {
+		return run_async<mat3_base>(wait_list, [mesh](ecg_status* status) { return ecg::compute_covariance_matrix(mesh, status); });
+	}
+
+	ecg_future<mat3_base> compute_covariance_matrix(const ecg_uploaded_mesh_t& mesh, const ecg_wait_list_t& wait_list) {
+		return run_async<mat3_base>(wait_list, [mesh](ecg_status* status) { return ecg::compute_covariance_matrix(mesh, status); });
+	}
+
+	ecg_future<bool> is_mesh_closed(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list) {
+		return run_async<bool>(wait_list, [mesh](ecg_status* status) { return ecg::is_mesh_closed(mesh, status); });
+	}
+
+	ecg_future<bool> is_mesh_closed(const ecg_uploaded_mesh_t& mesh, const ecg_wait_list_t& wait_list) {
+		return run_async<bool>(wait_list, [mesh](ecg_status* status) { return ecg::is_mesh_closed(mesh, status); });
+	}
+
+	ecg_future<bool> is_mesh_manifold(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list) {
+		return run_async<bool>(wait_list, [mesh](ecg_status* status) { return ecg::is_mesh_manifold(mesh, status); });
+	}
+
+	ecg_future<bool> is_mesh_manifold(const ecg_uploaded_mesh_t& mesh, const ecg_wait_list_t& wait_list) {
+		return run_async<bool>(wait_list, [mesh](ecg_status* status) { return ecg::is_mesh_manifold(mesh, status); });
+	}
+
+	ecg_future<bool> is_mesh_self_intersected(const ecg_mesh_t* mesh, self_intersection_method method, const ecg_wait_list_t& wait_list) {
+		return run_async<bool>(wait_list, [mesh, method](ecg_status* status) { return ecg::is_mesh_self_intersected(mesh, method, status); });
+	}
+
+	ecg_future<bool> is_mesh_self_intersected(const ecg_uploaded_mesh_t& mesh, self_intersection_method method, const ecg_wait_list_t& wait_list) {
+		return run_async<bool>(wait_list, [mesh, method](ecg_status* status) { return ecg::is_mesh_self_intersected(mesh, method, status); });
+	}
+
+	ecg_future<ecg_array_t> triangulate_mesh(const ecg_mesh_t* mesh, int base_num_vert, const ecg_wait_list_t& wait_list) {
+		return run_async<ecg_array_t>(wait_list, [mesh, base_num_vert](ecg_status* status) { return ecg::triangulate_mesh(mesh, base_num_vert, status); });
+	}
+
+	ecg_future<float> compute_volume(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list) {
+		return run_async<float>(wait_list, [mesh](ecg_status* status) { return ecg::compute_volume(mesh, status); });
+	}
+
+	ecg_future<float> compute_volume(const ecg_uploaded_mesh_t& mesh, const ecg_wait_list_t& wait_list) {
+		return run_async<float>(wait_list, [mesh](ecg_status* status) { return ecg::compute_volume(mesh, status); });
+	}
+
+	ecg_future<ecg_array_t> compute_faces_normals(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list) {
+		return run_enqueued<ecg_array_t>(wait_list,
+			[mesh](ecg_status* status) { return ecg::compute_faces_normals(mesh, status); },
+			[mesh](ecg_cmd_chain& chain, ecg_status_handler& op_res) {
+				default_mesh_check(mesh, op_res, nullptr);
+				auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+				return enqueue_faces_normals(chain, cl_mesh, op_res);
+			});
+	}
+
+	ecg_future<ecg_array_t> compute_faces_normals(const ecg_uploaded_mesh_t& mesh, const ecg_wait_list_t& wait_list) {
+		return run_enqueued<ecg_array_t>(wait_list,
+			[mesh](ecg_status* status) { return ecg::compute_faces_normals(mesh, status); },
+			[mesh](ecg_cmd_chain& chain, ecg_status_handler& op_res) {
+				auto cl_mesh = uploaded_mesh_check(mesh, op_res, nullptr);
+				return enqueue_faces_normals(chain, *cl_mesh, op_res);
+			});
+	}
+
+	ecg_future<ecg_array_t> compute_vertex_normals(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list) {
+		return run_async<ecg_array_t>(wait_list, [mesh](ecg_status* status) { return ecg::compute_vertex_normals(mesh, status); });
+	}
+
+	ecg_future<ecg_array_t> compute_vertex_normals(const ecg_uploaded_mesh_t& mesh, const ecg_wait_list_t& wait_list) {
+		return run_async<ecg_array_t>(wait_list, [mesh](ecg_status* status) { return ecg::compute_vertex_normals(mesh, status); });
+	}
+
+	ecg_future<ecg_internal_mesh_t> compute_intersection(const ecg_mesh_t* m1, const ecg_mesh_t* m2, const ecg_wait_list_t& wait_list) {
+		return run_async<ecg_internal_mesh_t>(wait_list, [m1, m2](ecg_status* status) { return ecg::compute_intersection(m1, m2, status); });
+	}
+
+	ecg_future<ecg_internal_mesh_t> compute_intersection(const ecg_uploaded_mesh_t& m1, const ecg_uploaded_mesh_t& m2, const ecg_wait_list_t& wait_list) {
+		return run_async<ecg_internal_mesh_t>(wait_list, [m1, m2](ecg_status* status) { return ecg::compute_intersection(m1, m2, status); });
+	}
+
+	namespace hulls {
+		ecg_future<bounding_box> compute_aabb(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list) {
+			return run_enqueued<bounding_box>(wait_list,
+				[mesh](ecg_status* status) { return ecg::hulls::compute_aabb(mesh, status); },
+				[mesh](ecg_cmd_chain& chain, ecg_status_handler& op_res) {
+					default_mesh_check(mesh, op_res, nullptr);
+					auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+					return enqueue_aabb(chain, cl_mesh, op_res);
+				});
+		}
+
+		ecg_future<bounding_box> compute_aabb(const ecg_uploaded_mesh_t& mesh, const ecg_wait_list_t& wait_list) {
+			return run_enqueued<bounding_box>(wait_list,
+				[mesh](ecg_status* status) { return ecg::hulls::compute_aabb(mesh, status); },
+				[mesh](ecg_cmd_chain& chain, ecg_status_handler& op_res) {
+					auto cl_mesh = uploaded_mesh_check(mesh, op_res, nullptr);
+					return enqueue_aabb(chain, *cl_mesh, op_res);
+				});
+		}
+
+		ecg_future<full_bounding_box> compute_obb(const ecg_mesh_t* mesh, const ecg_wait_list_t& wait_list) {
+			return run_async<full_bounding_box>(wait_list, [mesh](ecg_status* status) { return ecg::hulls::compute_obb(mesh, status); });
+		}
+
+		ecg_future<full_bounding_box> compute_obb(const ecg_uploaded_mesh_t& mesh, const ecg_wait_list_t& wait_list) {
+			return run_async<full_bounding_box>(wait_list, [mesh](ecg_status* status) { return ecg::hulls::compute_obb(mesh, status); });
+		}
+	}
+}
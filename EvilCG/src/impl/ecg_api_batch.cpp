@@ -0,0 +1,340 @@
+#include <ecg_api.h>
+
+#include <core/ecg_cl_programs.h>
+#include <core/ecg_cpu.h>
+#include <core/ecg_host_ctrl.h>
+#include <core/ecg_internal.h>
+#include <core/ecg_program.h>
+
+#include <help/ecg_allocate.h>
+#include <help/ecg_logger.h>
+#include <help/ecg_helper.h>
+#include <help/ecg_checks.h>
+#include <help/ecg_geom.h>
+
+namespace ecg::batch {
+	/// <summary>
+	/// Meshes of a batch packed on the device. Offsets hold the first vertex (or face) of every mesh and the total count at the end.
+	/// </summary>
+	struct ecg_cl_batch_t {
+		ecg_pooled_buffer vertexes_buffer;
+		ecg_pooled_buffer indexes_buffer;
+		ecg_pooled_buffer offsets_buffer;
+
+		cl_uint meshes_cnt = 0;
+		cl_uint vertexes_cnt = 0;
+		cl_uint faces_cnt = 0;
+	};
+
+	enum class batch_offsets_t {
+		NONE,
+		VERTEXES,
+		FACES
+	};
+
+	// Meshes of a few hundred faces are copied in chunks, one mesh per task would cost more than the copy
+	constexpr size_t g_pack_grain = 64;
+
+	void batch_check(const ecg_mesh_t* meshes, size_t meshes_count, ecg_status_handler& op_res, ecg_status* status) {
+		if (status != nullptr) *status = ecg_status_code::SUCCESS;
+		if (meshes == nullptr || meshes_count == 0) op_res = ecg_status_code::INVALID_ARG;
+		if (meshes_count >= std::numeric_limits<cl_uint>::max()) op_res = ecg_status_code::INVALID_ARG;
+
+		for (size_t mesh_id = 0; mesh_id < meshes_count; ++mesh_id)
+			default_mesh_check(&meshes[mesh_id], op_res, status);
+	}
+
+	/// <summary>
+	/// First vertex and face of every mesh, the totals are stored past the last mesh.
+	/// </summary>
+	void get_batch_offsets(const ecg_mesh_t* meshes, size_t meshes_count,
+		std::vector<cl_uint>& vertex_offsets, std::vector<cl_uint>& face_offsets, ecg_status_handler& op_res
+	) {
+		vertex_offsets.resize(meshes_count + 1);
+		face_offsets.resize(meshes_count + 1);
+
+		// Packed indexes are 32-bit, so the whole batch has to fit them
+		size_t vertexes_cnt = 0;
+		size_t faces_cnt = 0;
+		for (size_t mesh_id = 0; mesh_id < meshes_count; ++mesh_id) {
+			vertex_offsets[mesh_id] = static_cast<cl_uint>(vertexes_cnt);
+			face_offsets[mesh_id] = static_cast<cl_uint>(faces_cnt);
+			vertexes_cnt += meshes[mesh_id].vertexes_size;
+			faces_cnt += meshes[mesh_id].indexes_size / 3;
+
+			if (vertexes_cnt > std::numeric_limits<cl_uint>::max() || faces_cnt * 3 > std::numeric_limits<cl_uint>::max())
+				op_res = ecg_status_code::INVALID_ARG;
+		}
+
+		vertex_offsets[meshes_count] = static_cast<cl_uint>(vertexes_cnt);
+		face_offsets[meshes_count] = static_cast<cl_uint>(faces_cnt);
+	}
+
+	ecg_cl_batch_t allocate_cl_batch(ecg_cmd_chain& chain, const ecg_mesh_t* meshes, size_t meshes_count, bool with_indexes,
+		batch_offsets_t offsets, ecg_status_handler& op_res
+	) {
+		auto& ctrl = ecg_cl::get_instance();
+		auto& buffer_pool = ctrl.get_buffer_pool();
+		ecg_cl_batch_t result;
+
+		std::vector<cl_uint> vertex_offsets, face_offsets;
+		get_batch_offsets(meshes, meshes_count, vertex_offsets, face_offsets, op_res);
+
+		result.meshes_cnt = static_cast<cl_uint>(meshes_count);
+		result.vertexes_cnt = vertex_offsets.back();
+		result.faces_cnt = face_offsets.back();
+
+		std::vector<vec3_base> vertexes(result.vertexes_cnt);
+		std::vector<uint32_t> indexes(with_indexes ? result.faces_cnt * 3 : 0);
+		std::atomic<bool> has_invalid_index = false;
+
+		// Indexes are rebased to the packed vertexes, so the kernels of single meshes work on the batch as is
+		cpu::parallel_for(meshes_count, g_pack_grain, [&](size_t begin, size_t end) {
+			for (size_t mesh_id = begin; mesh_id < end; ++mesh_id) {
+				const ecg_mesh_t& mesh = meshes[mesh_id];
+				std::memcpy(&vertexes[vertex_offsets[mesh_id]], mesh.vertexes, sizeof(vec3_base) * mesh.vertexes_size);
+				if (!with_indexes) continue;
+
+				uint32_t* packed_indexes = &indexes[face_offsets[mesh_id] * 3];
+				for (size_t id = 0; id < mesh.indexes_size; ++id) {
+					if (mesh.indexes[id] >= mesh.vertexes_size) has_invalid_index = true;
+					packed_indexes[id] = mesh.indexes[id] + vertex_offsets[mesh_id];
+				}
+			}
+		});
+
+		if (has_invalid_index) op_res = ecg_status_code::INVALID_ARG;
+
+		cl_int err_create_buffer = CL_SUCCESS;
+		size_t vertexes_buffer_size = sizeof(vec3_base) * vertexes.size();
+		result.vertexes_buffer = buffer_pool.acquire(chain, CL_MEM_READ_ONLY, vertexes_buffer_size, &err_create_buffer); op_res = err_create_buffer;
+		op_res = chain.write_buffer(result.vertexes_buffer, 0, vertexes_buffer_size, vertexes.data());
+
+		if (with_indexes) {
+			size_t indexes_buffer_size = sizeof(uint32_t) * indexes.size();
+			result.indexes_buffer = buffer_pool.acquire(chain, CL_MEM_READ_ONLY, indexes_buffer_size, &err_create_buffer); op_res = err_create_buffer;
+			op_res = chain.write_buffer(result.indexes_buffer, 0, indexes_buffer_size, indexes.data());
+		}
+
+		if (offsets != batch_offsets_t::NONE) {
+			const auto& offsets_data = offsets == batch_offsets_t::VERTEXES ? vertex_offsets : face_offsets;
+			size_t offsets_buffer_size = sizeof(cl_uint) * offsets_data.size();
+			result.offsets_buffer = buffer_pool.acquire(chain, CL_MEM_READ_ONLY, offsets_buffer_size, &err_create_buffer); op_res = err_create_buffer;
+			op_res = chain.write_buffer(result.offsets_buffer, 0, offsets_buffer_size, offsets_data.data());
+		}
+
+		// Host data is released on return
+		op_res = chain.wait();
+		return result;
+	}
+
+	/// <summary>
+	/// Computes every mesh of the batch with the host implementation, results of a mesh are stored at its item offset.
+	/// </summary>
+	template <typename Type, typename Func>
+	void cpu_batch(const ecg_mesh_t* meshes, size_t meshes_count, bool per_face, ecg_array_t& result, Func&& func, ecg_status_handler& op_res) {
+		std::vector<cl_uint> vertex_offsets, face_offsets;
+		get_batch_offsets(meshes, meshes_count, vertex_offsets, face_offsets, op_res);
+
+		result = allocate_array<Type>(per_face ? face_offsets.back() : meshes_count);
+		if (result.arr_ptr == nullptr) op_res = ecg_status_code::RUNTIME_ERROR;
+
+		// Host functions split large meshes between the compute threads themselves, so meshes are visited in order
+		Type* values = static_cast<Type*>(result.arr_ptr);
+		for (size_t mesh_id = 0; mesh_id < meshes_count; ++mesh_id)
+			func(&meshes[mesh_id], per_face ? values + face_offsets[mesh_id] : values + mesh_id);
+	}
+
+	ecg_array_t compute_surface_area(const ecg_mesh_t* meshes, size_t meshes_count, ecg_status* status) {
+		ecg_profile_scope profile_scope("batch::compute_surface_area");
+		auto& mem_inst = ecg_mem::get_instance();
+		ecg_array_t result;
+		ecg_status_handler op_res;
+
+		try {
+			batch_check(meshes, meshes_count, op_res, status);
+
+			if (get_active_backend() == ECG_BACKEND_CPU) {
+				cpu_batch<float>(meshes, meshes_count, false, result, [&](const ecg_mesh_t* mesh, float* area) {
+					*area = cpu::compute_surface_area(mesh, op_res);
+				}, op_res);
+				return result;
+			}
+
+			auto& ctrl = ecg_cl::get_instance();
+			auto& dev = ctrl.get_device();
+
+			std::vector<cl_uint> vertex_offsets, face_offsets;
+			get_batch_offsets(meshes, meshes_count, vertex_offsets, face_offsets, op_res);
+
+			ecg_cmd_chain chain(ctrl.get_cmd_queue());
+			auto cl_batch = allocate_cl_batch(chain, meshes, meshes_count, true, batch_offsets_t::NONE, op_res);
+			result = allocate_array<float>(meshes_count);
+			if (result.arr_ptr == nullptr) op_res = ecg_status_code::RUNTIME_ERROR;
+
+			// Meshes are the face ranges of the packed buffers, their sums go through fixed trees, so repeated runs give the same bits
+			auto areas = internal_compute_surface_areas(chain, dev, cl_batch.vertexes_buffer, cl_batch.indexes_buffer, face_offsets, op_res);
+			std::copy(areas.begin(), areas.end(), static_cast<float*>(result.arr_ptr));
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+			mem_inst.delete_memory(result.handler);
+			result = ecg_array_t{};
+		}
+
+		return result;
+	}
+
+	ecg_array_t compute_volume(const ecg_mesh_t* meshes, size_t meshes_count, ecg_status* status) {
+		ecg_profile_scope profile_scope("batch::compute_volume");
+		auto& mem_inst = ecg_mem::get_instance();
+		ecg_array_t result;
+		ecg_status_handler op_res;
+
+		try {
+			batch_check(meshes, meshes_count, op_res, status);
+
+			if (get_active_backend() == ECG_BACKEND_CPU) {
+				cpu_batch<float>(meshes, meshes_count, false, result, [&](const ecg_mesh_t* mesh, float* volume) {
+					*volume = cpu::sum_faces_volumes(mesh, op_res);
+				}, op_res);
+				return result;
+			}
+
+			auto& ctrl = ecg_cl::get_instance();
+			auto& context = ctrl.get_context();
+			auto& dev = ctrl.get_device();
+
+			cl::Program::Sources sources = { batch_compute_volume_code };
+			auto program = ecg_program_wrapper::get_program(context, dev, sources, batch_compute_volume_name);
+
+			ecg_cmd_chain chain(ctrl.get_cmd_queue());
+			auto cl_batch = allocate_cl_batch(chain, meshes, meshes_count, true, batch_offsets_t::FACES, op_res);
+			result = allocate_array<float>(meshes_count);
+			if (result.arr_ptr == nullptr) op_res = ecg_status_code::RUNTIME_ERROR;
+
+			size_t volumes_buffer_size = sizeof(float) * meshes_count;
+			ecg_pooled_buffer volumes_buffer = allocate_result_buffer(chain, result.arr_ptr, volumes_buffer_size, op_res);
+
+			cl::NDRange global = cl_batch.faces_cnt;
+			cl::NDRange local = cl::NullRange;
+
+			op_res = chain.fill_buffer(volumes_buffer, 0.0f, 0, volumes_buffer_size);
+			op_res = program->execute(
+				chain, batch_compute_volume_name, global, local,
+				cl_batch.vertexes_buffer, cl_batch.indexes_buffer, cl_batch.faces_cnt,
+				cl_batch.offsets_buffer, cl_batch.meshes_cnt,
+				volumes_buffer
+			);
+
+			read_result_buffer(chain, volumes_buffer, result.arr_ptr, volumes_buffer_size, op_res);
+			op_res = chain.wait();
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+			mem_inst.delete_memory(result.handler);
+			result = ecg_array_t{};
+		}
+
+		return result;
+	}
+
+	ecg_array_t compute_faces_normals(const ecg_mesh_t* meshes, size_t meshes_count, ecg_status* status) {
+		ecg_profile_scope profile_scope("batch::compute_faces_normals");
+		auto& mem_inst = ecg_mem::get_instance();
+		ecg_array_t result;
+		ecg_status_handler op_res;
+
+		try {
+			batch_check(meshes, meshes_count, op_res, status);
+
+			if (get_active_backend() == ECG_BACKEND_CPU) {
+				cpu_batch<vec3_base>(meshes, meshes_count, true, result, [&](const ecg_mesh_t* mesh, vec3_base* normals) {
+					ecg_array_t mesh_normals = cpu::compute_faces_normals(mesh, op_res);
+					std::memcpy(normals, mesh_normals.arr_ptr, sizeof(vec3_base) * mesh_normals.arr_size);
+					mem_inst.delete_memory(mesh_normals.handler);
+				}, op_res);
+				return result;
+			}
+
+			auto& ctrl = ecg_cl::get_instance();
+			auto& context = ctrl.get_context();
+			auto& dev = ctrl.get_device();
+
+			// Normals are written by face id, so the kernel of single meshes computes the packed faces directly
+			cl::Program::Sources sources = { compute_faces_normals_code };
+			auto program = ecg_program_wrapper::get_program(context, dev, sources, compute_faces_normals_name);
+
+			ecg_cmd_chain chain(ctrl.get_cmd_queue());
+			auto cl_batch = allocate_cl_batch(chain, meshes, meshes_count, true, batch_offsets_t::NONE, op_res);
+			result = allocate_array<vec3_base>(cl_batch.faces_cnt);
+			if (result.arr_ptr == nullptr) op_res = ecg_status_code::RUNTIME_ERROR;
+
+			size_t normals_buffer_size = sizeof(vec3_base) * cl_batch.faces_cnt;
+			ecg_pooled_buffer normals_buffer = allocate_result_buffer(chain, result.arr_ptr, normals_buffer_size, op_res);
+
+			cl_uint indexes_size = cl_batch.faces_cnt * 3;
+			cl::NDRange global = cl_batch.faces_cnt;
+			cl::NDRange local = cl::NullRange;
+
+			op_res = program->execute(
+				chain, compute_faces_normals_name, global, local,
+				cl_batch.vertexes_buffer, cl_batch.vertexes_cnt,
+				cl_batch.indexes_buffer, indexes_size,
+				normals_buffer, cl_batch.faces_cnt
+			);
+
+			read_result_buffer(chain, normals_buffer, result.arr_ptr, normals_buffer_size, op_res);
+			op_res = chain.wait();
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+			mem_inst.delete_memory(result.handler);
+			result = ecg_array_t{};
+		}
+
+		return result;
+	}
+}
+
+namespace ecg::batch::hulls {
+	ecg_array_t compute_aabb(const ecg_mesh_t* meshes, size_t meshes_count, ecg_status* status) {
+		ecg_profile_scope profile_scope("batch::hulls::compute_aabb");
+		auto& mem_inst = ecg_mem::get_instance();
+		ecg_array_t result;
+		ecg_status_handler op_res;
+
+		try {
+			batch_check(meshes, meshes_count, op_res, status);
+
+			if (get_active_backend() == ECG_BACKEND_CPU) {
+				cpu_batch<bounding_box>(meshes, meshes_count, false, result, [&](const ecg_mesh_t* mesh, bounding_box* bb) {
+					*bb = cpu::compute_aabb(mesh, op_res);
+				}, op_res);
+				return result;
+			}
+
+			auto& ctrl = ecg_cl::get_instance();
+			auto& dev = ctrl.get_device();
+
+			std::vector<cl_uint> vertex_offsets, face_offsets;
+			get_batch_offsets(meshes, meshes_count, vertex_offsets, face_offsets, op_res);
+
+			ecg_cmd_chain chain(ctrl.get_cmd_queue());
+			auto cl_batch = allocate_cl_batch(chain, meshes, meshes_count, false, batch_offsets_t::NONE, op_res);
+			result = allocate_array<bounding_box>(meshes_count);
+			if (result.arr_ptr == nullptr) op_res = ecg_status_code::RUNTIME_ERROR;
+
+			// Meshes are the vertex ranges of the packed buffer, they are reduced like the parts of one mesh without atomics
+			auto boxes = ecg::hulls::internal_compute_aabbs(chain, dev, cl_batch.vertexes_buffer, vertex_offsets, op_res);
+			std::copy(boxes.begin(), boxes.end(), static_cast<bounding_box*>(result.arr_ptr));
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+			mem_inst.delete_memory(result.handler);
+			result = ecg_array_t{};
+		}
+
+		return result;
+	}
+}
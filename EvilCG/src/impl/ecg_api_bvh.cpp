@@ -0,0 +1,236 @@
+#include <ecg_api.h>
+
+#include <core/ecg_cl_programs.h>
+#include <core/ecg_cpu.h>
+#include <core/ecg_host_ctrl.h>
+#include <core/ecg_internal.h>
+#include <core/ecg_program.h>
+
+#include <help/ecg_allocate.h>
+#include <help/ecg_logger.h>
+#include <help/ecg_helper.h>
+#include <help/ecg_checks.h>
+#include <help/ecg_geom.h>
+
+namespace ecg {
+	std::shared_ptr<ecg_program_wrapper> get_bvh_program() {
+		auto& ctrl = ecg_cl::get_instance();
+		cl::Program::Sources sources = { bvh_code };
+		return ecg_program_wrapper::get_program(ctrl.get_context(), ctrl.get_device(), sources, compute_faces_morton_codes_name);
+	}
+
+	ecg_cl_bvh_t internal_build_bvh(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res) {
+		auto& ctrl = ecg_cl::get_instance();
+		auto& buffer_pool = ctrl.get_buffer_pool();
+		auto program = get_bvh_program();
+
+		ecg_cl_bvh_t bvh;
+		bvh.leaves_cnt = static_cast<cl_uint>(mesh.indexes_size / 3);
+		const cl_uint inner_nodes_cnt = bvh.leaves_cnt - 1;
+		const cl_uint nodes_cnt = bvh.leaves_cnt + inner_nodes_cnt;
+
+		// A single face is the root itself, the node buffers are kept non-empty
+		const cl_uint inner_items_cnt = std::max<cl_uint>(inner_nodes_cnt, 1);
+
+		cl_int err_create_buffer = CL_SUCCESS;
+		ecg_pooled_buffer codes_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(cl_ulong) * bvh.leaves_cnt, &err_create_buffer); op_res = err_create_buffer;
+		ecg_pooled_buffer visits_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(cl_uint) * inner_items_cnt, &err_create_buffer); op_res = err_create_buffer;
+		bvh.faces_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(cl_uint) * bvh.leaves_cnt, &err_create_buffer); op_res = err_create_buffer;
+		bvh.children_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(cl_uint) * inner_items_cnt * 2, &err_create_buffer); op_res = err_create_buffer;
+		bvh.parents_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(cl_uint) * nodes_cnt, &err_create_buffer); op_res = err_create_buffer;
+		bvh.last_leaves_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(cl_uint) * inner_items_cnt, &err_create_buffer); op_res = err_create_buffer;
+		bvh.boxes_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(cl_float) * 6 * nodes_cnt, &err_create_buffer); op_res = err_create_buffer;
+
+		// Centroids are normalized by the box of the vertexes, flat axes keep the zero code
+		bounding_box aabb = hulls::internal_compute_aabb(chain, mesh, op_res);
+		auto get_scale = [](float min, float max) { return max > min ? 1.0f / (max - min) : 0.0f; };
+
+		cl_int vrt_size = sizeof(vec3_base) / sizeof(float);
+		cl::NDRange leaves_global = bvh.leaves_cnt;
+		cl::NDRange nodes_global = inner_nodes_cnt;
+		cl::NDRange local = cl::NullRange;
+
+		op_res = program->execute(
+			chain, compute_faces_morton_codes_name, leaves_global, local,
+			mesh.vertexes_buffer, mesh.indexes_buffer, vrt_size, bvh.leaves_cnt,
+			aabb.min.x, aabb.min.y, aabb.min.z,
+			get_scale(aabb.min.x, aabb.max.x), get_scale(aabb.min.y, aabb.max.y), get_scale(aabb.min.z, aabb.max.z),
+			codes_buffer, bvh.faces_buffer
+		);
+
+		internal_sort_keys(chain, codes_buffer, bvh.faces_buffer, bvh.leaves_cnt, bvh_morton_bits * 3, op_res);
+
+		cl_uint invalid_node = bvh_invalid_node;
+		cl_uint pattern = 0;
+		op_res = chain.fill_buffer(bvh.parents_buffer, invalid_node, 0, sizeof(cl_uint) * nodes_cnt);
+		op_res = chain.fill_buffer(visits_buffer, pattern, 0, sizeof(cl_uint) * inner_items_cnt);
+
+		if (inner_nodes_cnt != 0) {
+			op_res = program->execute(
+				chain, build_bvh_nodes_name, nodes_global, local,
+				codes_buffer, bvh.leaves_cnt,
+				bvh.children_buffer, bvh.parents_buffer, bvh.last_leaves_buffer
+			);
+		}
+
+		op_res = program->execute(
+			chain, compute_bvh_boxes_name, leaves_global, local,
+			mesh.vertexes_buffer, mesh.indexes_buffer, vrt_size,
+			bvh.faces_buffer, bvh.leaves_cnt,
+			bvh.children_buffer, bvh.parents_buffer,
+			visits_buffer, bvh.boxes_buffer
+		);
+
+		return bvh;
+	}
+
+	cl_uint internal_find_self_intersections(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_array_t* pairs, ecg_status_handler& op_res) {
+		auto& ctrl = ecg_cl::get_instance();
+		auto program = get_bvh_program();
+
+		if (mesh.indexes_size / 3 < 2) return 0;
+		ecg_cl_bvh_t bvh = internal_build_bvh(chain, mesh, op_res);
+
+		cl_int err_create_buffer = CL_SUCCESS;
+		ecg_pooled_buffer counts_buffer = ctrl.get_buffer_pool().acquire(chain, CL_MEM_READ_WRITE, sizeof(cl_uint) * (bvh.leaves_cnt + 1), &err_create_buffer); op_res = err_create_buffer;
+
+		cl_uint pattern = 0;
+		cl_int vrt_size = sizeof(vec3_base) / sizeof(float);
+		cl::NDRange global = bvh.leaves_cnt;
+		cl::NDRange local = cl::NullRange;
+
+		auto find_intersections = [&](cl_uint mode, const cl::Buffer& pairs_buffer) {
+			op_res = program->execute(
+				chain, find_bvh_intersections_name, global, local,
+				mesh.vertexes_buffer, mesh.indexes_buffer, vrt_size,
+				bvh.faces_buffer, bvh.leaves_cnt,
+				bvh.children_buffer, bvh.parents_buffer, bvh.last_leaves_buffer,
+				bvh.boxes_buffer, mode,
+				counts_buffer, pairs_buffer, counts_buffer
+			);
+		};
+
+		// The flag of the first crossing reuses the counts, nothing else is written in this mode
+		if (pairs == nullptr) {
+			cl_uint is_found = 0;
+			op_res = chain.fill_buffer(counts_buffer, pattern, 0, sizeof(cl_uint));
+			find_intersections(bvh_find_any, counts_buffer);
+
+			op_res = chain.read_buffer(counts_buffer, 0, sizeof(cl_uint), &is_found);
+			op_res = chain.wait();
+			return is_found;
+		}
+
+		// Pairs are counted per face, then written at the scanned offsets
+		cl_uint pairs_cnt = 0;
+		find_intersections(bvh_count_pairs, counts_buffer);
+		internal_scan_exclusive(chain, counts_buffer, bvh.leaves_cnt, op_res);
+		op_res = chain.read_buffer(counts_buffer, sizeof(cl_uint) * bvh.leaves_cnt, sizeof(cl_uint), &pairs_cnt);
+		op_res = chain.wait();
+
+		*pairs = allocate_array<uint32_t>(size_t(pairs_cnt) * 2);
+		if (pairs_cnt == 0) return 0;
+
+		size_t pairs_buffer_size = sizeof(cl_uint) * pairs->arr_size;
+		ecg_pooled_buffer pairs_buffer = allocate_result_buffer(chain, pairs->arr_ptr, pairs_buffer_size, op_res);
+		find_intersections(bvh_fill_pairs, pairs_buffer);
+		read_result_buffer(chain, pairs_buffer, pairs->arr_ptr, pairs_buffer_size, op_res);
+		op_res = chain.wait();
+
+		// Pairs come in the order of the leaves, sorting by face ids makes them independent of the tree
+		auto pairs_ptr = static_cast<uint32_t*>(pairs->arr_ptr);
+		std::vector<uint64_t> sorted_pairs(pairs_cnt);
+		for (size_t id = 0; id < pairs_cnt; ++id)
+			sorted_pairs[id] = (uint64_t(pairs_ptr[id * 2 + 0]) << 32) | pairs_ptr[id * 2 + 1];
+		std::sort(sorted_pairs.begin(), sorted_pairs.end());
+		for (size_t id = 0; id < pairs_cnt; ++id) {
+			pairs_ptr[id * 2 + 0] = static_cast<uint32_t>(sorted_pairs[id] >> 32);
+			pairs_ptr[id * 2 + 1] = static_cast<uint32_t>(sorted_pairs[id]);
+		}
+
+		return pairs_cnt;
+	}
+
+	cl_uint internal_find_bvh_candidates(ecg_cmd_chain& chain, 
+		const ecg_cl_mesh_t& mesh, const ecg_cl_bvh_t& bvh,
+		ecg_pooled_buffer& offsets_buffer, ecg_pooled_buffer& candidates_buffer, ecg_status_handler& op_res
+	) {
+		auto& ctrl = ecg_cl::get_instance();
+		auto& buffer_pool = ctrl.get_buffer_pool();
+		auto program = get_bvh_program();
+
+		cl_uint faces_cnt = static_cast<cl_uint>(mesh.indexes_size / 3);
+		cl_int err_create_buffer = CL_SUCCESS;
+		offsets_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(cl_uint) * (faces_cnt + 1), &err_create_buffer); op_res = err_create_buffer;
+
+		cl_int vrt_size = sizeof(vec3_base) / sizeof(float);
+		cl::NDRange global = faces_cnt;
+		cl::NDRange local = cl::NullRange;
+
+		auto find_candidates = [&](cl_uint mode, const cl::Buffer& ids_buffer) {
+			op_res = program->execute(
+				chain, find_bvh_candidates_name, global, local,
+				mesh.vertexes_buffer, mesh.indexes_buffer, vrt_size, faces_cnt,
+				bvh.faces_buffer, bvh.leaves_cnt,
+				bvh.children_buffer, bvh.parents_buffer,
+				bvh.boxes_buffer, mode,
+				offsets_buffer, ids_buffer
+			);
+		};
+
+		// Candidates are counted per face, then written at the scanned offsets
+		cl_uint candidates_cnt = 0;
+		find_candidates(bvh_count_pairs, offsets_buffer);
+		internal_scan_exclusive(chain, offsets_buffer, faces_cnt, op_res);
+		op_res = chain.read_buffer(offsets_buffer, sizeof(cl_uint) * faces_cnt, sizeof(cl_uint), &candidates_cnt);
+		op_res = chain.wait();
+		if (candidates_cnt == 0) return 0;
+
+		candidates_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(cl_uint) * candidates_cnt, &err_create_buffer); op_res = err_create_buffer;
+		find_candidates(bvh_fill_pairs, candidates_buffer);
+
+		// Lists come in the order of the leaves, sorting keeps the order of the exhaustive search
+		internal_sort_lists(chain, offsets_buffer, faces_cnt, candidates_buffer, op_res);
+		return candidates_cnt;
+	}
+
+	ecg_array_t find_self_intersections(const ecg_mesh_t* mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("find_self_intersections");
+		ecg_status_handler op_res;
+		ecg_array_t result;
+
+		try {
+			default_mesh_check(mesh, op_res, status);
+			if (get_active_backend() == ECG_BACKEND_CPU) return cpu::find_self_intersections(mesh, op_res);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+			internal_find_self_intersections(chain, cl_mesh, &result, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+			if (result.handler != 0) ecg_mem::get_instance().delete_memory(result.handler);
+			result = ecg_array_t();
+		}
+
+		return result;
+	}
+
+	ecg_array_t find_self_intersections(const ecg_uploaded_mesh_t& mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("find_self_intersections");
+		ecg_status_handler op_res;
+		ecg_array_t result;
+
+		try {
+			auto cl_mesh = uploaded_mesh_check(mesh, op_res, status);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			internal_find_self_intersections(chain, *cl_mesh, &result, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+			if (result.handler != 0) ecg_mem::get_instance().delete_memory(result.handler);
+			result = ecg_array_t();
+		}
+
+		return result;
+	}
+}
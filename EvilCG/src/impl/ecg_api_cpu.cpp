@@ -0,0 +1,1128 @@
+#include <core/ecg_cpu.h>
+
+#include <help/ecg_allocate.h>
+#include <help/ecg_helper.h>
+#include <help/ecg_math.h>
+#include <help/ecg_geom.h>
+
+namespace ecg::cpu {
+	// Quadratic passes do a lot of work per item, so they are split into small chunks
+	const size_t quadratic_grain = 16;
+
+	// Mirrors float3 of OpenCL C, so the kernels are ported to the host line by line
+	struct float3 {
+		float x;
+		float y;
+		float z;
+	};
+
+	struct double3 {
+		double x;
+		double y;
+		double z;
+	};
+
+	inline float3 operator+(const float3& lhs, const float3& rhs) { return float3{ lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z }; }
+	inline float3 operator-(const float3& lhs, const float3& rhs) { return float3{ lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z }; }
+	inline float3 operator*(const float3& lhs, float rhs) { return float3{ lhs.x * rhs, lhs.y * rhs, lhs.z * rhs }; }
+	inline float3 operator/(const float3& lhs, float rhs) { return float3{ lhs.x / rhs, lhs.y / rhs, lhs.z / rhs }; }
+	inline bool operator==(const float3& lhs, const float3& rhs) { return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z; }
+
+	inline float dot(const float3& lhs, const float3& rhs) {
+		return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
+	}
+
+	inline float3 cross(const float3& lhs, const float3& rhs) {
+		return float3{
+			lhs.y * rhs.z - lhs.z * rhs.y,
+			lhs.z * rhs.x - lhs.x * rhs.z,
+			lhs.x * rhs.y - lhs.y * rhs.x
+		};
+	}
+
+	inline float length(const float3& vrt) {
+		return std::sqrt(dot(vrt, vrt));
+	}
+
+	struct cpu_edge_t {
+		uint32_t id0;
+		uint32_t id1;
+	};
+
+	struct cpu_face_t {
+		uint32_t id0;
+		uint32_t id1;
+		uint32_t id2;
+	};
+
+	inline float3 get_vertex(const ecg_mesh_t* mesh, uint32_t id) {
+		const vec3_base& vrt = mesh->vertexes[id];
+		return float3{ vrt.x, vrt.y, vrt.z };
+	}
+
+	inline cpu_face_t get_face(const ecg_mesh_t* mesh, size_t face_id) {
+		const uint32_t* face = mesh->indexes + face_id * 3;
+		return cpu_face_t{ face[0], face[1], face[2] };
+	}
+
+	inline vec3_base to_vec3(const float3& vrt) {
+		return vec3_base(vrt.x, vrt.y, vrt.z);
+	}
+
+	// Zero vectors stay zero as with normalize in OpenCL C
+	inline float3 safe_normalize(const float3& vrt) {
+		float len = length(vrt);
+		return len > 0.0f ? vrt / len : float3{};
+	}
+
+	inline float3 get_face_normal(const float3& s0, const float3& s1, const float3& s2) {
+		return cross(s1 - s0, s2 - s0);
+	}
+
+	inline bool is_face_contains_edge(const cpu_face_t& face, const cpu_edge_t& edge) {
+		return
+			(edge.id0 == face.id0 && edge.id1 == face.id1) ||
+			(edge.id0 == face.id1 && edge.id1 == face.id2) ||
+			(edge.id0 == face.id2 && edge.id1 == face.id0) ||
+			(edge.id1 == face.id0 && edge.id0 == face.id1) ||
+			(edge.id1 == face.id1 && edge.id0 == face.id2) ||
+			(edge.id1 == face.id2 && edge.id0 == face.id0);
+	}
+
+	inline bool is_edges_equal(const cpu_edge_t& lhs, const cpu_edge_t& rhs) {
+		return
+			(lhs.id0 == rhs.id0 && lhs.id1 == rhs.id1) ||
+			(lhs.id0 == rhs.id1 && lhs.id1 == rhs.id0);
+	}
+
+	cpu_edge_t get_another_edge(const cpu_face_t& face, const cpu_edge_t& edge) {
+		cpu_edge_t new_edge{ 0, 0 };
+
+		if (face.id0 == edge.id0) {
+			if (face.id1 == edge.id1) new_edge = { face.id0, face.id2 };
+			if (face.id2 == edge.id1) new_edge = { face.id0, face.id1 };
+		}
+
+		if (face.id1 == edge.id0) {
+			if (face.id0 == edge.id1) new_edge = { face.id1, face.id2 };
+			if (face.id2 == edge.id1) new_edge = { face.id1, face.id0 };
+		}
+
+		if (face.id2 == edge.id0) {
+			if (face.id0 == edge.id1) new_edge = { face.id2, face.id1 };
+			if (face.id1 == edge.id1) new_edge = { face.id2, face.id0 };
+		}
+
+		return new_edge;
+	}
+
+	bool is_point_in_triangle(const float3& p, const float3& s0, const float3& s1, const float3& s2) {
+		float3 v0 = s1 - s0;
+		float3 v1 = s2 - s0;
+		float3 v2 = p - s0;
+
+		float d00 = dot(v0, v0); float d01 = dot(v0, v1);
+		float d11 = dot(v1, v1); float d20 = dot(v2, v0);
+		float d21 = dot(v2, v1);
+
+		float denom = d00 * d11 - d01 * d01;
+		if (denom == 0.0f) return false;
+
+		float v = (d11 * d20 - d01 * d21) / denom;
+		float w = (d00 * d21 - d01 * d20) / denom;
+		float u = 1.0f - v - w;
+		return u >= 0.0f && v >= 0.0f && w >= 0.0f;
+	}
+
+	bool get_intersection_point(
+		const float3& p0, const float3& p1,
+		const float3& s0, const float3& s1, const float3& s2,
+		float3& intersection_point
+	) {
+		float3 line_dir = p1 - p0;
+		float3 surf_norm = get_face_normal(s0, s1, s2);
+		float denom = dot(surf_norm, line_dir);
+		float d = -dot(surf_norm, s0);
+
+		if (denom == 0.0f) {
+			if (dot(surf_norm, p0) + d != 0.0f || dot(surf_norm, p1) + d != 0.0f)
+				return false;
+
+			if (is_point_in_triangle(p0, s0, s1, s2)) intersection_point = p0;
+			else if (is_point_in_triangle(p1, s0, s1, s2)) intersection_point = p1;
+			else intersection_point = (p0 + p1) / 2.0f;
+			return true;
+		}
+
+		float t_param = -(d + dot(surf_norm, p0)) / denom;
+		float3 pi_point = p0 + line_dir * t_param;
+		if (!is_point_in_triangle(pi_point, s0, s1, s2)) return false;
+
+		intersection_point = pi_point;
+		return true;
+	}
+
+	inline bool is_vertex_of_triangle(const float3& s0, const float3& s1, const float3& s2, const float3& pt) {
+		return s0 == pt || s1 == pt || s2 == pt;
+	}
+
+	bool check_is_point_in_face(const float3& s0, const float3& s1, const float3& s2, const float3& p) {
+		const float epsilon = 1e-6f;
+		float3 v0 = s1 - s0;
+		float3 v1 = s2 - s0;
+		float3 v2 = p - s0;
+
+		float d00 = dot(v0, v0); float d01 = dot(v0, v1);
+		float d11 = dot(v1, v1); float d20 = dot(v2, v0);
+		float d21 = dot(v2, v1);
+
+		float denom = d00 * d11 - d01 * d01;
+		if (std::fabs(denom) < epsilon) return false;
+
+		float v = (d11 * d20 - d01 * d21) / denom;
+		float w = (d00 * d21 - d01 * d20) / denom;
+		float u = 1.0f - v - w;
+
+		return
+			u >= -epsilon && v >= -epsilon && w >= -epsilon &&
+			u <= 1.0f + epsilon && v <= 1.0f + epsilon && w <= 1.0f + epsilon;
+	}
+
+	void intersect_face_and_line(
+		const float3& s0, const float3& s1, const float3& s2,
+		const float3& p0, const float3& p1,
+		uint32_t f1_id, uint32_t f2_id,
+		std::vector<vec3_base>& intersections, std::vector<uint32_t>& int_faces
+	) {
+		float3 surf_norm = cross(s1 - s0, s2 - s0);
+		float d = -dot(surf_norm, s0);
+		float3 line_dir = p1 - p0;
+
+		// Coplanar segments aren't reported, as on the device
+		float denom = dot(surf_norm, line_dir);
+		if (std::fabs(denom) < 1e-04f) return;
+
+		float t_param = -(d + dot(surf_norm, p0)) / denom;
+		if (t_param < 0.0f || t_param > 1.0f) return;
+
+		float3 potential_intersection = p0 + line_dir * t_param;
+		if (!check_is_point_in_face(s0, s1, s2, potential_intersection)) return;
+
+		intersections.push_back(to_vec3(potential_intersection));
+		int_faces.push_back(f1_id);
+		int_faces.push_back(f2_id);
+	}
+
+	inline void expand_bb(bounding_box& bb, const vec3_base& vrt) {
+		bb.min.x = std::min(bb.min.x, vrt.x);
+		bb.min.y = std::min(bb.min.y, vrt.y);
+		bb.min.z = std::min(bb.min.z, vrt.z);
+		bb.max.x = std::max(bb.max.x, vrt.x);
+		bb.max.y = std::max(bb.max.y, vrt.y);
+		bb.max.z = std::max(bb.max.z, vrt.z);
+	}
+
+	bounding_box merge_bb(const bounding_box& lhs, const bounding_box& rhs) {
+		return bounding_box{
+			vec3_base(std::min(lhs.min.x, rhs.min.x), std::min(lhs.min.y, rhs.min.y), std::min(lhs.min.z, rhs.min.z)),
+			vec3_base(std::max(lhs.max.x, rhs.max.x), std::max(lhs.max.y, rhs.max.y), std::max(lhs.max.z, rhs.max.z))
+		};
+	}
+
+	adjacency_list_t get_vertex_faces(const ecg_mesh_t* mesh) {
+		size_t faces_cnt = mesh->indexes_size / 3;
+		adjacency_list_t result;
+		result.offsets.assign(mesh->vertexes_size + 1, 0);
+
+		auto for_each_vertex = [mesh](size_t face_id, auto&& func) {
+			cpu_face_t face = get_face(mesh, face_id);
+			func(face.id0);
+			if (face.id1 != face.id0) func(face.id1);
+			if (face.id2 != face.id0 && face.id2 != face.id1) func(face.id2);
+		};
+
+		for (size_t face_id = 0; face_id < faces_cnt; ++face_id)
+			for_each_vertex(face_id, [&](uint32_t vrt) { ++result.offsets[vrt + 1]; });
+
+		std::partial_sum(result.offsets.begin(), result.offsets.end(), result.offsets.begin());
+		result.ids.resize(result.offsets.back());
+
+		std::vector<uint32_t> positions(result.offsets.begin(), result.offsets.end() - 1);
+		for (size_t face_id = 0; face_id < faces_cnt; ++face_id)
+			for_each_vertex(face_id, [&](uint32_t vrt) { result.ids[positions[vrt]++] = static_cast<uint32_t>(face_id); });
+
+		return result;
+	}
+
+	bool is_mesh_vertexes_manifold(const ecg_mesh_t* mesh) {
+		adjacency_list_t vertex_faces = get_vertex_faces(mesh);
+		std::atomic<bool> result = true;
+
+		// Every vertex must have one closed fan of faces, the walk goes from face to face over the edges of the vertex
+		parallel_for(mesh->vertexes_size, default_grain, [&](size_t begin, size_t end) {
+			for (size_t vrt = begin; vrt < end && result; ++vrt) {
+				const uint32_t* faces = vertex_faces.ids.data() + vertex_faces.offsets[vrt];
+				const uint32_t faces_cnt = vertex_faces.offsets[vrt + 1] - vertex_faces.offsets[vrt];
+				const uint32_t vertex_id = static_cast<uint32_t>(vrt);
+
+				auto find_next_face = [&](const cpu_edge_t& edge, uint32_t prev_face_id) {
+					for (uint32_t id = 0; id < faces_cnt; ++id) {
+						if (faces[id] == prev_face_id) continue;
+						if (is_face_contains_edge(get_face(mesh, faces[id]), edge)) return faces[id];
+					}
+					return prev_face_id;
+				};
+
+				if (faces_cnt == 0) {
+					result = false;
+					return;
+				}
+
+				uint32_t origin_face_id = faces[0];
+				cpu_face_t origin_face = get_face(mesh, origin_face_id);
+				cpu_edge_t origin_edge{ vertex_id, 0 };
+				if (origin_face.id0 == vertex_id) origin_edge.id1 = origin_face.id1;
+				if (origin_face.id1 == vertex_id) origin_edge.id1 = origin_face.id2;
+				if (origin_face.id2 == vertex_id) origin_edge.id1 = origin_face.id0;
+
+				uint32_t prev_face_id = origin_face_id;
+				uint32_t next_face_id = find_next_face(origin_edge, prev_face_id);
+				if (next_face_id == prev_face_id) {
+					result = false;
+					return;
+				}
+
+				cpu_edge_t current_edge = get_another_edge(get_face(mesh, next_face_id), origin_edge);
+				uint32_t iter_counter = 1;
+
+				while (!is_edges_equal(origin_edge, current_edge) && iter_counter < faces_cnt) {
+					prev_face_id = next_face_id;
+					next_face_id = find_next_face(current_edge, prev_face_id);
+					if (next_face_id == prev_face_id) {
+						result = false;
+						return;
+					}
+
+					current_edge = get_another_edge(get_face(mesh, next_face_id), current_edge);
+					++iter_counter;
+				}
+
+				if (iter_counter != faces_cnt || !is_edges_equal(origin_edge, current_edge)) {
+					result = false;
+					return;
+				}
+			}
+		});
+
+		return result;
+	}
+
+	void check_indexes(const ecg_mesh_t* mesh, ecg_status_handler& op_res) {
+		// The device reads garbage for broken indexes, the host would read outside of the array
+		const uint32_t* indexes = mesh->indexes;
+		const uint32_t vertexes_size = mesh->vertexes_size;
+
+		uint32_t max_index = parallel_reduce(mesh->indexes_size, default_grain, uint32_t(0),
+			[indexes](size_t begin, size_t end) {
+				uint32_t result = 0;
+				for (size_t id = begin; id < end; ++id)
+					result = std::max(result, indexes[id]);
+				return result;
+			},
+			[](uint32_t lhs, uint32_t rhs) { return std::max(lhs, rhs); }
+		);
+
+		if (max_index >= vertexes_size) op_res = ecg_status_code::INVALID_ARG;
+	}
+
+	vec3_base sum_vertexes(const ecg_mesh_t* mesh, [[maybe_unused]] ecg_status_handler& op_res) {
+		const vec3_base* vertexes = mesh->vertexes;
+
+		double3 result = parallel_reduce(mesh->vertexes_size, default_grain, double3{},
+			[vertexes](size_t begin, size_t end) {
+				double3 acc{};
+				for (size_t id = begin; id < end; ++id) {
+					acc.x += vertexes[id].x;
+					acc.y += vertexes[id].y;
+					acc.z += vertexes[id].z;
+				}
+				return acc;
+			},
+			[](const double3& lhs, const double3& rhs) {
+				return double3{ lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z };
+			}
+		);
+
+		return vec3_base(
+			static_cast<float>(result.x),
+			static_cast<float>(result.y),
+			static_cast<float>(result.z)
+		);
+	}
+
+	vec3_base get_center(const ecg_mesh_t* mesh, ecg_status_handler& op_res) {
+		vec3_base acc = sum_vertexes(mesh, op_res);
+		return acc / static_cast<float>(mesh->vertexes_size);
+	}
+
+	float compute_surface_area(const ecg_mesh_t* mesh, ecg_status_handler& op_res) {
+		check_indexes(mesh, op_res);
+
+		double result = parallel_reduce(mesh->indexes_size / 3, default_grain, 0.0,
+			[mesh](size_t begin, size_t end) {
+				double acc = 0.0;
+				for (size_t face_id = begin; face_id < end; ++face_id) {
+					cpu_face_t face = get_face(mesh, face_id);
+					float3 v0 = get_vertex(mesh, face.id0);
+					float3 v1 = get_vertex(mesh, face.id1);
+					float3 v2 = get_vertex(mesh, face.id2);
+					acc += length(cross(v1 - v0, v2 - v0)) / 2.0f;
+				}
+				return acc;
+			},
+			std::plus<double>()
+		);
+
+		return static_cast<float>(result);
+	}
+
+	ecg_array_t compute_faces_areas(const ecg_mesh_t* mesh, ecg_array_t* areas_cdf, ecg_status_handler& op_res) {
+		check_indexes(mesh, op_res);
+		size_t faces_cnt = mesh->indexes_size / 3;
+
+		ecg_array_t result = allocate_array<float>(faces_cnt);
+		float* areas = static_cast<float*>(result.arr_ptr);
+
+		parallel_for(faces_cnt, default_grain, [&](size_t begin, size_t end) {
+			for (size_t face_id = begin; face_id < end; ++face_id) {
+				cpu_face_t face = get_face(mesh, face_id);
+				float3 v0 = get_vertex(mesh, face.id0);
+				float3 v1 = get_vertex(mesh, face.id1);
+				float3 v2 = get_vertex(mesh, face.id2);
+				areas[face_id] = length(cross(v1 - v0, v2 - v0)) / 2.0f;
+			}
+		});
+
+		if (areas_cdf != nullptr) {
+			*areas_cdf = allocate_array<float>(faces_cnt);
+			float* cdf = static_cast<float*>(areas_cdf->arr_ptr);
+
+			double acc = 0.0;
+			for (size_t face_id = 0; face_id < faces_cnt; ++face_id) {
+				acc += areas[face_id];
+				cdf[face_id] = static_cast<float>(acc);
+			}
+		}
+
+		return result;
+	}
+
+	mat3_base compute_covariance_matrix(const ecg_mesh_t* mesh, ecg_status_handler& op_res) {
+		vec3_base center = get_center(mesh, op_res);
+		const vec3_base* vertexes = mesh->vertexes;
+
+		// Row-major as mat3_base, accumulated in double so the sum doesn't lose small vertexes
+		using mat3_acc_t = std::array<double, 9>;
+		mat3_acc_t result = parallel_reduce(mesh->vertexes_size, default_grain, mat3_acc_t{},
+			[vertexes, center](size_t begin, size_t end) {
+				mat3_acc_t acc{};
+				for (size_t id = begin; id < end; ++id) {
+					double diff[3] = {
+						double(vertexes[id].x) - center.x,
+						double(vertexes[id].y) - center.y,
+						double(vertexes[id].z) - center.z
+					};
+
+					for (size_t row = 0; row < 3; ++row)
+						for (size_t col = 0; col < 3; ++col)
+							acc[row * 3 + col] += diff[row] * diff[col];
+				}
+				return acc;
+			},
+			[](const mat3_acc_t& lhs, const mat3_acc_t& rhs) {
+				mat3_acc_t sum;
+				for (size_t id = 0; id < sum.size(); ++id) sum[id] = lhs[id] + rhs[id];
+				return sum;
+			}
+		);
+
+		return mat3_base{
+			static_cast<float>(result[0]), static_cast<float>(result[1]), static_cast<float>(result[2]),
+			static_cast<float>(result[3]), static_cast<float>(result[4]), static_cast<float>(result[5]),
+			static_cast<float>(result[6]), static_cast<float>(result[7]), static_cast<float>(result[8])
+		};
+	}
+
+	// Undirected edges of all faces as min << 32 | max, equal edges are next to each other after the sort
+	std::vector<uint64_t> get_sorted_edges(const ecg_mesh_t* mesh) {
+		size_t faces_cnt = mesh->indexes_size / 3;
+		std::vector<uint64_t> edges(faces_cnt * 3);
+
+		parallel_for(faces_cnt, default_grain, [&](size_t begin, size_t end) {
+			for (size_t face_id = begin; face_id < end; ++face_id) {
+				cpu_face_t face = get_face(mesh, face_id);
+				auto [e0_a, e0_b] = make_edge(face.id0, face.id1);
+				auto [e1_a, e1_b] = make_edge(face.id1, face.id2);
+				auto [e2_a, e2_b] = make_edge(face.id2, face.id0);
+				edges[face_id * 3 + 0] = (uint64_t(e0_a) << 32) | e0_b;
+				edges[face_id * 3 + 1] = (uint64_t(e1_a) << 32) | e1_b;
+				edges[face_id * 3 + 2] = (uint64_t(e2_a) << 32) | e2_b;
+			}
+		});
+
+		std::sort(edges.begin(), edges.end());
+		return edges;
+	}
+
+	// Calls func(edge, faces_cnt) for every distinct edge
+	template <typename Func>
+	void for_each_edge(const std::vector<uint64_t>& edges, Func&& func) {
+		for (size_t id = 0; id < edges.size();) {
+			size_t next = id;
+			while (next < edges.size() && edges[next] == edges[id]) ++next;
+			func(edges[id], next - id);
+			id = next;
+		}
+	}
+
+	ecg_edge_stats_t compute_edge_stats(const ecg_mesh_t* mesh, ecg_status_handler& op_res) {
+		check_indexes(mesh, op_res);
+		ecg_edge_stats_t result{};
+
+		for_each_edge(get_sorted_edges(mesh), [&](uint64_t, size_t faces_cnt) {
+			++result.edges_cnt;
+			if (faces_cnt == 1) ++result.boundary_edges_cnt;
+			if (faces_cnt > 2) ++result.non_manifold_edges_cnt;
+		});
+
+		return result;
+	}
+
+	ecg_array_t find_edges(const ecg_mesh_t* mesh, uint32_t min_faces_cnt, uint32_t max_faces_cnt, ecg_status_handler& op_res) {
+		check_indexes(mesh, op_res);
+		std::vector<uint32_t> found;
+
+		for_each_edge(get_sorted_edges(mesh), [&](uint64_t edge, size_t faces_cnt) {
+			if (faces_cnt < min_faces_cnt || faces_cnt > max_faces_cnt) return;
+			found.push_back(static_cast<uint32_t>(edge >> 32));
+			found.push_back(static_cast<uint32_t>(edge));
+		});
+
+		ecg_array_t result = allocate_array<uint32_t>(found.size());
+		safe_copy_to_arr(result, found);
+		return result;
+	}
+
+	ecg_array_t compute_vertexes_valence(const ecg_mesh_t* mesh, ecg_status_handler& op_res) {
+		check_indexes(mesh, op_res);
+		ecg_array_t result = allocate_array<uint32_t>(mesh->vertexes_size);
+		uint32_t* valence = static_cast<uint32_t*>(result.arr_ptr);
+		std::fill(valence, valence + mesh->vertexes_size, 0);
+
+		for_each_edge(get_sorted_edges(mesh), [&](uint64_t edge, size_t) {
+			uint32_t id0 = static_cast<uint32_t>(edge >> 32);
+			uint32_t id1 = static_cast<uint32_t>(edge);
+			if (id0 == id1) return;
+			++valence[id0];
+			++valence[id1];
+		});
+
+		return result;
+	}
+
+	adjacency_list_t get_face_faces(const ecg_mesh_t* mesh) {
+		size_t faces_cnt = mesh->indexes_size / 3;
+		adjacency_list_t result;
+		result.offsets.assign(faces_cnt + 1, 0);
+
+		// Half-edges sorted by their edge, faces of one run are neighbours of each other
+		std::vector<std::pair<uint64_t, uint32_t>> half_edges(faces_cnt * 3);
+		parallel_for(half_edges.size(), default_grain, [&](size_t begin, size_t end) {
+			for (size_t id = begin; id < end; ++id) {
+				size_t next = id % 3 == 2 ? id - 2 : id + 1;
+				auto [id0, id1] = make_edge(mesh->indexes[id], mesh->indexes[next]);
+				half_edges[id] = { (uint64_t(id0) << 32) | id1, static_cast<uint32_t>(id) };
+			}
+		});
+		std::sort(half_edges.begin(), half_edges.end());
+
+		auto for_each_pair = [&](auto&& func) {
+			for (size_t first = 0; first < half_edges.size();) {
+				size_t last = first;
+				while (last < half_edges.size() && half_edges[last].first == half_edges[first].first) ++last;
+
+				for (size_t id = first; id < last; ++id)
+					for (size_t other = first; other < last; ++other)
+						if (half_edges[id].second / 3 != half_edges[other].second / 3)
+							func(half_edges[id].second / 3, half_edges[other].second / 3);
+				first = last;
+			}
+		};
+
+		for_each_pair([&](uint32_t face_id, uint32_t) { ++result.offsets[face_id + 1]; });
+		std::partial_sum(result.offsets.begin(), result.offsets.end(), result.offsets.begin());
+		result.ids.resize(result.offsets.back());
+
+		std::vector<uint32_t> positions(result.offsets.begin(), result.offsets.end() - 1);
+		for_each_pair([&](uint32_t face_id, uint32_t neighbour_id) { result.ids[positions[face_id]++] = neighbour_id; });
+
+		parallel_for(faces_cnt, default_grain, [&](size_t begin, size_t end) {
+			for (size_t face_id = begin; face_id < end; ++face_id)
+				std::sort(result.ids.begin() + result.offsets[face_id], result.ids.begin() + result.offsets[face_id + 1]);
+		});
+
+		return result;
+	}
+
+	adjacency_list_t get_vertex_vertexes(const ecg_mesh_t* mesh) {
+		std::vector<uint64_t> edges = get_sorted_edges(mesh);
+		adjacency_list_t result;
+		result.offsets.assign(mesh->vertexes_size + 1, 0);
+
+		auto for_each_neighbour = [&](auto&& func) {
+			for_each_edge(edges, [&](uint64_t edge, size_t) {
+				uint32_t id0 = static_cast<uint32_t>(edge >> 32);
+				uint32_t id1 = static_cast<uint32_t>(edge);
+				if (id0 == id1) return;
+				func(id0, id1);
+				func(id1, id0);
+			});
+		};
+
+		for_each_neighbour([&](uint32_t vrt, uint32_t) { ++result.offsets[vrt + 1]; });
+		std::partial_sum(result.offsets.begin(), result.offsets.end(), result.offsets.begin());
+		result.ids.resize(result.offsets.back());
+
+		// Edges are ordered by their smaller vertex, so smaller neighbours come first and every list is sorted
+		std::vector<uint32_t> positions(result.offsets.begin(), result.offsets.end() - 1);
+		for_each_neighbour([&](uint32_t vrt, uint32_t neighbour) { result.ids[positions[vrt]++] = neighbour; });
+
+		return result;
+	}
+
+	ecg_adjacency_list_t to_adjacency_list(adjacency_list_t list) {
+		ecg_adjacency_list_t result;
+		result.offsets = allocate_array<uint32_t>(list.offsets.size());
+		result.ids = allocate_array<uint32_t>(list.ids.size());
+		safe_copy_to_arr(result.offsets, list.offsets);
+		safe_copy_to_arr(result.ids, list.ids);
+		return result;
+	}
+
+	ecg_adjacency_t build_adjacency(const ecg_mesh_t* mesh, ecg_status_handler& op_res) {
+		check_indexes(mesh, op_res);
+
+		ecg_adjacency_t result;
+		result.vertex_faces = to_adjacency_list(get_vertex_faces(mesh));
+		result.face_faces = to_adjacency_list(get_face_faces(mesh));
+		result.vertex_vertexes = to_adjacency_list(get_vertex_vertexes(mesh));
+		return result;
+	}
+
+	bool is_mesh_closed(const ecg_mesh_t* mesh, ecg_status_handler& op_res) {
+		// Every undirected edge of a closed mesh is shared by exactly two faces
+		ecg_edge_stats_t stats = compute_edge_stats(mesh, op_res);
+		return stats.boundary_edges_cnt == 0 && stats.non_manifold_edges_cnt == 0;
+	}
+
+	// Segment p0-p1 of the face o0-o1-o2 against the face s0-s1-s2, see is_segment_crossing_face of bvh_code
+	bool is_segment_crossing_face(
+		const float3& p0, const float3& p1,
+		const float3& s0, const float3& s1, const float3& s2,
+		const float3& o0, const float3& o1, const float3& o2
+	) {
+		const bool is_p0_shared = is_vertex_of_triangle(s0, s1, s2, p0);
+		const bool is_p1_shared = is_vertex_of_triangle(s0, s1, s2, p1);
+		if (is_p0_shared && is_p1_shared) return false;
+
+		const float3 direction = p1 - p0;
+		const float3 normal = get_face_normal(s0, s1, s2);
+		const float denom = dot(normal, direction);
+		const float d = -dot(normal, s0);
+
+		if (denom == 0.0f) {
+			if (dot(normal, p0) + d != 0.0f || dot(normal, p1) + d != 0.0f) return false;
+			return
+				(!is_p0_shared && is_point_in_triangle(p0, s0, s1, s2)) ||
+				(!is_p1_shared && is_point_in_triangle(p1, s0, s1, s2));
+		}
+
+		if (is_p0_shared || is_p1_shared) return false;
+
+		const float t_param = -(d + dot(normal, p0)) / denom;
+		if (t_param < 0.0f || t_param > 1.0f) return false;
+
+		const float3 point = p0 + direction * t_param;
+		return
+			is_point_in_triangle(point, s0, s1, s2) &&
+			!is_vertex_of_triangle(s0, s1, s2, point) &&
+			!is_vertex_of_triangle(o0, o1, o2, point);
+	}
+
+	bool is_faces_crossed(const ecg_mesh_t* mesh, uint32_t first_id, uint32_t second_id) {
+		cpu_face_t first = get_face(mesh, first_id);
+		cpu_face_t second = get_face(mesh, second_id);
+		float3 a0 = get_vertex(mesh, first.id0), a1 = get_vertex(mesh, first.id1), a2 = get_vertex(mesh, first.id2);
+		float3 b0 = get_vertex(mesh, second.id0), b1 = get_vertex(mesh, second.id1), b2 = get_vertex(mesh, second.id2);
+
+		return
+			is_segment_crossing_face(a0, a1, b0, b1, b2, a0, a1, a2) ||
+			is_segment_crossing_face(a1, a2, b0, b1, b2, a0, a1, a2) ||
+			is_segment_crossing_face(a2, a0, b0, b1, b2, a0, a1, a2) ||
+			is_segment_crossing_face(b0, b1, a0, a1, a2, b0, b1, b2) ||
+			is_segment_crossing_face(b1, b2, a0, a1, a2, b0, b1, b2) ||
+			is_segment_crossing_face(b2, b0, a0, a1, a2, b0, b1, b2);
+	}
+
+	std::vector<uint32_t> get_crossed_faces(const ecg_mesh_t* mesh, bool first_only) {
+		const uint32_t faces_cnt = mesh->indexes_size / 3;
+		const float box_padding = 1e-5f;
+
+		// Padded boxes of the faces, as the leaves of the device BVH
+		std::vector<float3> boxes(size_t(faces_cnt) * 2);
+		for (uint32_t face_id = 0; face_id < faces_cnt; ++face_id) {
+			cpu_face_t face = get_face(mesh, face_id);
+			float3 v0 = get_vertex(mesh, face.id0), v1 = get_vertex(mesh, face.id1), v2 = get_vertex(mesh, face.id2);
+			float3 box_min = { std::min({ v0.x, v1.x, v2.x }), std::min({ v0.y, v1.y, v2.y }), std::min({ v0.z, v1.z, v2.z }) };
+			float3 box_max = { std::max({ v0.x, v1.x, v2.x }), std::max({ v0.y, v1.y, v2.y }), std::max({ v0.z, v1.z, v2.z }) };
+			float3 padding = {
+				std::max(std::fabs(box_min.x), std::fabs(box_max.x)) * box_padding,
+				std::max(std::fabs(box_min.y), std::fabs(box_max.y)) * box_padding,
+				std::max(std::fabs(box_min.z), std::fabs(box_max.z)) * box_padding
+			};
+			boxes[face_id * 2 + 0] = box_min - padding;
+			boxes[face_id * 2 + 1] = box_max + padding;
+		}
+
+		auto is_boxes_overlapped = [&](uint32_t first_id, uint32_t second_id) {
+			const float3& min0 = boxes[first_id * 2 + 0]; const float3& max0 = boxes[first_id * 2 + 1];
+			const float3& min1 = boxes[second_id * 2 + 0]; const float3& max1 = boxes[second_id * 2 + 1];
+			return
+				min0.x <= max1.x && max0.x >= min1.x &&
+				min0.y <= max1.y && max0.y >= min1.y &&
+				min0.z <= max1.z && max0.z >= min1.z;
+		};
+
+		// Sort and sweep along x, only faces that start before the end of a box can overlap it
+		std::vector<uint32_t> sorted_faces(faces_cnt);
+		std::iota(sorted_faces.begin(), sorted_faces.end(), 0);
+		std::sort(sorted_faces.begin(), sorted_faces.end(), [&](uint32_t lhs, uint32_t rhs) {
+			return boxes[lhs * 2].x < boxes[rhs * 2].x || (boxes[lhs * 2].x == boxes[rhs * 2].x && lhs < rhs);
+		});
+
+		std::mutex pairs_lock;
+		std::vector<uint64_t> pairs;
+		std::atomic<bool> is_found = false;
+
+		parallel_for(faces_cnt, quadratic_grain, [&](size_t begin, size_t end) {
+			std::vector<uint64_t> range_pairs;
+			for (size_t position = begin; position < end && !(first_only && is_found); ++position) {
+				const uint32_t face_id = sorted_faces[position];
+				const float sweep_end = boxes[face_id * 2 + 1].x;
+
+				for (size_t other = position + 1; other < faces_cnt && boxes[sorted_faces[other] * 2].x <= sweep_end; ++other) {
+					const uint32_t other_id = sorted_faces[other];
+					if (!is_boxes_overlapped(face_id, other_id) || !is_faces_crossed(mesh, face_id, other_id)) continue;
+					range_pairs.push_back((uint64_t(std::min(face_id, other_id)) << 32) | std::max(face_id, other_id));
+					if (first_only) {
+						is_found = true;
+						break;
+					}
+				}
+			}
+
+			std::scoped_lock lock(pairs_lock);
+			pairs.insert(pairs.end(), range_pairs.begin(), range_pairs.end());
+		});
+
+		std::sort(pairs.begin(), pairs.end());
+		std::vector<uint32_t> result(pairs.size() * 2);
+		for (size_t id = 0; id < pairs.size(); ++id) {
+			result[id * 2 + 0] = static_cast<uint32_t>(pairs[id] >> 32);
+			result[id * 2 + 1] = static_cast<uint32_t>(pairs[id]);
+		}
+
+		return result;
+	}
+
+	ecg_array_t find_self_intersections(const ecg_mesh_t* mesh, ecg_status_handler& op_res) {
+		check_indexes(mesh, op_res);
+		std::vector<uint32_t> pairs = get_crossed_faces(mesh, false);
+
+		ecg_array_t result = allocate_array<uint32_t>(pairs.size());
+		safe_copy_to_arr(result, pairs);
+		return result;
+	}
+
+	bool is_mesh_self_intersected(const ecg_mesh_t* mesh, self_intersection_method method, ecg_status_handler& op_res) {
+		check_indexes(mesh, op_res);
+		if (method == self_intersection_method::SI_BVH)
+			return !get_crossed_faces(mesh, true).empty();
+		size_t faces_cnt = mesh->indexes_size / 3;
+		std::atomic<bool> result = false;
+
+		parallel_for(faces_cnt, quadratic_grain, [&](size_t begin, size_t end) {
+			for (size_t face_id = begin; face_id < end && !result; ++face_id) {
+				cpu_face_t curr_face = get_face(mesh, face_id);
+				float3 curr_v0 = get_vertex(mesh, curr_face.id0);
+				float3 curr_v1 = get_vertex(mesh, curr_face.id1);
+				float3 curr_v2 = get_vertex(mesh, curr_face.id2);
+
+				for (size_t id = 0; id < faces_cnt; ++id) {
+					if (id == face_id) continue;
+
+					cpu_face_t face = get_face(mesh, id);
+					float3 v0 = get_vertex(mesh, face.id0);
+					float3 v1 = get_vertex(mesh, face.id1);
+					float3 v2 = get_vertex(mesh, face.id2);
+
+					// Edges of both faces against the other face, touching at a vertex isn't an intersection
+					auto check = [&](const float3& p0, const float3& p1, const float3& s0, const float3& s1, const float3& s2) {
+						float3 point{};
+						return get_intersection_point(p0, p1, s0, s1, s2, point) && !is_vertex_of_triangle(v0, v1, v2, point);
+					};
+
+					if (check(curr_v0, curr_v1, v0, v1, v2) || check(curr_v1, curr_v2, v0, v1, v2) || check(curr_v2, curr_v0, v0, v1, v2) ||
+						check(v0, v1, curr_v0, curr_v1, curr_v2) || check(v1, v2, curr_v0, curr_v1, curr_v2) || check(v2, v0, curr_v0, curr_v1, curr_v2)) {
+						result = true;
+						return;
+					}
+				}
+			}
+		});
+
+		return result;
+	}
+
+	bool is_mesh_manifold(const ecg_mesh_t* mesh, ecg_status_handler& op_res) {
+		return
+			is_mesh_closed(mesh, op_res) &&
+			is_mesh_vertexes_manifold(mesh) &&
+			!is_mesh_self_intersected(mesh, self_intersection_method::SI_BRUTEFORCE, op_res);
+	}
+
+	ecg_array_t triangulate_mesh(const ecg_mesh_t* mesh, int base_num_vert, ecg_status_handler& op_res) {
+		const size_t triangle_size = 3;
+		const size_t old_faces_cnt = mesh->indexes_size / base_num_vert;
+		const size_t one_face_to_multiply = base_num_vert - 2;
+		const uint32_t* old_indexes = mesh->indexes;
+
+		ecg_array_t result = allocate_array<uint32_t>(one_face_to_multiply * old_faces_cnt * triangle_size);
+		if (result.arr_ptr == nullptr) op_res = ecg_status_code::RUNTIME_ERROR;
+		uint32_t* new_indexes = static_cast<uint32_t*>(result.arr_ptr);
+
+		// Faces are split into fans around their first vertex
+		parallel_for(old_faces_cnt, default_grain, [&](size_t begin, size_t end) {
+			for (size_t face_id = begin; face_id < end; ++face_id) {
+				size_t index_id = face_id * base_num_vert;
+				size_t new_face_id = face_id * one_face_to_multiply;
+
+				for (size_t id = 0; id < one_face_to_multiply; ++id, ++new_face_id) {
+					size_t current_index = index_id + id + 1;
+					new_indexes[new_face_id * 3 + 0] = old_indexes[index_id];
+					new_indexes[new_face_id * 3 + 1] = old_indexes[current_index];
+					new_indexes[new_face_id * 3 + 2] = old_indexes[current_index + 1];
+				}
+			}
+		});
+
+		return result;
+	}
+
+	float compute_volume(const ecg_mesh_t* mesh, ecg_status_handler& op_res) {
+		bool is_manifold = is_mesh_manifold(mesh, op_res);
+		if (!is_manifold) op_res = ecg_status_code::NON_MANIFOLD_MESH;
+		return sum_faces_volumes(mesh, op_res);
+	}
+
+	float sum_faces_volumes(const ecg_mesh_t* mesh, ecg_status_handler& op_res) {
+		check_indexes(mesh, op_res);
+
+		double result = parallel_reduce(mesh->indexes_size / 3, default_grain, 0.0,
+			[mesh](size_t begin, size_t end) {
+				double acc = 0.0;
+				for (size_t face_id = begin; face_id < end; ++face_id) {
+					cpu_face_t face = get_face(mesh, face_id);
+					float3 v0 = get_vertex(mesh, face.id0);
+					float3 v1 = get_vertex(mesh, face.id1);
+					float3 v2 = get_vertex(mesh, face.id2);
+
+					float3 norm = get_face_normal(v0, v1, v2);
+					float3 center = (v0 + v1 + v2) / 3.0f;
+					float surf_area = length(norm) / 2.0f;
+					float sign = dot(center, norm) > 0.0f ? 1.0f : -1.0f;
+					acc += (1.0f / 3.0f) * surf_area * sign;
+				}
+				return acc;
+			},
+			std::plus<double>()
+		);
+
+		return static_cast<float>(result);
+	}
+
+	ecg_array_t compute_faces_normals(const ecg_mesh_t* mesh, ecg_status_handler& op_res) {
+		check_indexes(mesh, op_res);
+		size_t faces_cnt = mesh->indexes_size / 3;
+
+		ecg_array_t result = allocate_array<vec3_base>(faces_cnt);
+		vec3_base* normals = static_cast<vec3_base*>(result.arr_ptr);
+
+		parallel_for(faces_cnt, default_grain, [&](size_t begin, size_t end) {
+			for (size_t face_id = begin; face_id < end; ++face_id) {
+				cpu_face_t face = get_face(mesh, face_id);
+				float3 v0 = get_vertex(mesh, face.id0);
+				float3 v1 = get_vertex(mesh, face.id1);
+				float3 v2 = get_vertex(mesh, face.id2);
+				normals[face_id] = to_vec3(safe_normalize(get_face_normal(v0, v1, v2)));
+			}
+		});
+
+		return result;
+	}
+
+	ecg_array_t compute_vertex_normals(const ecg_mesh_t* mesh, ecg_status_handler& op_res) {
+		check_indexes(mesh, op_res);
+		size_t faces_cnt = mesh->indexes_size / 3;
+
+		std::vector<float3> faces_normals(faces_cnt);
+		parallel_for(faces_cnt, default_grain, [&](size_t begin, size_t end) {
+			for (size_t face_id = begin; face_id < end; ++face_id) {
+				cpu_face_t face = get_face(mesh, face_id);
+				float3 v0 = get_vertex(mesh, face.id0);
+				float3 v1 = get_vertex(mesh, face.id1);
+				float3 v2 = get_vertex(mesh, face.id2);
+				faces_normals[face_id] = safe_normalize(get_face_normal(v0, v1, v2));
+			}
+		});
+
+		adjacency_list_t vertex_faces = get_vertex_faces(mesh);
+		ecg_array_t result = allocate_array<vec3_base>(mesh->vertexes_size);
+		vec3_base* normals = static_cast<vec3_base*>(result.arr_ptr);
+
+		// Average of the normals of adjacent faces, vertexes without faces get a zero normal
+		parallel_for(mesh->vertexes_size, default_grain, [&](size_t begin, size_t end) {
+			for (size_t vrt = begin; vrt < end; ++vrt) {
+				float3 normal{};
+				uint32_t first = vertex_faces.offsets[vrt];
+				uint32_t last = vertex_faces.offsets[vrt + 1];
+
+				for (uint32_t id = first; id < last; ++id)
+					normal = normal + faces_normals[vertex_faces.ids[id]];
+				if (last != first) normal = normal / static_cast<float>(last - first);
+
+				normals[vrt] = to_vec3(normal);
+			}
+		});
+
+		return result;
+	}
+
+	intersection_set_t get_intersection_points(const ecg_mesh_t* m1, const ecg_mesh_t* m2, ecg_status_handler& op_res) {
+		check_indexes(m1, op_res);
+		check_indexes(m2, op_res);
+
+		size_t m1_faces_cnt = m1->indexes_size / 3;
+		size_t m2_faces_cnt = m2->indexes_size / 3;
+		intersection_set_t result{};
+
+		// Points of every face are collected separately and joined in the order of the faces
+		std::vector<std::vector<vec3_base>> face_intersections(m1_faces_cnt);
+		std::vector<std::vector<uint32_t>> face_int_faces(m1_faces_cnt);
+
+		parallel_for(m1_faces_cnt, quadratic_grain, [&](size_t begin, size_t end) {
+			for (size_t m1_face_id = begin; m1_face_id < end; ++m1_face_id) {
+				cpu_face_t face_1 = get_face(m1, m1_face_id);
+				float3 a_1 = get_vertex(m1, face_1.id0);
+				float3 b_1 = get_vertex(m1, face_1.id1);
+				float3 c_1 = get_vertex(m1, face_1.id2);
+
+				auto& intersections = face_intersections[m1_face_id];
+				auto& int_faces = face_int_faces[m1_face_id];
+				uint32_t f1_id = static_cast<uint32_t>(m1_face_id);
+
+				for (size_t m2_face_id = 0; m2_face_id < m2_faces_cnt; ++m2_face_id) {
+					cpu_face_t face_2 = get_face(m2, m2_face_id);
+					float3 a_2 = get_vertex(m2, face_2.id0);
+					float3 b_2 = get_vertex(m2, face_2.id1);
+					float3 c_2 = get_vertex(m2, face_2.id2);
+					uint32_t f2_id = static_cast<uint32_t>(m2_face_id);
+
+					intersect_face_and_line(a_1, b_1, c_1, a_2, b_2, f1_id, f2_id, intersections, int_faces);
+					intersect_face_and_line(a_1, b_1, c_1, b_2, c_2, f1_id, f2_id, intersections, int_faces);
+					intersect_face_and_line(a_1, b_1, c_1, c_2, a_2, f1_id, f2_id, intersections, int_faces);
+
+					intersect_face_and_line(a_2, b_2, c_2, a_1, b_1, f1_id, f2_id, intersections, int_faces);
+					intersect_face_and_line(a_2, b_2, c_2, b_1, c_1, f1_id, f2_id, intersections, int_faces);
+					intersect_face_and_line(a_2, b_2, c_2, c_1, a_1, f1_id, f2_id, intersections, int_faces);
+				}
+			}
+		});
+
+		std::vector<vec3_base> intersections;
+		std::vector<uint32_t> int_faces;
+		for (size_t face_id = 0; face_id < m1_faces_cnt; ++face_id) {
+			intersections.insert(intersections.end(), face_intersections[face_id].begin(), face_intersections[face_id].end());
+			int_faces.insert(int_faces.end(), face_int_faces[face_id].begin(), face_int_faces[face_id].end());
+		}
+
+		if (intersections.empty()) return result;
+
+		auto [opt_vrt, opt_ind] = optimize_intersection(intersections, int_faces);
+		result.vrt = allocate_array<vec3_base>(opt_vrt.size());
+		result.ind = allocate_array<uint32_t>(opt_ind.size());
+
+		safe_copy_to_arr(result.vrt, opt_vrt);
+		safe_copy_to_arr(result.ind, opt_ind);
+		return result;
+	}
+
+	bounding_box compute_aabb(const ecg_mesh_t* mesh, [[maybe_unused]] ecg_status_handler& op_res) {
+		const vec3_base* vertexes = mesh->vertexes;
+
+		return parallel_reduce(mesh->vertexes_size, default_grain, default_bb,
+			[vertexes](size_t begin, size_t end) {
+				bounding_box bb = default_bb;
+				for (size_t id = begin; id < end; ++id)
+					expand_bb(bb, vertexes[id]);
+				return bb;
+			},
+			merge_bb
+		);
+	}
+
+	ecg_mesh_stats_t compute_mesh_stats(const ecg_mesh_t* mesh, ecg_status_handler& op_res) {
+		check_indexes(mesh, op_res);
+		ecg_mesh_stats_t result{};
+
+		// Moments around the first vertex, as in the kernel, so the covariance doesn't cancel out far from the origin
+		struct vertex_acc_t {
+			double sum[3] = {};
+			double moments[6] = {};
+			bounding_box bb = default_bb;
+		};
+
+		const vec3_base* vertexes = mesh->vertexes;
+		const vec3_base pivot = vertexes[0];
+
+		vertex_acc_t vertex_acc = parallel_reduce(mesh->vertexes_size, default_grain, vertex_acc_t{},
+			[vertexes, pivot](size_t begin, size_t end) {
+				vertex_acc_t acc;
+				for (size_t id = begin; id < end; ++id) {
+					double delta[3] = {
+						double(vertexes[id].x) - pivot.x,
+						double(vertexes[id].y) - pivot.y,
+						double(vertexes[id].z) - pivot.z
+					};
+
+					for (size_t axis = 0; axis < 3; ++axis) acc.sum[axis] += delta[axis];
+					acc.moments[0] += delta[0] * delta[0];
+					acc.moments[1] += delta[1] * delta[1];
+					acc.moments[2] += delta[2] * delta[2];
+					acc.moments[3] += delta[0] * delta[1];
+					acc.moments[4] += delta[0] * delta[2];
+					acc.moments[5] += delta[1] * delta[2];
+					expand_bb(acc.bb, vertexes[id]);
+				}
+				return acc;
+			},
+			[](const vertex_acc_t& lhs, const vertex_acc_t& rhs) {
+				vertex_acc_t acc;
+				for (size_t id = 0; id < 3; ++id) acc.sum[id] = lhs.sum[id] + rhs.sum[id];
+				for (size_t id = 0; id < 6; ++id) acc.moments[id] = lhs.moments[id] + rhs.moments[id];
+				acc.bb = merge_bb(lhs.bb, rhs.bb);
+				return acc;
+			}
+		);
+
+		struct face_acc_t {
+			double area = 0.0;
+			double volume = 0.0;
+			size_t degenerate_cnt = 0;
+		};
+
+		face_acc_t face_acc = parallel_reduce(mesh->indexes_size / 3, default_grain, face_acc_t{},
+			[mesh](size_t begin, size_t end) {
+				face_acc_t acc;
+				for (size_t face_id = begin; face_id < end; ++face_id) {
+					cpu_face_t face = get_face(mesh, face_id);
+					float3 v0 = get_vertex(mesh, face.id0);
+					float3 v1 = get_vertex(mesh, face.id1);
+					float3 v2 = get_vertex(mesh, face.id2);
+
+					float3 ab = v1 - v0;
+					float3 ac = v2 - v0;
+					float3 bc = v2 - v1;
+					float face_area = length(cross(ab, ac)) / 2.0f;
+					float max_edge = std::max({ dot(ab, ab), dot(ac, ac), dot(bc, bc) });
+
+					acc.area += face_area;
+					acc.volume += dot(v0, cross(v1, v2)) / 6.0f;
+					if (face_area <= 1e-6f * max_edge) ++acc.degenerate_cnt;
+				}
+				return acc;
+			},
+			[](const face_acc_t& lhs, const face_acc_t& rhs) {
+				return face_acc_t{ lhs.area + rhs.area, lhs.volume + rhs.volume, lhs.degenerate_cnt + rhs.degenerate_cnt };
+			}
+		);
+
+		const double n = static_cast<double>(mesh->vertexes_size);
+		const double mean[3] = { vertex_acc.sum[0] / n, vertex_acc.sum[1] / n, vertex_acc.sum[2] / n };
+
+		result.vertexes_sum = vec3_base(
+			static_cast<float>(vertex_acc.sum[0] + n * pivot.x),
+			static_cast<float>(vertex_acc.sum[1] + n * pivot.y),
+			static_cast<float>(vertex_acc.sum[2] + n * pivot.z));
+		result.center = vec3_base(
+			static_cast<float>(pivot.x + mean[0]),
+			static_cast<float>(pivot.y + mean[1]),
+			static_cast<float>(pivot.z + mean[2]));
+
+		result.covariance.m00 = static_cast<float>(vertex_acc.moments[0] - n * mean[0] * mean[0]);
+		result.covariance.m11 = static_cast<float>(vertex_acc.moments[1] - n * mean[1] * mean[1]);
+		result.covariance.m22 = static_cast<float>(vertex_acc.moments[2] - n * mean[2] * mean[2]);
+		result.covariance.m01 = result.covariance.m10 = static_cast<float>(vertex_acc.moments[3] - n * mean[0] * mean[1]);
+		result.covariance.m02 = result.covariance.m20 = static_cast<float>(vertex_acc.moments[4] - n * mean[0] * mean[2]);
+		result.covariance.m12 = result.covariance.m21 = static_cast<float>(vertex_acc.moments[5] - n * mean[1] * mean[2]);
+
+		result.aabb = vertex_acc.bb;
+		result.surface_area = static_cast<float>(face_acc.area);
+		result.volume = static_cast<float>(face_acc.volume);
+		result.vertexes_cnt = mesh->vertexes_size;
+		result.faces_cnt = mesh->indexes_size / 3;
+		result.degenerate_faces_cnt = face_acc.degenerate_cnt;
+		return result;
+	}
+
+	full_bounding_box compute_obb(const ecg_mesh_t* mesh, ecg_status_handler& op_res) {
+		vec3_base center = get_center(mesh, op_res);
+		mat3_base cov_mat = compute_covariance_matrix(mesh, op_res);
+
+		cov_mat = cov_mat / static_cast<float>(mesh->vertexes_size);
+		svd_t svd_mat = compute_svd(cov_mat);
+		vec3_base y_axis = { svd_mat.u.m01, svd_mat.u.m11, svd_mat.u.m21 };
+		vec3_base z_axis = { svd_mat.u.m02, svd_mat.u.m12, svd_mat.u.m22 };
+
+		mat3_base transf = make_transform(z_axis, y_axis);
+		mat3_base inv_transf = invert(transf);
+		const vec3_base* vertexes = mesh->vertexes;
+
+		bounding_box bb = parallel_reduce(mesh->vertexes_size, default_grain, default_bb,
+			[vertexes, center, inv_transf](size_t begin, size_t end) {
+				bounding_box bb = default_bb;
+				for (size_t id = begin; id < end; ++id)
+					expand_bb(bb, inv_transf * (vertexes[id] - center));
+				return bb;
+			},
+			merge_bb
+		);
+
+		full_bounding_box result_obb = hulls::expand_bb(&bb);
+		for (vec3_base* pt : { &result_obb.p0, &result_obb.p1, &result_obb.p2, &result_obb.p3,
+			&result_obb.p4, &result_obb.p5, &result_obb.p6, &result_obb.p7 })
+			*pt = center + transf * *pt;
+
+		return result_obb;
+	}
+}
@@ -42,6 +42,7 @@ namespace ecg {
 	}
 
 	void save_mesh(const ecg_mesh_t* mesh, const char* filename, ecg_file_type fl_type, ecg_status* status) {
+		ecg_profile_scope profile_scope("save_mesh");
 		ecg_status_handler op_res;
 
 		try {
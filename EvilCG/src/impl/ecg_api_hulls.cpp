@@ -1,6 +1,7 @@
 #include <ecg_api.h>
 
 #include <core/ecg_cl_programs.h>
+#include <core/ecg_cpu.h>
 #include <core/ecg_host_ctrl.h>
 #include <core/ecg_internal.h>
 #include <core/ecg_program.h>
@@ -16,63 +17,146 @@ namespace ecg::hulls {
 	// TODO: Should be dynamic parameter
 	const float g_convex_epsilon = 1E-08F;
 
+	const uint32_t g_no_face = UINT32_MAX;
+
+	// Sets from this size are culled by the k-DOP of their extreme points by default
+	const size_t g_hull_prefilter_min_vertexes = 1 << 14;
+
 	struct convex_face_t {
-		uint64_t v0;
-		uint64_t v1;
-		uint64_t v2;
+		std::array<uint32_t, 3> vertexes;
+		// Face behind the edge from vertexes[id] to vertexes[(id + 1) % 3]
+		std::array<uint32_t, 3> neighbors;
 		vec3_base normal;
-		vec3_base center;
+		float offset = 0.0f;
 		bool valid = true;
-		std::set<uint64_t> outer_vertexes;
+		// Points above the face, every point is listed by one face only
+		std::vector<uint32_t> conflicts;
+		uint32_t farthest = 0;
+		float farthest_distance = 0.0f;
+	};
+
+	// Minimum and maximum projections on every direction of the k-DOP with the ids of their vertexes
+	struct kdop_extremes_t {
+		std::vector<float> values;
+		std::vector<uint32_t> ids;
+
+		explicit kdop_extremes_t(size_t directions_cnt) : values(directions_cnt * 2, 0.0f), ids(directions_cnt * 2, kdop_no_vertex) {}
+
+		// The smaller id wins a tie, as in the work groups of find_kdop_extremes
+		void update(size_t id, float value, uint32_t vrt_id) {
+			if (vrt_id == kdop_no_vertex) return;
+
+			const bool is_max = id % 2 != 0;
+			const bool is_better = ids[id] == kdop_no_vertex ||
+				(is_max ? value > values[id] : value < values[id]) ||
+				(value == values[id] && vrt_id < ids[id]);
+			if (!is_better) return;
+
+			values[id] = value;
+			ids[id] = vrt_id;
+		}
 	};
 
-	void internal_compute_aabb(
-		cl::Context& context, cl::CommandQueue& queue,
-		cl::Buffer& aabb_result, cl::Buffer& vertexes_buffer,
-		cl_int vert_size, std::shared_ptr<ecg_program_wrapper>& program, ecg_status_handler& op_res,
-		cl::NDRange global, cl::NDRange local,
-		bounding_box& result_bb
+	struct convex_hull_t {
+		std::span<vec3_base> points;
+		std::vector<convex_face_t> faces;
+		float eps = g_convex_epsilon;
+	};
+
+	std::vector<bounding_box> internal_compute_aabbs(ecg_cmd_chain& chain, cl::Device& dev,
+		const cl::Buffer& vertexes_buffer, const std::vector<cl_uint>& range_offsets, ecg_status_handler& op_res
+	) {
+		std::vector<bounding_box> result(range_offsets.size() - 1, default_bb);
+		internal_enqueue_aabbs(chain, dev, vertexes_buffer, range_offsets, result.data(), op_res);
+		op_res = chain.wait();
+		return result;
+	}
+
+	void internal_enqueue_aabbs(ecg_cmd_chain& chain, cl::Device& dev,
+		const cl::Buffer& vertexes_buffer, const std::vector<cl_uint>& range_offsets, bounding_box* result, ecg_status_handler& op_res
 	) {
-		op_res = queue.enqueueWriteBuffer(aabb_result, CL_FALSE, 0, sizeof(bounding_box), &default_bb);
-		op_res = queue.finish();
+		auto& buffer_pool = ecg_cl::get_instance().get_buffer_pool();
+		const size_t ranges_cnt = range_offsets.size() - 1;
+
+		cl::Program::Sources sources = { compute_aabb_code };
+		auto program = ecg_program_wrapper::get_program(chain.get_context(), dev, sources, compute_aabb_name);
+		auto kernel = program->get_kernel(compute_aabb_name);
+
+		size_t max_range_size = 0;
+		for (size_t range_id = 0; range_id < ranges_cnt; ++range_id)
+			max_range_size = std::max<size_t>(max_range_size, range_offsets[range_id + 1] - range_offsets[range_id]);
+
+		// Local arrays of the kernels are sized for the default group, small ranges don't need all of it
+		size_t group_size = std::min(compute_aabb_group_size, std::bit_ceil(std::max<size_t>(max_range_size, 1)));
+		if (kernel != nullptr)
+			group_size = std::min(group_size, std::bit_floor(kernel->get_kernel().getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(dev)));
+
+		// All ranges get the same number of groups, together they fill the device
+		const size_t max_groups_cnt = std::max<size_t>(dev.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>(), 1) * compute_aabb_groups_per_unit;
+		const size_t groups_per_range = std::clamp<size_t>((max_range_size + group_size - 1) / group_size, 1, std::max<size_t>(max_groups_cnt / ranges_cnt, 1));
+
+		cl_int err_create_buffer = CL_SUCCESS;
+		size_t offsets_buffer_size = sizeof(cl_uint) * range_offsets.size();
+		ecg_pooled_buffer offsets_buffer = buffer_pool.acquire(chain, CL_MEM_READ_ONLY, offsets_buffer_size, &err_create_buffer); op_res = err_create_buffer;
+		ecg_pooled_buffer partials_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(bounding_box) * ranges_cnt * groups_per_range, &err_create_buffer); op_res = err_create_buffer;
+		ecg_pooled_buffer aabbs_buffer = buffer_pool.acquire(chain, CL_MEM_WRITE_ONLY, sizeof(bounding_box) * ranges_cnt, &err_create_buffer); op_res = err_create_buffer;
+
+		cl::NDRange global = ranges_cnt * groups_per_range * group_size;
+		cl::NDRange reduce_global = ranges_cnt * group_size;
+		cl::NDRange local = group_size;
+		cl_uint groups_cnt = static_cast<cl_uint>(groups_per_range);
+
+		op_res = chain.write_buffer(offsets_buffer, 0, offsets_buffer_size, range_offsets.data());
+
+		op_res = program->execute(
+			chain, compute_aabb_name, global, local,
+			vertexes_buffer, offsets_buffer, groups_cnt,
+			partials_buffer
+		);
 
 		op_res = program->execute(
-			queue, compute_aabb_name, global, local,
-			vertexes_buffer, vert_size,
-			aabb_result);
+			chain, reduce_aabb_name, reduce_global, local,
+			partials_buffer, groups_cnt,
+			aabbs_buffer
+		);
+
+		op_res = chain.read_buffer(aabbs_buffer, 0, sizeof(bounding_box) * ranges_cnt, result);
+	}
 
-		op_res = queue.enqueueReadBuffer(aabb_result, CL_FALSE, 0, sizeof(bounding_box), &result_bb);
-		op_res = queue.finish();
+	bounding_box internal_compute_aabb(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res) {
+		auto& ctrl = ecg_cl::get_instance();
+		std::vector<cl_uint> range_offsets = { 0, static_cast<cl_uint>(mesh.vertexes_size) };
+		return internal_compute_aabbs(chain, ctrl.get_device(), mesh.vertexes_buffer, range_offsets, op_res).front();
 	}
 
 	bounding_box compute_aabb(const ecg_mesh_t* mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("hulls::compute_aabb");
 		bounding_box result_bb = default_bb;
 		ecg_status_handler op_res;
 
 		try {
 			default_mesh_check(mesh, op_res, status);
+			if (get_active_backend() == ECG_BACKEND_CPU) return cpu::compute_aabb(mesh, op_res);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+			result_bb = internal_compute_aabb(chain, cl_mesh, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+		}
 
-			auto& ctrl = ecg_cl::get_instance();
-			auto& queue = ctrl.get_cmd_queue();
-			auto& context = ctrl.get_context();
-			auto& dev = ctrl.get_device();
-
-			cl::Program::Sources sources = { compute_aabb_code };
-			auto program = ecg_program_wrapper::get_program(context, dev, sources, compute_aabb_name);
-
-			const size_t buffer_size = sizeof(mesh->vertexes[0]) * mesh->vertexes_size;
-			cl::Buffer vertexes_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, buffer_size);
-			cl::Buffer aabb_result = cl::Buffer(context, CL_MEM_READ_WRITE, sizeof(bounding_box));
+		return result_bb;
+	}
 
-			cl::NDRange local = cl::NullRange;
-			cl::NDRange global = mesh->vertexes_size;
-			cl_int vert_size = sizeof(mesh->vertexes[0]) / sizeof(float);
+	bounding_box compute_aabb(const ecg_uploaded_mesh_t& mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("hulls::compute_aabb");
+		bounding_box result_bb = default_bb;
+		ecg_status_handler op_res;
 
-			op_res = queue.enqueueWriteBuffer(vertexes_buffer, CL_FALSE, 0, buffer_size, mesh->vertexes);
-			internal_compute_aabb(
-				context, queue, aabb_result, vertexes_buffer, vert_size,
-				program, op_res, global, local, result_bb
-			);
+		try {
+			auto cl_mesh = uploaded_mesh_check(mesh, op_res, status);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			result_bb = internal_compute_aabb(chain, *cl_mesh, op_res);
 		}
 		catch (...) {
 			on_unknown_exception(op_res, status);
@@ -81,88 +165,97 @@ namespace ecg::hulls {
 		return result_bb;
 	}
 
+	full_bounding_box internal_compute_obb(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res) {
+		auto& ctrl = ecg_cl::get_instance();
+		auto& context = ctrl.get_context();
+		auto& dev = ctrl.get_device();
+
+		bounding_box bb = default_bb;
+		constexpr cl_int vertex_size = sizeof(vec3_base) / sizeof(float);
+		cl_int vertexes_cnt = static_cast<cl_int>(mesh.vertexes_size);
+
+		// The center and the covariance come from one sweep over the vertexes
+		ecg_mesh_stats_t stats = internal_compute_mesh_stats(chain, mesh, false, op_res);
+		vec3_base center = stats.center;
+		cl_float4 center_cl = { center.x, center.y, center.z, 0.0f };
+
+		cl::Program::Sources obb_sources = {
+			enable_atomics_def,
+			get_vertex,
+			compute_cov_mat_code,
+			compute_obb_code
+		};
+
+		auto compute_obb = ecg_program_wrapper::get_program(context, dev, obb_sources, compute_obb_name);
+		cl::NDRange global = mesh.vertexes_size;
+		cl::NDRange local = cl::NullRange;
+
+		mat3_base cov_mat = stats.covariance / static_cast<float>(mesh.vertexes_size);
+		svd_t svd_mat = compute_svd(cov_mat);
+		vec3_base x_axis = { svd_mat.u.m00, svd_mat.u.m10, svd_mat.u.m20 };
+		vec3_base y_axis = { svd_mat.u.m01, svd_mat.u.m11, svd_mat.u.m21 };
+		vec3_base z_axis = { svd_mat.u.m02, svd_mat.u.m12, svd_mat.u.m22 };
+
+		mat3_base transf = make_transform(z_axis, y_axis);
+		mat3_base inv_transf = invert(transf);
+
+		ecg_pooled_buffer inv_transf_buffer = ctrl.get_buffer_pool().acquire(chain, CL_MEM_READ_ONLY, sizeof(inv_transf));
+		ecg_pooled_buffer res_bb_buffer = ctrl.get_buffer_pool().acquire(chain, CL_MEM_WRITE_ONLY, sizeof(bounding_box));
+
+		op_res = chain.write_buffer(inv_transf_buffer, 0, sizeof(inv_transf), &inv_transf);
+		op_res = chain.write_buffer(res_bb_buffer, 0, sizeof(bounding_box), &bb);
+
+		op_res = compute_obb->execute(
+			chain, compute_obb_name, global, local,
+			mesh.vertexes_buffer, vertex_size, vertexes_cnt,
+			inv_transf_buffer, center_cl,
+			res_bb_buffer
+		);
+
+		op_res = chain.read_buffer(res_bb_buffer, 0, sizeof(bounding_box), &bb);
+		op_res = chain.wait();
+
+		full_bounding_box result_obb = hulls::expand_bb(&bb);
+		result_obb.p0 = center + transf * result_obb.p0;
+		result_obb.p1 = center + transf * result_obb.p1;
+		result_obb.p2 = center + transf * result_obb.p2;
+		result_obb.p3 = center + transf * result_obb.p3;
+
+		result_obb.p4 = center + transf * result_obb.p4;
+		result_obb.p5 = center + transf * result_obb.p5;
+		result_obb.p6 = center + transf * result_obb.p6;
+		result_obb.p7 = center + transf * result_obb.p7;
+		return result_obb;
+	}
+
 	full_bounding_box compute_obb(const ecg_mesh_t* mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("hulls::compute_obb");
 		full_bounding_box result_obb;
 		ecg_status_handler op_res;
 
 		try {
 			default_mesh_check(mesh, op_res, status);
+			if (get_active_backend() == ECG_BACKEND_CPU) return cpu::compute_obb(mesh, op_res);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+			result_obb = internal_compute_obb(chain, cl_mesh, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+		}
+
+		return result_obb;
+	}
+
+	full_bounding_box compute_obb(const ecg_uploaded_mesh_t& mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("hulls::compute_obb");
+		full_bounding_box result_obb;
+		ecg_status_handler op_res;
 
-			auto& ctrl = ecg_cl::get_instance();
-			auto& queue = ctrl.get_cmd_queue();
-			auto& context = ctrl.get_context();
-			auto& dev = ctrl.get_device();
-
-			bounding_box bb = default_bb;
-			mat3_base cov_mat = null_mat3;
-			vec3_base center = get_center(mesh, status);
-			cl_float4 center_cl = { center.x, center.y, center.z, 0.0f };
-			constexpr cl_int vertex_size = sizeof(vec3_base) / sizeof(float);
-
-			cl_int vertex_buffer_size = mesh->vertexes_size * sizeof(mesh->vertexes[0]);
-			cl::Buffer cov_mat_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, sizeof(cov_mat));
-			cl::Buffer vertex_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, vertex_buffer_size);
-
-			cl::Program::Sources obb_sources = {
-				enable_atomics_def,
-				get_vertex,
-				compute_cov_mat_code,
-				compute_obb_code
-			};
-
-			auto compute_obb = ecg_program_wrapper::get_program(context, dev, obb_sources, compute_obb_name);
-			cl::NDRange global = mesh->vertexes_size;
-			cl::NDRange local = cl::NullRange;
-
-			op_res = queue.enqueueWriteBuffer(vertex_buffer, CL_FALSE, 0, vertex_buffer_size, mesh->vertexes);
-			op_res = queue.enqueueWriteBuffer(cov_mat_buffer, CL_FALSE, 0, sizeof(mat3_base), &cov_mat);
-			op_res = queue.finish();
-
-			op_res = compute_obb->execute(
-				queue, compute_cov_mat_name, global, local,
-				vertex_buffer, vertex_size, center_cl,
-				cov_mat_buffer
-			);
-
-			op_res = queue.enqueueReadBuffer(cov_mat_buffer, CL_FALSE, 0, sizeof(mat3_base), &cov_mat);
-			op_res = queue.finish();
-
-			cov_mat = cov_mat / static_cast<float>(mesh->vertexes_size);
-			svd_t svd_mat = compute_svd(cov_mat);
-			vec3_base x_axis = { svd_mat.u.m00, svd_mat.u.m10, svd_mat.u.m20 };
-			vec3_base y_axis = { svd_mat.u.m01, svd_mat.u.m11, svd_mat.u.m21 };
-			vec3_base z_axis = { svd_mat.u.m02, svd_mat.u.m12, svd_mat.u.m22 };
-
-			mat3_base transf = make_transform(z_axis, y_axis);
-			mat3_base inv_transf = invert(transf);
-
-			cl::Buffer inv_transf_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, sizeof(inv_transf));
-			cl::Buffer res_bb_buffer = cl::Buffer(context, CL_MEM_WRITE_ONLY, sizeof(bounding_box));
-
-			op_res = queue.enqueueWriteBuffer(inv_transf_buffer, CL_FALSE, 0, sizeof(inv_transf), &inv_transf);
-			op_res = queue.enqueueWriteBuffer(res_bb_buffer, CL_FALSE, 0, sizeof(bounding_box), &bb);
-			op_res = queue.finish();
-
-			op_res = compute_obb->execute(
-				queue, compute_obb_name, global, local,
-				vertex_buffer, vertex_size,
-				inv_transf_buffer, center_cl,
-				res_bb_buffer
-			);
-
-			op_res = queue.enqueueReadBuffer(res_bb_buffer, CL_FALSE, 0, sizeof(bounding_box), &bb);
-			op_res = queue.finish();
-
-			result_obb = hulls::expand_bb(&bb);
-			result_obb.p0 = center + transf * result_obb.p0;
-			result_obb.p1 = center + transf * result_obb.p1;
-			result_obb.p2 = center + transf * result_obb.p2;
-			result_obb.p3 = center + transf * result_obb.p3;
-
-			result_obb.p4 = center + transf * result_obb.p4;
-			result_obb.p5 = center + transf * result_obb.p5;
-			result_obb.p6 = center + transf * result_obb.p6;
-			result_obb.p7 = center + transf * result_obb.p7;
+		try {
+			auto cl_mesh = uploaded_mesh_check(mesh, op_res, status);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			result_obb = internal_compute_obb(chain, *cl_mesh, op_res);
 		}
 		catch (...) {
 			on_unknown_exception(op_res, status);
@@ -187,216 +280,489 @@ namespace ecg::hulls {
 		return res;
 	}
 
-	void add_face(std::span<vec3_base>& global_vertexes, std::list<convex_face_t>& convex_hull_faces,
-		uint64_t ind0, uint64_t ind1, uint64_t ind2, const vec3_base& global_center, float eps = g_convex_epsilon)
-	{
-		vec3_base a = global_vertexes[ind0];
-		vec3_base b = global_vertexes[ind1];
-		vec3_base c = global_vertexes[ind2];
-
-		vec3_base ab = b - a;
-		vec3_base ac = c - a;
-		vec3_base n = cross(ab, ac);
-		float nlen2 = dot(n, n);
-		if (nlen2 < eps) return;
+	float get_plane_distance(const convex_face_t& face, const vec3_base& point) {
+		return dot(face.normal, point) - face.offset;
+	}
 
-		vec3_base normal = normalize(n);
-		vec3_base center = (a + b + c) / 3.0f;
-		if (dot(normal, center - global_center) < 0.0f) normal = -normal;
+	uint32_t add_face(convex_hull_t& hull, uint32_t v0, uint32_t v1, uint32_t v2) {
+		const vec3_base a = hull.points[v0];
+		vec3_base n = cross(hull.points[v1] - a, hull.points[v2] - a);
+		float n_length = length(n);
 
+		// Slivers keep the zero normal, so no point is above them
 		convex_face_t face;
-		face.v0 = ind0; face.v1 = ind1; face.v2 = ind2;
-		face.normal = normal;
-		face.center = center;
-		face.valid = true;
-
-		for (size_t id = 0; id < global_vertexes.size(); ++id) {
-			if (id == face.v0 || id == face.v1 || id == face.v2) continue;
-			float d = dot(face.normal, global_vertexes[id] - global_vertexes[face.v0]);
-			if (d > eps) face.outer_vertexes.insert(id);
-		}
+		face.vertexes = { v0, v1, v2 };
+		face.neighbors = { g_no_face, g_no_face, g_no_face };
+		face.normal = n_length > 0.0f ? n / n_length : vec3_base{ 0.0f, 0.0f, 0.0f };
+		face.offset = dot(face.normal, a);
 
-		convex_hull_faces.push_back(face);
+		hull.faces.push_back(std::move(face));
+		return static_cast<uint32_t>(hull.faces.size() - 1);
 	}
 
-	std::list<convex_face_t> get_initial_tetrahedron(std::span<vec3_base>& global_vertexes, vec3_base& global_center) {
-		std::vector<uint64_t> initial_convex;
-		vec3_base initial_center_vertex;
-		initial_convex.resize(4);
+	void assign_conflicts(convex_hull_t& hull, const std::vector<uint32_t>& points, uint32_t first_face) {
+		const uint32_t faces_end = static_cast<uint32_t>(hull.faces.size());
+		std::vector<uint32_t> owners(points.size(), g_no_face);
+		std::vector<float> distances(points.size(), 0.0f);
+
+		// Every point goes to the first face it's above, points below all faces are inside the hull
+		cpu::parallel_for(points.size(), cpu::default_grain, [&](size_t begin, size_t end) {
+			for (size_t id = begin; id < end; ++id) {
+				const vec3_base& point = hull.points[points[id]];
+				for (uint32_t face_id = first_face; face_id < faces_end; ++face_id) {
+					float distance = get_plane_distance(hull.faces[face_id], point);
+					if (distance > hull.eps) {
+						owners[id] = face_id;
+						distances[id] = distance;
+						break;
+					}
+				}
+			}
+		});
+
+		// Lists are filled in the order of the points, so the hull doesn't depend on the threads
+		for (size_t id = 0; id < points.size(); ++id) {
+			if (owners[id] == g_no_face) continue;
 
-		uint64_t x_max_vrt = 0;
-		uint64_t x_min_vrt = 0;
+			convex_face_t& face = hull.faces[owners[id]];
+			if (face.conflicts.empty() || distances[id] > face.farthest_distance) {
+				face.farthest = points[id];
+				face.farthest_distance = distances[id];
+			}
+			face.conflicts.push_back(points[id]);
+		}
+	}
 
-		// 1. Find the farthest points on the X-axis
-		size_t vrt_id = 0;
-		for (auto& vrt : global_vertexes) {
-			if (global_vertexes[x_max_vrt].x < vrt.x) x_max_vrt = vrt_id;
-			if (global_vertexes[x_min_vrt].x > vrt.x) x_min_vrt = vrt_id;
-			++vrt_id;
+	bool get_initial_tetrahedron(
+		std::span<vec3_base>& global_vertexes, const std::vector<uint32_t>& candidates, float eps, std::array<uint32_t, 4>& initial_convex
+	) {
+		auto get_axis = [](const vec3_base& vrt, int axis) { return axis == 0 ? vrt.x : axis == 1 ? vrt.y : vrt.z; };
+		std::array<uint32_t, 3> min_vrt = { candidates[0], candidates[0], candidates[0] };
+		std::array<uint32_t, 3> max_vrt = { candidates[0], candidates[0], candidates[0] };
+
+		// 1. Find the farthest points on the widest axis
+		for (uint32_t vrt_id : candidates) {
+			for (int axis = 0; axis < 3; ++axis) {
+				float value = get_axis(global_vertexes[vrt_id], axis);
+				if (get_axis(global_vertexes[min_vrt[axis]], axis) > value) min_vrt[axis] = vrt_id;
+				if (get_axis(global_vertexes[max_vrt[axis]], axis) < value) max_vrt[axis] = vrt_id;
+			}
 		}
 
-		initial_convex[0] = x_min_vrt;
-		initial_convex[1] = x_max_vrt;
+		float max_extent = 0.0f;
+		for (int axis = 0; axis < 3; ++axis) {
+			float extent = get_axis(global_vertexes[max_vrt[axis]], axis) - get_axis(global_vertexes[min_vrt[axis]], axis);
+			if (extent <= max_extent) continue;
+
+			max_extent = extent;
+			initial_convex[0] = min_vrt[axis];
+			initial_convex[1] = max_vrt[axis];
+		}
+		if (max_extent <= eps) return false;
 
 		// 2. Find third farthest from line point
 		float third_vertex_distance = 0.0f;
-		uint64_t third_vertex = 0;
-
-		vrt_id = 0;
-		for (auto& vrt : global_vertexes) {
-			vec3_base ic_0 = global_vertexes[initial_convex[0]];
-			vec3_base ic_1 = global_vertexes[initial_convex[1]];
+		vec3_base ic_0 = global_vertexes[initial_convex[0]];
+		vec3_base ic_1 = global_vertexes[initial_convex[1]];
 
-			float current_distance = distance(vrt, ic_0, ic_1);
+		for (uint32_t vrt_id : candidates) {
+			float current_distance = distance(global_vertexes[vrt_id], ic_0, ic_1);
 			if (current_distance > third_vertex_distance) {
 				third_vertex_distance = current_distance;
-				third_vertex = vrt_id;
+				initial_convex[2] = vrt_id;
 			}
-			++vrt_id;
 		}
-		initial_convex[2] = third_vertex;
+		if (third_vertex_distance <= eps) return false;
 
-		// 3. Find third farthest from surface point
+		// 3. Find the farthest point from the surface
 		float fourth_vertex_distance = 0.0f;
-		uint64_t fourth_vertex = 0;
+		vec3_base ic_2 = global_vertexes[initial_convex[2]];
 
-		vrt_id = 0;
-		for (auto& vrt : global_vertexes) {
-			vec3_base ic_0 = global_vertexes[initial_convex[0]];
-			vec3_base ic_1 = global_vertexes[initial_convex[1]];
-			vec3_base ic_2 = global_vertexes[initial_convex[2]];
-
-			float current_distance = distance(vrt, ic_0, ic_1, ic_2);
+		for (uint32_t vrt_id : candidates) {
+			float current_distance = distance(global_vertexes[vrt_id], ic_0, ic_1, ic_2);
 			if (current_distance > fourth_vertex_distance) {
 				fourth_vertex_distance = current_distance;
-				fourth_vertex = vrt_id;
+				initial_convex[3] = vrt_id;
 			}
-			++vrt_id;
 		}
 
-		initial_convex[3] = fourth_vertex;
-		for (auto& vrt_id : initial_convex) { global_center += global_vertexes[vrt_id]; }
-		global_center /= initial_convex.size();
+		return fourth_vertex_distance > eps;
+	}
+
+	void create_initial_hull(convex_hull_t& hull, std::array<uint32_t, 4> initial_convex, const std::vector<uint32_t>& candidates) {
+		// The base is turned away from the apex, so all faces are wound outwards
+		auto [a, b, c, d] = initial_convex;
+		vec3_base base_normal = cross(hull.points[b] - hull.points[a], hull.points[c] - hull.points[a]);
+		if (dot(base_normal, hull.points[d] - hull.points[a]) > 0.0f) std::swap(b, c);
+
+		add_face(hull, a, b, c);
+		add_face(hull, a, d, b);
+		add_face(hull, b, d, c);
+		add_face(hull, c, d, a);
+
+		hull.faces[0].neighbors = { 1, 2, 3 };
+		hull.faces[1].neighbors = { 3, 2, 0 };
+		hull.faces[2].neighbors = { 1, 3, 0 };
+		hull.faces[3].neighbors = { 2, 1, 0 };
 
-		std::list<convex_face_t> convex_hull_faces;
-		add_face(global_vertexes, convex_hull_faces, initial_convex[0], initial_convex[1], initial_convex[2], global_center);
-		add_face(global_vertexes, convex_hull_faces, initial_convex[0], initial_convex[1], initial_convex[3], global_center);
-		add_face(global_vertexes, convex_hull_faces, initial_convex[0], initial_convex[2], initial_convex[3], global_center);
-		add_face(global_vertexes, convex_hull_faces, initial_convex[1], initial_convex[2], initial_convex[3], global_center);
+		std::vector<uint32_t> points;
+		points.reserve(candidates.size());
+		for (uint32_t vrt_id : candidates)
+			if (vrt_id != a && vrt_id != b && vrt_id != c && vrt_id != d) points.push_back(vrt_id);
 
-		return convex_hull_faces;
+		assign_conflicts(hull, points, 0);
 	}
 
-	std::list<convex_face_t> expand_hull(
-		std::span<vec3_base>& global_vertexes,
-		std::list<convex_face_t>& convex_hull_faces,
-		vec3_base global_center)
-	{
-		bool convex_hull_changed = true;
-
-		while (convex_hull_changed) {
-			convex_hull_changed = false;
-
-			uint64_t best_face_idx = UINT64_MAX;
-			uint64_t best_candidate = UINT64_MAX;
-			float max_dist = 0.0f;
-
-			// Search best candidate
-			auto it = convex_hull_faces.begin();
-			for (auto f_it = convex_hull_faces.begin(); f_it != convex_hull_faces.end(); ++f_it) {
-				if (!f_it->valid) continue;
-
-				for (uint64_t idx : f_it->outer_vertexes) {
-					float d = dot(f_it->normal, global_vertexes[idx] - global_vertexes[f_it->v0]);
-					if (d > max_dist) {
-						max_dist = d;
-						best_candidate = idx;
-						best_face_idx = std::distance(convex_hull_faces.begin(), f_it);
+	void expand_hull(convex_hull_t& hull) {
+		std::vector<uint32_t> marks;
+		std::vector<uint32_t> stack;
+		std::vector<uint32_t> visible_faces;
+		std::vector<std::pair<uint32_t, int>> horizon;
+		std::vector<uint32_t> orphans;
+		std::unordered_map<uint32_t, uint32_t> new_faces_by_start;
+
+		// New faces are appended, so every face is visited once after it's created
+		for (uint32_t face_id = 0; face_id < hull.faces.size(); ++face_id) {
+			if (!hull.faces[face_id].valid || hull.faces[face_id].conflicts.empty()) continue;
+
+			const uint32_t eye = hull.faces[face_id].farthest;
+			const vec3_base eye_point = hull.points[eye];
+			const uint32_t stamp = face_id + 1;
+			marks.resize(hull.faces.size(), 0);
+
+			// Faces seen from the point are connected, the edges to the hidden ones form the horizon
+			visible_faces.clear();
+			horizon.clear();
+			stack.assign(1, face_id);
+			marks[face_id] = stamp;
+
+			while (!stack.empty()) {
+				uint32_t current = stack.back();
+				stack.pop_back();
+				visible_faces.push_back(current);
+
+				for (int edge = 0; edge < 3; ++edge) {
+					uint32_t neighbor = hull.faces[current].neighbors[edge];
+					if (marks[neighbor] == stamp) continue;
+
+					if (get_plane_distance(hull.faces[neighbor], eye_point) > hull.eps) {
+						marks[neighbor] = stamp;
+						stack.push_back(neighbor);
+					}
+					else {
+						horizon.emplace_back(current, edge);
 					}
 				}
 			}
 
-			if (best_candidate == UINT64_MAX || max_dist < g_convex_epsilon)
-				break;
+			// Every horizon edge makes a face with the point, its hidden neighbor is linked back to it
+			const uint32_t first_new_face = static_cast<uint32_t>(hull.faces.size());
+			new_faces_by_start.clear();
 
-			convex_hull_changed = true;
-			vec3_base new_p = global_vertexes[best_candidate];
+			for (auto [visible, edge] : horizon) {
+				const uint32_t v0 = hull.faces[visible].vertexes[edge];
+				const uint32_t v1 = hull.faces[visible].vertexes[(edge + 1) % 3];
+				const uint32_t hidden = hull.faces[visible].neighbors[edge];
+				const uint32_t new_face = add_face(hull, v0, v1, eye);
 
-			std::unordered_map<edge_t, int, ecg_hash_func, ecg_compare_func> edge_counter;
-			std::unordered_set<uint64_t> affected_points;
+				hull.faces[new_face].neighbors[0] = hidden;
+				for (auto& neighbor : hull.faces[hidden].neighbors)
+					if (neighbor == visible) neighbor = new_face;
+				new_faces_by_start[v0] = new_face;
+			}
 
-			// Get all faces that see vertex
-			for (auto& face : convex_hull_faces) {
-				if (!face.valid) continue;
+			// The side from v1 to the point is shared with the face starting at v1
+			for (uint32_t new_face = first_new_face; new_face < hull.faces.size(); ++new_face) {
+				const uint32_t next_face = new_faces_by_start.at(hull.faces[new_face].vertexes[1]);
+				hull.faces[new_face].neighbors[1] = next_face;
+				hull.faces[next_face].neighbors[2] = new_face;
+			}
 
-				float d = dot(face.normal, new_p - global_vertexes[face.v0]);
-				if (d > g_convex_epsilon) {
-					face.valid = false;
-					affected_points.insert(face.outer_vertexes.begin(), face.outer_vertexes.end());
+			orphans.clear();
+			for (uint32_t visible : visible_faces) {
+				convex_face_t& face = hull.faces[visible];
+				face.valid = false;
+				for (uint32_t point : face.conflicts)
+					if (point != eye) orphans.push_back(point);
+				std::vector<uint32_t>().swap(face.conflicts);
+			}
 
-					++edge_counter[make_edge_struct(face.v0, face.v1)];
-					++edge_counter[make_edge_struct(face.v1, face.v2)];
-					++edge_counter[make_edge_struct(face.v2, face.v0)];
+			assign_conflicts(hull, orphans, first_new_face);
+		}
+	}
+
+	// Planes are compared with the rounding error of the coordinates
+	float get_hull_epsilon(std::span<vec3_base> vertexes) {
+		vec3_base max_abs = { 0.0f, 0.0f, 0.0f };
+		for (auto& vrt : vertexes) {
+			max_abs.x = std::max(max_abs.x, std::abs(vrt.x));
+			max_abs.y = std::max(max_abs.y, std::abs(vrt.y));
+			max_abs.z = std::max(max_abs.z, std::abs(vrt.z));
+		}
+
+		return std::max(g_convex_epsilon, 3.0f * FLT_EPSILON * (max_abs.x + max_abs.y + max_abs.z));
+	}
+
+	// Planes of the hull of the extreme points as normal and offset, empty when the extremes are flat
+	std::vector<float> get_kdop_planes(std::span<vec3_base> vertexes, std::vector<uint32_t> extremes, float eps) {
+		std::sort(extremes.begin(), extremes.end());
+		extremes.erase(std::unique(extremes.begin(), extremes.end()), extremes.end());
+
+		convex_hull_t hull;
+		hull.points = vertexes;
+		hull.eps = eps;
+
+		std::array<uint32_t, 4> initial_convex = {};
+		if (extremes.size() < 4 || !get_initial_tetrahedron(hull.points, extremes, eps, initial_convex)) return {};
+		create_initial_hull(hull, initial_convex, extremes);
+		expand_hull(hull);
+
+		// A sliver has no plane, so the polytope isn't trusted
+		std::vector<float> planes;
+		for (auto& face : hull.faces) {
+			if (!face.valid) continue;
+			if (face.normal.x == 0.0f && face.normal.y == 0.0f && face.normal.z == 0.0f) return {};
+			planes.insert(planes.end(), { face.normal.x, face.normal.y, face.normal.z, face.offset });
+		}
 
-					face.outer_vertexes.clear();
+		return planes;
+	}
+
+	std::vector<uint32_t> get_kdop_extremes(std::span<vec3_base> vertexes, size_t directions_cnt) {
+		kdop_extremes_t init(directions_cnt);
+		kdop_extremes_t result = cpu::parallel_reduce(vertexes.size(), cpu::default_grain, init,
+			[&](size_t begin, size_t end) {
+				kdop_extremes_t part = init;
+				for (size_t vrt_id = begin; vrt_id < end; ++vrt_id) {
+					const vec3_base& vrt = vertexes[vrt_id];
+					for (size_t direction_id = 0; direction_id < directions_cnt; ++direction_id) {
+						const float* direction = &kdop_directions[direction_id * 3];
+						float value = vrt.x * direction[0] + vrt.y * direction[1] + vrt.z * direction[2];
+						part.update(direction_id * 2 + 0, value, static_cast<uint32_t>(vrt_id));
+						part.update(direction_id * 2 + 1, value, static_cast<uint32_t>(vrt_id));
+					}
 				}
-			}
+				return part;
+			},
+			[](kdop_extremes_t lhs, const kdop_extremes_t& rhs) {
+				for (size_t id = 0; id < rhs.ids.size(); ++id)
+					lhs.update(id, rhs.values[id], rhs.ids[id]);
+				return lhs;
+			});
+
+		return result.ids;
+	}
+
+	std::vector<uint32_t> get_hull_candidates(std::span<vec3_base> vertexes, const std::vector<float>& planes, float eps) {
+		const size_t planes_cnt = planes.size() / 4;
+		std::vector<uint8_t> flags(vertexes.size(), 0);
 
-			// Add new faces for corner edges
-			std::list<convex_face_t> new_faces;
-			for (auto& [edge, cnt] : edge_counter) {
-				if (cnt == 1) {
-					add_face(global_vertexes, new_faces,
-						edge.a, edge.b, best_candidate,
-						global_center, g_convex_epsilon);
+		cpu::parallel_for(vertexes.size(), cpu::default_grain, [&](size_t begin, size_t end) {
+			for (size_t vrt_id = begin; vrt_id < end; ++vrt_id) {
+				const vec3_base& vrt = vertexes[vrt_id];
+				for (size_t plane_id = 0; plane_id < planes_cnt && flags[vrt_id] == 0; ++plane_id) {
+					const float* plane = &planes[plane_id * 4];
+					if (vrt.x * plane[0] + vrt.y * plane[1] + vrt.z * plane[2] - plane[3] >= -eps) flags[vrt_id] = 1;
 				}
 			}
+		});
 
-			// Fill next outer points for new faces
-			for (auto& nf : new_faces) {
-				for (uint64_t idx : affected_points) {
-					if (idx == nf.v0 || idx == nf.v1 || idx == nf.v2) continue;
-					float d = dot(nf.normal, global_vertexes[idx] - global_vertexes[nf.v0]);
-					if (d > g_convex_epsilon)
-						nf.outer_vertexes.insert(idx);
-				}
+		std::vector<uint32_t> candidates;
+		for (uint32_t vrt_id = 0; vrt_id < vertexes.size(); ++vrt_id)
+			if (flags[vrt_id] != 0) candidates.push_back(vrt_id);
+
+		return candidates;
+	}
+
+	std::vector<uint32_t> internal_get_kdop_extremes(ecg_cmd_chain& chain, const cl::Buffer& vertexes_buffer, cl_uint vertexes_cnt, size_t directions_cnt, ecg_status_handler& op_res) {
+		auto& ctrl = ecg_cl::get_instance();
+		auto& dev = ctrl.get_device();
+		auto& buffer_pool = ctrl.get_buffer_pool();
+
+		cl::Program::Sources sources = { hull_prefilter_code };
+		auto program = ecg_program_wrapper::get_program(ctrl.get_context(), dev, sources, find_kdop_extremes_name);
+		auto kernel = program->get_kernel(find_kdop_extremes_name);
+
+		// Groups are sized as for compute_aabb, the local arrays of the kernel are sized for its group
+		size_t group_size = std::min(compute_aabb_group_size, std::bit_ceil(std::max<size_t>(vertexes_cnt, 1)));
+		if (kernel != nullptr)
+			group_size = std::min(group_size, std::bit_floor(kernel->get_kernel().getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(dev)));
+
+		const size_t max_groups_cnt = std::max<size_t>(dev.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>(), 1) * compute_aabb_groups_per_unit;
+		const size_t groups_cnt = std::clamp<size_t>((vertexes_cnt + group_size - 1) / group_size, 1, max_groups_cnt);
+		const size_t partials_cnt = groups_cnt * directions_cnt * 2;
+
+		cl_int err_create_buffer = CL_SUCCESS;
+		size_t directions_buffer_size = sizeof(cl_float) * directions_cnt * 3;
+		ecg_pooled_buffer directions_buffer = buffer_pool.acquire(chain, CL_MEM_READ_ONLY, directions_buffer_size, &err_create_buffer); op_res = err_create_buffer;
+		ecg_pooled_buffer values_buffer = buffer_pool.acquire(chain, CL_MEM_WRITE_ONLY, sizeof(cl_float) * partials_cnt, &err_create_buffer); op_res = err_create_buffer;
+		ecg_pooled_buffer ids_buffer = buffer_pool.acquire(chain, CL_MEM_WRITE_ONLY, sizeof(cl_uint) * partials_cnt, &err_create_buffer); op_res = err_create_buffer;
+
+		cl::NDRange global = groups_cnt * group_size;
+		cl::NDRange local = group_size;
+		cl_uint directions_size = static_cast<cl_uint>(directions_cnt);
+
+		op_res = chain.write_buffer(directions_buffer, 0, directions_buffer_size, kdop_directions);
+
+		op_res = program->execute(
+			chain, find_kdop_extremes_name, global, local,
+			vertexes_buffer, vertexes_cnt,
+			directions_buffer, directions_size,
+			values_buffer, ids_buffer
+		);
+
+		std::vector<float> values(partials_cnt);
+		std::vector<uint32_t> ids(partials_cnt);
+		op_res = chain.read_buffer(values_buffer, 0, sizeof(cl_float) * partials_cnt, values.data());
+		op_res = chain.read_buffer(ids_buffer, 0, sizeof(cl_uint) * partials_cnt, ids.data());
+		op_res = chain.wait();
+
+		// Partials of the groups are merged in the same way as inside a group
+		kdop_extremes_t extremes(directions_cnt);
+		for (size_t partial_id = 0; partial_id < partials_cnt; ++partial_id)
+			extremes.update(partial_id % (directions_cnt * 2), values[partial_id], ids[partial_id]);
+
+		return extremes.ids;
+	}
+
+	std::vector<uint32_t> internal_get_hull_candidates(ecg_cmd_chain& chain,
+		const cl::Buffer& vertexes_buffer, cl_uint vertexes_cnt, const std::vector<float>& planes, float eps, ecg_status_handler& op_res
+	) {
+		auto& ctrl = ecg_cl::get_instance();
+		auto& buffer_pool = ctrl.get_buffer_pool();
+
+		cl::Program::Sources sources = { hull_prefilter_code };
+		auto program = ecg_program_wrapper::get_program(ctrl.get_context(), ctrl.get_device(), sources, find_kdop_extremes_name);
+
+		cl_int err_create_buffer = CL_SUCCESS;
+		size_t planes_buffer_size = sizeof(cl_float) * planes.size();
+		ecg_pooled_buffer planes_buffer = buffer_pool.acquire(chain, CL_MEM_READ_ONLY, planes_buffer_size, &err_create_buffer); op_res = err_create_buffer;
+		ecg_pooled_buffer offsets_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(cl_uint) * (vertexes_cnt + 1), &err_create_buffer); op_res = err_create_buffer;
+
+		cl::NDRange global = vertexes_cnt;
+		cl::NDRange local = cl::NullRange;
+		cl_uint planes_cnt = static_cast<cl_uint>(planes.size() / 4);
+
+		op_res = chain.write_buffer(planes_buffer, 0, planes_buffer_size, planes.data());
+
+		op_res = program->execute(
+			chain, mark_hull_candidates_name, global, local,
+			vertexes_buffer, vertexes_cnt,
+			planes_buffer, planes_cnt, eps,
+			offsets_buffer
+		);
+
+		// Flags of the candidates are scanned into their positions in the compacted list
+		cl_uint candidates_cnt = 0;
+		internal_scan_exclusive(chain, offsets_buffer, vertexes_cnt, op_res);
+		op_res = chain.read_buffer(offsets_buffer, sizeof(cl_uint) * vertexes_cnt, sizeof(cl_uint), &candidates_cnt);
+		op_res = chain.wait();
+
+		std::vector<uint32_t> candidates(candidates_cnt);
+		if (candidates_cnt == 0) return candidates;
+
+		size_t candidates_buffer_size = sizeof(cl_uint) * candidates_cnt;
+		ecg_pooled_buffer candidates_buffer = buffer_pool.acquire(chain, CL_MEM_WRITE_ONLY, candidates_buffer_size, &err_create_buffer); op_res = err_create_buffer;
+
+		op_res = program->execute(
+			chain, compact_hull_candidates_name, global, local,
+			offsets_buffer, vertexes_cnt,
+			candidates_buffer
+		);
+
+		op_res = chain.read_buffer(candidates_buffer, 0, candidates_buffer_size, candidates.data());
+		op_res = chain.wait();
+		return candidates;
+	}
+
+	// Vertexes that may lie on the hull, in ascending order
+	std::vector<uint32_t> find_hull_candidates(std::span<vec3_base> vertexes, hull_prefilter_method prefilter, ecg_status_handler& op_res) {
+		std::vector<uint32_t> candidates;
+		const size_t directions_cnt = prefilter == HP_KDOP_6 ? kdop_6_directions_cnt : kdop_26_directions_cnt;
+		const float eps = get_hull_epsilon(vertexes);
+
+		if (prefilter != HP_NONE) {
+			ecg_profile_scope phase_scope("hull_prefilter");
+
+			if (get_active_backend() == ECG_BACKEND_CPU) {
+				auto planes = get_kdop_planes(vertexes, get_kdop_extremes(vertexes, directions_cnt), eps);
+				if (!planes.empty()) candidates = get_hull_candidates(vertexes, planes, eps);
 			}
+			else {
+				auto& ctrl = ecg_cl::get_instance();
+				ecg_cmd_chain chain(ctrl.get_cmd_queue());
+				cl_uint vertexes_cnt = static_cast<cl_uint>(vertexes.size());
+
+				cl_int err_create_buffer = CL_SUCCESS;
+				size_t vertexes_buffer_size = sizeof(vec3_base) * vertexes.size();
+				ecg_pooled_buffer vertexes_buffer = ctrl.get_buffer_pool().acquire(chain, CL_MEM_READ_ONLY, vertexes_buffer_size, &err_create_buffer); op_res = err_create_buffer;
+				op_res = chain.write_buffer(vertexes_buffer, 0, vertexes_buffer_size, vertexes.data());
+
+				auto planes = get_kdop_planes(vertexes, internal_get_kdop_extremes(chain, vertexes_buffer, vertexes_cnt, directions_cnt, op_res), eps);
+				if (!planes.empty()) candidates = internal_get_hull_candidates(chain, vertexes_buffer, vertexes_cnt, planes, eps, op_res);
+			}
+		}
 
-			convex_hull_faces.splice(convex_hull_faces.end(), new_faces);
+		// Without the polytope of the extremes nothing is culled
+		if (candidates.empty()) {
+			candidates.resize(vertexes.size());
+			std::iota(candidates.begin(), candidates.end(), 0);
 		}
 
-		convex_hull_faces.remove_if([](auto& f) { return !f.valid; });
-		return convex_hull_faces;
+		return candidates;
 	}
 
 	ecg_internal_mesh_t create_convex_hull(const ecg_array_t vrt_arr, ecg_status* status) {
+		// Small sets are built faster than they are filtered
+		std::span<vec3_base> vertexes(static_cast<vec3_base*>(vrt_arr.arr_ptr), vrt_arr.arr_ptr == nullptr ? 0 : vrt_arr.arr_size);
+		hull_prefilter_method prefilter = vertexes.size() >= g_hull_prefilter_min_vertexes ? HP_KDOP_26 : HP_NONE;
+		return create_convex_hull(vrt_arr, prefilter, nullptr, status);
+	}
+
+	ecg_internal_mesh_t create_convex_hull(const ecg_array_t vrt_arr, hull_prefilter_method prefilter, size_t* culled_cnt, ecg_status* status) {
+		ecg_profile_scope profile_scope("hulls::create_convex_hull");
 		auto& mem_inst = ecg_mem::get_instance();
 		ecg_internal_mesh_t result;
 		ecg_status_handler op_res;
 
-		if (vrt_arr.arr_ptr == nullptr || vrt_arr.arr_size == 0 || vrt_arr.arr_size < 4) {
+		if (culled_cnt != nullptr) *culled_cnt = 0;
+		if (vrt_arr.arr_ptr == nullptr || vrt_arr.arr_size == 0 || vrt_arr.arr_size < 4 || prefilter >= HP_METHODS_COUNT) {
 			if (status != nullptr) *status = ecg_status_code::INVALID_ARG;
 			return result;
 		}
 
 		try {
 			std::span<vec3_base> global_vertexes(static_cast<vec3_base*>(vrt_arr.arr_ptr), vrt_arr.arr_size);
-			vec3_base global_center = vec3_base{ 0.0f, 0.0f, 0.0f };
+			std::vector<uint32_t> candidates = find_hull_candidates(global_vertexes, prefilter, op_res);
+			if (culled_cnt != nullptr) *culled_cnt = global_vertexes.size() - candidates.size();
 
-			auto normalized_vertexes = normalize_mesh(global_vertexes);
-			std::span<vec3_base> normalized_vertexes_span(normalized_vertexes.begin(), normalized_vertexes.end());
+			std::vector<vec3_base> normalized_vertexes;
+			{
+				ecg_profile_scope phase_scope("normalize_mesh");
+				normalized_vertexes = normalize_mesh(global_vertexes);
+			}
+
+			convex_hull_t hull;
+			hull.points = std::span<vec3_base>(normalized_vertexes.begin(), normalized_vertexes.end());
+			hull.eps = get_hull_epsilon(hull.points);
+
+			{
+				ecg_profile_scope phase_scope("initial_tetrahedron");
+				std::array<uint32_t, 4> initial_convex = {};
+				if (!get_initial_tetrahedron(hull.points, candidates, hull.eps, initial_convex)) op_res = ecg_status_code::INVALID_ARG;
+				create_initial_hull(hull, initial_convex, candidates);
+			}
 
-			auto convex_hull_faces = get_initial_tetrahedron(normalized_vertexes_span, global_center);
-			auto new_convex_hull = expand_hull(normalized_vertexes_span, convex_hull_faces, global_center);
+			{
+				ecg_profile_scope phase_scope("expand_hull");
+				expand_hull(hull);
+			}
 
 			{
-				std::vector<uint32_t> ch_indexes(new_convex_hull.size() * 3);
-				size_t face_id = 0;
-				
-				for (auto it = new_convex_hull.begin(); it != new_convex_hull.end(); ++it, ++face_id) {
-					ch_indexes[face_id * 3 + 0] = it->v0;
-					ch_indexes[face_id * 3 + 1] = it->v1;
-					ch_indexes[face_id * 3 + 2] = it->v2;
+				std::vector<uint32_t> ch_indexes;
+				for (auto& face : hull.faces) {
+					if (!face.valid) continue;
+					ch_indexes.insert(ch_indexes.end(), face.vertexes.begin(), face.vertexes.end());
 				}
 
 				result.vertexes = allocate_array<vec3_base>(global_vertexes.size());
@@ -75,6 +75,7 @@ namespace ecg {
 	}
 
 	ecg_internal_mesh_t load_mesh(const char* filename, ecg_status* status) {
+		ecg_profile_scope profile_scope("load_mesh");
 		auto& mem_inst = ecg_mem::get_instance();
 		ecg_internal_mesh_t result;
 		ecg_status_handler op_res;
@@ -1,6 +1,7 @@
 #include <ecg_api.h>
 
 #include <core/ecg_cl_programs.h>
+#include <core/ecg_cpu.h>
 #include <core/ecg_host_ctrl.h>
 #include <core/ecg_internal.h>
 #include <core/ecg_program.h>
@@ -19,12 +20,11 @@ namespace ecg {
 
 	const int min_votes_for_inner_vertex = 2;
 
-	intersection_set_t get_intersection_points(const ecg_mesh_t* m1, const ecg_mesh_t* m2, ecg_status* status) {
+	intersection_set_t get_intersection_points(ecg_cmd_chain& chain, const ecg_cl_mesh_t& m1, const ecg_cl_mesh_t& m2, ecg_status* status) {
 		auto& mem_inst = ecg_mem::get_instance();
 		auto& ctrl = ecg_cl::get_instance();
-		auto queue = ctrl.get_cmd_queue();
-		auto context = ctrl.get_context();
-		auto device = ctrl.get_device();
+		auto& context = ctrl.get_context();
+		auto& device = ctrl.get_device();
 		ecg_status_handler op_res;
 
 		intersection_set_t empty_res;
@@ -39,28 +39,34 @@ namespace ecg {
 		res = empty_res;
 
 		try {
-			default_mesh_check(m1, op_res, status);
-			default_mesh_check(m2, op_res, status);
+			if (status != nullptr) *status = ecg_status_code::SUCCESS;
 
 			cl::Program::Sources sources = { intersect_two_meshes_code };
 			auto program = ecg_program_wrapper::get_program(context, device, sources, intersect_two_meshes_name);
 
-			cl_uint m1_faces_cnt = m1->indexes_size / 3;
+			cl_uint m1_faces_cnt = m1.indexes_size / 3;
+			cl_uint m2_faces_cnt = m2.indexes_size / 3;
+			if (m1_faces_cnt == 0 || m2_faces_cnt == 0)
+				return empty_res;
+
+			// Broad phase: only faces of m2 whose boxes overlap a face of m1 reach the triangle tests.
+			// Faces of m1 outside of the box of m2 are culled at the root of its tree.
+			ecg_cl_bvh_t m2_bvh = internal_build_bvh(chain, m2, op_res);
+			ecg_pooled_buffer candidate_offsets_buffer;
+			ecg_pooled_buffer candidates_buffer;
+			if (internal_find_bvh_candidates(chain, m1, m2_bvh, candidate_offsets_buffer, candidates_buffer, op_res) == 0)
+				return empty_res;
+
 			std::vector<uint32_t> vrt_offsets;
 			vrt_offsets.resize(m1_faces_cnt);
 
-			cl_uint m1_vertexes_buffer_size = m1->vertexes_size * sizeof(vec3_base);
-			cl_uint m2_vertexes_buffer_size = m2->vertexes_size * sizeof(vec3_base);
-			cl::Buffer m1_vertexes_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, m1_vertexes_buffer_size);
-			cl::Buffer m2_vertexes_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, m2_vertexes_buffer_size);
-
-			cl_uint m1_indexes_buffer_size = m1->indexes_size * sizeof(uint32_t);
-			cl_uint m2_indexes_buffer_size = m2->indexes_size * sizeof(uint32_t);
-			cl::Buffer m1_indexes_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, m1_indexes_buffer_size);
-			cl::Buffer m2_indexes_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, m2_indexes_buffer_size);
+			const cl::Buffer& m1_vertexes_buffer = m1.vertexes_buffer;
+			const cl::Buffer& m2_vertexes_buffer = m2.vertexes_buffer;
+			const cl::Buffer& m1_indexes_buffer = m1.indexes_buffer;
+			const cl::Buffer& m2_indexes_buffer = m2.indexes_buffer;
 
 			cl_uint vrt_offsets_buffer_size = m1_faces_cnt * sizeof(uint32_t);
-			cl::Buffer vrt_offsets_buffer = cl::Buffer(context, CL_MEM_READ_WRITE, vrt_offsets_buffer_size);
+			ecg_pooled_buffer vrt_offsets_buffer = ctrl.get_buffer_pool().acquire(chain, CL_MEM_READ_WRITE, vrt_offsets_buffer_size);
 
 			cl::NDRange global = m1_faces_cnt;
 			cl::NDRange local = cl::NullRange;
@@ -68,36 +74,30 @@ namespace ecg {
 			cl_int null_value = 0;
 			cl_int pattern = 0;
 
-			cl_int m1_vrt_size = m1->vertexes_size;
-			cl_int m2_vrt_size = m2->vertexes_size;
-			cl_int m1_ind_size = m1->indexes_size;
-			cl_int m2_ind_size = m2->indexes_size;
+			cl_int m1_vrt_size = m1.vertexes_size;
+			cl_int m2_vrt_size = m2.vertexes_size;
+			cl_int m1_ind_size = m1.indexes_size;
+			cl_int m2_ind_size = m2.indexes_size;
 			cl_int vrt_off_size = m1_faces_cnt;
 
-			op_res = queue.enqueueWriteBuffer(m1_vertexes_buffer, CL_FALSE, 0, m1_vertexes_buffer_size, m1->vertexes);
-			op_res = queue.enqueueWriteBuffer(m2_vertexes_buffer, CL_FALSE, 0, m2_vertexes_buffer_size, m2->vertexes);
-
-			op_res = queue.enqueueWriteBuffer(m1_indexes_buffer, CL_FALSE, 0, m1_indexes_buffer_size, m1->indexes);
-			op_res = queue.enqueueWriteBuffer(m2_indexes_buffer, CL_FALSE, 0, m2_indexes_buffer_size, m2->indexes);
-
-			op_res = queue.enqueueFillBuffer(vrt_offsets_buffer, pattern, 0, vrt_offsets_buffer_size);
-			op_res = queue.finish();
+			op_res = chain.fill_buffer(vrt_offsets_buffer, pattern, 0, vrt_offsets_buffer_size);
 
 			op_res = program->execute(
 				// in
-				queue, intersect_two_meshes_name, global, local,
+				chain, intersect_candidate_faces_name, global, local,
 				m1_vertexes_buffer, m1_vrt_size,
 				m2_vertexes_buffer, m2_vrt_size,
 				m1_indexes_buffer, m1_ind_size,
 				m2_indexes_buffer, m2_ind_size,
+				candidate_offsets_buffer, candidates_buffer,
 				vrt_offsets_buffer, vrt_off_size,
 				// out (first iterate calculate size of out)
 				nullptr, long_null_value,
 				nullptr, long_null_value
 			);
 
-			op_res = queue.enqueueReadBuffer(vrt_offsets_buffer, CL_FALSE, 0, vrt_offsets_buffer_size, vrt_offsets.data());
-			queue.finish();
+			op_res = chain.read_buffer(vrt_offsets_buffer, 0, vrt_offsets_buffer_size, vrt_offsets.data());
+			op_res = chain.wait();
 
 			auto item = std::find_if(
 				vrt_offsets.begin(), vrt_offsets.end(),
@@ -121,32 +121,31 @@ namespace ecg {
 			int_faces.resize(number_of_faces);
 
 			cl_long faces_buffer_size = number_of_faces * sizeof(uint32_t);
-			cl::Buffer faces_buffer = cl::Buffer(context, CL_MEM_READ_WRITE, faces_buffer_size);
+			ecg_pooled_buffer faces_buffer = ctrl.get_buffer_pool().acquire(chain, CL_MEM_READ_WRITE, faces_buffer_size);
 
 			cl_long intersections_buffer_size = number_of_intersections * sizeof(vec3_base);
-			cl::Buffer intersections_buffer = cl::Buffer(context, CL_MEM_READ_WRITE, intersections_buffer_size);
+			ecg_pooled_buffer intersections_buffer = ctrl.get_buffer_pool().acquire(chain, CL_MEM_READ_WRITE, intersections_buffer_size);
 
-			op_res = queue.enqueueWriteBuffer(vrt_offsets_buffer, CL_FALSE, 0, vrt_offsets_buffer_size, vrt_offsets.data());
-			op_res = queue.finish();
+			op_res = chain.write_buffer(vrt_offsets_buffer, 0, vrt_offsets_buffer_size, vrt_offsets.data());
 
 			op_res = program->execute(
 				// in
-				queue, intersect_two_meshes_name, global, local,
+				chain, intersect_candidate_faces_name, global, local,
 				m1_vertexes_buffer, m1_vrt_size,
 				m2_vertexes_buffer, m2_vrt_size,
 				m1_indexes_buffer, m1_ind_size,
 				m2_indexes_buffer, m2_ind_size,
+				candidate_offsets_buffer, candidates_buffer,
 				vrt_offsets_buffer, vrt_off_size,
 				// out
 				intersections_buffer, number_of_intersections,
 				faces_buffer, number_of_faces
 			);
 
-			op_res = queue.enqueueReadBuffer(intersections_buffer, CL_FALSE, 0, intersections_buffer_size, intersections.data());
-			queue.finish();
+			op_res = chain.read_buffer(intersections_buffer, 0, intersections_buffer_size, intersections.data());
 
-			op_res = queue.enqueueReadBuffer(faces_buffer, CL_FALSE, 0, faces_buffer_size, int_faces.data());
-			queue.finish();
+			op_res = chain.read_buffer(faces_buffer, 0, faces_buffer_size, int_faces.data());
+			op_res = chain.wait();
 
 			auto [opt_vrt, opt_ind] = optimize_intersection(intersections, int_faces);
 			intersection_set_t temp_int_set;
@@ -169,8 +168,10 @@ namespace ecg {
 
 	bool check_is_point_in_mesh(const ecg_mesh_t* mesh, const vec3_base vertex) {
 		try {
+			// std::rand isn't thread-safe, every thread has its own generator
+			thread_local std::mt19937 generator(std::random_device{}());
 			auto randf = [](float min, float max) {
-				return min + (max - min) * (static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX));
+				return std::uniform_real_distribution<float>(min, max)(generator);
 				};
 
 			auto base = normalize({ randf(-1,1), randf(-1,1), randf(-1,1) });
@@ -221,7 +222,7 @@ namespace ecg {
 
 	void add_inner_vertexes(
 		const std::span<vec3_base>& vertexes, const std::span<face_t>& faces, const ecg_mesh_t* mesh,
-		const umap<fp, uset<uint32_t, std::hash<uint32_t>>, ecg_hash_func>& edge_to_faces,
+		const cpu::adjacency_list_t& face_faces,
 		const umap<uint32_t, face_t, std::hash<uint32_t>>& faces_from_mesh,
 		uset<uint32_t, std::hash<uint32_t>>& new_vertexes
 	) {
@@ -235,30 +236,24 @@ namespace ecg {
 		// Try to get nearest points | faces
 		auto get_nearest_faces = [](
 			std::span<face_t> faces,
-			const umap<fp, uset<uint32_t, std::hash<uint32_t>>, ecg_hash_func>& edge_to_faces,
+			const cpu::adjacency_list_t& face_faces,
 			const umap<uint32_t, face_t, std::hash<uint32_t>>& to_process,
 			const umap<uint32_t, face_t, std::hash<uint32_t>>& processed
 			) -> umap<uint32_t, face_t, std::hash<uint32_t>>
 			{
 				umap<uint32_t, face_t, std::hash<uint32_t>> nearest;
 
-				for (auto [id, face] : to_process) {
-					fp edges[] = {
-						make_edge(face.ind_1, face.ind_2),
-						make_edge(face.ind_2, face.ind_3),
-						make_edge(face.ind_3, face.ind_1)
-					};
-
-					for (auto edge : edges) {
-						auto it = edge_to_faces.find(edge);
-						if (it != edge_to_faces.end()) {
-							for (auto neighbor_id : it->second) {
-								if (!processed.contains(neighbor_id) && !nearest.contains(neighbor_id)) {
-									nearest.insert({ neighbor_id, faces[neighbor_id] });
-								}
-							}
-						}
+				auto add_nearest = [&](uint32_t neighbor_id) {
+					if (!processed.contains(neighbor_id) && !nearest.contains(neighbor_id)) {
+						nearest.insert({ neighbor_id, faces[neighbor_id] });
 					}
+				};
+
+				// The face itself is a candidate too, so the first step checks the faces from the intersections
+				for (auto [id, face] : to_process) {
+					add_nearest(id);
+					for (uint32_t i = face_faces.offsets[id]; i < face_faces.offsets[id + 1]; ++i)
+						add_nearest(face_faces.ids[i]);
 				}
 
 				return nearest;
@@ -267,7 +262,7 @@ namespace ecg {
 		do {
 			find_new_vertex = false;
 			auto nearest_faces = get_nearest_faces(
-				faces, edge_to_faces, to_process, processed_faces
+				faces, face_faces, to_process, processed_faces
 			);
 
 			bool add_new_vertex = false;
@@ -325,8 +320,6 @@ namespace ecg {
 			// Main logic for searching interior points
 			{
 				// Intersection data
-				umap<fp, uset<uint32_t, std::hash<uint32_t>>, ecg_hash_func> edge_to_faces_a;
-				umap<fp, uset<uint32_t, std::hash<uint32_t>>, ecg_hash_func> edge_to_faces_b;
 				umap<uint32_t, face_t, std::hash<uint32_t>> faces_from_mesh_a;
 				umap<uint32_t, face_t, std::hash<uint32_t>> faces_from_mesh_b;
 
@@ -339,18 +332,13 @@ namespace ecg {
 				std::span<vec3_base> b_vertexes(m2->vertexes, m2->vertexes_size);
 				std::span<vec3_base> a_vertexes(m1->vertexes, m1->vertexes_size);
 
-				for (size_t id = 0; id < a_faces.size(); ++id) {
-					auto face = a_faces[id];
-					edge_to_faces_a[make_edge(face.ind_1, face.ind_2)].insert(id);
-					edge_to_faces_a[make_edge(face.ind_2, face.ind_3)].insert(id);
-					edge_to_faces_a[make_edge(face.ind_3, face.ind_1)].insert(id);
-				}
+				cpu::adjacency_list_t face_faces_a;
+				cpu::adjacency_list_t face_faces_b;
 
-				for (size_t id = 0; id < b_faces.size(); ++id) {
-					auto face = b_faces[id];
-					edge_to_faces_b[make_edge(face.ind_1, face.ind_2)].insert(id);
-					edge_to_faces_b[make_edge(face.ind_2, face.ind_3)].insert(id);
-					edge_to_faces_b[make_edge(face.ind_3, face.ind_1)].insert(id);
+				{
+					ecg_profile_scope phase_scope("adjacency");
+					face_faces_a = cpu::get_face_faces(m1);
+					face_faces_b = cpu::get_face_faces(m2);
 				}
 
 				for (size_t id = 0; id < vrt_arr_size; ++id) {
@@ -383,8 +371,11 @@ namespace ecg {
 				}
 
 				// Search other nearest points
-				add_inner_vertexes(b_vertexes, b_faces, m1, edge_to_faces_b, faces_from_mesh_b, new_vertexes_b);
-				add_inner_vertexes(a_vertexes, a_faces, m2, edge_to_faces_a, faces_from_mesh_a, new_vertexes_a);
+				{
+					ecg_profile_scope phase_scope("inner_vertexes");
+					add_inner_vertexes(b_vertexes, b_faces, m1, face_faces_b, faces_from_mesh_b, new_vertexes_b);
+					add_inner_vertexes(a_vertexes, a_faces, m2, face_faces_a, faces_from_mesh_a, new_vertexes_a);
+				}
 
 				// Fill data
 				{
@@ -412,17 +403,73 @@ namespace ecg {
 	}
 
 	ecg_internal_mesh_t compute_intersection(const ecg_mesh_t* m1, const ecg_mesh_t* m2, ecg_status* status) {
-		auto& mem_inst = ecg_mem::get_instance();
-		ecg_internal_mesh_t result;
-		ecg_array_t empty;
-		empty.arr_ptr = nullptr;
-		empty.arr_size = 0;
-		empty.handler = 0;
+		ecg_profile_scope profile_scope("compute_intersection");
+		ecg_status_handler op_res;
+		intersection_set_t int_set_v1;
+
+		try {
+			default_mesh_check(m1, op_res, status);
+			default_mesh_check(m2, op_res, status);
+
+			if (get_active_backend() == ECG_BACKEND_CPU) {
+				int_set_v1 = cpu::get_intersection_points(m1, m2, op_res);
+			}
+			else {
+				ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+				auto m1_cl = allocate_cl_mesh(chain, m1, op_res);
+				auto m2_cl = allocate_cl_mesh(chain, m2, op_res);
+				int_set_v1 = get_intersection_points(chain, m1_cl, m2_cl, status);
+			}
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+			return ecg_internal_mesh_t{};
+		}
 
-		auto int_set_v1 = get_intersection_points(m1, m2, status);
 		auto vrt = add_interior_intersection_points(m1, m2, &int_set_v1, status);
 		auto convex = hulls::create_convex_hull(vrt, status);
 
 		return convex;
 	}
+
+	ecg_internal_mesh_t compute_intersection(const ecg_uploaded_mesh_t& m1, const ecg_uploaded_mesh_t& m2, ecg_status* status) {
+		ecg_profile_scope profile_scope("compute_intersection");
+		ecg_status_handler op_res;
+		intersection_set_t int_set_v1;
+
+		// Interior points are searched on the host, so the geometry is read back once
+		std::vector<vec3_base> m1_vertexes, m2_vertexes;
+		std::vector<uint32_t> m1_indexes, m2_indexes;
+		ecg_mesh_t m1_host, m2_host;
+
+		try {
+			auto m1_cl = uploaded_mesh_check(m1, op_res, status);
+			auto m2_cl = uploaded_mesh_check(m2, op_res, status);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			int_set_v1 = get_intersection_points(chain, *m1_cl, *m2_cl, status);
+
+			read_cl_mesh(chain, *m1_cl, m1_vertexes, m1_indexes, op_res);
+			read_cl_mesh(chain, *m2_cl, m2_vertexes, m2_indexes, op_res);
+			op_res = chain.wait();
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+			return ecg_internal_mesh_t{};
+		}
+
+		m1_host.vertexes = m1_vertexes.data();
+		m1_host.vertexes_size = m1_vertexes.size();
+		m1_host.indexes = m1_indexes.data();
+		m1_host.indexes_size = m1_indexes.size();
+
+		m2_host.vertexes = m2_vertexes.data();
+		m2_host.vertexes_size = m2_vertexes.size();
+		m2_host.indexes = m2_indexes.data();
+		m2_host.indexes_size = m2_indexes.size();
+
+		auto vrt = add_interior_intersection_points(&m1_host, &m2_host, &int_set_v1, status);
+		auto convex = hulls::create_convex_hull(vrt, status);
+
+		return convex;
+	}
 }
\ No newline at end of file
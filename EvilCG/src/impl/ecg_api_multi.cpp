@@ -0,0 +1,381 @@
+#include <ecg_api.h>
+
+#include <core/ecg_cl_programs.h>
+#include <core/ecg_multi_cl.h>
+#include <core/ecg_internal.h>
+#include <core/ecg_program.h>
+
+#include <help/ecg_allocate.h>
+#include <help/ecg_logger.h>
+#include <help/ecg_helper.h>
+#include <help/ecg_checks.h>
+#include <help/ecg_geom.h>
+
+namespace ecg::multi {
+	void init(const int* device_ids, size_t ids_count, ecg_status* status) {
+		auto& multi_ctrl = ecg_multi_cl::get_instance();
+		ecg_status_handler op_res;
+
+		try {
+			if (status != nullptr) *status = ecg_status_code::SUCCESS;
+			if (device_ids == nullptr && ids_count != 0) op_res = ecg_status_code::INVALID_ARG;
+
+			std::vector<int> ids;
+			if (device_ids != nullptr) ids.assign(device_ids, device_ids + ids_count);
+			op_res = multi_ctrl.init(ids);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+		}
+	}
+
+	void release() {
+		ecg_multi_cl::get_instance().release();
+	}
+
+	size_t get_devices_count() {
+		return ecg_multi_cl::get_instance().get_devices().size();
+	}
+
+	void multi_device_check(ecg_status_handler& op_res) {
+		if (!ecg_multi_cl::get_instance().is_init())
+			op_res = ecg_status_code::RUNTIME_ERROR;
+	}
+
+	float compute_surface_area(const ecg_mesh_t* mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("multi::compute_surface_area");
+		auto& multi_ctrl = ecg_multi_cl::get_instance();
+		ecg_status_handler op_res;
+		float result = -FLT_MAX;
+
+		try {
+			default_mesh_check(mesh, op_res, status);
+			multi_device_check(op_res);
+
+			auto parts = multi_ctrl.split(mesh->indexes_size / 3);
+			std::vector<float> parts_area(parts.size(), 0.0f);
+
+			op_res = multi_ctrl.run(parts, [&](const ecg_work_part_t& part, ecg_status_handler& part_res) {
+				auto& device = *part.device;
+				ecg_cmd_chain chain(device.queue);
+				auto cl_mesh = allocate_cl_mesh(mesh, device.context, part_res);
+
+				parts_area[part.id] = internal_compute_surface_area(chain, device.device,
+					cl_mesh.vertexes_buffer, cl_mesh.indexes_buffer,
+					static_cast<cl_uint>(part.offset), static_cast<cl_uint>(part.offset + part.size), part_res);
+			});
+
+			result = std::accumulate(parts_area.begin(), parts_area.end(), 0.0f);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+		}
+
+		return result;
+	}
+
+	ecg_array_t compute_faces_normals(const ecg_mesh_t* mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("multi::compute_faces_normals");
+		auto& multi_ctrl = ecg_multi_cl::get_instance();
+		auto& buffer_pool = ecg_cl::get_instance().get_buffer_pool();
+		auto& mem_inst = ecg_mem::get_instance();
+		ecg_array_t result_normals;
+		ecg_status_handler op_res;
+
+		try {
+			default_mesh_check(mesh, op_res, status);
+			multi_device_check(op_res);
+
+			cl_uint faces_cnt = mesh->indexes_size / 3;
+			auto parts = multi_ctrl.split(faces_cnt);
+			result_normals = allocate_array<vec3_base>(faces_cnt);
+			if (result_normals.arr_ptr == nullptr) op_res = ecg_status_code::RUNTIME_ERROR;
+
+			op_res = multi_ctrl.run(parts, [&](const ecg_work_part_t& part, ecg_status_handler& part_res) {
+				auto& device = *part.device;
+				ecg_cmd_chain chain(device.queue);
+				auto cl_mesh = allocate_cl_mesh(mesh, device.context, part_res);
+
+				cl::Program::Sources sources = { compute_faces_normals_code };
+				auto program = ecg_program_wrapper::get_program(device.context, device.device, sources, compute_faces_normals_name);
+
+				// Kernel writes normals by face id, the buffer covers all faces but only the part is read back
+				cl_uint indexes_size = cl_mesh.indexes_size;
+				cl_uint vertexes_size = cl_mesh.vertexes_size;
+				size_t normals_buffer_size = sizeof(vec3_base) * faces_cnt;
+
+				cl_int err_create_buffer = CL_SUCCESS;
+				ecg_pooled_buffer normals_buffer = buffer_pool.acquire(chain, CL_MEM_WRITE_ONLY, normals_buffer_size, &err_create_buffer);
+				part_res = err_create_buffer;
+
+				cl::NDRange offset = part.offset;
+				cl::NDRange global = part.size;
+				cl::NDRange local = cl::NullRange;
+
+				part_res = program->execute_range(
+					chain, compute_faces_normals_name, offset, global, local,
+					cl_mesh.vertexes_buffer, vertexes_size,
+					cl_mesh.indexes_buffer, indexes_size,
+					normals_buffer, faces_cnt
+				);
+
+				auto normals = static_cast<vec3_base*>(result_normals.arr_ptr);
+				part_res = chain.read_buffer(normals_buffer, sizeof(vec3_base) * part.offset, sizeof(vec3_base) * part.size, normals + part.offset);
+				part_res = chain.wait();
+			});
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+			if (result_normals.handler != 0) mem_inst.delete_memory(result_normals.handler);
+			result_normals = ecg_array_t();
+		}
+
+		return result_normals;
+	}
+
+	bool is_mesh_self_intersected(const ecg_mesh_t* mesh, self_intersection_method method, ecg_status* status) {
+		ecg_profile_scope profile_scope("multi::is_mesh_self_intersected");
+		auto& multi_ctrl = ecg_multi_cl::get_instance();
+		auto& buffer_pool = ecg_cl::get_instance().get_buffer_pool();
+		ecg_status_handler op_res;
+		bool result = false;
+
+		try {
+			default_mesh_check(mesh, op_res, status);
+			multi_device_check(op_res);
+			if (method >= self_intersection_method::SI_METHODS_COUNT)
+				op_res = ecg_status_code::INCORRECT_METHOD;
+
+			// The tree isn't split between devices, it is built and traversed on the main one
+			if (method == self_intersection_method::SI_BVH)
+				return ecg::is_mesh_self_intersected(mesh, method, status);
+
+			auto parts = multi_ctrl.split(mesh->indexes_size / 3);
+			std::vector<uint8_t> parts_result(parts.size(), false);
+
+			op_res = multi_ctrl.run(parts, [&](const ecg_work_part_t& part, ecg_status_handler& part_res) {
+				auto& device = *part.device;
+				ecg_cmd_chain chain(device.queue);
+				auto cl_mesh = allocate_cl_mesh(mesh, device.context, part_res);
+
+				cl::Program::Sources sources = { is_mesh_self_intersected_code };
+				auto program = ecg_program_wrapper::get_program(device.context, device.device, sources, is_mesh_self_intersected_name);
+
+				bool is_self_intersected = false;
+				cl_int vrt_size = sizeof(vec3_base) / sizeof(float);
+				cl_uint indexes_size = cl_mesh.indexes_size;
+				cl_uint vertexes_size = cl_mesh.vertexes_size;
+				ecg_pooled_buffer is_self_intersected_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(bool));
+
+				cl::NDRange offset = part.offset;
+				cl::NDRange global = part.size;
+				cl::NDRange local = cl::NullRange;
+
+				part_res = chain.write_buffer(is_self_intersected_buffer, 0, sizeof(bool), &is_self_intersected);
+				part_res = program->execute_range(
+					chain, is_mesh_self_intersected_name, offset, global, local,
+					cl_mesh.vertexes_buffer, vertexes_size, cl_mesh.indexes_buffer, indexes_size,
+					vrt_size, is_self_intersected_buffer
+				);
+
+				part_res = chain.read_buffer(is_self_intersected_buffer, 0, sizeof(bool), &is_self_intersected);
+				part_res = chain.wait();
+				parts_result[part.id] = is_self_intersected;
+			});
+
+			result = std::any_of(parts_result.begin(), parts_result.end(), [](uint8_t value) { return value != 0; });
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+		}
+
+		return result;
+	}
+
+	intersection_set_t get_intersection_points(const ecg_mesh_t* m1, const ecg_mesh_t* m2, ecg_status_handler& op_res) {
+		auto& multi_ctrl = ecg_multi_cl::get_instance();
+		auto& buffer_pool = ecg_cl::get_instance().get_buffer_pool();
+		intersection_set_t res;
+
+		struct part_data_t {
+			ecg_cl_mesh_t m1;
+			ecg_cl_mesh_t m2;
+			ecg_pooled_buffer vrt_offsets_buffer;
+		};
+
+		cl_uint m1_faces_cnt = m1->indexes_size / 3;
+		auto parts = multi_ctrl.split(m1_faces_cnt);
+		std::vector<part_data_t> parts_data(parts.size());
+		std::vector<uint32_t> vrt_offsets(m1_faces_cnt, 0);
+		size_t vrt_offsets_buffer_size = m1_faces_cnt * sizeof(uint32_t);
+
+		cl_int m1_vrt_size = m1->vertexes_size;
+		cl_int m2_vrt_size = m2->vertexes_size;
+		cl_int m1_ind_size = m1->indexes_size;
+		cl_int m2_ind_size = m2->indexes_size;
+		cl_int vrt_off_size = m1_faces_cnt;
+		cl::Program::Sources sources = { intersect_two_meshes_code };
+
+		// First pass counts intersections of every face of the first mesh
+		op_res = multi_ctrl.run(parts, [&](const ecg_work_part_t& part, ecg_status_handler& part_res) {
+			auto& device = *part.device;
+			ecg_cmd_chain chain(device.queue);
+			auto& data = parts_data[part.id];
+			data.m1 = allocate_cl_mesh(m1, device.context, part_res);
+			data.m2 = allocate_cl_mesh(m2, device.context, part_res);
+
+			auto program = ecg_program_wrapper::get_program(device.context, device.device, sources, intersect_two_meshes_name);
+
+			cl_int err_create_buffer = CL_SUCCESS;
+			data.vrt_offsets_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, vrt_offsets_buffer_size, &err_create_buffer);
+			part_res = err_create_buffer;
+
+			cl::NDRange offset = part.offset;
+			cl::NDRange global = part.size;
+			cl::NDRange local = cl::NullRange;
+			cl_long long_null_value = 0;
+			cl_int pattern = 0;
+
+			part_res = chain.fill_buffer(data.vrt_offsets_buffer, pattern, 0, vrt_offsets_buffer_size);
+			part_res = program->execute_range(
+				chain, intersect_two_meshes_name, offset, global, local,
+				data.m1.vertexes_buffer, m1_vrt_size,
+				data.m2.vertexes_buffer, m2_vrt_size,
+				data.m1.indexes_buffer, m1_ind_size,
+				data.m2.indexes_buffer, m2_ind_size,
+				data.vrt_offsets_buffer, vrt_off_size,
+				nullptr, long_null_value,
+				nullptr, long_null_value
+			);
+
+			part_res = chain.read_buffer(data.vrt_offsets_buffer, sizeof(uint32_t) * part.offset, sizeof(uint32_t) * part.size, vrt_offsets.data() + part.offset);
+			part_res = chain.wait();
+		});
+
+		cl_long number_of_intersections = 0;
+		for (size_t id = 0; id < vrt_offsets.size(); ++id) {
+			uint32_t temp = vrt_offsets[id];
+			vrt_offsets[id] += number_of_intersections;
+			number_of_intersections += temp;
+		}
+
+		if (number_of_intersections == 0)
+			return res;
+
+		cl_long number_of_faces = number_of_intersections * 2;
+		std::vector<vec3_base> intersections(number_of_intersections);
+		std::vector<uint32_t> int_faces(number_of_faces);
+
+		// Second pass writes intersections, every device reads back the ones of its faces
+		op_res = multi_ctrl.run(parts, [&](const ecg_work_part_t& part, ecg_status_handler& part_res) {
+			auto& device = *part.device;
+			ecg_cmd_chain chain(device.queue);
+			auto& data = parts_data[part.id];
+			auto program = ecg_program_wrapper::get_program(device.context, device.device, sources, intersect_two_meshes_name);
+
+			size_t first = part.offset == 0 ? 0 : vrt_offsets[part.offset - 1];
+			size_t last = vrt_offsets[part.offset + part.size - 1];
+			if (first == last) return;
+
+			cl_int err_create_buffer = CL_SUCCESS;
+			ecg_pooled_buffer intersections_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, number_of_intersections * sizeof(vec3_base), &err_create_buffer);
+			part_res = err_create_buffer;
+			ecg_pooled_buffer faces_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, number_of_faces * sizeof(uint32_t), &err_create_buffer);
+			part_res = err_create_buffer;
+
+			cl::NDRange offset = part.offset;
+			cl::NDRange global = part.size;
+			cl::NDRange local = cl::NullRange;
+
+			part_res = chain.write_buffer(data.vrt_offsets_buffer, 0, vrt_offsets_buffer_size, vrt_offsets.data());
+			part_res = program->execute_range(
+				chain, intersect_two_meshes_name, offset, global, local,
+				data.m1.vertexes_buffer, m1_vrt_size,
+				data.m2.vertexes_buffer, m2_vrt_size,
+				data.m1.indexes_buffer, m1_ind_size,
+				data.m2.indexes_buffer, m2_ind_size,
+				data.vrt_offsets_buffer, vrt_off_size,
+				intersections_buffer, number_of_intersections,
+				faces_buffer, number_of_faces
+			);
+
+			part_res = chain.read_buffer(intersections_buffer, sizeof(vec3_base) * first, sizeof(vec3_base) * (last - first), intersections.data() + first);
+			part_res = chain.read_buffer(faces_buffer, sizeof(uint32_t) * first * 2, sizeof(uint32_t) * (last - first) * 2, int_faces.data() + first * 2);
+			part_res = chain.wait();
+		});
+
+		auto [opt_vrt, opt_ind] = optimize_intersection(intersections, int_faces);
+		res.vrt = allocate_array<vec3_base>(opt_vrt.size());
+		res.ind = allocate_array<uint32_t>(opt_ind.size());
+
+		safe_copy_to_arr(res.vrt, opt_vrt);
+		safe_copy_to_arr(res.ind, opt_ind);
+		return res;
+	}
+
+	ecg_internal_mesh_t compute_intersection(const ecg_mesh_t* m1, const ecg_mesh_t* m2, ecg_status* status) {
+		ecg_profile_scope profile_scope("multi::compute_intersection");
+		auto& mem_inst = ecg_mem::get_instance();
+		ecg_status_handler op_res;
+		intersection_set_t int_set;
+
+		try {
+			default_mesh_check(m1, op_res, status);
+			default_mesh_check(m2, op_res, status);
+			multi_device_check(op_res);
+			int_set = get_intersection_points(m1, m2, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+			if (int_set.vrt.handler != 0) mem_inst.delete_memory(int_set.vrt.handler);
+			if (int_set.ind.handler != 0) mem_inst.delete_memory(int_set.ind.handler);
+			return ecg_internal_mesh_t{};
+		}
+
+		auto vrt = add_interior_intersection_points(m1, m2, &int_set, status);
+		auto convex = ecg::hulls::create_convex_hull(vrt, status);
+
+		if (int_set.vrt.handler != 0) mem_inst.delete_memory(int_set.vrt.handler);
+		if (int_set.ind.handler != 0) mem_inst.delete_memory(int_set.ind.handler);
+		if (vrt.handler != 0) mem_inst.delete_memory(vrt.handler);
+		return convex;
+	}
+
+	namespace hulls {
+		bounding_box compute_aabb(const ecg_mesh_t* mesh, ecg_status* status) {
+			ecg_profile_scope profile_scope("multi::hulls::compute_aabb");
+			auto& multi_ctrl = ecg_multi_cl::get_instance();
+			bounding_box result_bb = default_bb;
+			ecg_status_handler op_res;
+
+			try {
+				default_mesh_check(mesh, op_res, status);
+				multi_device_check(op_res);
+
+				auto parts = multi_ctrl.split(mesh->vertexes_size);
+				std::vector<bounding_box> parts_bb(parts.size(), default_bb);
+
+				op_res = multi_ctrl.run(parts, [&](const ecg_work_part_t& part, ecg_status_handler& part_res) {
+					auto& device = *part.device;
+					ecg_cmd_chain chain(device.queue);
+					auto cl_mesh = allocate_cl_mesh(mesh, device.context, part_res);
+
+					// The part is a sub-range of the vertexes uploaded to the device
+					std::vector<cl_uint> range_offsets = { static_cast<cl_uint>(part.offset), static_cast<cl_uint>(part.offset + part.size) };
+					parts_bb[part.id] = ecg::hulls::internal_compute_aabbs(chain, device.device,
+						cl_mesh.vertexes_buffer, range_offsets, part_res).front();
+				});
+
+				for (const auto& bb : parts_bb) {
+					result_bb.min = vec3_base(std::min(result_bb.min.x, bb.min.x), std::min(result_bb.min.y, bb.min.y), std::min(result_bb.min.z, bb.min.z));
+					result_bb.max = vec3_base(std::max(result_bb.max.x, bb.max.x), std::max(result_bb.max.y, bb.max.y), std::max(result_bb.max.z, bb.max.z));
+				}
+			}
+			catch (...) {
+				on_unknown_exception(op_res, status);
+			}
+
+			return result_bb;
+		}
+	}
+}
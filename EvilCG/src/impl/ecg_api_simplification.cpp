@@ -1,6 +1,7 @@
 #include <ecg_api.h>
 
 #include <core/ecg_cl_programs.h>
+#include <core/ecg_cpu.h>
 #include <core/ecg_host_ctrl.h>
 #include <core/ecg_internal.h>
 #include <core/ecg_program.h>
@@ -13,67 +14,694 @@
 #include <help/ecg_geom.h>
 
 namespace ecg {
-	void center_point_simplification(const ecg_mesh_t* mesh, ecg_internal_mesh_t& result_mesh, ecg_status_handler& op_res) {
+	// Collapses are rejected when a face around them would turn by more than about 80 degrees
+	const double g_qem_min_normal_cos = 0.17;
+
+	// Planes through the open edges keep the borders of the mesh in place
+	const double g_qem_boundary_weight = 1000.0;
+
+	// Relative pivot threshold below which the optimal position of a collapse isn't solved
+	const double g_qem_pivot_threshold = 1e-6;
+
+	// Collapse checks walk the rings of both vertexes, so the edges are split into small chunks
+	const size_t g_qem_collapse_grain = 256;
+
+	const uint32_t g_qem_no_edge = UINT32_MAX;
+
+	// Cell keys of the grid clustering fit into 63 bits
+	const uint32_t g_cluster_max_resolution = 1 << 21;
+
+	// Quadric error of Garland and Heckbert, p^T a p + 2 b^T p + c is the sum of squared distances to its planes
+	struct quadric_t {
+		Eigen::Matrix3d a = Eigen::Matrix3d::Zero();
+		Eigen::Vector3d b = Eigen::Vector3d::Zero();
+		double c = 0.0;
+
+		quadric_t& operator+=(const quadric_t& rhs) {
+			a += rhs.a;
+			b += rhs.b;
+			c += rhs.c;
+			return *this;
+		}
+
+		double evaluate(const Eigen::Vector3d& pos) const {
+			return std::max(pos.dot(a * pos) + 2.0 * b.dot(pos) + c, 0.0);
+		}
+	};
+
+	struct qem_edge_t {
+		uint32_t v0;
+		uint32_t v1;
+		uint32_t faces_cnt;
+		uint32_t face_id;
+		double cost;
+		Eigen::Vector3d position;
+	};
+
+	// Items of every vertex in CSR form, the items of vertex i are ids[offsets[i], offsets[i + 1])
+	struct qem_lists_t {
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> ids;
+
+		std::span<const uint32_t> get(uint32_t vrt_id) const {
+			return std::span<const uint32_t>(ids.data() + offsets[vrt_id], offsets[vrt_id + 1] - offsets[vrt_id]);
+		}
+	};
+
+	/// <summary>
+	/// Simplified mesh in coordinates moved to the center of its box and scaled to its largest side.
+	/// Collapsed vertexes stay in the arrays without faces, so the quadrics are kept for the next targets.
+	/// </summary>
+	struct qem_state_t {
+		std::vector<Eigen::Vector3d> positions;
+		std::vector<quadric_t> quadrics;
+		std::vector<uint32_t> indexes;
+		Eigen::Vector3d center = Eigen::Vector3d::Zero();
+		double scale = 1.0;
+	};
+
+	struct qem_topology_t {
+		std::vector<qem_edge_t> edges;
+		qem_lists_t vertex_edges;
+		qem_lists_t vertex_faces;
+		// Vertexes of open edges and of edges with more than two faces
+		std::vector<uint8_t> is_boundary;
+		std::vector<uint8_t> is_locked;
+	};
+
+	// Slot i of the slots belongs to the item i / slots_per_item, items of a vertex are listed in ascending order
+	qem_lists_t get_vertex_lists(std::span<const uint32_t> slots, size_t slots_per_item, size_t vertexes_cnt) {
+		qem_lists_t lists;
+		lists.offsets.assign(vertexes_cnt + 1, 0);
+		lists.ids.resize(slots.size());
+
+		for (uint32_t vrt_id : slots) ++lists.offsets[vrt_id + 1];
+		std::partial_sum(lists.offsets.begin(), lists.offsets.end(), lists.offsets.begin());
+
+		std::vector<uint32_t> positions(lists.offsets.begin(), lists.offsets.end() - 1);
+		for (size_t slot_id = 0; slot_id < slots.size(); ++slot_id)
+			lists.ids[positions[slots[slot_id]]++] = static_cast<uint32_t>(slot_id / slots_per_item);
+
+		return lists;
+	}
+
+	Eigen::Vector3d get_qem_face_normal(const qem_state_t& state, uint32_t face_id) {
+		const uint32_t* face = state.indexes.data() + face_id * 3;
+		const Eigen::Vector3d& v0 = state.positions[face[0]];
+		return (state.positions[face[1]] - v0).cross(state.positions[face[2]] - v0);
+	}
+
+	quadric_t get_plane_quadric(const Eigen::Vector3d& normal, const Eigen::Vector3d& point, double weight) {
+		quadric_t quadric;
+		double offset = -normal.dot(point);
+		quadric.a = weight * normal * normal.transpose();
+		quadric.b = weight * offset * normal;
+		quadric.c = weight * offset * offset;
+		return quadric;
+	}
+
+	// Undirected (min, max) key of the edge with the face of the half-edge
+	using qem_half_edge_t = std::pair<uint64_t, uint32_t>;
+
+	uint64_t get_qem_edge_key(uint32_t id0, uint32_t id1) {
+		return (uint64_t(std::min(id0, id1)) << 32) | std::max(id0, id1);
+	}
+
+	std::vector<qem_half_edge_t> get_sorted_half_edges(const std::vector<uint32_t>& indexes) {
+		const size_t half_edges_cnt = indexes.size();
+		std::vector<qem_half_edge_t> half_edges(half_edges_cnt);
+
+		cpu::parallel_for(half_edges_cnt, cpu::default_grain, [&](size_t begin, size_t end) {
+			for (size_t half_edge_id = begin; half_edge_id < end; ++half_edge_id) {
+				size_t face_id = half_edge_id / 3;
+				uint32_t id0 = indexes[half_edge_id];
+				uint32_t id1 = indexes[face_id * 3 + (half_edge_id + 1) % 3];
+				half_edges[half_edge_id] = { get_qem_edge_key(id0, id1), static_cast<uint32_t>(face_id) };
+			}
+		});
+
+		std::sort(half_edges.begin(), half_edges.end());
+		return half_edges;
+	}
+
+	/// <summary>
+	/// Keeps the half-edges sorted after a round of collapses without sorting all of them again.
+	/// Half-edges of removed faces are dropped and faces get the ids of the compacted array, which keeps their order.
+	/// Only the half-edges at the removed vertexes change their keys, they are sorted and merged with the rest.
+	/// </summary>
+	void update_sorted_half_edges(std::vector<qem_half_edge_t>& half_edges,
+		const std::vector<uint32_t>& remap, const std::vector<uint32_t>& new_face_ids
+	) {
+		std::vector<qem_half_edge_t> kept;
+		std::vector<qem_half_edge_t> moved;
+		kept.reserve(half_edges.size());
+
+		for (const auto& [key, face_id] : half_edges) {
+			if (new_face_ids[face_id] == UINT32_MAX) continue;
+
+			uint64_t new_key = get_qem_edge_key(remap[static_cast<uint32_t>(key >> 32)], remap[static_cast<uint32_t>(key)]);
+			(new_key == key ? kept : moved).push_back({ new_key, new_face_ids[face_id] });
+		}
+
+		std::sort(moved.begin(), moved.end());
+		half_edges.resize(kept.size() + moved.size());
+		std::merge(kept.begin(), kept.end(), moved.begin(), moved.end(), half_edges.begin());
+	}
+
+	// Undirected edges of the sorted half-edges ordered by their vertexes, face_id is the first face of an edge
+	std::vector<qem_edge_t> get_edges(const std::vector<qem_half_edge_t>& half_edges) {
+		const size_t half_edges_cnt = half_edges.size();
+		std::vector<qem_edge_t> edges;
+		for (size_t first = 0; first < half_edges_cnt;) {
+			size_t last = first;
+			while (last < half_edges_cnt && half_edges[last].first == half_edges[first].first) ++last;
+
+			qem_edge_t edge = {};
+			edge.v0 = static_cast<uint32_t>(half_edges[first].first >> 32);
+			edge.v1 = static_cast<uint32_t>(half_edges[first].first);
+			edge.faces_cnt = static_cast<uint32_t>(last - first);
+			edge.face_id = half_edges[first].second;
+			edges.push_back(edge);
+			first = last;
+		}
+
+		return edges;
+	}
+
+	qem_topology_t get_qem_topology(const qem_state_t& state, const std::vector<qem_half_edge_t>& half_edges) {
+		qem_topology_t topology;
+		const size_t vertexes_cnt = state.positions.size();
+		topology.edges = get_edges(half_edges);
+
+		std::vector<uint32_t> edge_vertexes(topology.edges.size() * 2);
+		for (size_t edge_id = 0; edge_id < topology.edges.size(); ++edge_id) {
+			edge_vertexes[edge_id * 2 + 0] = topology.edges[edge_id].v0;
+			edge_vertexes[edge_id * 2 + 1] = topology.edges[edge_id].v1;
+		}
+
+		topology.vertex_edges = get_vertex_lists(edge_vertexes, 2, vertexes_cnt);
+		topology.vertex_faces = get_vertex_lists(state.indexes, 3, vertexes_cnt);
+
+		topology.is_boundary.assign(vertexes_cnt, 0);
+		topology.is_locked.assign(vertexes_cnt, 0);
+		for (const qem_edge_t& edge : topology.edges) {
+			if (edge.faces_cnt == 1) topology.is_boundary[edge.v0] = topology.is_boundary[edge.v1] = 1;
+			if (edge.faces_cnt > 2) topology.is_locked[edge.v0] = topology.is_locked[edge.v1] = 1;
+		}
+
+		return topology;
+	}
+
+	qem_state_t create_qem_state(const ecg_mesh_t* mesh) {
+		qem_state_t state;
+		const size_t vertexes_cnt = mesh->vertexes_size;
+
+		Eigen::Vector3d min = Eigen::Vector3d::Constant(std::numeric_limits<double>::max());
+		Eigen::Vector3d max = -min;
+		for (size_t vrt_id = 0; vrt_id < vertexes_cnt; ++vrt_id) {
+			const vec3_base& vrt = mesh->vertexes[vrt_id];
+			Eigen::Vector3d pos(vrt.x, vrt.y, vrt.z);
+			min = min.cwiseMin(pos);
+			max = max.cwiseMax(pos);
+		}
+
+		state.center = (min + max) * 0.5;
+		state.scale = std::max((max - min).maxCoeff(), std::numeric_limits<double>::min());
+		state.positions.resize(vertexes_cnt);
+		cpu::parallel_for(vertexes_cnt, cpu::default_grain, [&](size_t begin, size_t end) {
+			for (size_t vrt_id = begin; vrt_id < end; ++vrt_id) {
+				const vec3_base& vrt = mesh->vertexes[vrt_id];
+				state.positions[vrt_id] = (Eigen::Vector3d(vrt.x, vrt.y, vrt.z) - state.center) / state.scale;
+			}
+		});
+
+		// Faces with repeated vertexes have no plane and are dropped
+		for (size_t face_id = 0; face_id < mesh->indexes_size / 3; ++face_id) {
+			const uint32_t* face = mesh->indexes + face_id * 3;
+			if (face[0] == face[1] || face[1] == face[2] || face[0] == face[2]) continue;
+			state.indexes.insert(state.indexes.end(), face, face + 3);
+		}
+
+		const size_t faces_cnt = state.indexes.size() / 3;
+		std::vector<quadric_t> face_quadrics(faces_cnt);
+		cpu::parallel_for(faces_cnt, cpu::default_grain, [&](size_t begin, size_t end) {
+			for (size_t face_id = begin; face_id < end; ++face_id) {
+				Eigen::Vector3d normal = get_qem_face_normal(state, static_cast<uint32_t>(face_id));
+				double length = normal.norm();
+				if (length > 0.0) face_quadrics[face_id] = get_plane_quadric(normal / length, state.positions[state.indexes[face_id * 3]], 1.0);
+			}
+		});
+
+		// Every vertex sums the quadrics of its faces, so the sums don't depend on the threads
+		qem_topology_t topology = get_qem_topology(state, get_sorted_half_edges(state.indexes));
+		state.quadrics.resize(vertexes_cnt);
+		cpu::parallel_for(vertexes_cnt, cpu::default_grain, [&](size_t begin, size_t end) {
+			for (size_t vrt_id = begin; vrt_id < end; ++vrt_id)
+				for (uint32_t face_id : topology.vertex_faces.get(static_cast<uint32_t>(vrt_id)))
+					state.quadrics[vrt_id] += face_quadrics[face_id];
+		});
+
+		for (const qem_edge_t& edge : topology.edges) {
+			if (edge.faces_cnt != 1) continue;
+
+			Eigen::Vector3d direction = state.positions[edge.v1] - state.positions[edge.v0];
+			Eigen::Vector3d normal = direction.cross(get_qem_face_normal(state, edge.face_id));
+			double length = normal.norm();
+			if (length <= 0.0) continue;
+
+			quadric_t quadric = get_plane_quadric(normal / length, state.positions[edge.v0], g_qem_boundary_weight * direction.squaredNorm());
+			state.quadrics[edge.v0] += quadric;
+			state.quadrics[edge.v1] += quadric;
+		}
+
+		return state;
+	}
+
+	// Faces of the vertex keep their orientation when it is moved to the position, faces with the other vertex are removed
+	bool is_collapse_flip_free(const qem_state_t& state, const qem_topology_t& topology, uint32_t vrt_id, uint32_t other_id, const Eigen::Vector3d& position) {
+		for (uint32_t face_id : topology.vertex_faces.get(vrt_id)) {
+			const uint32_t* face = state.indexes.data() + face_id * 3;
+			if (face[0] == other_id || face[1] == other_id || face[2] == other_id) continue;
+
+			std::array<Eigen::Vector3d, 3> corners;
+			for (size_t corner = 0; corner < 3; ++corner)
+				corners[corner] = face[corner] == vrt_id ? position : state.positions[face[corner]];
+
+			Eigen::Vector3d old_normal = get_qem_face_normal(state, face_id);
+			Eigen::Vector3d new_normal = (corners[1] - corners[0]).cross(corners[2] - corners[0]);
+			double lengths = old_normal.norm() * new_normal.norm();
+			if (lengths <= 0.0 || old_normal.dot(new_normal) < g_qem_min_normal_cos * lengths) return false;
+		}
+
+		return true;
+	}
+
+	// Cost and position of the collapse of the edge, collapses that break the topology cost infinity
+	void compute_collapse(const qem_state_t& state, const qem_topology_t& topology, qem_edge_t& edge, double max_error) {
+		edge.cost = std::numeric_limits<double>::infinity();
+		if (edge.faces_cnt > 2 || topology.is_locked[edge.v0] || topology.is_locked[edge.v1]) return;
+		if (edge.faces_cnt == 2 && topology.is_boundary[edge.v0] && topology.is_boundary[edge.v1]) return;
+
+		// Link condition, the vertexes share only the opposite vertexes of the faces of the edge
+		uint32_t shared_cnt = 0;
+		for (uint32_t edge0_id : topology.vertex_edges.get(edge.v0)) {
+			const qem_edge_t& edge0 = topology.edges[edge0_id];
+			uint32_t neighbor = edge0.v0 == edge.v0 ? edge0.v1 : edge0.v0;
+			for (uint32_t edge1_id : topology.vertex_edges.get(edge.v1)) {
+				const qem_edge_t& edge1 = topology.edges[edge1_id];
+				if ((edge1.v0 == edge.v1 ? edge1.v1 : edge1.v0) == neighbor) ++shared_cnt;
+			}
+		}
+		if (shared_cnt != edge.faces_cnt) return;
+
+		quadric_t quadric = state.quadrics[edge.v0];
+		quadric += state.quadrics[edge.v1];
+
+		const Eigen::Vector3d& v0 = state.positions[edge.v0];
+		const Eigen::Vector3d& v1 = state.positions[edge.v1];
+		Eigen::Vector3d middle = (v0 + v1) * 0.5;
+
+		// The optimal position is used while it stays near the edge, otherwise the best of the ends and the middle
+		Eigen::FullPivLU<Eigen::Matrix3d> solver(quadric.a);
+		solver.setThreshold(g_qem_pivot_threshold);
+		bool is_solved = false;
+		if (solver.isInvertible()) {
+			edge.position = solver.solve(-quadric.b);
+			is_solved = (edge.position - middle).squaredNorm() <= (v1 - v0).squaredNorm();
+		}
+
+		if (is_solved) {
+			edge.cost = quadric.evaluate(edge.position);
+		}
+		else {
+			for (const Eigen::Vector3d& candidate : { v0, v1, middle }) {
+				double cost = quadric.evaluate(candidate);
+				if (cost < edge.cost) {
+					edge.cost = cost;
+					edge.position = candidate;
+				}
+			}
+		}
+
+		if (edge.cost > max_error ||
+			!is_collapse_flip_free(state, topology, edge.v0, edge.v1, edge.position) ||
+			!is_collapse_flip_free(state, topology, edge.v1, edge.v0, edge.position)
+		) {
+			edge.cost = std::numeric_limits<double>::infinity();
+		}
+	}
+
+	/// <summary>
+	/// Collapses the cheapest edges until the mesh has target_faces_cnt faces or no collapse is cheaper than max_error.
+	/// Every round collapses the edges that are cheaper than all edges within two rings of their vertexes,
+	/// so the faces changed by the collapses of a round are disjoint and the collapses are applied in parallel.
+	/// </summary>
+	void collapse_edges(qem_state_t& state, size_t target_faces_cnt, double max_error) {
+		// Sorted once, rounds only move the half-edges around the collapsed edges
+		std::vector<qem_half_edge_t> half_edges;
+		if (state.indexes.size() / 3 > target_faces_cnt) half_edges = get_sorted_half_edges(state.indexes);
+
+		while (state.indexes.size() / 3 > target_faces_cnt) {
+			const size_t faces_cnt = state.indexes.size() / 3;
+			const size_t vertexes_cnt = state.positions.size();
+			qem_topology_t topology = get_qem_topology(state, half_edges);
+			auto& edges = topology.edges;
+
+			cpu::parallel_for(edges.size(), g_qem_collapse_grain, [&](size_t begin, size_t end) {
+				for (size_t edge_id = begin; edge_id < end; ++edge_id)
+					compute_collapse(state, topology, edges[edge_id], max_error);
+			});
+
+			auto is_cheaper = [&](uint32_t lhs, uint32_t rhs) {
+				if (lhs == g_qem_no_edge) return false;
+				if (rhs == g_qem_no_edge) return true;
+				return edges[lhs].cost < edges[rhs].cost || (edges[lhs].cost == edges[rhs].cost && lhs < rhs);
+			};
+
+			// The cheapest edge of every vertex and then of its ring
+			std::vector<uint32_t> vertex_min(vertexes_cnt, g_qem_no_edge);
+			std::vector<uint32_t> ring_min(vertexes_cnt, g_qem_no_edge);
+			cpu::parallel_for(vertexes_cnt, cpu::default_grain, [&](size_t begin, size_t end) {
+				for (size_t vrt_id = begin; vrt_id < end; ++vrt_id)
+					for (uint32_t edge_id : topology.vertex_edges.get(static_cast<uint32_t>(vrt_id)))
+						if (std::isfinite(edges[edge_id].cost) && is_cheaper(edge_id, vertex_min[vrt_id])) vertex_min[vrt_id] = edge_id;
+			});
+
+			cpu::parallel_for(vertexes_cnt, cpu::default_grain, [&](size_t begin, size_t end) {
+				for (size_t vrt_id = begin; vrt_id < end; ++vrt_id) {
+					uint32_t result = vertex_min[vrt_id];
+					for (uint32_t edge_id : topology.vertex_edges.get(static_cast<uint32_t>(vrt_id))) {
+						uint32_t neighbor = edges[edge_id].v0 == vrt_id ? edges[edge_id].v1 : edges[edge_id].v0;
+						if (is_cheaper(vertex_min[neighbor], result)) result = vertex_min[neighbor];
+					}
+					ring_min[vrt_id] = result;
+				}
+			});
+
+			std::vector<uint32_t> collapses;
+			for (uint32_t edge_id = 0; edge_id < edges.size(); ++edge_id)
+				if (ring_min[edges[edge_id].v0] == edge_id && ring_min[edges[edge_id].v1] == edge_id) collapses.push_back(edge_id);
+			if (collapses.empty()) break;
+
+			// The cheapest collapses are applied until the target is reached
+			std::sort(collapses.begin(), collapses.end(), is_cheaper);
+			size_t removed_cnt = 0;
+			size_t collapses_cnt = 0;
+			while (collapses_cnt < collapses.size() && faces_cnt - removed_cnt > target_faces_cnt)
+				removed_cnt += edges[collapses[collapses_cnt++]].faces_cnt;
+			collapses.resize(collapses_cnt);
+
+			std::vector<uint32_t> remap(vertexes_cnt);
+			std::iota(remap.begin(), remap.end(), 0);
+			cpu::parallel_for(collapses.size(), cpu::default_grain, [&](size_t begin, size_t end) {
+				for (size_t collapse_id = begin; collapse_id < end; ++collapse_id) {
+					const qem_edge_t& edge = edges[collapses[collapse_id]];
+					remap[edge.v1] = edge.v0;
+					state.positions[edge.v0] = edge.position;
+					state.quadrics[edge.v0] += state.quadrics[edge.v1];
+				}
+			});
+
+			std::vector<uint8_t> is_kept(faces_cnt);
+			cpu::parallel_for(faces_cnt, cpu::default_grain, [&](size_t begin, size_t end) {
+				for (size_t face_id = begin; face_id < end; ++face_id) {
+					uint32_t* face = state.indexes.data() + face_id * 3;
+					for (size_t corner = 0; corner < 3; ++corner) face[corner] = remap[face[corner]];
+					is_kept[face_id] = face[0] != face[1] && face[1] != face[2] && face[0] != face[2];
+				}
+			});
+
+			size_t kept_cnt = 0;
+			std::vector<uint32_t> new_face_ids(faces_cnt, UINT32_MAX);
+			for (size_t face_id = 0; face_id < faces_cnt; ++face_id) {
+				if (!is_kept[face_id]) continue;
+				std::copy_n(state.indexes.begin() + face_id * 3, 3, state.indexes.begin() + kept_cnt * 3);
+				new_face_ids[face_id] = static_cast<uint32_t>(kept_cnt++);
+			}
+			state.indexes.resize(kept_cnt * 3);
+			update_sorted_half_edges(half_edges, remap, new_face_ids);
+		}
+	}
+
+	// Appends the vertexes of the faces in the order of their first use, the appended indexes start from the first appended vertex
+	template <typename GetVertex>
+	void append_compact_mesh(size_t vertexes_cnt, const std::vector<uint32_t>& indexes, GetVertex&& get_vertex,
+		std::vector<vec3_base>& result_vertexes, std::vector<uint32_t>& result_indexes
+	) {
+		std::vector<uint32_t> new_ids(vertexes_cnt, UINT32_MAX);
+		const size_t first_vertex = result_vertexes.size();
+
+		for (uint32_t vrt_id : indexes) {
+			if (new_ids[vrt_id] == UINT32_MAX) {
+				new_ids[vrt_id] = static_cast<uint32_t>(result_vertexes.size() - first_vertex);
+				result_vertexes.push_back(get_vertex(vrt_id));
+			}
+			result_indexes.push_back(new_ids[vrt_id]);
+		}
+	}
+
+	ecg_internal_mesh_t allocate_mesh(const std::vector<vec3_base>& vertexes, const std::vector<uint32_t>& indexes) {
+		ecg_internal_mesh_t result;
+		result.vertexes = allocate_array<vec3_base>(vertexes.size());
+		result.indexes = allocate_array<uint32_t>(indexes.size());
+		if (!vertexes.empty()) std::memcpy(result.vertexes.arr_ptr, vertexes.data(), vertexes.size() * sizeof(vec3_base));
+		if (!indexes.empty()) std::memcpy(result.indexes.arr_ptr, indexes.data(), indexes.size() * sizeof(uint32_t));
+		return result;
+	}
+
+	template <typename GetVertex>
+	ecg_internal_mesh_t get_compact_mesh(size_t vertexes_cnt, const std::vector<uint32_t>& indexes, GetVertex&& get_vertex) {
+		std::vector<vec3_base> result_vertexes;
+		std::vector<uint32_t> result_indexes;
+		append_compact_mesh(vertexes_cnt, indexes, get_vertex, result_vertexes, result_indexes);
+		return allocate_mesh(result_vertexes, result_indexes);
+	}
+
+	// Vertex in the original coordinates of the mesh
+	vec3_base get_qem_vertex(const qem_state_t& state, uint32_t vrt_id) {
+		Eigen::Vector3d pos = state.positions[vrt_id] * state.scale + state.center;
+		return vec3_base(static_cast<float>(pos.x()), static_cast<float>(pos.y()), static_cast<float>(pos.z()));
+	}
+
+	// Vertexes without faces are dropped
+	ecg_internal_mesh_t get_qem_mesh(const qem_state_t& state) {
+		return get_compact_mesh(state.positions.size(), state.indexes, [&state](uint32_t vrt_id) { return get_qem_vertex(state, vrt_id); });
+	}
+
+	/// <summary>
+	/// Grid of cubic cells over the box of a mesh, cells_cnt is the number of cells along every axis.
+	/// </summary>
+	struct cluster_grid_t {
+		vec3_base min;
+		float inv_cell_size = 0.0f;
+		std::array<uint32_t, 3> cells_cnt = { 1, 1, 1 };
+
+		uint64_t get_key(const vec3_base& vrt) const {
+			uint64_t x = std::min(static_cast<uint32_t>((vrt.x - min.x) * inv_cell_size), cells_cnt[0] - 1);
+			uint64_t y = std::min(static_cast<uint32_t>((vrt.y - min.y) * inv_cell_size), cells_cnt[1] - 1);
+			uint64_t z = std::min(static_cast<uint32_t>((vrt.z - min.z) * inv_cell_size), cells_cnt[2] - 1);
+			return (z * cells_cnt[1] + y) * cells_cnt[0] + x;
+		}
+
+		size_t get_key_bits() const {
+			uint64_t keys_cnt = uint64_t(cells_cnt[0]) * cells_cnt[1] * cells_cnt[2];
+			return std::max<size_t>(std::bit_width(keys_cnt - 1), 1);
+		}
+	};
+
+	cluster_grid_t get_cluster_grid(const bounding_box& aabb, const ecg_simplify_params_t& params, ecg_status_handler& op_res) {
+		// A closed surface covers about six squares of the resolution with cells and gets two faces per cell
+		uint32_t resolution = params.grid_resolution;
+		if (resolution == 0) resolution = static_cast<uint32_t>(std::ceil(std::sqrt(double(params.target_faces_cnt) / 12.0)));
+		if (resolution == 0 || resolution > g_cluster_max_resolution) op_res = ecg_status_code::INVALID_ARG;
+
+		cluster_grid_t grid;
+		grid.min = aabb.min;
+		std::array<float, 3> sides = { aabb.max.x - aabb.min.x, aabb.max.y - aabb.min.y, aabb.max.z - aabb.min.z };
+		float max_side = *std::max_element(sides.begin(), sides.end());
+		if (max_side <= 0.0f) return grid;
+
+		grid.inv_cell_size = resolution / max_side;
+		for (size_t axis = 0; axis < 3; ++axis)
+			grid.cells_cnt[axis] = std::clamp<uint32_t>(static_cast<uint32_t>(std::ceil(sides[axis] * grid.inv_cell_size)), 1, resolution);
+
+		return grid;
+	}
+
+	void internal_center_point_simplification(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, const cluster_grid_t& grid,
+		std::vector<vec3_base>& cell_vertexes, std::vector<uint32_t>& indexes, ecg_status_handler& op_res
+	) {
 		auto& ctrl = ecg_cl::get_instance();
-		auto& queue = ctrl.get_cmd_queue();
-		auto& context = ctrl.get_context();
-		auto& dev = ctrl.get_device();
+		auto& buffer_pool = ctrl.get_buffer_pool();
 
 		cl::Program::Sources sources = { center_point_simplification_code };
-		auto program = ecg_program_wrapper::get_program(context, dev, sources, center_point_simplification_name);
+		auto program = ecg_program_wrapper::get_program(ctrl.get_context(), ctrl.get_device(), sources, compute_cell_keys_name);
 
-		cl_uint indexes_size = mesh->indexes_size;
-		cl_uint vertexes_size = mesh->vertexes_size;
+		cl_uint vertexes_cnt = static_cast<cl_uint>(mesh.vertexes_size);
+		cl_uint faces_cnt = static_cast<cl_uint>(mesh.indexes_size / 3);
 		cl_int vrt_size = sizeof(vec3_base) / sizeof(float);
-		size_t indexes_buffer_size = sizeof(uint32_t) * indexes_size;
-		size_t vertexes_buffer_size = sizeof(vec3_base) * vertexes_size;
 
 		cl_int err_create_buffer = CL_SUCCESS;
-		cl::Buffer vertexes_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, vertexes_buffer_size, nullptr, &err_create_buffer); op_res = err_create_buffer;
-		cl::Buffer indexes_buffer = cl::Buffer(context, CL_MEM_READ_ONLY, indexes_buffer_size, nullptr, &err_create_buffer); op_res = err_create_buffer;
+		ecg_pooled_buffer keys_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(cl_ulong) * vertexes_cnt, &err_create_buffer); op_res = err_create_buffer;
+		ecg_pooled_buffer ids_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(cl_uint) * vertexes_cnt, &err_create_buffer); op_res = err_create_buffer;
+		ecg_pooled_buffer offsets_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(cl_uint) * (vertexes_cnt + 1), &err_create_buffer); op_res = err_create_buffer;
+		ecg_pooled_buffer vertex_cells_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(cl_uint) * vertexes_cnt, &err_create_buffer); op_res = err_create_buffer;
+		ecg_pooled_buffer faces_offsets_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(cl_uint) * (faces_cnt + 1), &err_create_buffer); op_res = err_create_buffer;
 
-		cl_uint result_indexes_size = indexes_size / 3;
-		cl_uint result_vertexes_size = vertexes_size / 3;
-		cl::Buffer result_vertexes_buffer = cl::Buffer(context, CL_MEM_READ_WRITE, vertexes_buffer_size / 3, &err_create_buffer); op_res = err_create_buffer;
-		cl::Buffer result_indexes_size_buffer = cl::Buffer(context, CL_MEM_READ_WRITE, sizeof(uint32_t), &err_create_buffer); op_res = err_create_buffer;
-
-		cl::NDRange global = mesh->vertexes_size;
+		cl::NDRange vertexes_global = vertexes_cnt;
+		cl::NDRange faces_global = faces_cnt;
 		cl::NDRange local = cl::NullRange;
 
-		op_res = queue.enqueueWriteBuffer(vertexes_buffer, CL_FALSE, 0, vertexes_buffer_size, mesh->vertexes);
-		op_res = queue.enqueueWriteBuffer(indexes_buffer, CL_FALSE, 0, indexes_buffer_size, mesh->indexes);
-		op_res = queue.finish();
+		op_res = program->execute(
+			chain, compute_cell_keys_name, vertexes_global, local,
+			mesh.vertexes_buffer, vrt_size, vertexes_cnt,
+			grid.min.x, grid.min.y, grid.min.z, grid.inv_cell_size,
+			grid.cells_cnt[0], grid.cells_cnt[1], grid.cells_cnt[2],
+			keys_buffer, ids_buffer
+		);
+
+		// Vertexes of a cell become a run of the sorted keys, ids stay ascending inside it
+		internal_sort_keys(chain, keys_buffer, ids_buffer, vertexes_cnt, grid.get_key_bits(), op_res);
 
 		op_res = program->execute(
-			queue, center_point_simplification_name, global, local,
-			vertexes_buffer, vertexes_size, indexes_buffer, indexes_size,
-			// Result mesh
-			result_vertexes_buffer, result_vertexes_size,
-			result_indexes_size_buffer, vrt_size
+			chain, find_cell_starts_name, vertexes_global, local,
+			keys_buffer, vertexes_cnt, offsets_buffer
 		);
 
-		//op_res = queue.enqueueReadBuffer();
-		op_res = queue.finish();
+		cl_uint cells_cnt = 0;
+		internal_scan_exclusive(chain, offsets_buffer, vertexes_cnt, op_res);
+		op_res = chain.read_buffer(offsets_buffer, sizeof(cl_uint) * vertexes_cnt, sizeof(cl_uint), &cells_cnt);
+		op_res = chain.wait();
+
+		size_t cell_vertexes_buffer_size = sizeof(vec3_base) * cells_cnt;
+		ecg_pooled_buffer cell_vertexes_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, cell_vertexes_buffer_size, &err_create_buffer); op_res = err_create_buffer;
+
+		op_res = program->execute(
+			chain, average_cell_vertexes_name, vertexes_global, local,
+			mesh.vertexes_buffer, vrt_size, vertexes_cnt,
+			ids_buffer, offsets_buffer,
+			vertex_cells_buffer, cell_vertexes_buffer
+		);
+
+		op_res = program->execute(
+			chain, mark_cluster_faces_name, faces_global, local,
+			mesh.indexes_buffer, faces_cnt,
+			vertex_cells_buffer, faces_offsets_buffer
+		);
+
+		cl_uint kept_faces_cnt = 0;
+		internal_scan_exclusive(chain, faces_offsets_buffer, faces_cnt, op_res);
+		op_res = chain.read_buffer(faces_offsets_buffer, sizeof(cl_uint) * faces_cnt, sizeof(cl_uint), &kept_faces_cnt);
+		op_res = chain.wait();
+
+		cell_vertexes.resize(cells_cnt);
+		indexes.resize(size_t(kept_faces_cnt) * 3);
+		op_res = chain.read_buffer(cell_vertexes_buffer, 0, cell_vertexes_buffer_size, cell_vertexes.data());
+
+		if (kept_faces_cnt != 0) {
+			size_t result_indexes_buffer_size = sizeof(cl_uint) * indexes.size();
+			ecg_pooled_buffer result_indexes_buffer = buffer_pool.acquire(chain, CL_MEM_WRITE_ONLY, result_indexes_buffer_size, &err_create_buffer); op_res = err_create_buffer;
+
+			op_res = program->execute(
+				chain, compact_cluster_faces_name, faces_global, local,
+				mesh.indexes_buffer, faces_cnt,
+				vertex_cells_buffer, faces_offsets_buffer,
+				result_indexes_buffer
+			);
+			op_res = chain.read_buffer(result_indexes_buffer, 0, result_indexes_buffer_size, indexes.data());
+		}
+
+		op_res = chain.wait();
 	}
 
-	void qem_simplification(const ecg_mesh_t* mesh, ecg_internal_mesh_t& result_mesh, ecg_status_handler& op_res) {
-		throw std::logic_error("Not implemented method"); // TODO: implement later this method
+	// Same passes as on the device, the cells sum their vertexes in the same order
+	void cpu_center_point_simplification(const ecg_mesh_t* mesh, const cluster_grid_t& grid,
+		std::vector<vec3_base>& cell_vertexes, std::vector<uint32_t>& indexes
+	) {
+		const size_t vertexes_cnt = mesh->vertexes_size;
+		std::vector<std::pair<uint64_t, uint32_t>> keys(vertexes_cnt);
+		cpu::parallel_for(vertexes_cnt, cpu::default_grain, [&](size_t begin, size_t end) {
+			for (size_t vrt_id = begin; vrt_id < end; ++vrt_id)
+				keys[vrt_id] = { grid.get_key(mesh->vertexes[vrt_id]), static_cast<uint32_t>(vrt_id) };
+		});
+		std::sort(keys.begin(), keys.end());
+
+		std::vector<uint32_t> vertex_cells(vertexes_cnt);
+		for (size_t first = 0; first < vertexes_cnt;) {
+			vec3_base sum;
+			size_t last = first;
+			for (; last < vertexes_cnt && keys[last].first == keys[first].first; ++last) {
+				sum = sum + mesh->vertexes[keys[last].second];
+				vertex_cells[keys[last].second] = static_cast<uint32_t>(cell_vertexes.size());
+			}
+
+			cell_vertexes.push_back(sum / static_cast<float>(last - first));
+			first = last;
+		}
+
+		for (size_t face_id = 0; face_id < mesh->indexes_size / 3; ++face_id) {
+			uint32_t c0 = vertex_cells[mesh->indexes[face_id * 3 + 0]];
+			uint32_t c1 = vertex_cells[mesh->indexes[face_id * 3 + 1]];
+			uint32_t c2 = vertex_cells[mesh->indexes[face_id * 3 + 2]];
+			if (c0 != c1 && c1 != c2 && c0 != c2) indexes.insert(indexes.end(), { c0, c1, c2 });
+		}
+	}
+
+	void center_point_simplification(const ecg_mesh_t* mesh, const ecg_simplify_params_t& params, ecg_internal_mesh_t& result_mesh, ecg_status_handler& op_res) {
+		std::vector<vec3_base> cell_vertexes;
+		std::vector<uint32_t> indexes;
+		cpu::check_indexes(mesh, op_res);
+
+		if (get_active_backend() == ECG_BACKEND_CPU) {
+			cluster_grid_t grid = get_cluster_grid(cpu::compute_aabb(mesh, op_res), params, op_res);
+			cpu_center_point_simplification(mesh, grid, cell_vertexes, indexes);
+		}
+		else {
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+			cluster_grid_t grid = get_cluster_grid(hulls::internal_compute_aabb(chain, cl_mesh, op_res), params, op_res);
+			internal_center_point_simplification(chain, cl_mesh, grid, cell_vertexes, indexes, op_res);
+		}
+
+		// Cells whose faces were all dropped don't get a vertex
+		result_mesh = get_compact_mesh(cell_vertexes.size(), indexes, [&cell_vertexes](uint32_t cell_id) { return cell_vertexes[cell_id]; });
+	}
+
+	void qem_simplification(const ecg_mesh_t* mesh, const ecg_simplify_params_t& params, ecg_internal_mesh_t& result_mesh, ecg_status_handler& op_res) {
+		qem_state_t state;
+		{
+			ecg_profile_scope phase_scope("compute_quadrics");
+			cpu::check_indexes(mesh, op_res);
+			state = create_qem_state(mesh);
+		}
+
+		{
+			// The error is measured in the scaled coordinates of the state
+			ecg_profile_scope phase_scope("collapse_edges");
+			collapse_edges(state, params.target_faces_cnt, double(params.max_error) / (state.scale * state.scale));
+		}
+
+		result_mesh = get_qem_mesh(state);
 	}
 
-	ecg_internal_mesh_t simplify_mesh(const ecg_mesh_t* mesh, simplify_method method, ecg_status* status) {
+	ecg_internal_mesh_t simplify_mesh(const ecg_mesh_t* mesh, simplify_method method, const ecg_simplify_params_t& params, ecg_status* status) {
+		ecg_profile_scope profile_scope("simplify_mesh");
+		auto& mem_inst = ecg_mem::get_instance();
 		ecg_status_handler op_res;
 		ecg_internal_mesh_t result;
 
 		try {
 			default_mesh_check(mesh, op_res, status);
+			if (!(params.max_error >= 0.0f)) op_res = ecg_status_code::INVALID_ARG;
+
 			switch (method)
 			{
 			case ecg::SM_CENTER_POINT: {
-				center_point_simplification(mesh, result, op_res);
+				center_point_simplification(mesh, params, result, op_res);
 				break;
 			}
 			case ecg::SM_QEM: {
-				qem_simplification(mesh, result, op_res);
+				qem_simplification(mesh, params, result, op_res);
 				break;
 			}
 			default:
@@ -83,6 +711,67 @@ namespace ecg {
 		}
 		catch (...) {
 			on_unknown_exception(op_res, status);
+			mem_inst.delete_memory(result.vertexes.handler);
+			mem_inst.delete_memory(result.indexes.handler);
+			result = ecg_internal_mesh_t{};
+		}
+
+		return result;
+	}
+
+	ecg_lod_chain_t generate_lod_chain(const ecg_mesh_t* mesh, const float* ratios, size_t ratios_count, ecg_status* status) {
+		ecg_profile_scope profile_scope("generate_lod_chain");
+		auto& mem_inst = ecg_mem::get_instance();
+		ecg_status_handler op_res;
+		ecg_lod_chain_t result;
+
+		try {
+			default_mesh_check(mesh, op_res, status);
+			if (ratios == nullptr || ratios_count == 0) op_res = ecg_status_code::INVALID_ARG;
+			for (size_t level = 0; level < ratios_count; ++level) {
+				if (!(ratios[level] > 0.0f && ratios[level] <= 1.0f)) op_res = ecg_status_code::INVALID_ARG;
+				if (level != 0 && ratios[level] > ratios[level - 1]) op_res = ecg_status_code::INVALID_ARG;
+			}
+
+			qem_state_t state;
+			{
+				ecg_profile_scope phase_scope("compute_quadrics");
+				cpu::check_indexes(mesh, op_res);
+				state = create_qem_state(mesh);
+			}
+
+			// Every level continues the collapses of the previous one with its quadrics
+			const size_t faces_cnt = state.indexes.size() / 3;
+			std::vector<vec3_base> vertexes;
+			std::vector<uint32_t> indexes;
+			std::vector<uint32_t> vertex_offsets = { 0 };
+			std::vector<uint32_t> index_offsets = { 0 };
+
+			for (size_t level = 0; level < ratios_count; ++level) {
+				{
+					ecg_profile_scope phase_scope("collapse_edges");
+					size_t target_faces_cnt = static_cast<size_t>(std::ceil(double(ratios[level]) * faces_cnt));
+					collapse_edges(state, target_faces_cnt, std::numeric_limits<double>::infinity());
+				}
+
+				append_compact_mesh(state.positions.size(), state.indexes, [&state](uint32_t vrt_id) { return get_qem_vertex(state, vrt_id); }, vertexes, indexes);
+				vertex_offsets.push_back(static_cast<uint32_t>(vertexes.size()));
+				index_offsets.push_back(static_cast<uint32_t>(indexes.size()));
+			}
+
+			result.mesh = allocate_mesh(vertexes, indexes);
+			result.vertex_offsets = allocate_array<uint32_t>(vertex_offsets.size());
+			result.index_offsets = allocate_array<uint32_t>(index_offsets.size());
+			std::memcpy(result.vertex_offsets.arr_ptr, vertex_offsets.data(), vertex_offsets.size() * sizeof(uint32_t));
+			std::memcpy(result.index_offsets.arr_ptr, index_offsets.data(), index_offsets.size() * sizeof(uint32_t));
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+			mem_inst.delete_memory(result.mesh.vertexes.handler);
+			mem_inst.delete_memory(result.mesh.indexes.handler);
+			mem_inst.delete_memory(result.vertex_offsets.handler);
+			mem_inst.delete_memory(result.index_offsets.handler);
+			result = ecg_lod_chain_t{};
 		}
 
 		return result;
@@ -0,0 +1,618 @@
+#include <ecg_api.h>
+
+#include <core/ecg_cl_programs.h>
+#include <core/ecg_cpu.h>
+#include <core/ecg_host_ctrl.h>
+#include <core/ecg_internal.h>
+#include <core/ecg_program.h>
+
+#include <help/ecg_allocate.h>
+#include <help/ecg_logger.h>
+#include <help/ecg_helper.h>
+#include <help/ecg_checks.h>
+#include <help/ecg_geom.h>
+
+namespace ecg {
+	std::shared_ptr<ecg_program_wrapper> get_edge_topology_program() {
+		auto& ctrl = ecg_cl::get_instance();
+		cl::Program::Sources sources = { edge_topology_code };
+		return ecg_program_wrapper::get_program(ctrl.get_context(), ctrl.get_device(), sources, build_edge_keys_name);
+	}
+
+	// Local arrays of the kernels are sized for the default group, smaller devices get their largest power of two
+	size_t get_edges_group_size(ecg_program_wrapper& program, cl::Device& dev) {
+		size_t group_size = edges_group_size;
+		auto kernel = program.get_kernel(radix_rank_name);
+		if (kernel != nullptr)
+			group_size = std::min(group_size, std::bit_floor(kernel->get_kernel().getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(dev)));
+		return group_size;
+	}
+
+	void internal_scan_exclusive(ecg_cmd_chain& chain, const cl::Buffer& values_buffer, cl_uint values_cnt, ecg_status_handler& op_res) {
+		auto& ctrl = ecg_cl::get_instance();
+		auto& dev = ctrl.get_device();
+		auto program = get_edge_topology_program();
+
+		const size_t group_size = get_edges_group_size(*program, dev);
+		const size_t max_groups_cnt = std::max<size_t>(dev.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>(), 1) * scan_groups_per_unit;
+		size_t groups_cnt = std::clamp<size_t>((values_cnt + group_size - 1) / group_size, 1, max_groups_cnt);
+
+		// Values of one group are scanned in place, longer arrays are split into blocks of every group
+		if (groups_cnt == 1) {
+			cl::NDRange global = group_size;
+			cl::NDRange local = group_size;
+
+			op_res = program->execute(
+				chain, scan_exclusive_name, global, local,
+				values_buffer, values_cnt
+			);
+			return;
+		}
+
+		const size_t block_size = (values_cnt + groups_cnt - 1) / groups_cnt;
+		groups_cnt = (values_cnt + block_size - 1) / block_size;
+
+		cl_int err_create_buffer = CL_SUCCESS;
+		ecg_pooled_buffer block_sums_buffer = ctrl.get_buffer_pool().acquire(chain, CL_MEM_READ_WRITE, sizeof(cl_uint) * (groups_cnt + 1), &err_create_buffer); op_res = err_create_buffer;
+
+		cl::NDRange global = groups_cnt * group_size;
+		cl::NDRange local = group_size;
+		cl_uint block_size_arg = static_cast<cl_uint>(block_size);
+
+		op_res = program->execute(
+			chain, scan_blocks_name, global, local,
+			values_buffer, values_cnt, block_size_arg,
+			block_sums_buffer
+		);
+
+		internal_scan_exclusive(chain, block_sums_buffer, static_cast<cl_uint>(groups_cnt), op_res);
+
+		op_res = program->execute(
+			chain, add_block_offsets_name, global, local,
+			values_buffer, values_cnt, block_size_arg,
+			block_sums_buffer
+		);
+	}
+
+	void internal_sort_keys(ecg_cmd_chain& chain, ecg_pooled_buffer& keys_buffer, ecg_pooled_buffer& values_buffer, cl_uint items_cnt, size_t key_bits, ecg_status_handler& op_res) {
+		auto& ctrl = ecg_cl::get_instance();
+		auto& buffer_pool = ctrl.get_buffer_pool();
+		auto program = get_edge_topology_program();
+
+		const size_t group_size = get_edges_group_size(*program, ctrl.get_device());
+		const size_t groups_cnt = (items_cnt + group_size - 1) / group_size;
+		const cl_uint digit_counts_cnt = static_cast<cl_uint>(groups_cnt << edges_radix_bits);
+
+		size_t keys_buffer_size = sizeof(cl_ulong) * items_cnt;
+		size_t values_buffer_size = sizeof(cl_uint) * items_cnt;
+
+		cl_int err_create_buffer = CL_SUCCESS;
+		ecg_pooled_buffer sorted_keys_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, keys_buffer_size, &err_create_buffer); op_res = err_create_buffer;
+		ecg_pooled_buffer sorted_values_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, values_buffer_size, &err_create_buffer); op_res = err_create_buffer;
+		ecg_pooled_buffer ranks_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, values_buffer_size, &err_create_buffer); op_res = err_create_buffer;
+		ecg_pooled_buffer digit_counts_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(cl_uint) * (digit_counts_cnt + 1), &err_create_buffer); op_res = err_create_buffer;
+
+		cl::NDRange global = groups_cnt * group_size;
+		cl::NDRange local = group_size;
+
+		for (cl_uint shift = 0; shift < key_bits; shift += edges_radix_bits) {
+			op_res = program->execute(
+				chain, radix_rank_name, global, local,
+				keys_buffer, items_cnt, shift,
+				ranks_buffer, digit_counts_buffer
+			);
+
+			internal_scan_exclusive(chain, digit_counts_buffer, digit_counts_cnt, op_res);
+
+			op_res = program->execute(
+				chain, radix_scatter_name, global, local,
+				keys_buffer, values_buffer, items_cnt, shift,
+				ranks_buffer, digit_counts_buffer,
+				sorted_keys_buffer, sorted_values_buffer
+			);
+
+			std::swap(keys_buffer, sorted_keys_buffer);
+			std::swap(values_buffer, sorted_values_buffer);
+		}
+	}
+
+	void internal_sort_lists(ecg_cmd_chain& chain, const cl::Buffer& offsets_buffer, cl_uint lists_cnt, const cl::Buffer& ids_buffer, ecg_status_handler& op_res) {
+		auto& ctrl = ecg_cl::get_instance();
+		auto program = get_edge_topology_program();
+		cl::NDRange global = lists_cnt;
+		cl::NDRange local = cl::NullRange;
+
+		op_res = program->execute(
+			chain, sort_adjacency_lists_name, global, local,
+			offsets_buffer, lists_cnt,
+			ids_buffer
+		);
+	}
+
+	ecg_cl_edges_t internal_sort_edges(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res) {
+		auto& ctrl = ecg_cl::get_instance();
+		auto& buffer_pool = ctrl.get_buffer_pool();
+		auto program = get_edge_topology_program();
+
+		ecg_cl_edges_t edges;
+		edges.half_edges_cnt = static_cast<cl_uint>(mesh.indexes_size);
+		edges.vertexes_cnt = static_cast<cl_uint>(mesh.vertexes_size);
+
+		cl_int err_create_buffer = CL_SUCCESS;
+		ecg_pooled_buffer keys_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(cl_ulong) * edges.half_edges_cnt, &err_create_buffer); op_res = err_create_buffer;
+		ecg_pooled_buffer half_edges_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(cl_uint) * edges.half_edges_cnt, &err_create_buffer); op_res = err_create_buffer;
+
+		cl::NDRange global = edges.half_edges_cnt;
+		cl::NDRange local = cl::NullRange;
+
+		op_res = program->execute(
+			chain, build_edge_keys_name, global, local,
+			mesh.indexes_buffer, edges.half_edges_cnt, edges.vertexes_cnt,
+			keys_buffer, half_edges_buffer
+		);
+
+		// Keys are below vertexes_cnt^2, digits above it are zero for every key
+		const size_t key_bits = std::bit_width(uint64_t(edges.vertexes_cnt) * edges.vertexes_cnt - 1);
+		internal_sort_keys(chain, keys_buffer, half_edges_buffer, edges.half_edges_cnt, key_bits, op_res);
+
+		edges.keys_buffer = std::move(keys_buffer);
+		edges.half_edges_buffer = std::move(half_edges_buffer);
+		return edges;
+	}
+
+	ecg_edge_stats_t internal_count_edges(ecg_cmd_chain& chain, const ecg_cl_edges_t& edges, const cl::Buffer* valence_buffer, ecg_status_handler& op_res) {
+		auto& ctrl = ecg_cl::get_instance();
+		auto program = get_edge_topology_program();
+
+		std::array<cl_uint, 3> counters = {};
+		size_t counters_buffer_size = sizeof(cl_uint) * counters.size();
+
+		cl_int err_create_buffer = CL_SUCCESS;
+		ecg_pooled_buffer counters_buffer = ctrl.get_buffer_pool().acquire(chain, CL_MEM_READ_WRITE, counters_buffer_size, &err_create_buffer); op_res = err_create_buffer;
+
+		cl_uint pattern = 0;
+		op_res = chain.fill_buffer(counters_buffer, pattern, 0, counters_buffer_size);
+
+		cl::NDRange global = edges.half_edges_cnt;
+		cl::NDRange local = cl::NullRange;
+		cl_uint with_valence = valence_buffer != nullptr ? 1 : 0;
+
+		op_res = program->execute(
+			chain, count_edge_runs_name, global, local,
+			edges.keys_buffer, edges.half_edges_cnt, edges.vertexes_cnt,
+			counters_buffer, with_valence, with_valence ? *valence_buffer : static_cast<const cl::Buffer&>(counters_buffer)
+		);
+
+		op_res = chain.read_buffer(counters_buffer, 0, counters_buffer_size, counters.data());
+		op_res = chain.wait();
+
+		return ecg_edge_stats_t{ counters[0], counters[1], counters[2] };
+	}
+
+	ecg_array_t internal_find_edges(ecg_cmd_chain& chain, const ecg_cl_edges_t& edges, cl_uint min_faces_cnt, cl_uint max_faces_cnt, ecg_status_handler& op_res) {
+		auto& ctrl = ecg_cl::get_instance();
+		auto program = get_edge_topology_program();
+
+		cl_int err_create_buffer = CL_SUCCESS;
+		ecg_pooled_buffer offsets_buffer = ctrl.get_buffer_pool().acquire(chain, CL_MEM_READ_WRITE, sizeof(cl_uint) * (edges.half_edges_cnt + 1), &err_create_buffer); op_res = err_create_buffer;
+
+		cl::NDRange global = edges.half_edges_cnt;
+		cl::NDRange local = cl::NullRange;
+
+		// Heads of matching runs are flagged and compacted by a scan, so the edges keep the order of the keys
+		op_res = program->execute(
+			chain, mark_edge_runs_name, global, local,
+			edges.keys_buffer, edges.half_edges_cnt,
+			min_faces_cnt, max_faces_cnt,
+			offsets_buffer
+		);
+
+		internal_scan_exclusive(chain, offsets_buffer, edges.half_edges_cnt, op_res);
+
+		cl_uint edges_cnt = 0;
+		op_res = chain.read_buffer(offsets_buffer, sizeof(cl_uint) * edges.half_edges_cnt, sizeof(cl_uint), &edges_cnt);
+		op_res = chain.wait();
+
+		ecg_array_t result = allocate_array<uint32_t>(size_t(edges_cnt) * 2);
+		if (edges_cnt == 0) return result;
+
+		size_t edges_buffer_size = sizeof(cl_uint) * result.arr_size;
+		ecg_pooled_buffer edges_buffer = allocate_result_buffer(chain, result.arr_ptr, edges_buffer_size, op_res);
+
+		op_res = program->execute(
+			chain, emit_edges_name, global, local,
+			edges.keys_buffer, edges.half_edges_cnt, edges.vertexes_cnt,
+			offsets_buffer, edges_buffer
+		);
+
+		read_result_buffer(chain, edges_buffer, result.arr_ptr, edges_buffer_size, op_res);
+		op_res = chain.wait();
+		return result;
+	}
+
+	bool internal_is_mesh_vertexes_manifold(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, const ecg_cl_edges_t& edges, ecg_status_handler& op_res) {
+		auto& ctrl = ecg_cl::get_instance();
+		auto& buffer_pool = ctrl.get_buffer_pool();
+		auto program = get_edge_topology_program();
+		bool result = true;
+
+		size_t vertexes_buffer_size = sizeof(cl_uint) * edges.vertexes_cnt;
+		size_t positions_buffer_size = sizeof(cl_uint) * edges.half_edges_cnt;
+
+		cl_int err_create_buffer = CL_SUCCESS;
+		ecg_pooled_buffer corners_cnt_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, vertexes_buffer_size, &err_create_buffer); op_res = err_create_buffer;
+		ecg_pooled_buffer first_half_edges_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, vertexes_buffer_size, &err_create_buffer); op_res = err_create_buffer;
+		ecg_pooled_buffer positions_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, positions_buffer_size, &err_create_buffer); op_res = err_create_buffer;
+		ecg_pooled_buffer result_buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(bool), &err_create_buffer); op_res = err_create_buffer;
+
+		cl_uint zero_pattern = 0;
+		cl_uint max_pattern = std::numeric_limits<cl_uint>::max();
+		op_res = chain.fill_buffer(corners_cnt_buffer, zero_pattern, 0, vertexes_buffer_size);
+		op_res = chain.fill_buffer(first_half_edges_buffer, max_pattern, 0, vertexes_buffer_size);
+		op_res = chain.write_buffer(result_buffer, 0, sizeof(bool), &result);
+
+		cl::NDRange half_edges_global = edges.half_edges_cnt;
+		cl::NDRange vertexes_global = edges.vertexes_cnt;
+		cl::NDRange local = cl::NullRange;
+
+		op_res = program->execute(
+			chain, count_vertex_corners_name, half_edges_global, local,
+			mesh.indexes_buffer, edges.half_edges_cnt,
+			corners_cnt_buffer, first_half_edges_buffer
+		);
+
+		op_res = program->execute(
+			chain, find_half_edges_positions_name, half_edges_global, local,
+			edges.half_edges_buffer, edges.half_edges_cnt,
+			positions_buffer
+		);
+
+		op_res = program->execute(
+			chain, check_vertexes_fans_name, vertexes_global, local,
+			mesh.indexes_buffer, edges.keys_buffer, edges.half_edges_buffer,
+			positions_buffer, edges.half_edges_cnt,
+			corners_cnt_buffer, first_half_edges_buffer,
+			edges.vertexes_cnt, result_buffer
+		);
+
+		op_res = chain.read_buffer(result_buffer, 0, sizeof(bool), &result);
+		op_res = chain.wait();
+		return result;
+	}
+
+	ecg_array_t internal_compute_vertexes_valence(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res) {
+		auto& ctrl = ecg_cl::get_instance();
+
+		ecg_cl_edges_t edges = internal_sort_edges(chain, mesh, op_res);
+		size_t valence_buffer_size = sizeof(cl_uint) * mesh.vertexes_size;
+
+		ecg_array_t result = allocate_array<uint32_t>(mesh.vertexes_size);
+		ecg_pooled_buffer valence_buffer = allocate_result_buffer(chain, result.arr_ptr, valence_buffer_size, op_res);
+
+		cl_uint pattern = 0;
+		op_res = chain.fill_buffer(valence_buffer, pattern, 0, valence_buffer_size);
+
+		internal_count_edges(chain, edges, &valence_buffer, op_res);
+		read_result_buffer(chain, valence_buffer, result.arr_ptr, valence_buffer_size, op_res);
+		op_res = chain.wait();
+		return result;
+	}
+
+	std::shared_ptr<ecg_cl_adjacency_t> internal_build_adjacency(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res) {
+		auto& ctrl = ecg_cl::get_instance();
+		auto& buffer_pool = ctrl.get_buffer_pool();
+		auto program = get_edge_topology_program();
+
+		auto adjacency = std::make_shared<ecg_cl_adjacency_t>();
+		auto& vertex_faces = adjacency->vertex_faces;
+		auto& face_faces = adjacency->face_faces;
+		auto& vertex_vertexes = adjacency->vertex_vertexes;
+
+		ecg_cl_edges_t edges = internal_sort_edges(chain, mesh, op_res);
+		const cl_uint faces_cnt = edges.half_edges_cnt / 3;
+		vertex_faces.items_cnt = edges.vertexes_cnt;
+		face_faces.items_cnt = faces_cnt;
+		vertex_vertexes.items_cnt = edges.vertexes_cnt;
+
+		// Lists can be empty, buffers can't
+		cl_int err_create_buffer = CL_SUCCESS;
+		auto acquire_buffer = [&](size_t items_cnt) {
+			ecg_pooled_buffer buffer = buffer_pool.acquire(chain, CL_MEM_READ_WRITE, sizeof(cl_uint) * std::max<size_t>(items_cnt, 1), &err_create_buffer); op_res = err_create_buffer;
+			return buffer;
+		};
+
+		// The adjacency is kept on the mesh and used later by other chains, its lists get their own buffers of the exact size
+		auto create_buffer = [&](size_t items_cnt) {
+			ecg_pooled_buffer buffer(cl::Buffer(ctrl.get_context(), CL_MEM_READ_WRITE, sizeof(cl_uint) * std::max<size_t>(items_cnt, 1), nullptr, &err_create_buffer)); op_res = err_create_buffer;
+			return buffer;
+		};
+
+		vertex_faces.offsets_buffer = create_buffer(vertex_faces.items_cnt + 1);
+		face_faces.offsets_buffer = create_buffer(face_faces.items_cnt + 1);
+		vertex_vertexes.offsets_buffer = create_buffer(vertex_vertexes.items_cnt + 1);
+		ecg_pooled_buffer positions_buffer = acquire_buffer(edges.half_edges_cnt);
+		ecg_pooled_buffer faces_cursors_buffer = acquire_buffer(edges.vertexes_cnt);
+		ecg_pooled_buffer vertexes_cursors_buffer = acquire_buffer(edges.vertexes_cnt);
+
+		cl_uint pattern = 0;
+		size_t vertexes_buffer_size = sizeof(cl_uint) * edges.vertexes_cnt;
+		op_res = chain.fill_buffer(vertex_faces.offsets_buffer, pattern, 0, vertexes_buffer_size);
+		op_res = chain.fill_buffer(vertex_vertexes.offsets_buffer, pattern, 0, vertexes_buffer_size);
+		op_res = chain.fill_buffer(faces_cursors_buffer, pattern, 0, vertexes_buffer_size);
+		op_res = chain.fill_buffer(vertexes_cursors_buffer, pattern, 0, vertexes_buffer_size);
+
+		cl::NDRange faces_global = faces_cnt;
+		cl::NDRange half_edges_global = edges.half_edges_cnt;
+		cl::NDRange local = cl::NullRange;
+
+		// Counts of all lists, the valence of the vertexes is the count of their neighbours
+		op_res = program->execute(
+			chain, count_vertex_faces_name, faces_global, local,
+			mesh.indexes_buffer, faces_cnt,
+			vertex_faces.offsets_buffer
+		);
+
+		op_res = program->execute(
+			chain, find_half_edges_positions_name, half_edges_global, local,
+			edges.half_edges_buffer, edges.half_edges_cnt,
+			positions_buffer
+		);
+
+		op_res = program->execute(
+			chain, count_face_faces_name, faces_global, local,
+			edges.keys_buffer, edges.half_edges_buffer, positions_buffer,
+			edges.half_edges_cnt, faces_cnt,
+			face_faces.offsets_buffer
+		);
+
+		internal_count_edges(chain, edges, &vertex_vertexes.offsets_buffer, op_res);
+
+		for (auto list : { &vertex_faces, &face_faces, &vertex_vertexes }) {
+			internal_scan_exclusive(chain, list->offsets_buffer, list->items_cnt, op_res);
+			op_res = chain.read_buffer(list->offsets_buffer, sizeof(cl_uint) * list->items_cnt, sizeof(cl_uint), &list->ids_cnt);
+		}
+		op_res = chain.wait();
+
+		vertex_faces.ids_buffer = create_buffer(vertex_faces.ids_cnt);
+		face_faces.ids_buffer = create_buffer(face_faces.ids_cnt);
+		vertex_vertexes.ids_buffer = create_buffer(vertex_vertexes.ids_cnt);
+
+		op_res = program->execute(
+			chain, fill_vertex_faces_name, faces_global, local,
+			mesh.indexes_buffer, faces_cnt,
+			vertex_faces.offsets_buffer, faces_cursors_buffer,
+			vertex_faces.ids_buffer
+		);
+
+		op_res = program->execute(
+			chain, fill_face_faces_name, faces_global, local,
+			edges.keys_buffer, edges.half_edges_buffer, positions_buffer,
+			edges.half_edges_cnt, faces_cnt,
+			face_faces.offsets_buffer, face_faces.ids_buffer
+		);
+
+		op_res = program->execute(
+			chain, fill_vertex_vertexes_name, half_edges_global, local,
+			edges.keys_buffer, edges.half_edges_cnt, edges.vertexes_cnt,
+			vertex_vertexes.offsets_buffer, vertexes_cursors_buffer,
+			vertex_vertexes.ids_buffer
+		);
+
+		for (auto list : { &vertex_faces, &face_faces, &vertex_vertexes })
+			internal_sort_lists(chain, list->offsets_buffer, list->items_cnt, list->ids_buffer, op_res);
+
+		// Other chains read the adjacency without waiting for this one
+		op_res = chain.wait();
+		return adjacency;
+	}
+
+	std::shared_ptr<ecg_cl_adjacency_t> internal_get_adjacency(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res) {
+		std::scoped_lock lock(*mesh.adjacency_lock);
+		if (mesh.adjacency == nullptr) mesh.adjacency = internal_build_adjacency(chain, mesh, op_res);
+		return mesh.adjacency;
+	}
+
+	ecg_adjacency_list_t read_adjacency_list(ecg_cmd_chain& chain, const ecg_cl_adjacency_list_t& list, ecg_status_handler& op_res) {
+		ecg_adjacency_list_t result;
+		result.offsets = allocate_array<uint32_t>(size_t(list.items_cnt) + 1);
+		result.ids = allocate_array<uint32_t>(list.ids_cnt);
+
+		op_res = chain.read_buffer(list.offsets_buffer, 0, sizeof(cl_uint) * result.offsets.arr_size, result.offsets.arr_ptr);
+		if (list.ids_cnt != 0)
+			op_res = chain.read_buffer(list.ids_buffer, 0, sizeof(cl_uint) * result.ids.arr_size, result.ids.arr_ptr);
+		return result;
+	}
+
+	ecg_adjacency_t internal_read_adjacency(ecg_cmd_chain& chain, const ecg_cl_mesh_t& mesh, ecg_status_handler& op_res) {
+		auto adjacency = internal_get_adjacency(chain, mesh, op_res);
+
+		ecg_adjacency_t result;
+		result.vertex_faces = read_adjacency_list(chain, adjacency->vertex_faces, op_res);
+		result.face_faces = read_adjacency_list(chain, adjacency->face_faces, op_res);
+		result.vertex_vertexes = read_adjacency_list(chain, adjacency->vertex_vertexes, op_res);
+		op_res = chain.wait();
+		return result;
+	}
+
+	ecg_adjacency_t build_adjacency(const ecg_mesh_t* mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("build_adjacency");
+		ecg_adjacency_t result;
+		ecg_status_handler op_res;
+
+		try {
+			default_mesh_check(mesh, op_res, status);
+			if (get_active_backend() == ECG_BACKEND_CPU) return cpu::build_adjacency(mesh, op_res);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+			result = internal_read_adjacency(chain, cl_mesh, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+			cleanup(result);
+			result = ecg_adjacency_t{};
+		}
+
+		return result;
+	}
+
+	ecg_adjacency_t build_adjacency(const ecg_uploaded_mesh_t& mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("build_adjacency");
+		ecg_adjacency_t result;
+		ecg_status_handler op_res;
+
+		try {
+			auto cl_mesh = uploaded_mesh_check(mesh, op_res, status);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			result = internal_read_adjacency(chain, *cl_mesh, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+			cleanup(result);
+			result = ecg_adjacency_t{};
+		}
+
+		return result;
+	}
+
+	ecg_edge_stats_t compute_edge_stats(const ecg_mesh_t* mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("compute_edge_stats");
+		ecg_edge_stats_t result{};
+		ecg_status_handler op_res;
+
+		try {
+			default_mesh_check(mesh, op_res, status);
+			if (get_active_backend() == ECG_BACKEND_CPU) return cpu::compute_edge_stats(mesh, op_res);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+			auto edges = internal_sort_edges(chain, cl_mesh, op_res);
+			result = internal_count_edges(chain, edges, nullptr, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+		}
+
+		return result;
+	}
+
+	ecg_edge_stats_t compute_edge_stats(const ecg_uploaded_mesh_t& mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("compute_edge_stats");
+		ecg_edge_stats_t result{};
+		ecg_status_handler op_res;
+
+		try {
+			auto cl_mesh = uploaded_mesh_check(mesh, op_res, status);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			auto edges = internal_sort_edges(chain, *cl_mesh, op_res);
+			result = internal_count_edges(chain, edges, nullptr, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+		}
+
+		return result;
+	}
+
+	// Boundary edges have one face, non-manifold edges more than two
+	const cl_uint g_boundary_faces_cnt = 1;
+	const cl_uint g_min_non_manifold_faces_cnt = 3;
+
+	ecg_array_t find_edges(const ecg_mesh_t* mesh, cl_uint min_faces_cnt, cl_uint max_faces_cnt, ecg_status* status) {
+		ecg_array_t result;
+		ecg_status_handler op_res;
+
+		try {
+			default_mesh_check(mesh, op_res, status);
+			if (get_active_backend() == ECG_BACKEND_CPU) return cpu::find_edges(mesh, min_faces_cnt, max_faces_cnt, op_res);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+			auto edges = internal_sort_edges(chain, cl_mesh, op_res);
+			result = internal_find_edges(chain, edges, min_faces_cnt, max_faces_cnt, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+			if (result.handler != 0) ecg_mem::get_instance().delete_memory(result.handler);
+			result = ecg_array_t{};
+		}
+
+		return result;
+	}
+
+	ecg_array_t find_edges(const ecg_uploaded_mesh_t& mesh, cl_uint min_faces_cnt, cl_uint max_faces_cnt, ecg_status* status) {
+		ecg_array_t result;
+		ecg_status_handler op_res;
+
+		try {
+			auto cl_mesh = uploaded_mesh_check(mesh, op_res, status);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			auto edges = internal_sort_edges(chain, *cl_mesh, op_res);
+			result = internal_find_edges(chain, edges, min_faces_cnt, max_faces_cnt, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+			if (result.handler != 0) ecg_mem::get_instance().delete_memory(result.handler);
+			result = ecg_array_t{};
+		}
+
+		return result;
+	}
+
+	ecg_array_t find_boundary_edges(const ecg_mesh_t* mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("find_boundary_edges");
+		return find_edges(mesh, g_boundary_faces_cnt, g_boundary_faces_cnt, status);
+	}
+
+	ecg_array_t find_boundary_edges(const ecg_uploaded_mesh_t& mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("find_boundary_edges");
+		return find_edges(mesh, g_boundary_faces_cnt, g_boundary_faces_cnt, status);
+	}
+
+	ecg_array_t find_non_manifold_edges(const ecg_mesh_t* mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("find_non_manifold_edges");
+		return find_edges(mesh, g_min_non_manifold_faces_cnt, std::numeric_limits<cl_uint>::max(), status);
+	}
+
+	ecg_array_t find_non_manifold_edges(const ecg_uploaded_mesh_t& mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("find_non_manifold_edges");
+		return find_edges(mesh, g_min_non_manifold_faces_cnt, std::numeric_limits<cl_uint>::max(), status);
+	}
+
+	ecg_array_t compute_vertexes_valence(const ecg_mesh_t* mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("compute_vertexes_valence");
+		ecg_array_t result;
+		ecg_status_handler op_res;
+
+		try {
+			default_mesh_check(mesh, op_res, status);
+			if (get_active_backend() == ECG_BACKEND_CPU) return cpu::compute_vertexes_valence(mesh, op_res);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			auto cl_mesh = allocate_cl_mesh(chain, mesh, op_res);
+			result = internal_compute_vertexes_valence(chain, cl_mesh, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+			if (result.handler != 0) ecg_mem::get_instance().delete_memory(result.handler);
+			result = ecg_array_t{};
+		}
+
+		return result;
+	}
+
+	ecg_array_t compute_vertexes_valence(const ecg_uploaded_mesh_t& mesh, ecg_status* status) {
+		ecg_profile_scope profile_scope("compute_vertexes_valence");
+		ecg_array_t result;
+		ecg_status_handler op_res;
+
+		try {
+			auto cl_mesh = uploaded_mesh_check(mesh, op_res, status);
+			ecg_cmd_chain chain(ecg_cl::get_instance().get_cmd_queue());
+			result = internal_compute_vertexes_valence(chain, *cl_mesh, op_res);
+		}
+		catch (...) {
+			on_unknown_exception(op_res, status);
+			if (result.handler != 0) ecg_mem::get_instance().delete_memory(result.handler);
+			result = ecg_array_t{};
+		}
+
+		return result;
+	}
+}
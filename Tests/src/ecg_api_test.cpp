@@ -5,6 +5,10 @@
 #define ENABLE_ECG_CL
 #include <ecg_meshes.h>
 #include <ecg_api.h>
+#include <ecg_async.h>
+
+#include <core/ecg_multi_cl.h>
+#include <help/ecg_allocate.h>
 
 TEST(ecg_api, init_ecg) {
 	ecg::ecg_cl& host_ctrl = ecg::ecg_cl::get_instance();
@@ -108,6 +112,38 @@ TEST(ecg_api, summ_vertexes) {
 	check_func(meshes_inst.loaded_meshes);
 }
 
+TEST(ecg_api, summ_vertexes_precision) {
+	// Far from the origin a float accumulator drops the low bits of every next vertex
+	constexpr size_t vertexes_cnt = 1 << 16;
+	std::vector<ecg::vec3_base> vertexes(vertexes_cnt);
+	double expected[3] = { 0.0, 0.0, 0.0 };
+	for (size_t id = 0; id < vertexes_cnt; ++id) {
+		vertexes[id] = ecg::vec3_base(1000.0f + 0.1f * (id % 7), -250.0f + 0.01f * (id % 13), 0.001f * (id % 3));
+		expected[0] += vertexes[id].x;
+		expected[1] += vertexes[id].y;
+		expected[2] += vertexes[id].z;
+	}
+
+	std::vector<uint32_t> indexes = { 0, 1, 2 };
+	ecg::ecg_mesh_t mesh;
+	mesh.vertexes = vertexes.data();
+	mesh.vertexes_size = static_cast<uint32_t>(vertexes.size());
+	mesh.indexes = indexes.data();
+	mesh.indexes_size = static_cast<uint32_t>(indexes.size());
+
+	ecg::ecg_status status;
+	ecg::vec3_base sum = ecg::sum_vertexes(&mesh, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ASSERT_NEAR(sum.x, expected[0], std::abs(expected[0]) * 1e-6);
+	ASSERT_NEAR(sum.y, expected[1], std::abs(expected[1]) * 1e-6);
+	ASSERT_NEAR(sum.z, expected[2], std::abs(expected[2]) * 1e-5);
+
+	ecg::vec3_base center = ecg::get_center(&mesh, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ASSERT_NEAR(center.x, expected[0] / vertexes_cnt, 1e-3);
+	ASSERT_NEAR(center.y, expected[1] / vertexes_cnt, 1e-3);
+}
+
 TEST(ecg_api, get_center) {
 	ecg::vec3_base result_center;
 	bool compare_result = false;
@@ -169,11 +205,54 @@ TEST(ecg_api, compute_aabb) {
 		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
 		timer.end();
 
+		ecg::set_backend(ecg::ECG_BACKEND_CPU);
+		ecg::bounding_box cpu_bb = ecg::hulls::compute_aabb(&item->mesh, &status);
+		ecg::set_backend(ecg::ECG_BACKEND_AUTO);
+		ASSERT_TRUE(ecg::compare_bounding_boxes(result_bb, cpu_bb));
+
 		auto obj_save_path = item->full_path.replace_extension("").string() + "_test_aabb.obj";
 		ecg_meshes::save_bb_to_obj(&result_bb, obj_save_path);
 	}
 }
 
+TEST(ecg_api, DISABLED_compute_aabb_scaling) {
+	ecg::ecg_status status;
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<float> distribution(-1000.0f, 1000.0f);
+
+	constexpr size_t max_vertexes_cnt = 100'000'000;
+	std::vector<ecg::vec3_base> vertexes(max_vertexes_cnt);
+	for (auto& vrt : vertexes)
+		vrt = ecg::vec3_base(distribution(generator), distribution(generator), distribution(generator));
+
+	std::vector<uint32_t> indexes = { 0, 1, 2 };
+	constexpr size_t calls_cnt = 10;
+
+	for (size_t vertexes_cnt = 10'000; vertexes_cnt <= max_vertexes_cnt; vertexes_cnt *= 10) {
+		ecg::ecg_mesh_t mesh;
+		mesh.vertexes = vertexes.data();
+		mesh.vertexes_size = static_cast<uint32_t>(vertexes_cnt);
+		mesh.indexes = indexes.data();
+		mesh.indexes_size = static_cast<uint32_t>(indexes.size());
+
+		// Uploaded once, so only the reduction is timed
+		ecg::ecg_uploaded_mesh_t uploaded = ecg::upload_mesh(&mesh, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ecg::hulls::compute_aabb(uploaded, &status);
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (size_t call = 0; call < calls_cnt; ++call)
+			ecg::hulls::compute_aabb(uploaded, &status);
+		auto time = std::chrono::high_resolution_clock::now() - start;
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ecg::cleanup(uploaded.handler);
+
+		double ms = std::chrono::duration_cast<std::chrono::microseconds>(time).count() / 1000.0 / calls_cnt;
+		std::cout << "AABB of " << vertexes_cnt << " vertexes: " << ms << " ms, "
+			<< vertexes_cnt * sizeof(ecg::vec3_base) / (ms * 1e6) << " GB/s" << std::endl;
+	}
+}
+
 TEST(ecg_api, compute_obb) {
 	ecg::full_bounding_box result_bb;
 	bool compare_result = false;
@@ -266,7 +345,73 @@ TEST(ecg_api, compute_surface_area) {
 
 		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
 		ASSERT_NE(result_surf_area, -FLT_MAX);
+
+		// Sums don't depend on the order work items finish in
+		ASSERT_EQ(ecg::compute_surface_area(&item->mesh, &status), result_surf_area);
+	}
+}
+
+TEST(ecg_api, compute_faces_areas) {
+	auto& mesh_inst = ecg_meshes::get_instance();
+	ecg::ecg_status status;
+	ecg::ecg_array_t areas_cdf;
+
+	ecg::ecg_array_t areas = ecg::compute_faces_areas(nullptr, &areas_cdf, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::INVALID_ARG);
+	ASSERT_EQ(areas.arr_ptr, nullptr);
+	ASSERT_EQ(areas_cdf.arr_ptr, nullptr);
+
+	constexpr size_t max_vertexes_cnt = 1024;
+	for (auto& item : mesh_inst.loaded_meshes) {
+		auto& mesh = item->mesh;
+		if (mesh.vertexes_size > max_vertexes_cnt) continue;
+
+		areas = ecg::compute_faces_areas(&mesh, &areas_cdf, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+
+		const size_t faces_cnt = mesh.indexes_size / 3;
+		ASSERT_EQ(areas.arr_size, faces_cnt);
+		ASSERT_EQ(areas_cdf.arr_size, faces_cnt);
+
+		ecg::set_backend(ecg::ECG_BACKEND_CPU);
+		ecg::ecg_array_t cpu_areas = ecg::compute_faces_areas(&mesh, nullptr, &status);
+		ecg::set_backend(ecg::ECG_BACKEND_AUTO);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+
+		const float* face_areas = static_cast<const float*>(areas.arr_ptr);
+		const float* cpu_face_areas = static_cast<const float*>(cpu_areas.arr_ptr);
+		const float* cdf = static_cast<const float*>(areas_cdf.arr_ptr);
+
+		double expected_sum = 0.0;
+		for (size_t face_id = 0; face_id < faces_cnt; ++face_id) {
+			ASSERT_NEAR(face_areas[face_id], cpu_face_areas[face_id], std::max(cpu_face_areas[face_id] * 1e-5f, 1e-6f));
+			expected_sum += face_areas[face_id];
+			ASSERT_NEAR(cdf[face_id], expected_sum, expected_sum * 1e-4 + 1e-6);
+			if (face_id > 0) {
+				ASSERT_GE(cdf[face_id], cdf[face_id - 1]);
+			}
+		}
+
+		float surface_area = ecg::compute_surface_area(&mesh, &status);
+		ASSERT_NEAR(cdf[faces_cnt - 1], surface_area, std::abs(surface_area) * 1e-4f);
+
+		ecg::cleanup(areas.handler);
+		ecg::cleanup(areas_cdf.handler);
+		ecg::cleanup(cpu_areas.handler);
 	}
+
+	// Areas only, the CDF is optional
+	ecg::ecg_mesh_t& default_cube = mesh_inst.loaded_meshes_by_name["default_cube.obj"]->mesh;
+	ecg::ecg_uploaded_mesh_t uploaded = ecg::upload_mesh(&default_cube, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	areas = ecg::compute_faces_areas(uploaded, nullptr, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ASSERT_EQ(areas.arr_size, default_cube.indexes_size / 3);
+	for (size_t face_id = 0; face_id < areas.arr_size; ++face_id)
+		ASSERT_NEAR(static_cast<const float*>(areas.arr_ptr)[face_id], 2.0f, 1e-5f);
+
+	ecg::cleanup(areas.handler);
+	ecg::cleanup(uploaded.handler);
 }
 
 TEST(ecg_api, compute_covariance_matrix) {
@@ -301,6 +446,83 @@ TEST(ecg_api, compute_covariance_matrix) {
 	}
 }
 
+TEST(ecg_api, compute_mesh_stats) {
+	auto& mesh_inst = ecg_meshes::get_instance();
+	ecg::ecg_status status;
+
+	ecg::compute_mesh_stats(nullptr, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::INVALID_ARG);
+
+	ecg::ecg_mesh_t& default_cube = mesh_inst.loaded_meshes_by_name["default_cube.obj"]->mesh;
+	ecg::ecg_mesh_stats_t cube_stats = ecg::compute_mesh_stats(&default_cube, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ASSERT_NEAR(std::abs(cube_stats.volume), 8.0f, 1e-4f);
+	ASSERT_NEAR(cube_stats.surface_area, 24.0f, 1e-4f);
+	ASSERT_EQ(cube_stats.degenerate_faces_cnt, 0);
+
+	// A face with a repeated vertex and a face with collinear vertexes
+	std::vector<ecg::vec3_base> vertexes = { { 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 2.0f, 0.0f, 0.0f } };
+	std::vector<uint32_t> indexes = { 0, 1, 2, 0, 1, 1, 0, 1, 3 };
+	ecg::ecg_mesh_t degenerate_mesh;
+	degenerate_mesh.vertexes = vertexes.data();
+	degenerate_mesh.vertexes_size = static_cast<uint32_t>(vertexes.size());
+	degenerate_mesh.indexes = indexes.data();
+	degenerate_mesh.indexes_size = static_cast<uint32_t>(indexes.size());
+
+	for (ecg::ecg_backend backend : { ecg::ECG_BACKEND_OPENCL, ecg::ECG_BACKEND_CPU }) {
+		ecg::set_backend(backend);
+		ecg::ecg_mesh_stats_t stats = ecg::compute_mesh_stats(&degenerate_mesh, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_EQ(stats.faces_cnt, 3);
+		ASSERT_EQ(stats.degenerate_faces_cnt, 2);
+		ASSERT_NEAR(stats.surface_area, 0.5f, 1e-6f);
+	}
+	ecg::set_backend(ecg::ECG_BACKEND_AUTO);
+
+	// Results match the separate functions and the host implementation
+	constexpr size_t max_vertexes_cnt = 1024;
+	for (auto& item : mesh_inst.loaded_meshes) {
+		auto& mesh = item->mesh;
+		if (mesh.vertexes_size > max_vertexes_cnt) continue;
+
+		ecg::ecg_mesh_stats_t stats = ecg::compute_mesh_stats(&mesh, &status);
+		if (status != ecg::ecg_status_code::SUCCESS) continue;
+
+		ASSERT_EQ(stats.vertexes_cnt, mesh.vertexes_size);
+		ASSERT_EQ(stats.faces_cnt, mesh.indexes_size / 3);
+		ASSERT_TRUE(ecg::compare_bounding_boxes(stats.aabb, ecg::hulls::compute_aabb(&mesh)));
+
+		float expected_area = ecg::compute_surface_area(&mesh);
+		ASSERT_NEAR(stats.surface_area, expected_area, std::abs(expected_area) * 1e-4f);
+
+		ecg::vec3_base expected_sum = ecg::sum_vertexes(&mesh);
+		float sum_epsilon = 1e-4f * std::max({ 1.0f, std::abs(expected_sum.x), std::abs(expected_sum.y), std::abs(expected_sum.z) });
+		ASSERT_TRUE(ecg::compare_vec3_base(stats.vertexes_sum, expected_sum, sum_epsilon));
+
+		ecg::set_backend(ecg::ECG_BACKEND_CPU);
+		ecg::ecg_mesh_stats_t cpu_stats = ecg::compute_mesh_stats(&mesh, &status);
+		ecg::set_backend(ecg::ECG_BACKEND_AUTO);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+
+		ASSERT_EQ(stats.degenerate_faces_cnt, cpu_stats.degenerate_faces_cnt);
+		ASSERT_TRUE(ecg::compare_vec3_base(stats.center, cpu_stats.center, 1e-4f));
+		ASSERT_NEAR(stats.volume, cpu_stats.volume, std::max(std::abs(cpu_stats.volume) * 1e-4f, 1e-4f));
+
+		const float* cov = &stats.covariance.m00;
+		const float* cpu_cov = &cpu_stats.covariance.m00;
+		float cov_epsilon = 1e-3f * std::max({ 1.0f, cpu_stats.covariance.m00, cpu_stats.covariance.m11, cpu_stats.covariance.m22 });
+		for (size_t id = 0; id < 9; ++id) ASSERT_NEAR(cov[id], cpu_cov[id], cov_epsilon);
+	}
+
+	ecg::ecg_uploaded_mesh_t uploaded = ecg::upload_mesh(&default_cube, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ecg::ecg_mesh_stats_t uploaded_stats = ecg::compute_mesh_stats(uploaded, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ASSERT_FLOAT_EQ(uploaded_stats.surface_area, cube_stats.surface_area);
+	ASSERT_TRUE(ecg::compare_bounding_boxes(uploaded_stats.aabb, cube_stats.aabb));
+	ecg::cleanup(uploaded.handler);
+}
+
 TEST(ecg_api, is_mesh_closed) {
 	ecg::ecg_status status;
 	custom_timer_t timer;
@@ -465,6 +687,202 @@ TEST(ecg_api, is_mesh_manifold) {
 	ASSERT_FALSE(result);
 }
 
+TEST(ecg_api, edge_topology) {
+	auto& mesh_inst = ecg_meshes::get_instance();
+	ecg::ecg_status status;
+
+	ecg::ecg_edge_stats_t stats = ecg::compute_edge_stats(nullptr, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::INVALID_ARG);
+	ASSERT_EQ(stats.edges_cnt, 0);
+
+	// Three faces on the edge (0, 1), the other edges have one face
+	std::vector<ecg::vec3_base> vertexes = {
+		ecg::vec3_base(0.0f, 0.0f, 0.0f), ecg::vec3_base(1.0f, 0.0f, 0.0f),
+		ecg::vec3_base(0.5f, 1.0f, 0.0f), ecg::vec3_base(0.5f, -1.0f, 0.0f), ecg::vec3_base(0.5f, 0.0f, 1.0f)
+	};
+	std::vector<uint32_t> indexes = { 0, 1, 2, 1, 0, 3, 0, 1, 4 };
+	ecg::ecg_mesh_t fin_mesh;
+	fin_mesh.vertexes = vertexes.data();
+	fin_mesh.vertexes_size = static_cast<uint32_t>(vertexes.size());
+	fin_mesh.indexes = indexes.data();
+	fin_mesh.indexes_size = static_cast<uint32_t>(indexes.size());
+
+	stats = ecg::compute_edge_stats(&fin_mesh, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ASSERT_EQ(stats.edges_cnt, 7);
+	ASSERT_EQ(stats.boundary_edges_cnt, 6);
+	ASSERT_EQ(stats.non_manifold_edges_cnt, 1);
+
+	ecg::ecg_array_t non_manifold_edges = ecg::find_non_manifold_edges(&fin_mesh, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ASSERT_EQ(non_manifold_edges.arr_size, 2);
+	ASSERT_EQ(static_cast<const uint32_t*>(non_manifold_edges.arr_ptr)[0], 0);
+	ASSERT_EQ(static_cast<const uint32_t*>(non_manifold_edges.arr_ptr)[1], 1);
+
+	ecg::ecg_array_t valence = ecg::compute_vertexes_valence(&fin_mesh, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	std::vector<uint32_t> expected_valence = { 4, 4, 2, 2, 2 };
+	ASSERT_EQ(valence.arr_size, expected_valence.size());
+	for (size_t vrt_id = 0; vrt_id < expected_valence.size(); ++vrt_id)
+		ASSERT_EQ(static_cast<const uint32_t*>(valence.arr_ptr)[vrt_id], expected_valence[vrt_id]);
+
+	ecg::cleanup(non_manifold_edges.handler);
+	ecg::cleanup(valence.handler);
+
+	// The device sort gives the same edges in the same order as the host
+	constexpr size_t max_vertexes_cnt = 1024;
+	for (auto& item : mesh_inst.loaded_meshes) {
+		auto& mesh = item->mesh;
+		if (mesh.vertexes_size > max_vertexes_cnt) continue;
+
+		stats = ecg::compute_edge_stats(&mesh, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ecg::ecg_array_t boundary_edges = ecg::find_boundary_edges(&mesh, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		valence = ecg::compute_vertexes_valence(&mesh, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+
+		ecg::set_backend(ecg::ECG_BACKEND_CPU);
+		ecg::ecg_edge_stats_t cpu_stats = ecg::compute_edge_stats(&mesh, &status);
+		ecg::ecg_array_t cpu_boundary_edges = ecg::find_boundary_edges(&mesh, &status);
+		ecg::ecg_array_t cpu_valence = ecg::compute_vertexes_valence(&mesh, &status);
+		ecg::set_backend(ecg::ECG_BACKEND_AUTO);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+
+		ASSERT_EQ(stats.edges_cnt, cpu_stats.edges_cnt);
+		ASSERT_EQ(stats.boundary_edges_cnt, cpu_stats.boundary_edges_cnt);
+		ASSERT_EQ(stats.non_manifold_edges_cnt, cpu_stats.non_manifold_edges_cnt);
+		ASSERT_EQ(boundary_edges.arr_size, stats.boundary_edges_cnt * 2);
+		ASSERT_EQ(boundary_edges.arr_size, cpu_boundary_edges.arr_size);
+		if (boundary_edges.arr_size != 0) {
+			ASSERT_EQ(std::memcmp(boundary_edges.arr_ptr, cpu_boundary_edges.arr_ptr, sizeof(uint32_t) * boundary_edges.arr_size), 0);
+		}
+		ASSERT_EQ(valence.arr_size, cpu_valence.arr_size);
+		ASSERT_EQ(std::memcmp(valence.arr_ptr, cpu_valence.arr_ptr, sizeof(uint32_t) * valence.arr_size), 0);
+
+		ecg::cleanup(boundary_edges.handler);
+		ecg::cleanup(cpu_boundary_edges.handler);
+		ecg::cleanup(valence.handler);
+		ecg::cleanup(cpu_valence.handler);
+	}
+
+	// A closed cube has 18 edges of its 12 triangles and no boundary
+	ecg::ecg_mesh_t& default_cube = mesh_inst.loaded_meshes_by_name["default_cube.obj"]->mesh;
+	ecg::ecg_uploaded_mesh_t uploaded = ecg::upload_mesh(&default_cube, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	stats = ecg::compute_edge_stats(uploaded, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ASSERT_EQ(stats.edges_cnt, 18);
+	ASSERT_EQ(stats.boundary_edges_cnt, 0);
+	ASSERT_EQ(stats.non_manifold_edges_cnt, 0);
+
+	ecg::ecg_array_t boundary_edges = ecg::find_boundary_edges(uploaded, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ASSERT_EQ(boundary_edges.arr_ptr, nullptr);
+	ASSERT_TRUE(ecg::is_mesh_closed(uploaded, &status));
+
+	ecg::cleanup(uploaded.handler);
+}
+
+TEST(ecg_api, mesh_adjacency) {
+	auto& mesh_inst = ecg_meshes::get_instance();
+	ecg::ecg_status status;
+
+	auto is_same_list = [](const ecg::ecg_adjacency_list_t& lhs, const ecg::ecg_adjacency_list_t& rhs) {
+		if (lhs.offsets.arr_size != rhs.offsets.arr_size || lhs.ids.arr_size != rhs.ids.arr_size) return false;
+		if (std::memcmp(lhs.offsets.arr_ptr, rhs.offsets.arr_ptr, sizeof(uint32_t) * lhs.offsets.arr_size) != 0) return false;
+		return lhs.ids.arr_size == 0 || std::memcmp(lhs.ids.arr_ptr, rhs.ids.arr_ptr, sizeof(uint32_t) * lhs.ids.arr_size) == 0;
+	};
+
+	auto is_same_adjacency = [&](const ecg::ecg_adjacency_t& lhs, const ecg::ecg_adjacency_t& rhs) {
+		return is_same_list(lhs.vertex_faces, rhs.vertex_faces) &&
+			is_same_list(lhs.face_faces, rhs.face_faces) &&
+			is_same_list(lhs.vertex_vertexes, rhs.vertex_vertexes);
+	};
+
+	ecg::ecg_adjacency_t adjacency = ecg::build_adjacency(nullptr, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::INVALID_ARG);
+	ASSERT_EQ(adjacency.vertex_faces.offsets.arr_ptr, nullptr);
+
+	// Every vertex of a tetrahedron touches three faces and three vertexes, every face has three neighbours
+	std::vector<ecg::vec3_base> vertexes = {
+		ecg::vec3_base(0.0f, 0.0f, 0.0f), ecg::vec3_base(1.0f, 0.0f, 0.0f),
+		ecg::vec3_base(0.0f, 1.0f, 0.0f), ecg::vec3_base(0.0f, 0.0f, 1.0f)
+	};
+	std::vector<uint32_t> indexes = { 0, 2, 1, 0, 1, 3, 0, 3, 2, 1, 2, 3 };
+	ecg::ecg_mesh_t tetrahedron;
+	tetrahedron.vertexes = vertexes.data();
+	tetrahedron.vertexes_size = static_cast<uint32_t>(vertexes.size());
+	tetrahedron.indexes = indexes.data();
+	tetrahedron.indexes_size = static_cast<uint32_t>(indexes.size());
+
+	adjacency = ecg::build_adjacency(&tetrahedron, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	for (const auto* list : { &adjacency.vertex_faces, &adjacency.face_faces, &adjacency.vertex_vertexes }) {
+		ASSERT_EQ(list->offsets.arr_size, 5);
+		ASSERT_EQ(list->ids.arr_size, 12);
+		auto offsets = static_cast<const uint32_t*>(list->offsets.arr_ptr);
+		auto ids = static_cast<const uint32_t*>(list->ids.arr_ptr);
+		for (uint32_t item = 0; item < 4; ++item) {
+			ASSERT_EQ(offsets[item], item * 3);
+			ASSERT_LT(ids[offsets[item]], ids[offsets[item] + 1]);
+			ASSERT_LT(ids[offsets[item] + 1], ids[offsets[item] + 2]);
+		}
+	}
+
+	auto vertex_vertexes = static_cast<const uint32_t*>(adjacency.vertex_vertexes.ids.arr_ptr);
+	ASSERT_EQ(vertex_vertexes[0], 1);
+	ASSERT_EQ(vertex_vertexes[1], 2);
+	ASSERT_EQ(vertex_vertexes[2], 3);
+	ecg::cleanup(adjacency);
+
+	// The device lists are sorted, so they match the host ones exactly
+	constexpr size_t max_vertexes_cnt = 1024;
+	for (auto& item : mesh_inst.loaded_meshes) {
+		auto& mesh = item->mesh;
+		if (mesh.vertexes_size > max_vertexes_cnt) continue;
+
+		adjacency = ecg::build_adjacency(&mesh, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+
+		ecg::set_backend(ecg::ECG_BACKEND_CPU);
+		ecg::ecg_adjacency_t cpu_adjacency = ecg::build_adjacency(&mesh, &status);
+		ecg::set_backend(ecg::ECG_BACKEND_AUTO);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+
+		ASSERT_EQ(adjacency.vertex_faces.offsets.arr_size, mesh.vertexes_size + 1);
+		ASSERT_EQ(adjacency.face_faces.offsets.arr_size, mesh.indexes_size / 3 + 1);
+		ASSERT_TRUE(is_same_adjacency(adjacency, cpu_adjacency));
+
+		ecg::cleanup(adjacency);
+		ecg::cleanup(cpu_adjacency);
+	}
+
+	// The uploaded mesh keeps its adjacency until the geometry is replaced
+	ecg::ecg_mesh_t& default_cube = mesh_inst.loaded_meshes_by_name["default_cube.obj"]->mesh;
+	ecg::ecg_uploaded_mesh_t uploaded = ecg::upload_mesh(&default_cube, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+
+	adjacency = ecg::build_adjacency(uploaded, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ecg::ecg_adjacency_t cached_adjacency = ecg::build_adjacency(uploaded, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ASSERT_TRUE(is_same_adjacency(adjacency, cached_adjacency));
+	ASSERT_EQ(adjacency.face_faces.ids.arr_size, default_cube.indexes_size);
+	ecg::cleanup(adjacency);
+	ecg::cleanup(cached_adjacency);
+
+	ecg::update_uploaded_mesh(&uploaded, &tetrahedron, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	adjacency = ecg::build_adjacency(uploaded, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ASSERT_EQ(adjacency.vertex_faces.offsets.arr_size, 5);
+	ASSERT_EQ(adjacency.vertex_vertexes.ids.arr_size, 12);
+
+	ecg::cleanup(adjacency);
+	ecg::cleanup(uploaded.handler);
+}
+
 TEST(ecg_api, is_mesh_self_intersected) {
 	auto invalid_method = ecg::self_intersection_method::SI_METHODS_COUNT;
 	auto method = ecg::self_intersection_method::SI_BRUTEFORCE;
@@ -556,6 +974,93 @@ TEST(ecg_api, is_mesh_self_intersected) {
 	ASSERT_TRUE(result);
 }
 
+TEST(ecg_api, find_self_intersections) {
+	auto& mesh_inst = ecg_meshes::get_instance();
+	ecg::ecg_status status;
+
+	ecg::ecg_array_t pairs = ecg::find_self_intersections(nullptr, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::INVALID_ARG);
+	ASSERT_EQ(pairs.arr_ptr, nullptr);
+
+	// The second face pierces the first one, the third is far away and the fourth shares an edge with the first
+	std::vector<ecg::vec3_base> vertexes = {
+		ecg::vec3_base(0.0f, 0.0f, 0.0f), ecg::vec3_base(2.0f, 0.0f, 0.0f), ecg::vec3_base(0.0f, 2.0f, 0.0f),
+		ecg::vec3_base(0.5f, 0.5f, -1.0f), ecg::vec3_base(0.5f, 0.5f, 1.0f), ecg::vec3_base(1.0f, 0.2f, 1.0f),
+		ecg::vec3_base(10.0f, 10.0f, 10.0f), ecg::vec3_base(11.0f, 10.0f, 10.0f), ecg::vec3_base(10.0f, 11.0f, 10.0f),
+		ecg::vec3_base(1.0f, -1.0f, 1.0f)
+	};
+	std::vector<uint32_t> indexes = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 1, 0, 9 };
+	ecg::ecg_mesh_t crossed_mesh;
+	crossed_mesh.vertexes = vertexes.data();
+	crossed_mesh.vertexes_size = static_cast<uint32_t>(vertexes.size());
+	crossed_mesh.indexes = indexes.data();
+	crossed_mesh.indexes_size = static_cast<uint32_t>(indexes.size());
+
+	pairs = ecg::find_self_intersections(&crossed_mesh, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ASSERT_EQ(pairs.arr_size, 2);
+	ASSERT_EQ(static_cast<const uint32_t*>(pairs.arr_ptr)[0], 0);
+	ASSERT_EQ(static_cast<const uint32_t*>(pairs.arr_ptr)[1], 1);
+	ASSERT_TRUE(ecg::is_mesh_self_intersected(&crossed_mesh, ecg::SI_BVH, &status));
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ecg::cleanup(pairs.handler);
+
+	// Without the piercing face only touching faces are left
+	indexes = { 0, 1, 2, 6, 7, 8, 1, 0, 9 };
+	crossed_mesh.indexes_size = static_cast<uint32_t>(indexes.size());
+	ASSERT_FALSE(ecg::is_mesh_self_intersected(&crossed_mesh, ecg::SI_BVH, &status));
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	pairs = ecg::find_self_intersections(&crossed_mesh, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ASSERT_EQ(pairs.arr_ptr, nullptr);
+
+	ecg::ecg_mesh_t& surface_1_non_manifold = mesh_inst.loaded_meshes_by_name["surface_1.obj"]->mesh;
+	ecg::ecg_mesh_t& not_self_intersected = mesh_inst.loaded_meshes_by_name["is_closed_mesh-true.obj"]->mesh;
+	ecg::ecg_mesh_t& self_intersected_1 = mesh_inst.loaded_meshes_by_name["self_intersected_mesh_1.obj"]->mesh;
+	ecg::ecg_mesh_t& self_intersected_2 = mesh_inst.loaded_meshes_by_name["self_intersected_mesh_2.obj"]->mesh;
+	ASSERT_FALSE(ecg::is_mesh_self_intersected(&surface_1_non_manifold, ecg::SI_BVH, &status));
+	ASSERT_FALSE(ecg::is_mesh_self_intersected(&not_self_intersected, ecg::SI_BVH, &status));
+	ASSERT_TRUE(ecg::is_mesh_self_intersected(&self_intersected_1, ecg::SI_BVH, &status));
+	ASSERT_TRUE(ecg::is_mesh_self_intersected(&self_intersected_2, ecg::SI_BVH, &status));
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+
+	// The tree only skips faces with disjoint boxes, so the pairs match the host check of all pairs
+	constexpr size_t max_vertexes_cnt = 1024;
+	for (auto& item : mesh_inst.loaded_meshes) {
+		auto& mesh = item->mesh;
+		if (mesh.vertexes_size > max_vertexes_cnt) continue;
+
+		pairs = ecg::find_self_intersections(&mesh, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		bool is_self_intersected = ecg::is_mesh_self_intersected(&mesh, ecg::SI_BVH, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_EQ(is_self_intersected, pairs.arr_size != 0);
+
+		ecg::set_backend(ecg::ECG_BACKEND_CPU);
+		ecg::ecg_array_t cpu_pairs = ecg::find_self_intersections(&mesh, &status);
+		ecg::set_backend(ecg::ECG_BACKEND_AUTO);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+
+		ASSERT_EQ(pairs.arr_size, cpu_pairs.arr_size);
+		if (pairs.arr_size != 0) {
+			ASSERT_EQ(std::memcmp(pairs.arr_ptr, cpu_pairs.arr_ptr, sizeof(uint32_t) * pairs.arr_size), 0);
+		}
+
+		ecg::cleanup(pairs.handler);
+		ecg::cleanup(cpu_pairs.handler);
+	}
+
+	ecg::ecg_mesh_t& default_cube = mesh_inst.loaded_meshes_by_name["default_cube.obj"]->mesh;
+	ecg::ecg_uploaded_mesh_t uploaded = ecg::upload_mesh(&default_cube, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	pairs = ecg::find_self_intersections(uploaded, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ASSERT_EQ(pairs.arr_ptr, nullptr);
+	ASSERT_FALSE(ecg::is_mesh_self_intersected(uploaded, ecg::SI_BVH, &status));
+
+	ecg::cleanup(uploaded.handler);
+}
+
 TEST(ecg_api, triangulate_mesh) {
 	ecg::ecg_status status;
 	ecg::ecg_array_t res;
@@ -758,54 +1263,1381 @@ TEST(ecg_api, compute_vertex_normals) {
 	ASSERT_TRUE(res.arr_size > 0);
 }
 
-namespace ecg_intersection {
-	TEST(ecg_api, compute_intersection) {
-		auto& mesh_inst = ecg_meshes::get_instance();
-		ecg::ecg_mesh_t cube_int_1 = mesh_inst.loaded_meshes_by_name["cube_int_1.obj"]->mesh;
-		ecg::ecg_mesh_t cube_int_2 = mesh_inst.loaded_meshes_by_name["cube_int_2.obj"]->mesh;
+TEST(ecg_api, upload_mesh) {
+	ecg::ecg_uploaded_mesh_t uploaded;
+	ecg::ecg_status status;
+	custom_timer_t timer;
+	ecg::ecg_mesh_t mesh;
 
-		ecg::ecg_status status = ecg::ecg_status_code::SUCCESS;
-		custom_timer_t timer;
+	timer.start();
+	uploaded = ecg::upload_mesh(nullptr, &status);
+	timer.end();
+
+	ASSERT_EQ(status, ecg::ecg_status_code::INVALID_ARG);
+	ASSERT_EQ(uploaded.handler, 0);
+
+	timer.start();
+	uploaded = ecg::upload_mesh(&mesh, &status);
+	timer.end();
+
+	ASSERT_EQ(status, ecg::ecg_status_code::EMPTY_VERTEX_ARR);
+	ASSERT_EQ(uploaded.handler, 0);
+
+	timer.start();
+	ecg::get_center(uploaded, &status);
+	timer.end();
+
+	ASSERT_EQ(status, ecg::ecg_status_code::INVALID_ARG);
+
+	// Handles of other allocations can't be used as uploaded meshes
+	ecg::ecg_array_t array = ecg::triangulate_mesh(&ecg_meshes::get_instance().loaded_meshes_by_name["default_cube.obj"]->mesh, 3, &status);
+	uploaded.handler = array.handler;
+	ecg::hulls::compute_aabb(uploaded, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::INVALID_ARG);
+	ecg::cleanup(array.handler);
+
+	auto& mesh_inst = ecg_meshes::get_instance();
+	for (size_t mesh_id = 0; mesh_id < mesh_inst.loaded_meshes.size(); ++mesh_id) {
+		auto item = mesh_inst.loaded_meshes[mesh_id];
 
 		timer.start();
-		ecg::ecg_internal_mesh_t res = ecg::compute_intersection(&cube_int_1, &cube_int_2, &status);
+		uploaded = ecg::upload_mesh(&item->mesh, &status);
 		timer.end();
 
-		ASSERT_TRUE(res.vertexes.arr_ptr != nullptr);
-		ASSERT_TRUE(res.vertexes.arr_size != 0);
-		ASSERT_TRUE(res.vertexes.handler != 0);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_NE(uploaded.handler, 0);
+		ASSERT_EQ(uploaded.vertexes_size, item->mesh.vertexes_size);
+		ASSERT_EQ(uploaded.indexes_size, item->mesh.indexes_size);
 
-		ecg::cleanup(res.vertexes.handler);
-		ecg::cleanup(res.indexes.handler);
+		ecg::bounding_box aabb = ecg::hulls::compute_aabb(&item->mesh, &status);
+		ecg::bounding_box uploaded_aabb = ecg::hulls::compute_aabb(uploaded, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_TRUE(ecg::compare_bounding_boxes(aabb, uploaded_aabb));
+
+		ecg::vec3_base center = ecg::get_center(&item->mesh, &status);
+		ecg::vec3_base uploaded_center = ecg::get_center(uploaded, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_TRUE(ecg::compare_vec3_base(center, uploaded_center, 1e-3f));
+
+		float area = ecg::compute_surface_area(&item->mesh, &status);
+		float uploaded_area = ecg::compute_surface_area(uploaded, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_NEAR(area, uploaded_area, std::abs(area) * 1e-4f);
+
+		bool is_closed = ecg::is_mesh_closed(&item->mesh, &status);
+		bool uploaded_is_closed = ecg::is_mesh_closed(uploaded, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_EQ(is_closed, uploaded_is_closed);
+
+		ecg::ecg_array_t normals = ecg::compute_faces_normals(uploaded, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_EQ(normals.arr_size, item->mesh.indexes_size / 3);
+		ecg::cleanup(normals.handler);
+
+		ecg::cleanup(uploaded.handler);
+		ecg::get_center(uploaded, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::INVALID_ARG);
 	}
-}
 
-namespace ecg_simplifiation {
-	TEST(ecg_api, convex_hull) {
-		auto& mesh_inst = ecg_meshes::get_instance();
-		ecg::ecg_mesh_t convex_hull_1 = mesh_inst.loaded_meshes_by_name["convex_hull_1.obj"]->mesh;
-		
-		ecg::ecg_status status = ecg::ecg_status_code::SUCCESS;
-		custom_timer_t timer;
+	// Updated geometry is used by the next queries on the same handle
+	ecg::ecg_mesh_t& default_cube = mesh_inst.loaded_meshes_by_name["default_cube.obj"]->mesh;
+	std::vector<ecg::vec3_base> moved_vertexes(default_cube.vertexes, default_cube.vertexes + default_cube.vertexes_size);
+	for (auto& vertex : moved_vertexes) vertex.x += 10.0f;
 
-		ecg::ecg_array_t vertexes;
-		vertexes.arr_ptr = convex_hull_1.vertexes;
-		vertexes.arr_size = convex_hull_1.vertexes_size;
+	ecg::ecg_mesh_t moved_cube = default_cube;
+	moved_cube.vertexes = moved_vertexes.data();
 
-		timer.start();
-		auto convex_hull = ecg::hulls::create_convex_hull(vertexes, &status);
-		timer.end();
+	uploaded = ecg::upload_mesh(&default_cube, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	uint64_t handler = uploaded.handler;
 
-		ecg::ecg_mesh_t mesh;
-		mesh.vertexes = static_cast<ecg::vec3_base*>(convex_hull.vertexes.arr_ptr);
-		mesh.indexes = static_cast<uint32_t*>(convex_hull.indexes.arr_ptr);
-		mesh.vertexes_size = convex_hull.vertexes.arr_size;
-		mesh.indexes_size = convex_hull.indexes.arr_size;
+	timer.start();
+	ecg::update_uploaded_mesh(&uploaded, &moved_cube, &status);
+	timer.end();
 
-		ecg::save_mesh(&mesh, "Models/res_convex_hull_1", ecg::ecg_file_type::ECG_OBJ_FILE, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ASSERT_EQ(uploaded.handler, handler);
+
+	ecg::bounding_box moved_aabb = ecg::hulls::compute_aabb(&moved_cube, &status);
+	ecg::bounding_box updated_aabb = ecg::hulls::compute_aabb(uploaded, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ASSERT_TRUE(ecg::compare_bounding_boxes(moved_aabb, updated_aabb));
+
+	ecg::update_uploaded_mesh(nullptr, &moved_cube, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::INVALID_ARG);
+
+	ecg::cleanup(uploaded.handler);
+}
+
+TEST(ecg_api, kernel_call_overhead) {
+	ecg::ecg_cl& host_ctrl = ecg::ecg_cl::get_instance();
+	auto& queue = host_ctrl.get_cmd_queue();
+	auto& context = host_ctrl.get_context();
+	auto& device = host_ctrl.get_device();
+
+	const std::string kernel_name = "add_value";
+	cl::Program::Sources sources = {
+		"__kernel void add_value(__global int* data, int value) { data[get_global_id(0)] += value; }"
+	};
+	auto program = ecg::ecg_program_wrapper::get_program(context, device, sources, "test_add_value");
+	ASSERT_TRUE(program->is_program_was_built());
+
+	constexpr cl_int items_cnt = 64;
+	constexpr cl_int calls_cnt = 1000;
+	const cl_int value = 1;
+
+	cl::NDRange global = items_cnt;
+	cl::NDRange local = cl::NullRange;
+	cl::Buffer data_buffer = cl::Buffer(context, CL_MEM_READ_WRITE, sizeof(cl_int) * items_cnt);
+	ASSERT_EQ(queue.enqueueFillBuffer(data_buffer, cl_int(0), 0, sizeof(cl_int) * items_cnt), CL_SUCCESS);
+	ASSERT_EQ(queue.finish(), CL_SUCCESS);
+
+	// Kernel object per call with a sync after every launch
+	auto start = std::chrono::high_resolution_clock::now();
+	for (cl_int call = 0; call < calls_cnt; ++call) {
+		cl::Kernel kernel(program->get_program(), kernel_name.c_str());
+		kernel.setArg(0, data_buffer);
+		kernel.setArg(1, value);
+		ASSERT_EQ(queue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local), CL_SUCCESS);
+		queue.finish();
+	}
+	auto uncached_time = std::chrono::high_resolution_clock::now() - start;
+
+	// Cached bound kernel, launches are ordered by their events without sync between them
+	ecg::ecg_cmd_chain chain(queue);
+	start = std::chrono::high_resolution_clock::now();
+	for (cl_int call = 0; call < calls_cnt; ++call) {
+		ASSERT_EQ(program->execute(chain, kernel_name, global, local, data_buffer, value), CL_SUCCESS);
 	}
+	ASSERT_EQ(chain.wait(), CL_SUCCESS);
+	auto cached_time = std::chrono::high_resolution_clock::now() - start;
+
+	std::vector<cl_int> result(items_cnt);
+	ASSERT_EQ(queue.enqueueReadBuffer(data_buffer, CL_TRUE, 0, sizeof(cl_int) * items_cnt, result.data()), CL_SUCCESS);
+	for (auto item : result) ASSERT_EQ(item, 2 * calls_cnt * value);
 
-	//TEST(ecg_api, qem_simplification) {
-	//	// TODO: implement tests and function
-	//}
+	auto per_call = [&](auto time) {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(time).count() / 1000.0 / calls_cnt;
+	};
+
+	std::cout << "Kernel call overhead (us/call): uncached = " << per_call(uncached_time)
+		<< ", cached = " << per_call(cached_time) << std::endl;
+
+	ASSERT_EQ(program->get_kernel("missing_kernel"), nullptr);
+}
+
+TEST(ecg_api, program_binary_cache) {
+	ecg::ecg_cl& host_ctrl = ecg::ecg_cl::get_instance();
+	auto& queue = host_ctrl.get_cmd_queue();
+	auto& context = host_ctrl.get_context();
+	auto& device = host_ctrl.get_device();
+	ecg::ecg_status status;
+
+	auto cache_dir = std::filesystem::temp_directory_path() / "ecg_program_cache_test";
+	std::filesystem::remove_all(cache_dir);
+	ecg::set_program_cache_dir(cache_dir.string().c_str());
+
+	cl::Program::Sources sources = {
+		"__kernel void fill_value(__global int* data, int value) { data[get_global_id(0)] = value; }"
+	};
+
+	// The first build compiles from sources and stores the binary
+	auto compiled = std::make_shared<ecg::ecg_program_wrapper>(context, device, sources);
+	ASSERT_TRUE(compiled->is_program_was_built());
+	ASSERT_FALSE(compiled->is_program_loaded_from_cache());
+	ASSERT_FALSE(std::filesystem::is_empty(cache_dir));
+
+	// The second build of the same sources is loaded from disk and still runs
+	auto loaded = std::make_shared<ecg::ecg_program_wrapper>(context, device, sources);
+	ASSERT_TRUE(loaded->is_program_was_built());
+	ASSERT_TRUE(loaded->is_program_loaded_from_cache());
+
+	constexpr cl_int items_cnt = 16;
+	const cl_int value = 7;
+	cl::NDRange global = items_cnt;
+	cl::NDRange local = cl::NullRange;
+	cl::Buffer data_buffer = cl::Buffer(context, CL_MEM_READ_WRITE, sizeof(cl_int) * items_cnt);
+	ecg::ecg_cmd_chain chain(queue);
+	ASSERT_EQ(loaded->execute(chain, "fill_value", global, local, data_buffer, value), CL_SUCCESS);
+
+	std::vector<cl_int> result(items_cnt);
+	ASSERT_EQ(chain.read_buffer(data_buffer, 0, sizeof(cl_int) * items_cnt, result.data()), CL_SUCCESS);
+	ASSERT_EQ(chain.wait(), CL_SUCCESS);
+	for (auto item : result) ASSERT_EQ(item, value);
+
+	// A corrupted binary falls back to a source build
+	for (const auto& entry : std::filesystem::directory_iterator(cache_dir)) {
+		std::ofstream file(entry.path(), std::ios::binary | std::ios::trunc);
+		file << "broken";
+	}
+
+	auto rebuilt = std::make_shared<ecg::ecg_program_wrapper>(context, device, sources);
+	ASSERT_TRUE(rebuilt->is_program_was_built());
+	ASSERT_FALSE(rebuilt->is_program_loaded_from_cache());
+
+	ecg::prewarm_all_programs(&status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+
+	ecg::set_program_cache_dir(nullptr);
+	std::filesystem::remove_all(cache_dir);
+}
+
+TEST(ecg_api, kernel_autotuning) {
+	ecg::ecg_cl& host_ctrl = ecg::ecg_cl::get_instance();
+	auto& device = host_ctrl.get_device();
+	auto& tuner = ecg::ecg_kernel_tuner::get_instance();
+	ecg::ecg_status status;
+
+	// The smallest mesh with several candidate sizes keeps the timed launches short
+	constexpr size_t min_vertexes_cnt = 1024;
+	const ecg::ecg_mesh_t* mesh = nullptr;
+	for (auto& item : ecg_meshes::get_instance().loaded_meshes) {
+		if (item->mesh.vertexes_size < min_vertexes_cnt) continue;
+		if (mesh == nullptr || item->mesh.vertexes_size < mesh->vertexes_size) mesh = &item->mesh;
+	}
+	ASSERT_NE(mesh, nullptr);
+	const size_t faces_cnt = mesh->indexes_size / 3;
+
+	ecg::set_autotuning(false);
+	ASSERT_FALSE(ecg::is_autotuning());
+	ASSERT_EQ(tuner.get_launch(device, cl::Kernel(), "compute_faces_normals", faces_cnt).local_size, 0);
+
+	ecg::bounding_box expected_bb = ecg::hulls::compute_aabb(mesh, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	float expected_area = ecg::compute_surface_area(mesh, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ecg::vec3_base expected_sum = ecg::sum_vertexes(mesh, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+
+	ASSERT_FALSE(ecg::ecg_kernel_tuner::is_range_checked("add_value"));
+	ASSERT_TRUE(ecg::ecg_kernel_tuner::is_range_checked("compute_faces_normals"));
+	ASSERT_EQ(ecg::ecg_kernel_tuner::get_size_class(0), 1);
+	ASSERT_EQ(ecg::ecg_kernel_tuner::get_size_class(1000), 1024);
+
+	auto profile_path = std::filesystem::temp_directory_path() / "ecg_tuning_profile_test.txt";
+	std::filesystem::remove(profile_path);
+
+	tuner.reset();
+	ecg::set_autotuning(true);
+	ecg::set_tuning_profile(profile_path.string().c_str());
+	ASSERT_TRUE(ecg::is_autotuning());
+	ASSERT_EQ(tuner.get_tuned_local_size(device, "compute_faces_normals", faces_cnt), 0);
+
+	// Results don't depend on the local size, while candidates are timed and after the choice
+	constexpr size_t calls_cnt = 32;
+	for (size_t call = 0; call < calls_cnt; ++call) {
+		ecg::bounding_box bb = ecg::hulls::compute_aabb(mesh, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_TRUE(ecg::compare_bounding_boxes(bb, expected_bb));
+
+		float area = ecg::compute_surface_area(mesh, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_NEAR(area, expected_area, std::abs(expected_area) * 1e-4f);
+
+		ecg::vec3_base sum = ecg::sum_vertexes(mesh, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_TRUE(ecg::compare_vec3_base(sum, expected_sum, 1e-2f));
+
+		ecg::ecg_array_t normals = ecg::compute_faces_normals(mesh, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ecg::cleanup(normals.handler);
+	}
+
+	const size_t max_work_group_size = device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>();
+	const size_t tuned_size = tuner.get_tuned_local_size(device, "compute_faces_normals", faces_cnt);
+	ASSERT_GT(tuned_size, 0);
+	ASSERT_LE(tuned_size, max_work_group_size);
+
+	// The local accumulator of summ_vertexes limits its candidates to power of two sizes it can hold
+	const size_t tuned_sum_size = tuner.get_tuned_local_size(device, "summ_vertexes", mesh->vertexes_size);
+	ASSERT_GT(tuned_sum_size, 0);
+	ASSERT_TRUE(std::has_single_bit(tuned_sum_size));
+	ASSERT_LE(tuned_sum_size, 256);
+
+	// A new run starts with the stored sizes
+	ASSERT_TRUE(std::filesystem::exists(profile_path));
+	tuner.reset();
+	ASSERT_EQ(tuner.get_tuned_local_size(device, "compute_faces_normals", faces_cnt), 0);
+	ecg::set_tuning_profile(profile_path.string().c_str());
+	ASSERT_EQ(tuner.get_tuned_local_size(device, "compute_faces_normals", faces_cnt), tuned_size);
+
+	ecg::bounding_box bb = ecg::hulls::compute_aabb(mesh, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ASSERT_TRUE(ecg::compare_bounding_boxes(bb, expected_bb));
+
+	ecg::set_tuning_profile(nullptr);
+	std::filesystem::remove(profile_path);
+}
+
+TEST(ecg_api, profiling) {
+	ecg::ecg_status status;
+
+	const ecg::ecg_mesh_t* mesh = nullptr;
+	for (auto& item : ecg_meshes::get_instance().loaded_meshes)
+		if (mesh == nullptr || item->mesh.vertexes_size < mesh->vertexes_size) mesh = &item->mesh;
+	ASSERT_NE(mesh, nullptr);
+
+	ecg::set_profiling(true);
+	ecg::clear_profiling();
+	ASSERT_TRUE(ecg::is_profiling());
+	ASSERT_EQ(ecg::get_profiling_stats().calls, 0);
+
+	ecg::hulls::compute_aabb(mesh, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ecg::compute_surface_area(mesh, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+
+	auto stats = ecg::get_profiling_stats();
+	ASSERT_EQ(stats.calls, 2);
+	ASSERT_GT(stats.kernels, 0);
+	ASSERT_GT(stats.transfers, 0);
+	ASSERT_GT(stats.host_to_device_bytes, 0);
+	ASSERT_GT(stats.device_to_host_bytes, 0);
+	ASSERT_GT(stats.host_time_ns, 0);
+
+	auto aabb_stats = ecg::get_profiling_stats("hulls::compute_aabb");
+	ASSERT_EQ(aabb_stats.calls, 1);
+	ASSERT_GT(aabb_stats.kernels, 0);
+	ASSERT_EQ(ecg::get_profiling_stats("unknown_call").calls, 0);
+
+	auto trace_path = std::filesystem::temp_directory_path() / "ecg_profiling_test.json";
+	ecg::save_profiling_trace(trace_path.string().c_str(), &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+
+	{
+		std::ifstream file(trace_path);
+		std::stringstream trace;
+		trace << file.rdbuf();
+		ASSERT_NE(trace.str().find("traceEvents"), std::string::npos);
+		ASSERT_NE(trace.str().find("compute_aabb"), std::string::npos);
+		ASSERT_NE(trace.str().find("\"kernel\""), std::string::npos);
+	}
+
+	ecg::save_profiling_trace(nullptr, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::INVALID_ARG);
+	ecg::log_profiling_stats();
+
+	// Disabled profiling keeps the recorded data and adds nothing
+	ecg::set_profiling(false);
+	ecg::hulls::compute_aabb(mesh, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ASSERT_EQ(ecg::get_profiling_stats().calls, 2);
+
+	ecg::clear_profiling();
+	ASSERT_EQ(ecg::get_profiling_stats().calls, 0);
+	std::filesystem::remove(trace_path);
+}
+
+TEST(ecg_api, async_api) {
+	ecg::ecg_status status;
+	auto& mesh_inst = ecg_meshes::get_instance();
+
+	// Invalid input is reported through the future and fails its event
+	auto invalid = ecg::async::get_center(nullptr);
+	ecg::vec3_base invalid_center = invalid.get(&status);
+	ASSERT_EQ(status, ecg::ecg_status_code::INVALID_ARG);
+	ASSERT_TRUE(ecg::compare_vec3_base(invalid_center, ecg::vec3_base()));
+	ASSERT_LT(invalid.get_event().getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>(), 0);
+
+	ecg::async::ecg_future<float> empty;
+	ASSERT_FALSE(empty.is_valid());
+	empty.get(&status);
+	ASSERT_EQ(status, ecg::ecg_status_code::RUNTIME_ERROR);
+
+	// Upload everything first, then keep several independent calls in flight
+	std::vector<ecg::async::ecg_future<ecg::ecg_uploaded_mesh_t>> uploads;
+	for (auto& item : mesh_inst.loaded_meshes) uploads.push_back(ecg::async::upload_mesh(&item->mesh));
+
+	std::vector<ecg::ecg_uploaded_mesh_t> uploaded;
+	for (auto& upload : uploads) {
+		uploaded.push_back(upload.get(&status));
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	}
+
+	std::vector<ecg::async::ecg_future<ecg::bounding_box>> aabbs;
+	std::vector<ecg::async::ecg_future<ecg::vec3_base>> centers;
+	std::vector<ecg::async::ecg_future<float>> areas;
+	for (size_t mesh_id = 0; mesh_id < uploaded.size(); ++mesh_id) {
+		aabbs.push_back(ecg::async::hulls::compute_aabb(uploaded[mesh_id]));
+		centers.push_back(ecg::async::get_center(uploaded[mesh_id]));
+		// The area waits for the aabb commands through the wait list, not on the host
+		areas.push_back(ecg::async::compute_surface_area(&mesh_inst.loaded_meshes[mesh_id]->mesh, { aabbs.back().get_event() }));
+	}
+
+	// A failed dependency fails both the enqueued calls and the ones running on the host pool
+	auto failed_area = ecg::async::compute_surface_area(uploaded[0], { invalid.get_event() });
+	failed_area.get(&status);
+	ASSERT_NE(status, ecg::ecg_status_code::SUCCESS);
+	ASSERT_LT(failed_area.get_event().getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>(), 0);
+
+	auto failed_volume = ecg::async::compute_volume(uploaded[0], { invalid.get_event() });
+	failed_volume.get(&status);
+	ASSERT_NE(status, ecg::ecg_status_code::SUCCESS);
+
+	for (size_t mesh_id = 0; mesh_id < uploaded.size(); ++mesh_id) {
+		auto& mesh = mesh_inst.loaded_meshes[mesh_id]->mesh;
+
+		ecg::bounding_box aabb = aabbs[mesh_id].get(&status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_TRUE(ecg::compare_bounding_boxes(aabb, ecg::hulls::compute_aabb(&mesh)));
+		ASSERT_EQ(aabbs[mesh_id].get_event().getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>(), CL_COMPLETE);
+
+		ecg::vec3_base center = centers[mesh_id].get(&status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_TRUE(ecg::compare_vec3_base(center, ecg::get_center(&mesh), 1e-3f));
+
+		float area = areas[mesh_id].get(&status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		float expected_area = ecg::compute_surface_area(&mesh);
+		ASSERT_NEAR(area, expected_area, std::abs(expected_area) * 1e-4f);
+
+		ecg::cleanup(uploaded[mesh_id].handler);
+	}
+}
+
+TEST(ecg_api, multi_device) {
+	auto& multi_ctrl = ecg::ecg_multi_cl::get_instance();
+	auto& mesh_inst = ecg_meshes::get_instance();
+	ecg::ecg_status status;
+
+	ecg::multi::release();
+	ecg::multi::compute_surface_area(&mesh_inst.loaded_meshes[0]->mesh, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::RUNTIME_ERROR);
+
+	ecg::multi::init(nullptr, 0, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ASSERT_EQ(ecg::multi::get_devices_count(), ecg::ecg_cl::get_available_devices().size());
+
+	// Small granularity, so even the test meshes are split between all devices
+	size_t granularity = multi_ctrl.get_granularity();
+	multi_ctrl.set_granularity(4);
+
+	auto parts = multi_ctrl.split(1000);
+	size_t next_offset = 0;
+	for (auto& part : parts) {
+		ASSERT_EQ(part.offset, next_offset);
+		next_offset += part.size;
+	}
+	ASSERT_EQ(next_offset, 1000);
+	ASSERT_EQ(parts.size(), ecg::multi::get_devices_count());
+
+	for (auto& item : mesh_inst.loaded_meshes) {
+		auto& mesh = item->mesh;
+		ecg::ecg_status expected_status;
+
+		float expected_area = ecg::compute_surface_area(&mesh, &expected_status);
+		float area = ecg::multi::compute_surface_area(&mesh, &status);
+		ASSERT_EQ(status, expected_status);
+		if (expected_status != ecg::ecg_status_code::SUCCESS) continue;
+		ASSERT_NEAR(area, expected_area, std::abs(expected_area) * 1e-4f);
+
+		ecg::bounding_box aabb = ecg::multi::hulls::compute_aabb(&mesh, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_TRUE(ecg::compare_bounding_boxes(aabb, ecg::hulls::compute_aabb(&mesh)));
+
+		ecg::ecg_array_t normals = ecg::multi::compute_faces_normals(&mesh, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ecg::ecg_array_t expected_normals = ecg::compute_faces_normals(&mesh);
+		ASSERT_EQ(normals.arr_size, expected_normals.arr_size);
+
+		auto normals_ptr = static_cast<ecg::vec3_base*>(normals.arr_ptr);
+		auto expected_normals_ptr = static_cast<ecg::vec3_base*>(expected_normals.arr_ptr);
+		for (size_t id = 0; id < normals.arr_size; ++id)
+			ASSERT_TRUE(ecg::compare_vec3_base(normals_ptr[id], expected_normals_ptr[id], 1e-4f));
+
+		ecg::cleanup(normals.handler);
+		ecg::cleanup(expected_normals.handler);
+	}
+
+	auto& self_intersected = mesh_inst.loaded_meshes_by_name["self_intersected_mesh_1.obj"]->mesh;
+	ASSERT_TRUE(ecg::multi::is_mesh_self_intersected(&self_intersected, ecg::self_intersection_method::SI_BRUTEFORCE, &status));
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+
+	auto& default_cube = mesh_inst.loaded_meshes_by_name["default_cube.obj"]->mesh;
+	ASSERT_FALSE(ecg::multi::is_mesh_self_intersected(&default_cube, ecg::self_intersection_method::SI_BRUTEFORCE, &status));
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+
+	ecg::ecg_mesh_t cube_int_1 = mesh_inst.loaded_meshes_by_name["cube_int_1.obj"]->mesh;
+	ecg::ecg_mesh_t cube_int_2 = mesh_inst.loaded_meshes_by_name["cube_int_2.obj"]->mesh;
+	ecg::ecg_internal_mesh_t intersection = ecg::multi::compute_intersection(&cube_int_1, &cube_int_2, &status);
+	ecg::ecg_internal_mesh_t expected_intersection = ecg::compute_intersection(&cube_int_1, &cube_int_2);
+	ASSERT_NE(intersection.vertexes.handler, 0);
+	ASSERT_EQ(intersection.vertexes.arr_size, expected_intersection.vertexes.arr_size);
+	ASSERT_EQ(intersection.indexes.arr_size, expected_intersection.indexes.arr_size);
+
+	ecg::cleanup(intersection.vertexes.handler);
+	ecg::cleanup(intersection.indexes.handler);
+	ecg::cleanup(expected_intersection.vertexes.handler);
+	ecg::cleanup(expected_intersection.indexes.handler);
+
+	// Every device took part, so the next split is weighted by the measured throughput
+	for (auto& device : multi_ctrl.get_devices()) ASSERT_GT(device->throughput, 0.0);
+
+	multi_ctrl.set_granularity(granularity);
+	ecg::multi::release();
+}
+
+TEST(ecg_api, batch_api) {
+	auto& mesh_inst = ecg_meshes::get_instance();
+	ecg::ecg_status status;
+
+	ecg::batch::compute_surface_area(nullptr, 0, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::INVALID_ARG);
+
+	// Every small valid mesh several times, so the batch has meshes of different sizes next to each other
+	constexpr size_t max_vertexes_cnt = 1024;
+	std::vector<ecg::ecg_mesh_t> meshes;
+	for (size_t copy = 0; copy < 3; ++copy) {
+		for (auto& item : mesh_inst.loaded_meshes) {
+			if (item->mesh.vertexes_size > max_vertexes_cnt) continue;
+			ecg::compute_surface_area(&item->mesh, &status);
+			if (status == ecg::ecg_status_code::SUCCESS) meshes.push_back(item->mesh);
+		}
+	}
+	ASSERT_FALSE(meshes.empty());
+
+	for (ecg::ecg_backend backend : { ecg::ECG_BACKEND_OPENCL, ecg::ECG_BACKEND_CPU }) {
+		ecg::set_backend(backend);
+
+		ecg::ecg_array_t areas = ecg::batch::compute_surface_area(meshes.data(), meshes.size(), &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_EQ(areas.arr_size, meshes.size());
+
+		// Areas are reduced without atomics, so a second run gives the same bits
+		ecg::ecg_array_t repeated_areas = ecg::batch::compute_surface_area(meshes.data(), meshes.size(), &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_EQ(std::memcmp(areas.arr_ptr, repeated_areas.arr_ptr, sizeof(float) * meshes.size()), 0);
+		ecg::cleanup(repeated_areas.handler);
+
+		ecg::ecg_array_t volumes = ecg::batch::compute_volume(meshes.data(), meshes.size(), &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_EQ(volumes.arr_size, meshes.size());
+
+		ecg::ecg_array_t boxes = ecg::batch::hulls::compute_aabb(meshes.data(), meshes.size(), &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_EQ(boxes.arr_size, meshes.size());
+
+		ecg::ecg_array_t normals = ecg::batch::compute_faces_normals(meshes.data(), meshes.size(), &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+
+		size_t face_offset = 0;
+		for (size_t mesh_id = 0; mesh_id < meshes.size(); ++mesh_id) {
+			auto& mesh = meshes[mesh_id];
+
+			float expected_area = ecg::compute_surface_area(&mesh);
+			ASSERT_NEAR(static_cast<float*>(areas.arr_ptr)[mesh_id], expected_area, std::abs(expected_area) * 1e-4f);
+
+			// Volumes of the batch aren't checked for manifoldness
+			float expected_volume = ecg::compute_volume(&mesh, &status);
+			if (status == ecg::ecg_status_code::SUCCESS) {
+				ASSERT_NEAR(static_cast<float*>(volumes.arr_ptr)[mesh_id], expected_volume, std::max(std::abs(expected_volume) * 1e-3f, 1e-4f));
+			}
+
+			ecg::bounding_box expected_bb = ecg::hulls::compute_aabb(&mesh);
+			ASSERT_TRUE(ecg::compare_bounding_boxes(static_cast<ecg::bounding_box*>(boxes.arr_ptr)[mesh_id], expected_bb));
+
+			ecg::ecg_array_t expected_normals = ecg::compute_faces_normals(&mesh);
+			auto normals_ptr = static_cast<ecg::vec3_base*>(normals.arr_ptr) + face_offset;
+			auto expected_normals_ptr = static_cast<ecg::vec3_base*>(expected_normals.arr_ptr);
+			for (size_t id = 0; id < expected_normals.arr_size; ++id)
+				ASSERT_TRUE(ecg::compare_vec3_base(normals_ptr[id], expected_normals_ptr[id], 1e-4f));
+
+			face_offset += expected_normals.arr_size;
+			ecg::cleanup(expected_normals.handler);
+		}
+		ASSERT_EQ(normals.arr_size, face_offset);
+
+		ecg::cleanup(areas.handler);
+		ecg::cleanup(volumes.handler);
+		ecg::cleanup(boxes.handler);
+		ecg::cleanup(normals.handler);
+
+		// One invalid mesh fails the whole batch with its status
+		std::vector<ecg::ecg_mesh_t> invalid_batch = meshes;
+		invalid_batch.push_back(meshes.front());
+		invalid_batch.back().indexes_size -= 1;
+		ecg::ecg_array_t invalid = ecg::batch::compute_surface_area(invalid_batch.data(), invalid_batch.size(), &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::NOT_TRIANGULATED_MESH);
+		ASSERT_EQ(invalid.arr_ptr, nullptr);
+	}
+
+	ecg::set_backend(ecg::ECG_BACKEND_AUTO);
+}
+
+TEST(ecg_api, thread_safe_stress) {
+	auto& mesh_inst = ecg_meshes::get_instance();
+	ecg::ecg_mesh_t& cube = mesh_inst.loaded_meshes_by_name["default_cube.obj"]->mesh;
+	ecg::ecg_mesh_t& closed_mesh = mesh_inst.loaded_meshes_by_name["is_closed_mesh-true.obj"]->mesh;
+	ecg::ecg_mesh_t& not_triangulated = mesh_inst.loaded_meshes_by_name["not_triangulated_mesh_1.obj"]->mesh;
+	ecg::ecg_mesh_t& cube_int_1 = mesh_inst.loaded_meshes_by_name["cube_int_1.obj"]->mesh;
+	ecg::ecg_mesh_t& cube_int_2 = mesh_inst.loaded_meshes_by_name["cube_int_2.obj"]->mesh;
+
+	bool thread_safe_mode = ecg::is_thread_safe_mode();
+	ecg::set_thread_safe_mode(true);
+	ASSERT_TRUE(ecg::is_thread_safe_mode());
+
+	// Results of a single thread are the reference for all threads
+	const ecg::vec3_base sum = ecg::sum_vertexes(&closed_mesh);
+	const ecg::vec3_base center = ecg::get_center(&closed_mesh);
+	const float area = ecg::compute_surface_area(&closed_mesh);
+	const float volume = ecg::compute_volume(&closed_mesh);
+	const bool is_closed = ecg::is_mesh_closed(&closed_mesh);
+	const bool is_manifold = ecg::is_mesh_manifold(&cube);
+	const bool is_self_intersected = ecg::is_mesh_self_intersected(&cube, ecg::self_intersection_method::SI_BRUTEFORCE);
+	const ecg::bounding_box aabb = ecg::hulls::compute_aabb(&closed_mesh);
+
+	// Every call is counted as one operation
+	auto run_all_api = [&](std::atomic<int>& errors) -> int {
+		ecg::ecg_status status;
+		int operations = 0;
+
+		auto check = [&](bool result) {
+			if (!result || status != ecg::ecg_status_code::SUCCESS) ++errors;
+			++operations;
+		};
+
+		check(ecg::compare_vec3_base(ecg::sum_vertexes(&closed_mesh, &status), sum, 1e-2f));
+		check(ecg::compare_vec3_base(ecg::get_center(&closed_mesh, &status), center, 1e-3f));
+		check(std::abs(ecg::compute_surface_area(&closed_mesh, &status) - area) <= std::abs(area) * 1e-4f);
+		check(std::abs(ecg::compute_volume(&closed_mesh, &status) - volume) <= std::abs(volume) * 1e-4f + 1e-4f);
+		check(ecg::is_mesh_closed(&closed_mesh, &status) == is_closed);
+		check(ecg::is_mesh_manifold(&cube, &status) == is_manifold);
+		check(ecg::is_mesh_self_intersected(&cube, ecg::self_intersection_method::SI_BRUTEFORCE, &status) == is_self_intersected);
+		check(ecg::compare_bounding_boxes(ecg::hulls::compute_aabb(&closed_mesh, &status), aabb));
+
+		ecg::compute_covariance_matrix(&closed_mesh, &status);
+		check(true);
+		ecg::hulls::compute_obb(&closed_mesh, &status);
+		check(true);
+
+		ecg::ecg_array_t faces_normals = ecg::compute_faces_normals(&closed_mesh, &status);
+		check(faces_normals.arr_size == closed_mesh.indexes_size / 3);
+		ecg::cleanup(faces_normals.handler);
+
+		ecg::ecg_array_t vertex_normals = ecg::compute_vertex_normals(&closed_mesh, &status);
+		check(vertex_normals.arr_size == closed_mesh.vertexes_size);
+		ecg::cleanup(vertex_normals.handler);
+
+		ecg::ecg_array_t triangulated = ecg::triangulate_mesh(&not_triangulated, 4, &status);
+		check(triangulated.arr_size > 0 && triangulated.arr_size % 3 == 0);
+		ecg::cleanup(triangulated.handler);
+
+		ecg::ecg_uploaded_mesh_t uploaded = ecg::upload_mesh(&closed_mesh, &status);
+		check(uploaded.handler != 0);
+		check(ecg::compare_bounding_boxes(ecg::hulls::compute_aabb(uploaded, &status), aabb));
+		ecg::cleanup(uploaded.handler);
+
+		ecg::ecg_internal_mesh_t intersection = ecg::compute_intersection(&cube_int_1, &cube_int_2, &status);
+		check(intersection.vertexes.arr_size != 0);
+		ecg::cleanup(intersection.vertexes.handler);
+		ecg::cleanup(intersection.indexes.handler);
+
+		return operations;
+	};
+
+	const int iterations = 3;
+	double single_thread_throughput = 0.0;
+	size_t thread_queues_cnt = ecg::ecg_cl::get_instance().get_thread_queues_count();
+
+	for (int threads_cnt : { 1, 2, 4, 8 }) {
+		std::atomic<int> errors = 0;
+		std::atomic<int> operations = 0;
+		std::vector<std::thread> threads;
+
+		auto start = std::chrono::steady_clock::now();
+		for (int thread_id = 0; thread_id < threads_cnt; ++thread_id) {
+			threads.emplace_back([&] {
+				for (int iteration = 0; iteration < iterations; ++iteration)
+					operations += run_all_api(errors);
+			});
+		}
+
+		for (auto& thread : threads) thread.join();
+		double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		double throughput = operations / time;
+		if (threads_cnt == 1) single_thread_throughput = throughput;
+
+		std::cout << "Threads: " << threads_cnt << ", operations/s: " << throughput
+			<< ", scaling: " << throughput / single_thread_throughput << std::endl;
+
+		ASSERT_EQ(errors, 0);
+
+		// Queues of the finished threads are released with them
+		ASSERT_EQ(ecg::ecg_cl::get_instance().get_thread_queues_count(), thread_queues_cnt);
+	}
+
+	ecg::set_thread_safe_mode(thread_safe_mode);
+}
+
+TEST(ecg_api, buffer_pool) {
+	auto& mesh_inst = ecg_meshes::get_instance();
+	ecg::ecg_mesh_t& mesh = mesh_inst.loaded_meshes_by_name["is_closed_mesh-true.obj"]->mesh;
+	ecg::ecg_status status;
+
+	ASSERT_EQ(ecg::ecg_buffer_pool::get_size_class(1), ecg::ecg_buffer_pool::min_size_class);
+	ASSERT_EQ(ecg::ecg_buffer_pool::get_size_class(1000), 1024);
+	ASSERT_EQ(ecg::ecg_buffer_pool::get_size_class(1024), 1024);
+
+	const float area = ecg::compute_surface_area(&mesh, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ecg::ecg_buffer_pool_stats_t first = ecg::get_buffer_pool_stats();
+	ASSERT_GT(first.cached_buffers, 0);
+
+	// Same sizes on the same queue are served from the pool
+	ASSERT_FLOAT_EQ(ecg::compute_surface_area(&mesh, &status), area);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ecg::ecg_buffer_pool_stats_t second = ecg::get_buffer_pool_stats();
+	ASSERT_GT(second.hits, first.hits);
+	ASSERT_EQ(second.misses, first.misses);
+
+	ecg::trim_buffer_pool();
+	ecg::ecg_buffer_pool_stats_t trimmed = ecg::get_buffer_pool_stats();
+	ASSERT_EQ(trimmed.cached_buffers, 0);
+	ASSERT_EQ(trimmed.cached_bytes, 0);
+	ASSERT_GT(trimmed.evictions, second.evictions);
+
+	// Without a limit nothing is kept, but the functions still work
+	ecg::set_buffer_pool_limit(0);
+	ASSERT_FLOAT_EQ(ecg::compute_surface_area(&mesh, &status), area);
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	ASSERT_EQ(ecg::get_buffer_pool_stats().cached_bytes, 0);
+	ASSERT_EQ(ecg::get_buffer_pool_stats().limit_bytes, 0);
+
+	ecg::set_buffer_pool_limit(ecg::ecg_buffer_pool::default_limit);
+}
+
+TEST(ecg_api, zero_copy) {
+	ecg::ecg_cl& host_ctrl = ecg::ecg_cl::get_instance();
+	auto& mesh_inst = ecg_meshes::get_instance();
+	ecg::ecg_mesh_t& mesh = mesh_inst.loaded_meshes_by_name["convex_hull_1.obj"]->mesh;
+	ecg::ecg_status status;
+
+	for (auto& dev : ecg::ecg_cl::get_available_devices()) {
+		host_ctrl.release_controller();
+		host_ctrl.default_init(dev.id);
+		if (!host_ctrl.is_host_unified_memory()) continue;
+
+		std::cout << "Device Name: " << host_ctrl.get_device().getInfo<CL_DEVICE_NAME>() << std::endl;
+		const int iterations = 3;
+		std::vector<std::vector<ecg::vec3_base>> results;
+
+		// Only aligned arrays of whole cache lines back buffers directly
+		ecg::set_zero_copy_mode(true);
+		const size_t alignment = host_ctrl.get_zero_copy_alignment();
+		std::vector<uint8_t> storage(alignment * 2);
+		void* aligned_ptr = storage.data();
+		size_t space = storage.size();
+		ASSERT_NE(std::align(alignment, alignment, aligned_ptr, space), nullptr);
+		ASSERT_TRUE(ecg::is_zero_copy_array(aligned_ptr, alignment));
+		ASSERT_FALSE(ecg::is_zero_copy_array(aligned_ptr, alignment - 4));
+		ASSERT_FALSE(ecg::is_zero_copy_array(static_cast<uint8_t*>(aligned_ptr) + 64, alignment - 64));
+
+		for (bool zero_copy : { false, true }) {
+			ecg::set_zero_copy_mode(zero_copy);
+			ASSERT_EQ(ecg::is_zero_copy_mode(), zero_copy);
+
+			std::vector<ecg::vec3_base> normals;
+			custom_timer_t timer;
+			timer.start();
+
+			for (int iteration = 0; iteration < iterations; ++iteration) {
+				ecg::ecg_array_t faces_normals = ecg::compute_faces_normals(&mesh, &status);
+				ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+				ecg::ecg_array_t vertex_normals = ecg::compute_vertex_normals(&mesh, &status);
+				ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+
+				if (iteration == 0) {
+					auto faces_ptr = static_cast<ecg::vec3_base*>(faces_normals.arr_ptr);
+					auto vertex_ptr = static_cast<ecg::vec3_base*>(vertex_normals.arr_ptr);
+					normals.assign(faces_ptr, faces_ptr + faces_normals.arr_size);
+					normals.insert(normals.end(), vertex_ptr, vertex_ptr + vertex_normals.arr_size);
+				}
+
+				ecg::cleanup(faces_normals.handler);
+				ecg::cleanup(vertex_normals.handler);
+			}
+
+			timer.end();
+			std::cout << (zero_copy ? "Zero-copy: " : "Copy: ") << timer << std::endl;
+			results.push_back(std::move(normals));
+		}
+
+		ASSERT_EQ(results[0].size(), results[1].size());
+		for (size_t id = 0; id < results[0].size(); ++id)
+			ASSERT_TRUE(ecg::compare_vec3_base(results[0][id], results[1][id], 1e-5f));
+
+		// Persistent meshes own their buffers even with zero-copy
+		ecg::ecg_uploaded_mesh_t uploaded = ecg::upload_mesh(&mesh, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_FLOAT_EQ(ecg::compute_surface_area(uploaded, &status), ecg::compute_surface_area(&mesh));
+		ecg::cleanup(uploaded.handler);
+	}
+
+	ecg::set_zero_copy_mode(true);
+	host_ctrl.release_controller();
+	host_ctrl.default_init();
+}
+
+TEST(ecg_api, cpu_backend) {
+	ecg::ecg_cl& host_ctrl = ecg::ecg_cl::get_instance();
+	auto& mesh_inst = ecg_meshes::get_instance();
+	ecg::ecg_status status;
+
+	ASSERT_EQ(ecg::get_backend(), ecg::ECG_BACKEND_AUTO);
+	ASSERT_EQ(ecg::get_active_backend(), ecg::ECG_BACKEND_OPENCL);
+
+	ecg::set_backend(ecg::ECG_BACKEND_CPU);
+	ASSERT_EQ(ecg::get_active_backend(), ecg::ECG_BACKEND_CPU);
+
+	ecg::vec3_base sum = ecg::sum_vertexes(nullptr, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::INVALID_ARG);
+	ASSERT_TRUE(ecg::compare_vec3_base(sum, ecg::vec3_base()));
+
+	ecg::ecg_mesh_t empty_mesh;
+	ASSERT_FLOAT_EQ(ecg::compute_surface_area(&empty_mesh, &status), -FLT_MAX);
+	ASSERT_EQ(status, ecg::ecg_status_code::EMPTY_VERTEX_ARR);
+
+	// Indexes outside of the vertex array are rejected instead of read
+	std::vector<ecg::vec3_base> broken_vertexes = { { 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } };
+	std::vector<uint32_t> broken_indexes = { 0, 1, 5 };
+	ecg::ecg_mesh_t broken_mesh;
+	broken_mesh.vertexes = broken_vertexes.data();
+	broken_mesh.vertexes_size = broken_vertexes.size();
+	broken_mesh.indexes = broken_indexes.data();
+	broken_mesh.indexes_size = broken_indexes.size();
+
+	ASSERT_FLOAT_EQ(ecg::compute_surface_area(&broken_mesh, &status), -FLT_MAX);
+	ASSERT_EQ(status, ecg::ecg_status_code::INVALID_ARG);
+	ecg::triangulate_mesh(&broken_mesh, 1, &status);
+	ASSERT_EQ(status, ecg::ecg_status_code::INCORRECT_VERTEX_COUNT_IN_FACE);
+
+	auto is_near = [](float lhs, float rhs) {
+		return std::fabs(lhs - rhs) <= 1e-3f * std::max({ 1.0f, std::fabs(lhs), std::fabs(rhs) });
+	};
+
+	auto is_near_vec = [&](const ecg::vec3_base& lhs, const ecg::vec3_base& rhs) {
+		return is_near(lhs.x, rhs.x) && is_near(lhs.y, rhs.y) && is_near(lhs.z, rhs.z);
+	};
+
+	auto is_near_arr = [&](const ecg::ecg_array_t& lhs, const ecg::ecg_array_t& rhs) {
+		if (lhs.arr_size != rhs.arr_size) return false;
+		auto lhs_ptr = static_cast<ecg::vec3_base*>(lhs.arr_ptr);
+		auto rhs_ptr = static_cast<ecg::vec3_base*>(rhs.arr_ptr);
+		for (size_t id = 0; id < lhs.arr_size; ++id)
+			if (!is_near_vec(lhs_ptr[id], rhs_ptr[id])) return false;
+		return true;
+	};
+
+	// Both backends must agree on every small mesh, large ones are too slow for the emulated devices
+	for (auto& item : mesh_inst.loaded_meshes) {
+		ecg::ecg_mesh_t& mesh = item->mesh;
+		if (mesh.indexes_size % 3 != 0 || mesh.indexes_size / 3 > 2500) continue;
+		std::cout << "Mesh: " << item->full_path.filename().string() << std::endl;
+
+		custom_timer_t timer;
+		ecg::ecg_status cpu_status, cl_status;
+
+		auto compare = [&](auto&& func, auto&& is_equal) {
+			ecg::set_backend(ecg::ECG_BACKEND_CPU);
+			auto cpu_result = func(&cpu_status);
+			ecg::set_backend(ecg::ECG_BACKEND_OPENCL);
+			auto cl_result = func(&cl_status);
+
+			ASSERT_EQ(cpu_status, cl_status);
+			if (cpu_status == ecg::ecg_status_code::SUCCESS) {
+				ASSERT_TRUE(is_equal(cpu_result, cl_result));
+			}
+		};
+
+		auto is_same = [](auto lhs, auto rhs) { return lhs == rhs; };
+
+		timer.start();
+		compare([&](ecg::ecg_status* st) { return ecg::sum_vertexes(&mesh, st); }, is_near_vec);
+		compare([&](ecg::ecg_status* st) { return ecg::get_center(&mesh, st); }, is_near_vec);
+		compare([&](ecg::ecg_status* st) { return ecg::compute_surface_area(&mesh, st); }, is_near);
+		compare([&](ecg::ecg_status* st) { return ecg::is_mesh_closed(&mesh, st); }, is_same);
+		compare([&](ecg::ecg_status* st) { return ecg::is_mesh_manifold(&mesh, st); }, is_same);
+		compare([&](ecg::ecg_status* st) { return ecg::is_mesh_self_intersected(&mesh, ecg::SI_BRUTEFORCE, st); }, is_same);
+		compare([&](ecg::ecg_status* st) { return ecg::compute_volume(&mesh, st); }, is_near);
+
+		compare([&](ecg::ecg_status* st) { return ecg::compute_covariance_matrix(&mesh, st); },
+			[&](const ecg::mat3_base& lhs, const ecg::mat3_base& rhs) {
+				auto lhs_ptr = reinterpret_cast<const float*>(&lhs);
+				auto rhs_ptr = reinterpret_cast<const float*>(&rhs);
+				for (size_t id = 0; id < 9; ++id)
+					if (!is_near(lhs_ptr[id], rhs_ptr[id])) return false;
+				return true;
+			});
+
+		compare([&](ecg::ecg_status* st) { return ecg::hulls::compute_aabb(&mesh, st); },
+			[&](const ecg::bounding_box& lhs, const ecg::bounding_box& rhs) {
+				return is_near_vec(lhs.min, rhs.min) && is_near_vec(lhs.max, rhs.max);
+			});
+
+		// Axes of symmetric meshes aren't unique, so only the status is compared
+		compare([&](ecg::ecg_status* st) { return ecg::hulls::compute_obb(&mesh, st); },
+			[](const ecg::full_bounding_box&, const ecg::full_bounding_box&) { return true; });
+
+		auto compare_arrays = [&](auto&& func) {
+			ecg::ecg_array_t results[2];
+			for (int id = 0; id < 2; ++id) {
+				ecg::set_backend(id == 0 ? ecg::ECG_BACKEND_CPU : ecg::ECG_BACKEND_OPENCL);
+				results[id] = func(&status);
+				ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+			}
+
+			ASSERT_TRUE(is_near_arr(results[0], results[1]));
+			ecg::cleanup(results[0].handler);
+			ecg::cleanup(results[1].handler);
+		};
+
+		compare_arrays([&](ecg::ecg_status* st) { return ecg::compute_faces_normals(&mesh, st); });
+		compare_arrays([&](ecg::ecg_status* st) { return ecg::compute_vertex_normals(&mesh, st); });
+		timer.end();
+	}
+
+	ecg::ecg_mesh_t& not_triangulated = mesh_inst.loaded_meshes_by_name["not_triangulated_mesh_1.obj"]->mesh;
+	ecg::ecg_array_t triangulated[2];
+	for (int id = 0; id < 2; ++id) {
+		ecg::set_backend(id == 0 ? ecg::ECG_BACKEND_CPU : ecg::ECG_BACKEND_OPENCL);
+		triangulated[id] = ecg::triangulate_mesh(&not_triangulated, 4, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	}
+
+	ASSERT_EQ(triangulated[0].arr_size, triangulated[1].arr_size);
+	ASSERT_TRUE(std::equal(
+		static_cast<uint32_t*>(triangulated[0].arr_ptr), static_cast<uint32_t*>(triangulated[0].arr_ptr) + triangulated[0].arr_size,
+		static_cast<uint32_t*>(triangulated[1].arr_ptr)));
+	ecg::cleanup(triangulated[0].handler);
+	ecg::cleanup(triangulated[1].handler);
+
+	ecg::ecg_mesh_t& cube_int_1 = mesh_inst.loaded_meshes_by_name["cube_int_1.obj"]->mesh;
+	ecg::ecg_mesh_t& cube_int_2 = mesh_inst.loaded_meshes_by_name["cube_int_2.obj"]->mesh;
+	ecg::ecg_internal_mesh_t intersections[2];
+	for (int id = 0; id < 2; ++id) {
+		ecg::set_backend(id == 0 ? ecg::ECG_BACKEND_CPU : ecg::ECG_BACKEND_OPENCL);
+		intersections[id] = ecg::compute_intersection(&cube_int_1, &cube_int_2, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+	}
+
+	ASSERT_EQ(intersections[0].vertexes.arr_size, intersections[1].vertexes.arr_size);
+	ASSERT_EQ(intersections[0].indexes.arr_size, intersections[1].indexes.arr_size);
+
+	// Without an initialized controller AUTO falls back to the host
+	ecg::ecg_mesh_t& mesh = mesh_inst.loaded_meshes_by_name["convex_hull_1.obj"]->mesh;
+	float expected_area = ecg::compute_surface_area(&mesh);
+
+	ecg::set_backend(ecg::ECG_BACKEND_AUTO);
+	host_ctrl.release_controller();
+	ASSERT_EQ(ecg::get_active_backend(), ecg::ECG_BACKEND_CPU);
+
+	ASSERT_TRUE(is_near(ecg::compute_surface_area(&mesh, &status), expected_area));
+	ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+
+	ecg::upload_mesh(&mesh, &status);
+	ASSERT_NE(status, ecg::ecg_status_code::SUCCESS);
+
+	host_ctrl.default_init();
+	ASSERT_EQ(ecg::get_active_backend(), ecg::ECG_BACKEND_OPENCL);
+}
+
+namespace ecg_intersection {
+	TEST(ecg_api, compute_intersection) {
+		auto& mesh_inst = ecg_meshes::get_instance();
+		ecg::ecg_mesh_t cube_int_1 = mesh_inst.loaded_meshes_by_name["cube_int_1.obj"]->mesh;
+		ecg::ecg_mesh_t cube_int_2 = mesh_inst.loaded_meshes_by_name["cube_int_2.obj"]->mesh;
+
+		ecg::ecg_status status = ecg::ecg_status_code::SUCCESS;
+		custom_timer_t timer;
+
+		timer.start();
+		ecg::ecg_internal_mesh_t res = ecg::compute_intersection(&cube_int_1, &cube_int_2, &status);
+		timer.end();
+
+		ASSERT_TRUE(res.vertexes.arr_ptr != nullptr);
+		ASSERT_TRUE(res.vertexes.arr_size != 0);
+		ASSERT_TRUE(res.vertexes.handler != 0);
+		ecg::cleanup(res.vertexes.handler);
+		ecg::cleanup(res.indexes.handler);
+
+		// The broad phase skips pairs of faces that can't cross, so the result matches the exhaustive search
+		auto compare_with_cpu = [&](const ecg::ecg_mesh_t& m1, const ecg::ecg_mesh_t& m2, bool is_empty) {
+			ecg::ecg_internal_mesh_t gpu_res = ecg::compute_intersection(&m1, &m2, &status);
+			ecg::ecg_status gpu_status = status;
+
+			ecg::set_backend(ecg::ECG_BACKEND_CPU);
+			ecg::ecg_internal_mesh_t cpu_res = ecg::compute_intersection(&m1, &m2, &status);
+			ecg::set_backend(ecg::ECG_BACKEND_AUTO);
+			ASSERT_EQ(gpu_status, status);
+
+			// Without points there is no hull to build, so an empty intersection reports an invalid argument
+			ASSERT_EQ(status, is_empty ? ecg::ecg_status_code::INVALID_ARG : ecg::ecg_status_code::SUCCESS);
+			ASSERT_EQ(gpu_res.vertexes.arr_size == 0, is_empty);
+			ASSERT_EQ(gpu_res.vertexes.arr_size, cpu_res.vertexes.arr_size);
+			ASSERT_EQ(gpu_res.indexes.arr_size, cpu_res.indexes.arr_size);
+
+			auto gpu_vertexes = static_cast<ecg::vec3_base*>(gpu_res.vertexes.arr_ptr);
+			auto cpu_vertexes = static_cast<ecg::vec3_base*>(cpu_res.vertexes.arr_ptr);
+			for (size_t id = 0; id < gpu_res.vertexes.arr_size; ++id) {
+				ASSERT_TRUE(ecg::compare_vec3_base(gpu_vertexes[id], cpu_vertexes[id], 1e-4f));
+			}
+
+			if (gpu_res.indexes.arr_size != 0) {
+				ASSERT_EQ(std::memcmp(gpu_res.indexes.arr_ptr, cpu_res.indexes.arr_ptr, sizeof(uint32_t) * gpu_res.indexes.arr_size), 0);
+			}
+
+			ecg::cleanup(gpu_res.vertexes.handler);
+			ecg::cleanup(gpu_res.indexes.handler);
+			ecg::cleanup(cpu_res.vertexes.handler);
+			ecg::cleanup(cpu_res.indexes.handler);
+		};
+
+		compare_with_cpu(cube_int_1, cube_int_2, false);
+
+		// Only a part of the faces of the first cube lies in the box of the shifted one, the rest is culled at the root
+		std::vector<ecg::vec3_base> shifted_vertexes(cube_int_1.vertexes, cube_int_1.vertexes + cube_int_1.vertexes_size);
+		for (auto& vrt : shifted_vertexes) vrt = { vrt.x + 1.5f, vrt.y + 0.25f, vrt.z + 0.35f };
+		ecg::ecg_mesh_t shifted_cube = cube_int_1;
+		shifted_cube.vertexes = shifted_vertexes.data();
+		compare_with_cpu(cube_int_1, shifted_cube, false);
+
+		// Separated boxes give no points
+		for (auto& vrt : shifted_vertexes) vrt.x += 5.0f;
+		compare_with_cpu(cube_int_1, shifted_cube, true);
+	}
+}
+
+namespace ecg_simplifiation {
+	TEST(ecg_api, convex_hull) {
+		auto& mesh_inst = ecg_meshes::get_instance();
+		ecg::ecg_mesh_t convex_hull_1 = mesh_inst.loaded_meshes_by_name["convex_hull_1.obj"]->mesh;
+		
+		ecg::ecg_status status = ecg::ecg_status_code::SUCCESS;
+		custom_timer_t timer;
+
+		ecg::ecg_array_t vertexes;
+		vertexes.arr_ptr = convex_hull_1.vertexes;
+		vertexes.arr_size = convex_hull_1.vertexes_size;
+
+		timer.start();
+		auto convex_hull = ecg::hulls::create_convex_hull(vertexes, &status);
+		timer.end();
+
+		ecg::ecg_mesh_t mesh;
+		mesh.vertexes = static_cast<ecg::vec3_base*>(convex_hull.vertexes.arr_ptr);
+		mesh.indexes = static_cast<uint32_t*>(convex_hull.indexes.arr_ptr);
+		mesh.vertexes_size = convex_hull.vertexes.arr_size;
+		mesh.indexes_size = convex_hull.indexes.arr_size;
+
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ecg::save_mesh(&mesh, "Models/res_convex_hull_1", ecg::ecg_file_type::ECG_OBJ_FILE, &status);
+
+		// Every vertex lies behind the planes of the outward faces and the hull is closed
+		ASSERT_TRUE(ecg::is_mesh_closed(&mesh, &status));
+		for (size_t face_id = 0; face_id < mesh.indexes_size / 3; ++face_id) {
+			ecg::vec3_base v0 = mesh.vertexes[mesh.indexes[face_id * 3 + 0]];
+			ecg::vec3_base v1 = mesh.vertexes[mesh.indexes[face_id * 3 + 1]];
+			ecg::vec3_base v2 = mesh.vertexes[mesh.indexes[face_id * 3 + 2]];
+
+			float e1[3] = { v1.x - v0.x, v1.y - v0.y, v1.z - v0.z };
+			float e2[3] = { v2.x - v0.x, v2.y - v0.y, v2.z - v0.z };
+			float normal[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+			float normal_length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			ASSERT_GT(normal_length, 0.0f);
+
+			for (size_t vrt_id = 0; vrt_id < mesh.vertexes_size; ++vrt_id) {
+				ecg::vec3_base vrt = mesh.vertexes[vrt_id];
+				float distance = (normal[0] * (vrt.x - v0.x) + normal[1] * (vrt.y - v0.y) + normal[2] * (vrt.z - v0.z)) / normal_length;
+				ASSERT_LT(distance, 1e-3f);
+			}
+		}
+
+		ecg::cleanup(convex_hull.vertexes.handler);
+		ecg::cleanup(convex_hull.indexes.handler);
+
+		// Corners of a cube with inner points give its 12 faces
+		std::vector<ecg::vec3_base> cube_vertexes = {
+			{ 0.5f, 0.5f, 0.5f }, { 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 1.0f, 0.0f },
+			{ 0.25f, 0.5f, 0.75f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 1.0f }, { 1.0f, 1.0f, 1.0f },
+		};
+		vertexes.arr_ptr = cube_vertexes.data();
+		vertexes.arr_size = cube_vertexes.size();
+
+		convex_hull = ecg::hulls::create_convex_hull(vertexes, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_EQ(convex_hull.indexes.arr_size, 36);
+
+		auto cube_indexes = static_cast<uint32_t*>(convex_hull.indexes.arr_ptr);
+		for (size_t id = 0; id < convex_hull.indexes.arr_size; ++id) {
+			ASSERT_NE(cube_indexes[id], 0);
+			ASSERT_NE(cube_indexes[id], 5);
+		}
+		ecg::cleanup(convex_hull.vertexes.handler);
+		ecg::cleanup(convex_hull.indexes.handler);
+
+		// Inner points of a cube are culled by the polytope of its k-DOP extremes on both backends
+		std::vector<ecg::vec3_base> cloud_vertexes;
+		for (int x = 1; x < 10; ++x)
+			for (int y = 1; y < 10; ++y)
+				for (int z = 1; z < 10; ++z)
+					cloud_vertexes.push_back({ x * 0.1f, y * 0.1f, z * 0.1f });
+		const size_t inner_cnt = cloud_vertexes.size();
+		cloud_vertexes.insert(cloud_vertexes.end(), cube_vertexes.begin(), cube_vertexes.end());
+		vertexes.arr_ptr = cloud_vertexes.data();
+		vertexes.arr_size = cloud_vertexes.size();
+
+		for (ecg::ecg_backend backend : { ecg::ECG_BACKEND_OPENCL, ecg::ECG_BACKEND_CPU }) {
+			ecg::set_backend(backend);
+			for (ecg::hull_prefilter_method prefilter : { ecg::HP_NONE, ecg::HP_KDOP_6, ecg::HP_KDOP_26 }) {
+				size_t culled_cnt = 0;
+				convex_hull = ecg::hulls::create_convex_hull(vertexes, prefilter, &culled_cnt, &status);
+				ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+				ASSERT_EQ(convex_hull.indexes.arr_size, 36);
+
+				if (prefilter == ecg::HP_NONE) ASSERT_EQ(culled_cnt, 0);
+				else if (prefilter == ecg::HP_KDOP_6) ASSERT_GT(culled_cnt, 0);
+				else ASSERT_GE(culled_cnt, inner_cnt);
+
+				ecg::cleanup(convex_hull.vertexes.handler);
+				ecg::cleanup(convex_hull.indexes.handler);
+			}
+		}
+		ecg::set_backend(ecg::ECG_BACKEND_AUTO);
+
+		convex_hull = ecg::hulls::create_convex_hull(vertexes, ecg::HP_METHODS_COUNT, nullptr, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::INVALID_ARG);
+
+		// Flat sets have no volume
+		std::vector<ecg::vec3_base> flat_vertexes = { { 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 1.0f, 0.0f } };
+		vertexes.arr_ptr = flat_vertexes.data();
+		vertexes.arr_size = flat_vertexes.size();
+
+		convex_hull = ecg::hulls::create_convex_hull(vertexes, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::INVALID_ARG);
+		ASSERT_EQ(convex_hull.indexes.handler, 0);
+	}
+
+	TEST(ecg_api, qem_simplification) {
+		auto& mesh_inst = ecg_meshes::get_instance();
+		ecg::ecg_mesh_t convex_hull_1 = mesh_inst.loaded_meshes_by_name["convex_hull_1.obj"]->mesh;
+		ecg::ecg_status status = ecg::ecg_status_code::SUCCESS;
+		custom_timer_t timer;
+
+		ecg::ecg_simplify_params_t params;
+		params.target_faces_cnt = convex_hull_1.indexes_size / 3 / 4;
+
+		timer.start();
+		auto simplified = ecg::simplify_mesh(&convex_hull_1, ecg::SM_QEM, params, &status);
+		timer.end();
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+
+		ecg::ecg_mesh_t mesh;
+		mesh.vertexes = static_cast<ecg::vec3_base*>(simplified.vertexes.arr_ptr);
+		mesh.indexes = static_cast<uint32_t*>(simplified.indexes.arr_ptr);
+		mesh.vertexes_size = static_cast<uint32_t>(simplified.vertexes.arr_size);
+		mesh.indexes_size = static_cast<uint32_t>(simplified.indexes.arr_size);
+		ecg::save_mesh(&mesh, "Models/res_qem_simplification_1", ecg::ecg_file_type::ECG_OBJ_FILE, &status);
+
+		// The target is reached, every vertex is used and the closed mesh stays closed
+		ASSERT_LE(mesh.indexes_size / 3, params.target_faces_cnt);
+		ASSERT_GE(mesh.indexes_size / 3 + 2, params.target_faces_cnt);
+		std::vector<bool> is_used(mesh.vertexes_size, false);
+		for (uint32_t id = 0; id < mesh.indexes_size; ++id) {
+			ASSERT_LT(mesh.indexes[id], mesh.vertexes_size);
+			is_used[mesh.indexes[id]] = true;
+		}
+		ASSERT_EQ(std::count(is_used.begin(), is_used.end(), false), 0);
+		ASSERT_TRUE(ecg::is_mesh_closed(&mesh, &status));
+
+		ecg::cleanup(simplified.vertexes.handler);
+		ecg::cleanup(simplified.indexes.handler);
+
+		// A flat grid is collapsed without error and stays in its plane and square
+		const uint32_t grid_size = 10;
+		std::vector<ecg::vec3_base> grid_vertexes;
+		std::vector<uint32_t> grid_indexes;
+		for (uint32_t y = 0; y <= grid_size; ++y)
+			for (uint32_t x = 0; x <= grid_size; ++x)
+				grid_vertexes.push_back({ float(x), float(y), 0.0f });
+
+		for (uint32_t y = 0; y < grid_size; ++y) {
+			for (uint32_t x = 0; x < grid_size; ++x) {
+				uint32_t id = y * (grid_size + 1) + x;
+				grid_indexes.insert(grid_indexes.end(), { id, id + 1, id + grid_size + 2, id, id + grid_size + 2, id + grid_size + 1 });
+			}
+		}
+
+		ecg::ecg_mesh_t grid;
+		grid.vertexes = grid_vertexes.data();
+		grid.vertexes_size = static_cast<uint32_t>(grid_vertexes.size());
+		grid.indexes = grid_indexes.data();
+		grid.indexes_size = static_cast<uint32_t>(grid_indexes.size());
+
+		params.target_faces_cnt = 0;
+		params.max_error = 1e-6f;
+		simplified = ecg::simplify_mesh(&grid, ecg::SM_QEM, params, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_LT(simplified.indexes.arr_size, grid_indexes.size() / 4);
+
+		float area = 0.0f;
+		auto vertexes = static_cast<ecg::vec3_base*>(simplified.vertexes.arr_ptr);
+		auto indexes = static_cast<uint32_t*>(simplified.indexes.arr_ptr);
+		for (size_t id = 0; id < simplified.vertexes.arr_size; ++id)
+			ASSERT_NEAR(vertexes[id].z, 0.0f, 1e-5f);
+
+		for (size_t face_id = 0; face_id < simplified.indexes.arr_size / 3; ++face_id) {
+			ecg::vec3_base v0 = vertexes[indexes[face_id * 3 + 0]];
+			ecg::vec3_base v1 = vertexes[indexes[face_id * 3 + 1]];
+			ecg::vec3_base v2 = vertexes[indexes[face_id * 3 + 2]];
+			area += ((v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x)) * 0.5f;
+		}
+		ASSERT_NEAR(area, float(grid_size * grid_size), 1e-3f);
+
+		ecg::cleanup(simplified.vertexes.handler);
+		ecg::cleanup(simplified.indexes.handler);
+
+		params.max_error = -1.0f;
+		simplified = ecg::simplify_mesh(&grid, ecg::SM_QEM, params, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::INVALID_ARG);
+		ASSERT_EQ(simplified.indexes.handler, 0);
+	}
+
+	TEST(ecg_api, center_point_simplification) {
+		auto& mesh_inst = ecg_meshes::get_instance();
+		ecg::ecg_mesh_t convex_hull_1 = mesh_inst.loaded_meshes_by_name["convex_hull_1.obj"]->mesh;
+		ecg::ecg_mesh_t default_cube = mesh_inst.loaded_meshes_by_name["default_cube.obj"]->mesh;
+		ecg::ecg_status status = ecg::ecg_status_code::SUCCESS;
+
+		ecg::ecg_simplify_params_t params;
+		params.grid_resolution = 8;
+
+		// Both backends cluster the same vertexes and keep the same faces
+		std::vector<ecg::ecg_internal_mesh_t> results;
+		for (ecg::ecg_backend backend : { ecg::ECG_BACKEND_OPENCL, ecg::ECG_BACKEND_CPU }) {
+			ecg::set_backend(backend);
+			results.push_back(ecg::simplify_mesh(&convex_hull_1, ecg::SM_CENTER_POINT, params, &status));
+			ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		}
+		ecg::set_backend(ecg::ECG_BACKEND_AUTO);
+
+		ecg::ecg_mesh_t mesh;
+		mesh.vertexes = static_cast<ecg::vec3_base*>(results[0].vertexes.arr_ptr);
+		mesh.indexes = static_cast<uint32_t*>(results[0].indexes.arr_ptr);
+		mesh.vertexes_size = static_cast<uint32_t>(results[0].vertexes.arr_size);
+		mesh.indexes_size = static_cast<uint32_t>(results[0].indexes.arr_size);
+		ecg::save_mesh(&mesh, "Models/res_center_point_simplification_1", ecg::ecg_file_type::ECG_OBJ_FILE, &status);
+
+		ASSERT_GT(mesh.indexes_size, 0);
+		ASSERT_LT(mesh.indexes_size, convex_hull_1.indexes_size);
+		ASSERT_EQ(results[1].indexes.arr_size, mesh.indexes_size);
+		ASSERT_EQ(results[1].vertexes.arr_size, mesh.vertexes_size);
+
+		auto cpu_vertexes = static_cast<ecg::vec3_base*>(results[1].vertexes.arr_ptr);
+		auto cpu_indexes = static_cast<uint32_t*>(results[1].indexes.arr_ptr);
+		for (uint32_t id = 0; id < mesh.indexes_size; ++id)
+			ASSERT_EQ(mesh.indexes[id], cpu_indexes[id]);
+
+		for (uint32_t vrt_id = 0; vrt_id < mesh.vertexes_size; ++vrt_id) {
+			ASSERT_NEAR(mesh.vertexes[vrt_id].x, cpu_vertexes[vrt_id].x, 1e-4f);
+			ASSERT_NEAR(mesh.vertexes[vrt_id].y, cpu_vertexes[vrt_id].y, 1e-4f);
+			ASSERT_NEAR(mesh.vertexes[vrt_id].z, cpu_vertexes[vrt_id].z, 1e-4f);
+		}
+
+		// Faces have three cells and every cell is used
+		std::vector<bool> is_used(mesh.vertexes_size, false);
+		for (uint32_t face_id = 0; face_id < mesh.indexes_size / 3; ++face_id) {
+			uint32_t* face = mesh.indexes + face_id * 3;
+			ASSERT_TRUE(face[0] != face[1] && face[1] != face[2] && face[0] != face[2]);
+			for (uint32_t corner = 0; corner < 3; ++corner) {
+				ASSERT_LT(face[corner], mesh.vertexes_size);
+				is_used[face[corner]] = true;
+			}
+		}
+		ASSERT_EQ(std::count(is_used.begin(), is_used.end(), false), 0);
+
+		for (auto& result : results) {
+			ecg::cleanup(result.vertexes.handler);
+			ecg::cleanup(result.indexes.handler);
+		}
+
+		// A smaller target gives a coarser grid
+		params.grid_resolution = 0;
+		params.target_faces_cnt = 200;
+		auto coarse = ecg::simplify_mesh(&convex_hull_1, ecg::SM_CENTER_POINT, params, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		params.target_faces_cnt = 2000;
+		auto fine = ecg::simplify_mesh(&convex_hull_1, ecg::SM_CENTER_POINT, params, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_LT(coarse.indexes.arr_size, fine.indexes.arr_size);
+
+		ecg::cleanup(coarse.vertexes.handler);
+		ecg::cleanup(coarse.indexes.handler);
+		ecg::cleanup(fine.vertexes.handler);
+		ecg::cleanup(fine.indexes.handler);
+
+		// One cell takes all vertexes of the cube and no face is left
+		params.grid_resolution = 1;
+		auto single_cell = ecg::simplify_mesh(&default_cube, ecg::SM_CENTER_POINT, params, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_EQ(single_cell.indexes.arr_size, 0);
+		ASSERT_EQ(single_cell.vertexes.arr_size, 0);
+
+		// Without a resolution and a target the grid is unknown
+		params.grid_resolution = 0;
+		params.target_faces_cnt = 0;
+		single_cell = ecg::simplify_mesh(&default_cube, ecg::SM_CENTER_POINT, params, &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::INVALID_ARG);
+	}
+
+	TEST(ecg_api, generate_lod_chain) {
+		auto& mesh_inst = ecg_meshes::get_instance();
+		ecg::ecg_mesh_t convex_hull_1 = mesh_inst.loaded_meshes_by_name["convex_hull_1.obj"]->mesh;
+		ecg::ecg_status status = ecg::ecg_status_code::SUCCESS;
+		custom_timer_t timer;
+
+		const std::vector<float> ratios = { 1.0f, 0.5f, 0.25f, 0.1f };
+		const size_t faces_cnt = convex_hull_1.indexes_size / 3;
+
+		timer.start();
+		auto chain = ecg::generate_lod_chain(&convex_hull_1, ratios.data(), ratios.size(), &status);
+		timer.end();
+		ASSERT_EQ(status, ecg::ecg_status_code::SUCCESS);
+		ASSERT_EQ(chain.vertex_offsets.arr_size, ratios.size() + 1);
+		ASSERT_EQ(chain.index_offsets.arr_size, ratios.size() + 1);
+
+		auto vertex_offsets = static_cast<uint32_t*>(chain.vertex_offsets.arr_ptr);
+		auto index_offsets = static_cast<uint32_t*>(chain.index_offsets.arr_ptr);
+		ASSERT_EQ(vertex_offsets[0], 0);
+		ASSERT_EQ(index_offsets[0], 0);
+		ASSERT_EQ(vertex_offsets[ratios.size()], chain.mesh.vertexes.arr_size);
+		ASSERT_EQ(index_offsets[ratios.size()], chain.mesh.indexes.arr_size);
+
+		// Every level is a closed mesh with the part of the faces of its ratio
+		for (size_t level = 0; level < ratios.size(); ++level) {
+			ecg::ecg_mesh_t mesh;
+			mesh.vertexes = static_cast<ecg::vec3_base*>(chain.mesh.vertexes.arr_ptr) + vertex_offsets[level];
+			mesh.indexes = static_cast<uint32_t*>(chain.mesh.indexes.arr_ptr) + index_offsets[level];
+			mesh.vertexes_size = vertex_offsets[level + 1] - vertex_offsets[level];
+			mesh.indexes_size = index_offsets[level + 1] - index_offsets[level];
+
+			size_t target_faces_cnt = static_cast<size_t>(std::ceil(double(ratios[level]) * faces_cnt));
+			ASSERT_LE(mesh.indexes_size / 3, target_faces_cnt);
+			ASSERT_GE(mesh.indexes_size / 3 + 2, target_faces_cnt);
+			for (uint32_t id = 0; id < mesh.indexes_size; ++id)
+				ASSERT_LT(mesh.indexes[id], mesh.vertexes_size);
+			ASSERT_TRUE(ecg::is_mesh_closed(&mesh, &status));
+		}
+		ASSERT_EQ(vertex_offsets[1], convex_hull_1.vertexes_size);
+
+		ecg::cleanup(chain.mesh.vertexes.handler);
+		ecg::cleanup(chain.mesh.indexes.handler);
+		ecg::cleanup(chain.vertex_offsets.handler);
+		ecg::cleanup(chain.index_offsets.handler);
+
+		// Levels can't have more faces than the previous ones
+		const std::vector<float> increasing_ratios = { 0.5f, 0.8f };
+		chain = ecg::generate_lod_chain(&convex_hull_1, increasing_ratios.data(), increasing_ratios.size(), &status);
+		ASSERT_EQ(status, ecg::ecg_status_code::INVALID_ARG);
+		ASSERT_EQ(chain.mesh.indexes.handler, 0);
+	}
 }
\ No newline at end of file